@@ -0,0 +1,48 @@
+/**
+ * bench.h
+ *
+ * Headless benchmarks for the pixel core
+ * Each bench_*.c file provides one Run*Benchmarks entry point
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * Print a group heading
+ *
+ * @param group Name of the benchmark group
+ */
+void BenchBeginGroup(const char* group);
+
+/**
+ * Print one benchmark result and keep it for the JSON report
+ *
+ * @param name Benchmark name
+ * @param seconds Total measured time
+ * @param items Number of processed items (pixels, lines, ...)
+ * @param unit Name of one item, used for the per-item cost
+ */
+void BenchReport(const char* name, double seconds, double items, const char* unit);
+
+/**
+ * Print the speedup of one measurement over a baseline measurement
+ *
+ * @param name What is being compared
+ * @param baselineSeconds Time of the reference implementation
+ * @param seconds Time of the implementation under test
+ */
+void BenchReportSpeedup(const char* name, double baselineSeconds, double seconds);
+
+// Benchmark groups
+void RunCoreBenchmarks(void);
+void RunRasterBenchmarks(void);
+void RunFillBenchmarks(void);
+void RunKernelBenchmarks(void);
+void RunBlendBenchmarks(void);
+void RunLayerBenchmarks(void);
+void RunPngBenchmarks(void);
+void RunProjectBenchmarks(void);
+void RunRenderBenchmarks(void);
+
+#endif // BENCH_H
@@ -0,0 +1,144 @@
+/**
+ * bench_blend.c
+ *
+ * Alpha blending: per-pixel BlendColors calls versus the span kernels on
+ * every backend the CPU supports, and whole brush strokes painted opaque
+ * versus translucent to show what the coverage mask and blending add.
+ */
+
+#include "bench.h"
+#include "blend.h"
+#include "canvas.h"
+#include "pixelops.h"
+#include "tool.h"
+#include "timing.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BLEND_PIXELS CANVAS_TILE_PIXELS
+#define BLEND_REPEATS 1024
+#define BLEND_CANVAS_SIZE 1024
+#define BLEND_STROKE_SEGMENTS 4000
+
+static const Color blendSource = {40, 120, 220, 128};
+
+/**
+ * Half-painted destination with mixed alpha, as a sketch layer looks
+ */
+static void PrepareBlendInput(Color* pixels) {
+    unsigned int seed = 4242u;
+    for (int i = 0; i < BLEND_PIXELS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned int r = seed >> 8;
+        unsigned char alpha = (r & 1) ? 255 : (unsigned char)(r >> 16);
+        pixels[i] = (Color){(unsigned char)r, (unsigned char)(r >> 4), (unsigned char)(r >> 8), alpha};
+    }
+}
+
+/**
+ * Time one mode over a tile, restoring the input before every pass
+ */
+static double TimeBlendSpan(PixelBlendMode mode, bool perPixel, const Color* input, Color* pixels) {
+    double total = 0.0;
+    for (int i = 0; i < BLEND_REPEATS; i++) {
+        memcpy(pixels, input, sizeof(Color) * BLEND_PIXELS);
+
+        double start = GetMonotonicTime();
+        if (perPixel) {
+            for (int p = 0; p < BLEND_PIXELS; p++) {
+                pixels[p] = BlendColors(pixels[p], blendSource, mode);
+            }
+        } else {
+            BlendColorSpan(pixels, BLEND_PIXELS, blendSource, mode);
+        }
+        total += GetMonotonicTime() - start;
+    }
+    return total;
+}
+
+/**
+ * Paint one long stroke of random drag segments with an 8 pixel round brush
+ */
+static double TimeStroke(Color color, PixelBlendMode mode) {
+    ToolState* state = CreateToolState();
+    Canvas* canvas = CreateCanvas(BLEND_CANVAS_SIZE, BLEND_CANVAS_SIZE);
+    if (state == NULL || canvas == NULL) {
+        DestroyToolState(state);
+        DestroyCanvas(canvas);
+        return 0.0;
+    }
+
+    SetForegroundColor(state, color);
+    SetBlendMode(state, mode);
+    SetBrushSize(state, 8);
+    SetBrushShape(state, BRUSH_ROUND);
+
+    unsigned int seed = 99u;
+    int x = BLEND_CANVAS_SIZE / 2;
+    int y = BLEND_CANVAS_SIZE / 2;
+
+    double start = GetMonotonicTime();
+    BeginToolStroke(state, canvas);
+    for (int i = 0; i < BLEND_STROKE_SEGMENTS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int nx = x + (int)((seed >> 8) % 49) - 24;
+        int ny = y + (int)((seed >> 16) % 49) - 24;
+        nx = (nx < 0) ? 0 : (nx >= BLEND_CANVAS_SIZE ? BLEND_CANVAS_SIZE - 1 : nx);
+        ny = (ny < 0) ? 0 : (ny >= BLEND_CANVAS_SIZE ? BLEND_CANVAS_SIZE - 1 : ny);
+        DrawLineWithTool(state, canvas, x, y, nx, ny);
+        x = nx;
+        y = ny;
+    }
+    EndToolStroke(state);
+    double seconds = GetMonotonicTime() - start;
+
+    DestroyCanvas(canvas);
+    DestroyToolState(state);
+    return seconds;
+}
+
+void RunBlendBenchmarks(void) {
+    BenchBeginGroup("Alpha blending (one tile x 1024)");
+
+    Color* input = (Color*)malloc(sizeof(Color) * BLEND_PIXELS);
+    Color* pixels = (Color*)malloc(sizeof(Color) * BLEND_PIXELS);
+    if (input == NULL || pixels == NULL) {
+        free(input);
+        free(pixels);
+        return;
+    }
+    PrepareBlendInput(input);
+
+    PixelOpsBackend defaultBackend = GetPixelOpsBackend();
+    double items = (double)BLEND_PIXELS * BLEND_REPEATS;
+
+    for (int mode = PIXEL_BLEND_NORMAL; mode < PIXEL_BLEND_COUNT; mode++) {
+        const char* modeName = GetPixelBlendModeName((PixelBlendMode)mode);
+        double perPixelSeconds = TimeBlendSpan((PixelBlendMode)mode, true, input, pixels);
+        BenchReport(TextFormat("%s (BlendColors loop)", modeName), perPixelSeconds, items, "px");
+
+        for (int backend = PIXELOPS_SCALAR; backend <= PIXELOPS_AVX2; backend++) {
+            if (!SetPixelOpsBackend((PixelOpsBackend)backend)) continue;
+
+            double seconds = TimeBlendSpan((PixelBlendMode)mode, false, input, pixels);
+            const char* name = GetPixelOpsBackendName((PixelOpsBackend)backend);
+            BenchReport(TextFormat("%s (%s)", modeName, name), seconds, items, "px");
+            BenchReportSpeedup(TextFormat("%s %s speedup", modeName, name), perPixelSeconds, seconds);
+        }
+    }
+    SetPixelOpsBackend(defaultBackend);
+
+    free(input);
+    free(pixels);
+
+    // Whole strokes through the tool path
+    Color opaque = blendSource;
+    opaque.a = 255;
+    double opaqueSeconds = TimeStroke(opaque, PIXEL_BLEND_NORMAL);
+    double translucentSeconds = TimeStroke(blendSource, PIXEL_BLEND_NORMAL);
+    double multiplySeconds = TimeStroke(blendSource, PIXEL_BLEND_MULTIPLY);
+
+    BenchReport("8px stroke, opaque", opaqueSeconds, BLEND_STROKE_SEGMENTS, "segment");
+    BenchReport("8px stroke, 50% normal", translucentSeconds, BLEND_STROKE_SEGMENTS, "segment");
+    BenchReport("8px stroke, 50% multiply", multiplySeconds, BLEND_STROKE_SEGMENTS, "segment");
+}
@@ -0,0 +1,173 @@
+/**
+ * bench_core.c
+ *
+ * Throughput of the pixel core's hot paths: single pixel writes, clearing,
+ * line drawing at several canvas sizes, plus the size-independent color
+ * space and screen coordinate conversions the UI calls every frame
+ */
+
+#include "bench.h"
+#include "canvas.h"
+#include "color.h"
+#include "tool.h"
+#include "timing.h"
+
+#define CORE_SIZE_COUNT 3
+#define CORE_PIXEL_WRITES (1 << 22)
+#define CORE_CLEAR_PIXELS (1 << 26)   // Cleared per size, over at least 4 clears
+#define CORE_LINE_BUDGET (1 << 23)   // Divided by the canvas size: longer lines, fewer of them
+#define CORE_CONVERSIONS (1 << 22)
+
+static const int coreSizes[CORE_SIZE_COUNT] = {256, 1024, 4096};
+
+/**
+ * Deterministic pseudo-random numbers so runs are comparable
+ */
+static unsigned int coreSeed;
+static int CoreRandom(int range) {
+    coreSeed = coreSeed * 1103515245u + 12345u;
+    return (int)((coreSeed >> 8) % (unsigned int)range);
+}
+
+/**
+ * SetPixel in scanline order and at scattered coordinates
+ */
+static void RunSetPixelBenchmarks(int size) {
+    Canvas* canvas = CreateCanvas(size, size);
+    if (canvas == NULL) return;
+
+    Color color = {200, 40, 40, 255};
+    double start = GetMonotonicTime();
+    for (int i = 0; i < CORE_PIXEL_WRITES; i++) {
+        int pixel = i % (size * size);
+        SetPixel(canvas, pixel % size, pixel / size, color);
+    }
+    BenchReport(TextFormat("SetPixel %dx%d (scanline)", size, size), GetMonotonicTime() - start,
+                CORE_PIXEL_WRITES, "pixel");
+
+    // Coordinates are drawn up front so the timed loop measures SetPixel alone
+    static int xs[4096];
+    static int ys[4096];
+    for (int i = 0; i < 4096; i++) {
+        xs[i] = CoreRandom(size);
+        ys[i] = CoreRandom(size);
+    }
+    start = GetMonotonicTime();
+    for (int i = 0; i < CORE_PIXEL_WRITES; i++) {
+        SetPixel(canvas, xs[i & 4095], ys[(i >> 12) & 4095], color);
+    }
+    BenchReport(TextFormat("SetPixel %dx%d (scattered)", size, size), GetMonotonicTime() - start,
+                CORE_PIXEL_WRITES, "pixel");
+
+    DestroyCanvas(canvas);
+}
+
+/**
+ * ClearCanvas on a canvas whose every tile holds pixels
+ */
+static void RunClearBenchmarks(int size) {
+    Canvas* canvas = CreateCanvas(size, size);
+    if (canvas == NULL) return;
+
+    int repeats = CORE_CLEAR_PIXELS / (size * size);
+    if (repeats < 4) repeats = 4;
+    double seconds = 0.0;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int y = 0; y < size; y++) {
+            FillCanvasSpan(canvas, 0, y, size, (Color){40, 40, 200, 255});
+        }
+        double start = GetMonotonicTime();
+        ClearCanvas(canvas, (Color){0, 0, 0, 0});
+        seconds += GetMonotonicTime() - start;
+    }
+    BenchReport(TextFormat("ClearCanvas %dx%d (painted)", size, size), seconds,
+                (double)size * size * repeats, "pixel");
+
+    DestroyCanvas(canvas);
+}
+
+/**
+ * Pencil lines between random points anywhere on the canvas
+ */
+static void RunLineBenchmarks(int size) {
+    Canvas* canvas = CreateCanvas(size, size);
+    ToolState* state = CreateToolState();
+    if (canvas == NULL || state == NULL) {
+        DestroyCanvas(canvas);
+        DestroyToolState(state);
+        return;
+    }
+    SetForegroundColor(state, (Color){200, 40, 40, 255});
+
+    int count = CORE_LINE_BUDGET / size;
+    double seconds = 0.0;
+    for (int i = 0; i < count; i++) {
+        int x0 = CoreRandom(size);
+        int y0 = CoreRandom(size);
+        int x1 = CoreRandom(size);
+        int y1 = CoreRandom(size);
+        double start = GetMonotonicTime();
+        DrawLineWithTool(state, canvas, x0, y0, x1, y1);
+        seconds += GetMonotonicTime() - start;
+    }
+    BenchReport(TextFormat("DrawLineWithTool %dx%d", size, size), seconds, count, "line");
+
+    DestroyToolState(state);
+    DestroyCanvas(canvas);
+}
+
+/**
+ * RGB to HSV and back over a spread of colors
+ */
+static void RunColorConversionBenchmarks(void) {
+    // Summed so the compiler cannot drop the conversions
+    volatile float hueSum = 0.0f;
+    double start = GetMonotonicTime();
+    for (int i = 0; i < CORE_CONVERSIONS; i++) {
+        unsigned int value = (unsigned int)i * 2654435761u;
+        ColorHSV hsv = ColorToHSV((Color){(unsigned char)value, (unsigned char)(value >> 8),
+                                          (unsigned char)(value >> 16), 255});
+        hueSum += hsv.h;
+    }
+    BenchReport("ColorToHSV", GetMonotonicTime() - start, CORE_CONVERSIONS, "color");
+
+    volatile unsigned char channelSum = 0;
+    start = GetMonotonicTime();
+    for (int i = 0; i < CORE_CONVERSIONS; i++) {
+        ColorHSV hsv = {(float)(i % 3600) * 0.1f, (float)(i % 101) * 0.01f, (float)(i % 97) / 96.0f};
+        Color color = HSVToColor(hsv, 255);
+        channelSum += color.r;
+    }
+    BenchReport("HSVToColor", GetMonotonicTime() - start, CORE_CONVERSIONS, "color");
+    (void)hueSum;
+    (void)channelSum;
+}
+
+/**
+ * Mouse position to canvas pixel at a range of zoom levels
+ */
+static void RunScreenToPixelBenchmarks(void) {
+    volatile float sum = 0.0f;
+    Vector2 offset = {37.0f, 52.0f};
+    double start = GetMonotonicTime();
+    for (int i = 0; i < CORE_CONVERSIONS; i++) {
+        float zoom = 0.25f + (float)(i & 63) * 0.5f;
+        Vector2 pixel = ScreenToPixel(i % 1920, (i >> 5) % 1080, offset, zoom, 16);
+        sum += pixel.x + pixel.y;
+    }
+    BenchReport("ScreenToPixel", GetMonotonicTime() - start, CORE_CONVERSIONS, "call");
+    (void)sum;
+}
+
+void RunCoreBenchmarks(void) {
+    BenchBeginGroup("Pixel core");
+    coreSeed = 24680u;
+
+    for (int i = 0; i < CORE_SIZE_COUNT; i++) {
+        RunSetPixelBenchmarks(coreSizes[i]);
+        RunClearBenchmarks(coreSizes[i]);
+        RunLineBenchmarks(coreSizes[i]);
+    }
+    RunColorConversionBenchmarks();
+    RunScreenToPixelBenchmarks();
+}
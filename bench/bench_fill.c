@@ -0,0 +1,88 @@
+/**
+ * bench_fill.c
+ *
+ * Flood fill on a 16-megapixel canvas: open regions (the common bucket
+ * click), narrow regions that stress the segment stack, and global fills
+ */
+
+#include "bench.h"
+#include "canvas.h"
+#include "fill.h"
+#include "timing.h"
+#include "pixelops.h"
+
+#define FILL_CANVAS_SIZE 4096
+
+/**
+ * Time one fill and report it per written pixel
+ */
+static void TimeFill(const char* name, Canvas* canvas, FillArena* arena, int x, int y,
+                     Color color, FillMode mode) {
+    double start = GetMonotonicTime();
+    size_t filled = FloodFillCanvas(canvas, arena, x, y, color, mode);
+    double seconds = GetMonotonicTime() - start;
+
+    BenchReport(name, seconds, (double)filled, "px");
+}
+
+/**
+ * Tile loader that stores solid red
+ */
+static bool LoadRedTile(void* userData, Canvas* canvas, int tileIndex, Color* pixels) {
+    (void)userData;
+    (void)canvas;
+    (void)tileIndex;
+    FillPixels(pixels, CANVAS_TILE_PIXELS, RED);
+    return true;
+}
+
+/**
+ * Fill an empty tile whose right neighbour is pending with red pixels
+ * The fill must stop at the neighbour's stored pixels, not paint over them
+ */
+static void CheckPendingNeighbourFill(FillArena* arena) {
+    Canvas* canvas = CreateCanvas(2 * CANVAS_TILE_SIZE, CANVAS_TILE_SIZE);
+    if (canvas == NULL) return;
+    SetCanvasTileLoader(canvas, LoadRedTile, NULL);
+    SetCanvasTilePending(canvas, 1);
+
+    double start = GetMonotonicTime();
+    size_t filled = FloodFillCanvas(canvas, arena, 0, 0, BLUE, FILL_CONTIGUOUS);
+    double seconds = GetMonotonicTime() - start;
+
+    Color kept = GetPixel(canvas, CANVAS_TILE_SIZE + 72, 0);
+    bool correct = filled == CANVAS_TILE_PIXELS && kept.r == RED.r && kept.g == RED.g && kept.b == RED.b;
+    BenchReport(correct ? "beside a pending tile" : "beside a pending tile (MISMATCH)", seconds, (double)filled, "px");
+
+    DestroyCanvas(canvas);
+}
+
+void RunFillBenchmarks(void) {
+    BenchBeginGroup("Flood fill (4096x4096)");
+
+    FillArena* arena = CreateFillArena();
+    Canvas* canvas = CreateCanvas(FILL_CANVAS_SIZE, FILL_CANVAS_SIZE);
+    if (arena == NULL || canvas == NULL) {
+        DestroyFillArena(arena);
+        DestroyCanvas(canvas);
+        return;
+    }
+
+    // Whole canvas as one region: first fill allocates every tile
+    TimeFill("open region, empty canvas", canvas, arena, 10, 10, (Color){30, 90, 200, 255}, FILL_CONTIGUOUS);
+    TimeFill("open region, painted canvas", canvas, arena, 10, 10, (Color){200, 90, 30, 255}, FILL_CONTIGUOUS);
+
+    // One-pixel walls with alternating gaps turn the canvas into a serpentine
+    // corridor, the worst case for run length and stack traffic
+    for (int x = 1; x < FILL_CANVAS_SIZE; x += 2) {
+        FillCanvasColumn(canvas, x, (x % 4 == 1) ? 0 : 1, FILL_CANVAS_SIZE - 1, BLACK);
+    }
+    TimeFill("serpentine corridor", canvas, arena, 0, 0, (Color){30, 200, 90, 255}, FILL_CONTIGUOUS);
+
+    TimeFill("global, all walls", canvas, arena, 1, 1, WHITE, FILL_GLOBAL);
+
+    CheckPendingNeighbourFill(arena);
+
+    DestroyCanvas(canvas);
+    DestroyFillArena(arena);
+}
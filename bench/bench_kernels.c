@@ -0,0 +1,184 @@
+/**
+ * bench_kernels.c
+ *
+ * Bulk pixel kernels: the plain Color-by-Color loops the canvas used before
+ * versus every pixelops backend the CPU supports. Each kernel runs over one
+ * canvas tile many times, the unit the canvas actually hands to the kernels.
+ */
+
+#include "bench.h"
+#include "canvas.h"
+#include "pixelops.h"
+#include "timing.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define KERNEL_PIXELS CANVAS_TILE_PIXELS
+#define KERNEL_REPEATS 1024
+#define KERNEL_CANVAS_SIZE 4096
+
+typedef enum {
+    KERNEL_FILL,
+    KERNEL_REPLACE,
+    KERNEL_REPLACE_TOLERANCE,
+    KERNEL_MASKED_FILL,
+    KERNEL_COUNT
+} KernelKind;
+
+static const char* kernelNames[KERNEL_COUNT] = {"fill", "replace exact", "replace tolerance", "masked fill"};
+
+static const Color fromColor = {200, 40, 40, 255};
+static const Color toColor = {40, 40, 200, 255};
+static const unsigned char tolerance = 24;
+
+/**
+ * Sprite-like test data: a third of the pixels are near the replaced color
+ */
+static void PrepareKernelInput(Color* pixels, unsigned char* mask) {
+    unsigned int seed = 777u;
+    for (int i = 0; i < KERNEL_PIXELS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned int r = seed >> 8;
+        if (r % 3 == 0) {
+            pixels[i] = (Color){(unsigned char)(fromColor.r - r % 16), fromColor.g, fromColor.b, 255};
+        } else {
+            pixels[i] = (Color){(unsigned char)r, (unsigned char)(r >> 8), (unsigned char)(r >> 16), 255};
+        }
+        mask[i] = (unsigned char)((r >> 4) & 1);
+    }
+}
+
+/**
+ * The pre-kernel loops, one Color at a time
+ */
+static void RunLegacyKernel(KernelKind kind, Color* pixels, const unsigned char* mask) {
+    switch (kind) {
+        case KERNEL_FILL:
+            for (int i = 0; i < KERNEL_PIXELS; i++) {
+                pixels[i] = toColor;
+            }
+            break;
+
+        case KERNEL_REPLACE:
+            for (int i = 0; i < KERNEL_PIXELS; i++) {
+                Color p = pixels[i];
+                if (p.r == fromColor.r && p.g == fromColor.g && p.b == fromColor.b && p.a == fromColor.a) {
+                    pixels[i] = toColor;
+                }
+            }
+            break;
+
+        case KERNEL_REPLACE_TOLERANCE:
+            for (int i = 0; i < KERNEL_PIXELS; i++) {
+                Color p = pixels[i];
+                if (abs(p.r - fromColor.r) <= tolerance && abs(p.g - fromColor.g) <= tolerance &&
+                    abs(p.b - fromColor.b) <= tolerance && abs(p.a - fromColor.a) <= tolerance) {
+                    pixels[i] = toColor;
+                }
+            }
+            break;
+
+        case KERNEL_MASKED_FILL:
+            for (int i = 0; i < KERNEL_PIXELS; i++) {
+                if (mask[i]) {
+                    pixels[i] = toColor;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void RunKernel(KernelKind kind, Color* pixels, const unsigned char* mask) {
+    switch (kind) {
+        case KERNEL_FILL:
+            FillPixels(pixels, KERNEL_PIXELS, toColor);
+            break;
+        case KERNEL_REPLACE:
+            ReplacePixels(pixels, KERNEL_PIXELS, fromColor, toColor);
+            break;
+        case KERNEL_REPLACE_TOLERANCE:
+            ReplacePixelsTolerance(pixels, KERNEL_PIXELS, fromColor, toColor, tolerance);
+            break;
+        case KERNEL_MASKED_FILL:
+            MaskedFillPixels(pixels, mask, KERNEL_PIXELS, toColor);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Time one kernel; the input is restored before every pass so replace
+ * kernels always find work
+ */
+static double TimeKernel(KernelKind kind, bool legacy, const Color* input, Color* pixels,
+                         const unsigned char* mask) {
+    double total = 0.0;
+    for (int i = 0; i < KERNEL_REPEATS; i++) {
+        memcpy(pixels, input, sizeof(Color) * KERNEL_PIXELS);
+
+        double start = GetMonotonicTime();
+        if (legacy) {
+            RunLegacyKernel(kind, pixels, mask);
+        } else {
+            RunKernel(kind, pixels, mask);
+        }
+        total += GetMonotonicTime() - start;
+    }
+    return total;
+}
+
+void RunKernelBenchmarks(void) {
+    BenchBeginGroup("Pixel kernels (one tile x 1024)");
+
+    Color* input = (Color*)malloc(sizeof(Color) * KERNEL_PIXELS);
+    Color* pixels = (Color*)malloc(sizeof(Color) * KERNEL_PIXELS);
+    unsigned char* mask = (unsigned char*)malloc(KERNEL_PIXELS);
+    if (input == NULL || pixels == NULL || mask == NULL) {
+        free(input);
+        free(pixels);
+        free(mask);
+        return;
+    }
+    PrepareKernelInput(input, mask);
+
+    PixelOpsBackend defaultBackend = GetPixelOpsBackend();
+    double items = (double)KERNEL_PIXELS * KERNEL_REPEATS;
+
+    for (int kind = 0; kind < KERNEL_COUNT; kind++) {
+        double legacySeconds = TimeKernel((KernelKind)kind, true, input, pixels, mask);
+        BenchReport(TextFormat("%s (Color loop)", kernelNames[kind]), legacySeconds, items, "px");
+
+        for (int backend = PIXELOPS_SCALAR; backend <= PIXELOPS_AVX2; backend++) {
+            if (!SetPixelOpsBackend((PixelOpsBackend)backend)) continue;
+
+            double seconds = TimeKernel((KernelKind)kind, false, input, pixels, mask);
+            const char* name = GetPixelOpsBackendName((PixelOpsBackend)backend);
+            BenchReport(TextFormat("%s (%s)", kernelNames[kind], name), seconds, items, "px");
+            BenchReportSpeedup(TextFormat("%s %s speedup", kernelNames[kind], name), legacySeconds, seconds);
+        }
+    }
+    SetPixelOpsBackend(defaultBackend);
+
+    free(input);
+    free(pixels);
+    free(mask);
+
+    // Canvas-wide recolor through the tile grid
+    Canvas* canvas = CreateCanvas(KERNEL_CANVAS_SIZE, KERNEL_CANVAS_SIZE);
+    if (canvas == NULL) return;
+    for (int y = 0; y < KERNEL_CANVAS_SIZE; y += 2) {
+        FillCanvasSpan(canvas, 0, y, KERNEL_CANVAS_SIZE, fromColor);
+    }
+
+    double start = GetMonotonicTime();
+    size_t replaced = ReplaceCanvasColor(canvas, fromColor, toColor, 0);
+    double seconds = GetMonotonicTime() - start;
+    BenchReport(TextFormat("ReplaceCanvasColor 4096x4096 (%s)", GetPixelOpsBackendName(defaultBackend)),
+                seconds, (double)replaced, "px");
+
+    DestroyCanvas(canvas);
+}
@@ -0,0 +1,168 @@
+/**
+ * bench_layers.c
+ *
+ * Layer compositing: flattening every layer across the whole document each
+ * frame versus the cached composite, which only rebuilds the tiles a
+ * stroke touched, and how a full recomposite scales across worker threads
+ */
+
+#include "bench.h"
+#include "layer.h"
+#include "threadpool.h"
+#include "timing.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LAYER_BENCH_SIZE 1024
+#define LAYER_BENCH_COUNT 20
+#define LAYER_BENCH_FRAMES 200
+#define LAYER_BENCH_FULL_PASSES 5
+
+/**
+ * Give every layer a few opaque and translucent blocks so most composite
+ * tiles have several contributing layers
+ */
+static void PaintBenchLayers(LayerStack* stack) {
+    unsigned int seed = 31337u;
+    for (int i = 0; i < stack->count; i++) {
+        Canvas* canvas = stack->layers[i].canvas;
+        for (int block = 0; block < 12; block++) {
+            seed = seed * 1103515245u + 12345u;
+            int x = (int)((seed >> 8) % LAYER_BENCH_SIZE);
+            seed = seed * 1103515245u + 12345u;
+            int y = (int)((seed >> 8) % LAYER_BENCH_SIZE);
+            int size = 64 + (int)((seed >> 20) % 192);
+            Color color = {(unsigned char)seed, (unsigned char)(seed >> 8), (unsigned char)(seed >> 16),
+                           (block % 2) ? 255 : 140};
+            for (int row = y; row < y + size; row++) {
+                FillCanvasSpan(canvas, x, row, size, color);
+            }
+        }
+    }
+}
+
+/**
+ * Copy the composite so other thread counts can be checked against it
+ */
+static Color* SnapshotComposite(LayerStack* stack) {
+    Canvas* composite = stack->composite;
+    int tileCount = composite->tilesX * composite->tilesY;
+    Color* snapshot = (Color*)calloc((size_t)tileCount * CANVAS_TILE_PIXELS, sizeof(Color));
+    if (snapshot == NULL) return NULL;
+
+    for (int i = 0; i < tileCount; i++) {
+        Color* pixels = GetCanvasTilePixels(composite, i);
+        if (pixels != NULL) {
+            memcpy(snapshot + (size_t)i * CANVAS_TILE_PIXELS, pixels, sizeof(Color) * CANVAS_TILE_PIXELS);
+        }
+    }
+    return snapshot;
+}
+
+static bool MatchesComposite(LayerStack* stack, const Color* snapshot) {
+    Color* current = SnapshotComposite(stack);
+    if (current == NULL) return false;
+
+    Canvas* composite = stack->composite;
+    size_t size = (size_t)composite->tilesX * composite->tilesY * CANVAS_TILE_PIXELS * sizeof(Color);
+    bool matches = memcmp(current, snapshot, size) == 0;
+    free(current);
+    return matches;
+}
+
+/**
+ * 1, 2, 4, ... and finally the exact maximum
+ */
+static int NextThreadCount(int threads, int maxThreads) {
+    if (threads == maxThreads) return maxThreads + 1;
+    return (threads * 2 > maxThreads) ? maxThreads : threads * 2;
+}
+
+/**
+ * Full recomposite on 1, 2, 4, ... threads up to the core count
+ */
+static void RunCompositeScaling(LayerStack* stack) {
+    BenchBeginGroup(TextFormat("Layer composite thread scaling (%d cores)", GetCpuCoreCount()));
+
+    SetLayerStackThreadPool(stack, NULL);
+    InvalidateLayerComposite(stack);
+    UpdateLayerComposite(stack);
+    Color* reference = SnapshotComposite(stack);
+    if (reference == NULL) return;
+
+    // Always try at least two threads so the parallel path is exercised
+    int maxThreads = GetCpuCoreCount();
+    if (maxThreads < 2) maxThreads = 2;
+
+    double singleSeconds = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads = NextThreadCount(threads, maxThreads)) {
+        ThreadPool* pool = CreateThreadPool(threads);
+        if (pool == NULL) break;
+        SetLayerStackThreadPool(stack, pool);
+
+        double start = GetMonotonicTime();
+        for (int pass = 0; pass < LAYER_BENCH_FULL_PASSES; pass++) {
+            InvalidateLayerComposite(stack);
+            UpdateLayerComposite(stack);
+        }
+        double seconds = (GetMonotonicTime() - start) / LAYER_BENCH_FULL_PASSES;
+        if (threads == 1) singleSeconds = seconds;
+
+        bool identical = MatchesComposite(stack, reference);
+        BenchReport(TextFormat("full recomposite, %d thread%s%s", GetThreadPoolSize(pool),
+                    (threads == 1) ? "" : "s", identical ? "" : " (MISMATCH)"), seconds, 1, "frame");
+        if (threads > 1) {
+            BenchReportSpeedup(TextFormat("%d threads speedup", GetThreadPoolSize(pool)), singleSeconds, seconds);
+        }
+
+        SetLayerStackThreadPool(stack, NULL);
+        DestroyThreadPool(pool);
+    }
+
+    free(reference);
+}
+
+void RunLayerBenchmarks(void) {
+    BenchBeginGroup("Layer composite (20 layers, 1024x1024)");
+
+    LayerStack* stack = CreateLayerStack(LAYER_BENCH_SIZE, LAYER_BENCH_SIZE);
+    if (stack == NULL) return;
+    while (stack->count < LAYER_BENCH_COUNT && AddLayer(stack, NULL) >= 0) {
+    }
+    for (int i = 0; i < stack->count; i++) {
+        SetLayerOpacity(stack, i, (i % 3 == 0) ? 200 : 255);
+        SetLayerBlendMode(stack, i, (i % 5 == 4) ? PIXEL_BLEND_MULTIPLY : PIXEL_BLEND_NORMAL);
+    }
+    PaintBenchLayers(stack);
+    UpdateLayerComposite(stack);
+
+    // Recomposite everything, as a per-frame flatten would
+    double start = GetMonotonicTime();
+    for (int pass = 0; pass < LAYER_BENCH_FULL_PASSES; pass++) {
+        InvalidateLayerComposite(stack);
+        UpdateLayerComposite(stack);
+    }
+    double fullSeconds = (GetMonotonicTime() - start) / LAYER_BENCH_FULL_PASSES;
+
+    // One short brush dab per frame on a middle layer
+    Canvas* canvas = stack->layers[LAYER_BENCH_COUNT / 2].canvas;
+    int tiles = 0;
+    start = GetMonotonicTime();
+    for (int frame = 0; frame < LAYER_BENCH_FRAMES; frame++) {
+        int x = 100 + frame * 4;
+        for (int row = 0; row < 6; row++) {
+            BlendCanvasSpan(canvas, x, 400 + row, 6, (Color){20, 200, 60, 160}, PIXEL_BLEND_NORMAL);
+        }
+        tiles += UpdateLayerComposite(stack);
+    }
+    double cachedSeconds = (GetMonotonicTime() - start) / LAYER_BENCH_FRAMES;
+
+    BenchReport("full recomposite per frame", fullSeconds, 1, "frame");
+    BenchReport(TextFormat("cached, dirty tiles only (%.1f tiles)", (double)tiles / LAYER_BENCH_FRAMES),
+                cachedSeconds, 1, "frame");
+    BenchReportSpeedup("cached composite speedup", fullSeconds, cachedSeconds);
+
+    RunCompositeScaling(stack);
+
+    DestroyLayerStack(stack);
+}
@@ -0,0 +1,300 @@
+/**
+ * bench_main.c
+ *
+ * Entry point and reporting helpers for the benchmark binary
+ *
+ * Usage: pixel_art_tool_bench [--group <name>] [--repeat <count>] [--json <path>]
+ *                             [--baseline <path>] [--threshold <percent>]
+ * Every BenchReport result is kept so it can be written as JSON and
+ * compared against a baseline written the same way; a result that costs
+ * more per item than its baseline by over the threshold is a regression
+ * and makes the binary exit with status 1. With --repeat the groups run
+ * several times and each result keeps its fastest run, which filters out
+ * most of the noise from other processes.
+ */
+
+#include "bench.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MAX_RESULTS 256
+#define BENCH_DEFAULT_THRESHOLD 15.0    // Percent
+
+typedef struct {
+    char group[48];
+    char name[64];
+    char unit[16];
+    double seconds;
+    double items;
+} BenchResult;
+
+typedef struct {
+    const char* name;                   // Matched by --group
+    void (*run)(void);
+} BenchGroup;
+
+static const BenchGroup benchGroups[] = {
+    {"core", RunCoreBenchmarks},
+    {"raster", RunRasterBenchmarks},
+    {"fill", RunFillBenchmarks},
+    {"kernels", RunKernelBenchmarks},
+    {"blend", RunBlendBenchmarks},
+    {"layers", RunLayerBenchmarks},
+    {"png", RunPngBenchmarks},
+    {"project", RunProjectBenchmarks},
+    {"render", RunRenderBenchmarks},
+};
+
+static BenchResult benchResults[BENCH_MAX_RESULTS];
+static int benchResultCount = 0;
+static char benchGroup[48] = "";
+
+void BenchBeginGroup(const char* group) {
+    printf("\n== %s ==\n", group);
+    snprintf(benchGroup, sizeof(benchGroup), "%s", group);
+}
+
+void BenchReport(const char* name, double seconds, double items, const char* unit) {
+    double perItem = (items > 0.0) ? seconds / items * 1e9 : 0.0;
+    printf("  %-40s %10.3f ms  %10.2f ns/%s\n", name, seconds * 1000.0, perItem, unit);
+
+    // A repeated run keeps the fastest time of each result
+    for (int i = 0; i < benchResultCount; i++) {
+        BenchResult* result = &benchResults[i];
+        if (strcmp(result->group, benchGroup) == 0 && strncmp(result->name, name, sizeof(result->name) - 1) == 0) {
+            if (seconds < result->seconds) result->seconds = seconds;
+            return;
+        }
+    }
+
+    if (benchResultCount < BENCH_MAX_RESULTS) {
+        BenchResult* result = &benchResults[benchResultCount++];
+        snprintf(result->group, sizeof(result->group), "%s", benchGroup);
+        snprintf(result->name, sizeof(result->name), "%s", name);
+        snprintf(result->unit, sizeof(result->unit), "%s", unit);
+        result->seconds = seconds;
+        result->items = items;
+    }
+}
+
+void BenchReportSpeedup(const char* name, double baselineSeconds, double seconds) {
+    printf("  %-40s %10.2fx\n", name, (seconds > 0.0) ? baselineSeconds / seconds : 0.0);
+}
+
+/**
+ * Cost compared against baselines: time per item, or the total without items
+ */
+static double GetResultCost(const BenchResult* result) {
+    return (result->items > 0.0) ? result->seconds / result->items * 1e9 : result->seconds * 1e9;
+}
+
+/**
+ * Write a JSON string, escaping the characters JSON requires
+ */
+static void WriteJsonString(FILE* out, const char* text) {
+    fputc('"', out);
+    for (; *text != '\0'; text++) {
+        if (*text == '"' || *text == '\\') {
+            fprintf(out, "\\%c", *text);
+        } else if ((unsigned char)*text < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*text);
+        } else {
+            fputc(*text, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/**
+ * Write every result as JSON, one result object per line
+ */
+static bool WriteBenchJson(const char* path) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) return false;
+
+    fprintf(out, "{\n  \"version\": 1,\n  \"results\": [\n");
+    for (int i = 0; i < benchResultCount; i++) {
+        const BenchResult* result = &benchResults[i];
+        fprintf(out, "    {\"group\": ");
+        WriteJsonString(out, result->group);
+        fprintf(out, ", \"name\": ");
+        WriteJsonString(out, result->name);
+        fprintf(out, ", \"unit\": ");
+        WriteJsonString(out, result->unit);
+        fprintf(out, ", \"seconds\": %.9g, \"items\": %.9g, \"nsPerItem\": %.6g}%s\n", result->seconds,
+                result->items, GetResultCost(result), (i + 1 < benchResultCount) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    bool ok = !ferror(out);
+    return (fclose(out) == 0) && ok;
+}
+
+/**
+ * Read a string field of one JSON result object (as written by WriteBenchJson)
+ */
+static bool ReadJsonString(const char* object, const char* key, char* out, size_t outSize) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\": \"", key);
+    const char* value = strstr(object, pattern);
+    if (value == NULL) return false;
+    value += strlen(pattern);
+
+    size_t length = 0;
+    while (*value != '\0' && *value != '"' && length + 1 < outSize) {
+        if (*value == '\\' && value[1] != '\0') value++;
+        out[length++] = *value++;
+    }
+    out[length] = '\0';
+    return *value == '"';
+}
+
+/**
+ * Read a number field of one JSON result object
+ */
+static bool ReadJsonNumber(const char* object, const char* key, double* out) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char* value = strstr(object, pattern);
+    if (value == NULL) return false;
+
+    char* end = NULL;
+    *out = strtod(value + strlen(pattern), &end);
+    return end != value + strlen(pattern);
+}
+
+/**
+ * Compare the results against a baseline JSON file and print the changes
+ * Returns the number of regressions, or -1 if the baseline cannot be read
+ */
+static int CompareBenchBaseline(const char* path, double thresholdPercent) {
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) return -1;
+
+    long size = (fseek(in, 0, SEEK_END) == 0) ? ftell(in) : -1;
+    char* text = (size >= 0 && fseek(in, 0, SEEK_SET) == 0) ? (char*)malloc((size_t)size + 1) : NULL;
+    bool ok = text != NULL && fread(text, 1, (size_t)size, in) == (size_t)size;
+    fclose(in);
+    if (!ok) {
+        free(text);
+        return -1;
+    }
+    text[size] = '\0';
+
+    printf("\n== Baseline comparison (%s, threshold %.1f%%) ==\n", path, thresholdPercent);
+    int regressions = 0;
+    int compared = 0;
+    for (int i = 0; i < benchResultCount; i++) {
+        const BenchResult* result = &benchResults[i];
+        double cost = GetResultCost(result);
+
+        // Result objects sit one per line, so each line is searched on its own
+        double baselineCost = -1.0;
+        for (char* line = text; line != NULL && *line != '\0';) {
+            char* next = strchr(line, '\n');
+            if (next != NULL) *next = '\0';
+
+            char group[48];
+            char name[64];
+            double value = 0.0;
+            if (ReadJsonString(line, "group", group, sizeof(group)) && ReadJsonString(line, "name", name, sizeof(name)) &&
+                strcmp(group, result->group) == 0 && strcmp(name, result->name) == 0 &&
+                ReadJsonNumber(line, "nsPerItem", &value)) {
+                baselineCost = value;
+            }
+
+            if (next != NULL) *next = '\n';
+            line = (next != NULL) ? next + 1 : NULL;
+            if (baselineCost >= 0.0) break;
+        }
+
+        if (baselineCost < 0.0) {
+            printf("  %-40s %10s\n", result->name, "new");
+            continue;
+        }
+
+        compared++;
+        double change = (baselineCost > 0.0) ? (cost - baselineCost) / baselineCost * 100.0 : 0.0;
+        bool regressed = change > thresholdPercent;
+        regressions += regressed ? 1 : 0;
+        printf("  %-40s %10.2f -> %10.2f ns/%s  %+7.1f%%%s\n", result->name, baselineCost, cost, result->unit, change,
+               regressed ? "  REGRESSION" : "");
+    }
+
+    printf("%d of %d results compared, %d regressions\n", compared, benchResultCount, regressions);
+    free(text);
+    return regressions;
+}
+
+/**
+ * Print the command line usage
+ */
+static void PrintBenchUsage(void) {
+    printf("Usage: pixel_art_tool_bench [--group <name>] [--repeat <count>] [--json <path>] [--baseline <path>]"
+           " [--threshold <percent>]\n");
+    printf("Groups:");
+    for (size_t i = 0; i < sizeof(benchGroups) / sizeof(benchGroups[0]); i++) {
+        printf(" %s", benchGroups[i].name);
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* groupName = NULL;
+    const char* jsonPath = NULL;
+    const char* baselinePath = NULL;
+    double thresholdPercent = BENCH_DEFAULT_THRESHOLD;
+    int repeatCount = 1;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--group") == 0 && hasValue) {
+            groupName = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && hasValue) {
+            repeatCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            thresholdPercent = atof(argv[++i]);
+        } else {
+            PrintBenchUsage();
+            return 2;
+        }
+    }
+
+    int groupsRun = 0;
+    for (int repeat = 0; repeat < repeatCount; repeat++) {
+        for (size_t i = 0; i < sizeof(benchGroups) / sizeof(benchGroups[0]); i++) {
+            if (groupName == NULL || strcmp(groupName, benchGroups[i].name) == 0) {
+                benchGroups[i].run();
+                groupsRun++;
+            }
+        }
+    }
+    if (groupsRun == 0) {
+        PrintBenchUsage();
+        return 2;
+    }
+
+    if (jsonPath != NULL) {
+        if (!WriteBenchJson(jsonPath)) {
+            fprintf(stderr, "cannot write %s\n", jsonPath);
+            return 2;
+        }
+        printf("\nWrote %d results to %s\n", benchResultCount, jsonPath);
+    }
+
+    if (baselinePath != NULL) {
+        int regressions = CompareBenchBaseline(baselinePath, thresholdPercent);
+        if (regressions < 0) {
+            fprintf(stderr, "cannot read baseline %s\n", baselinePath);
+            return 2;
+        }
+        return (regressions > 0) ? 1 : 0;
+    }
+    return 0;
+}
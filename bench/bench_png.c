@@ -0,0 +1,123 @@
+/**
+ * bench_png.c
+ *
+ * PNG load throughput: streaming rows straight into canvas tiles versus
+ * decoding the whole image into one buffer and copying it in pixel by
+ * pixel, which holds two full copies of the image at its peak
+ */
+
+#include "bench.h"
+#include "canvas.h"
+#include "import.h"
+#include "pngio.h"
+#include "timing.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PNG_BENCH_SIZE 2048
+#define PNG_BENCH_PATH "bench_png.png"
+
+/**
+ * Flat blocks with a band of noise, like a painted sprite sheet over a
+ * photographic reference
+ */
+static bool WriteBenchImage(const char* path) {
+    PngWriter* writer = CreatePngWriter(path, PNG_BENCH_SIZE, PNG_BENCH_SIZE);
+    Color* row = (Color*)malloc(sizeof(Color) * PNG_BENCH_SIZE);
+    if (writer == NULL || row == NULL) {
+        DestroyPngWriter(writer);
+        free(row);
+        return false;
+    }
+
+    unsigned int seed = 4242u;
+    bool ok = true;
+    for (int y = 0; y < PNG_BENCH_SIZE && ok; y++) {
+        for (int x = 0; x < PNG_BENCH_SIZE; x++) {
+            if (y >= PNG_BENCH_SIZE / 2 && y < PNG_BENCH_SIZE / 2 + PNG_BENCH_SIZE / 8) {
+                seed = seed * 1103515245u + 12345u;
+                row[x] = (Color){(unsigned char)(seed >> 8), (unsigned char)(seed >> 16), (unsigned char)(seed >> 24), 255};
+            } else {
+                int block = (x / 48) ^ (y / 48);
+                row[x] = (block % 3 == 0) ? (Color){0, 0, 0, 0} :
+                         (Color){(unsigned char)(block * 40), (unsigned char)(block * 90), (unsigned char)(x / 8), 255};
+            }
+        }
+        ok = WritePngRow(writer, row);
+    }
+
+    free(row);
+    if (!ok) {
+        DestroyPngWriter(writer);
+        return false;
+    }
+    return FinishPngWriter(writer);
+}
+
+/**
+ * Decode into a full image buffer, then SetPixel everything into a canvas
+ */
+static Canvas* LoadWholeImage(const char* path, size_t* peakBytes) {
+    int width = 0;
+    int height = 0;
+    PngReader* reader = CreatePngReader(path, &width, &height);
+    if (reader == NULL) return NULL;
+
+    Color* image = (Color*)malloc(sizeof(Color) * width * height);
+    Canvas* canvas = CreateCanvas(width, height);
+    bool ok = image != NULL && canvas != NULL;
+    for (int y = 0; y < height && ok; y++) {
+        ok = ReadPngRow(reader, image + (size_t)y * width);
+    }
+    DestroyPngReader(reader);
+
+    for (int y = 0; y < height && ok; y++) {
+        for (int x = 0; x < width; x++) {
+            SetPixel(canvas, x, y, image[(size_t)y * width + x]);
+        }
+    }
+    if (ok) {
+        *peakBytes = sizeof(Color) * width * height + GetCanvasMemoryUsage(canvas);
+    }
+
+    free(image);
+    if (!ok) {
+        DestroyCanvas(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+void RunPngBenchmarks(void) {
+    BenchBeginGroup("PNG import (2048x2048)");
+
+    const double pixels = (double)PNG_BENCH_SIZE * PNG_BENCH_SIZE;
+    double start = GetMonotonicTime();
+    if (!WriteBenchImage(PNG_BENCH_PATH)) {
+        printf("  could not write %s\n", PNG_BENCH_PATH);
+        return;
+    }
+    BenchReport("encode (streaming writer)", GetMonotonicTime() - start, pixels, "px");
+
+    size_t wholePeak = 0;
+    start = GetMonotonicTime();
+    Canvas* canvas = LoadWholeImage(PNG_BENCH_PATH, &wholePeak);
+    double wholeSeconds = GetMonotonicTime() - start;
+    DestroyCanvas(canvas);
+
+    ImportStats stats = {0};
+    LayerStack* stack = ImportImageDocument(PNG_BENCH_PATH, &stats);
+    if (canvas != NULL && stack != NULL) {
+        // Streaming keeps one row besides the canvas
+        size_t streamedPeak = stats.canvasBytes + sizeof(Color) * stats.width;
+        BenchReport(TextFormat("whole image + SetPixel (peak %.1f MB)", wholePeak / (1024.0 * 1024.0)),
+                    wholeSeconds, pixels, "px");
+        BenchReport(TextFormat("streamed into tiles (peak %.1f MB)", streamedPeak / (1024.0 * 1024.0)),
+                    stats.seconds, pixels, "px");
+        BenchReportSpeedup(TextFormat("streamed speedup (%.1f MP/s)", GetImportMegapixelsPerSecond(&stats)),
+                           wholeSeconds, stats.seconds);
+    }
+
+    DestroyLayerStack(stack);
+    remove(PNG_BENCH_PATH);
+}
@@ -0,0 +1,83 @@
+/**
+ * bench_project.c
+ *
+ * Project open time at two document sizes: opening reads only the index,
+ * so it should barely grow with the document, while loading every tile
+ * grows with the painted area
+ */
+
+#include "bench.h"
+#include "project.h"
+#include "timing.h"
+#include <stdio.h>
+
+#define PROJECT_BENCH_PATH "bench_project.pxp"
+#define PROJECT_BENCH_LAYERS 3
+
+/**
+ * Paint every tile of every layer with stripes, like a fully worked document
+ */
+static LayerStack* CreateBenchDocument(int size) {
+    LayerStack* stack = CreateLayerStack(size, size);
+    for (int i = 1; i < PROJECT_BENCH_LAYERS && stack != NULL; i++) {
+        AddLayer(stack, NULL);
+    }
+    if (stack == NULL) return NULL;
+
+    for (int i = 0; i < stack->count; i++) {
+        for (int y = 0; y < size; y++) {
+            Color color = {(unsigned char)(y * 7 + i * 50), (unsigned char)(y / 3), (unsigned char)(i * 80), 255};
+            FillCanvasSpan(stack->layers[i].canvas, (y * 13) % 64, y, size - 64, color);
+        }
+    }
+    return stack;
+}
+
+/**
+ * Save a document of the given size, then time opening it with and without loading it all
+ */
+static void BenchProjectSize(int size) {
+    LayerStack* stack = CreateBenchDocument(size);
+    if (stack == NULL) return;
+
+    double start = GetMonotonicTime();
+    bool saved = SaveProject(stack, PROJECT_BENCH_PATH, NULL);
+    double saveSeconds = GetMonotonicTime() - start;
+    DestroyLayerStack(stack);
+    if (!saved) {
+        printf("  could not write %s\n", PROJECT_BENCH_PATH);
+        return;
+    }
+
+    const double pixels = (double)size * size * PROJECT_BENCH_LAYERS;
+    BenchReport(TextFormat("%dx%d save", size, size), saveSeconds, pixels, "px");
+
+    ProjectFile* file = NULL;
+    start = GetMonotonicTime();
+    stack = OpenProject(PROJECT_BENCH_PATH, &file);
+    double openSeconds = GetMonotonicTime() - start;
+    if (stack != NULL) {
+        BenchReport(TextFormat("%dx%d open (index only)", size, size), openSeconds, pixels, "px");
+
+        start = GetMonotonicTime();
+        for (int i = 0; i < stack->count; i++) {
+            LoadCanvasTiles(stack->layers[i].canvas);
+        }
+        double loadSeconds = GetMonotonicTime() - start;
+        BenchReport(TextFormat("%dx%d load all %d tiles", size, size, (int)GetProjectTilesLoaded(file)),
+                    loadSeconds, pixels, "px");
+        BenchReportSpeedup(TextFormat("%dx%d lazy open speedup", size, size), openSeconds + loadSeconds,
+                           openSeconds);
+    }
+
+    DestroyLayerStack(stack);
+    CloseProject(file);
+    remove(PROJECT_BENCH_PATH);
+}
+
+void RunProjectBenchmarks(void) {
+    BenchBeginGroup("Project files (3 layers)");
+
+    BenchProjectSize(1024);
+    BenchProjectSize(4096);
+}
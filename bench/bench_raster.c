@@ -0,0 +1,125 @@
+/**
+ * bench_raster.c
+ *
+ * Drag-stroke line drawing: the original per-pixel Bresenham path versus
+ * the clipped span rasterizer used by DrawLineWithTool
+ */
+
+#include "bench.h"
+#include "canvas.h"
+#include "tool.h"
+#include "timing.h"
+#include <stdlib.h>
+
+#define RASTER_CANVAS_SIZE 1024
+#define RASTER_LINE_COUNT 20000
+
+typedef struct {
+    int x0, y0, x1, y1;
+} BenchLine;
+
+/**
+ * The pre-rasterizer drag path: one DrawPixelWithTool call per Bresenham
+ * step, each doing its own tool switch and bounds checks
+ */
+static void LegacyDrawLine(ToolState* state, Canvas* canvas, int x0, int y0, int x1, int y1) {
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    int err = dx - dy;
+
+    int x = x0;
+    int y = y0;
+
+    while (1) {
+        DrawPixelWithTool(state, canvas, x, y);
+        if (x == x1 && y == y1) {
+            break;
+        }
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+/**
+ * Deterministic pseudo-random numbers so runs are comparable
+ */
+static unsigned int benchSeed = 12345u;
+static int BenchRandom(int range) {
+    benchSeed = benchSeed * 1103515245u + 12345u;
+    return (int)((benchSeed >> 8) % (unsigned int)range);
+}
+
+/**
+ * Time one line set through both paths on fresh canvases
+ */
+static void RunLineScenario(const char* name, const BenchLine* lines, int count) {
+    ToolState* state = CreateToolState();
+    SetForegroundColor(state, (Color){200, 40, 40, 255});
+
+    Canvas* canvas = CreateCanvas(RASTER_CANVAS_SIZE, RASTER_CANVAS_SIZE);
+    double start = GetMonotonicTime();
+    for (int i = 0; i < count; i++) {
+        LegacyDrawLine(state, canvas, lines[i].x0, lines[i].y0, lines[i].x1, lines[i].y1);
+    }
+    double legacySeconds = GetMonotonicTime() - start;
+    DestroyCanvas(canvas);
+
+    canvas = CreateCanvas(RASTER_CANVAS_SIZE, RASTER_CANVAS_SIZE);
+    start = GetMonotonicTime();
+    for (int i = 0; i < count; i++) {
+        DrawLineWithTool(state, canvas, lines[i].x0, lines[i].y0, lines[i].x1, lines[i].y1);
+    }
+    double spanSeconds = GetMonotonicTime() - start;
+    DestroyCanvas(canvas);
+
+    DestroyToolState(state);
+
+    BenchReport(TextFormat("%s (per-pixel)", name), legacySeconds, count, "line");
+    BenchReport(TextFormat("%s (spans)", name), spanSeconds, count, "line");
+    BenchReportSpeedup(TextFormat("%s speedup", name), legacySeconds, spanSeconds);
+}
+
+void RunRasterBenchmarks(void) {
+    BenchBeginGroup("Line rasterizer");
+
+    BenchLine* lines = (BenchLine*)malloc(sizeof(BenchLine) * RASTER_LINE_COUNT);
+    if (lines == NULL) return;
+
+    // Typical drag segments fully inside the canvas
+    for (int i = 0; i < RASTER_LINE_COUNT; i++) {
+        int x = BenchRandom(RASTER_CANVAS_SIZE);
+        int y = BenchRandom(RASTER_CANVAS_SIZE);
+        lines[i] = (BenchLine){x, y, x + BenchRandom(65) - 32, y + BenchRandom(65) - 32};
+    }
+    RunLineScenario("short drags", lines, RASTER_LINE_COUNT);
+
+    // Long, mostly horizontal or vertical strokes across the canvas
+    for (int i = 0; i < RASTER_LINE_COUNT; i++) {
+        int p = BenchRandom(RASTER_CANVAS_SIZE);
+        if (i % 2 == 0) {
+            lines[i] = (BenchLine){0, p, RASTER_CANVAS_SIZE - 1, p + BenchRandom(9) - 4};
+        } else {
+            lines[i] = (BenchLine){p, 0, p + BenchRandom(9) - 4, RASTER_CANVAS_SIZE - 1};
+        }
+    }
+    RunLineScenario("long strokes", lines, RASTER_LINE_COUNT);
+
+    // Fast drags that leave the canvas far behind
+    for (int i = 0; i < RASTER_LINE_COUNT; i++) {
+        int x = BenchRandom(RASTER_CANVAS_SIZE);
+        int y = BenchRandom(RASTER_CANVAS_SIZE);
+        lines[i] = (BenchLine){x, y, x + BenchRandom(20001) - 10000, y + BenchRandom(20001) - 10000};
+    }
+    RunLineScenario("off-canvas drags", lines, RASTER_LINE_COUNT);
+
+    free(lines);
+}
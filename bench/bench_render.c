@@ -0,0 +1,114 @@
+/**
+ * bench_render.c
+ *
+ * Software renderer: the canvas view of a 1080p screen at zoom levels from
+ * zoomed out to 16x, on one thread and across the pool, with the threaded
+ * output checked against the single-threaded one, and the mip pyramid the
+ * zoomed-out views render from: building it and keeping it up to date
+ */
+
+#include "bench.h"
+#include "mipmap.h"
+#include "softrender.h"
+#include "threadpool.h"
+#include "timing.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RENDER_BENCH_CANVAS 4096
+#define RENDER_BENCH_WIDTH 1920
+#define RENDER_BENCH_HEIGHT 1080
+#define RENDER_BENCH_FRAMES 20
+
+#define RENDER_BENCH_EDITS 64     // Scattered pixel edits between mip updates
+
+static const float renderZooms[] = {0.03125f, 0.125f, 0.5f, 1.0f, 4.0f, 16.0f};
+
+/**
+ * Opaque and translucent stripes, with empty tiles between them
+ */
+static void PaintRenderCanvas(Canvas* canvas) {
+    for (int y = 0; y < RENDER_BENCH_CANVAS; y++) {
+        if ((y >> CANVAS_TILE_SHIFT) % 3 == 2) continue;
+        Color color = {(unsigned char)y, (unsigned char)(y >> 4), 160, (y % 4 == 0) ? 120 : 255};
+        FillCanvasSpan(canvas, (y * 7) % 64, y, RENDER_BENCH_CANVAS - 128, color);
+    }
+}
+
+/**
+ * Average time of one view render
+ */
+static double TimeRenderFrames(SoftwareFramebuffer* framebuffer, Canvas* canvas, float zoom, ThreadPool* pool) {
+    Vector2 offset = {-37.0f, -21.0f};
+    double start = GetMonotonicTime();
+    for (int frame = 0; frame < RENDER_BENCH_FRAMES; frame++) {
+        ClearSoftwareFramebuffer(framebuffer, DARKGRAY);
+        RenderSoftwareCanvas(framebuffer, canvas, offset, zoom, 1, pool);
+    }
+    return (GetMonotonicTime() - start) / RENDER_BENCH_FRAMES;
+}
+
+/**
+ * Building the pyramid from scratch, then updating it after small edits
+ */
+static void RunMipmapBenchmarks(Canvas* canvas) {
+    DestroyCanvasMipmap(canvas->mipmap);
+    canvas->mipmap = NULL;
+
+    int level = 0;
+    double start = GetMonotonicTime();
+    GetCanvasDrawLevel(canvas, 1.0f / 64.0f, &level);
+    BenchReport(TextFormat("mip pyramid build (%d levels)", level), GetMonotonicTime() - start,
+                (double)RENDER_BENCH_CANVAS * RENDER_BENCH_CANVAS, "pixel");
+
+    unsigned int seed = 97531u;
+    double seconds = 0.0;
+    for (int frame = 0; frame < RENDER_BENCH_FRAMES; frame++) {
+        for (int i = 0; i < RENDER_BENCH_EDITS; i++) {
+            seed = seed * 1103515245u + 12345u;
+            int x = (int)((seed >> 8) % RENDER_BENCH_CANVAS);
+            seed = seed * 1103515245u + 12345u;
+            int y = (int)((seed >> 8) % RENDER_BENCH_CANVAS);
+            SetPixel(canvas, x, y, (Color){(unsigned char)x, (unsigned char)y, 40, 255});
+        }
+        start = GetMonotonicTime();
+        UpdateCanvasMipmap(canvas->mipmap, canvas);
+        seconds += GetMonotonicTime() - start;
+    }
+    BenchReport(TextFormat("mip update after %d scattered edits", RENDER_BENCH_EDITS), seconds / RENDER_BENCH_FRAMES,
+                1, "frame");
+}
+
+void RunRenderBenchmarks(void) {
+    BenchBeginGroup(TextFormat("Software renderer (%dx%d canvas, %dx%d view, %d cores)", RENDER_BENCH_CANVAS,
+                    RENDER_BENCH_CANVAS, RENDER_BENCH_WIDTH, RENDER_BENCH_HEIGHT, GetCpuCoreCount()));
+
+    Canvas* canvas = CreateCanvas(RENDER_BENCH_CANVAS, RENDER_BENCH_CANVAS);
+    SoftwareFramebuffer* single = CreateSoftwareFramebuffer(RENDER_BENCH_WIDTH, RENDER_BENCH_HEIGHT);
+    SoftwareFramebuffer* threaded = CreateSoftwareFramebuffer(RENDER_BENCH_WIDTH, RENDER_BENCH_HEIGHT);
+    // Always try at least two threads so the parallel path is exercised
+    ThreadPool* pool = CreateThreadPool((GetCpuCoreCount() < 2) ? 2 : 0);
+    if (canvas != NULL && single != NULL && threaded != NULL) {
+        PaintRenderCanvas(canvas);
+        RunMipmapBenchmarks(canvas);    // Also leaves the pyramid built for the zoomed-out views
+
+        size_t frameBytes = (size_t)RENDER_BENCH_WIDTH * RENDER_BENCH_HEIGHT * sizeof(Color);
+        for (size_t i = 0; i < sizeof(renderZooms) / sizeof(renderZooms[0]); i++) {
+            float zoom = renderZooms[i];
+            double singleSeconds = TimeRenderFrames(single, canvas, zoom, NULL);
+            double threadedSeconds = TimeRenderFrames(threaded, canvas, zoom, pool);
+            bool identical = memcmp(single->pixels, threaded->pixels, frameBytes) == 0;
+
+            BenchReport(TextFormat("view at %.0f%%, 1 thread", zoom * 100.0f), singleSeconds, 1, "frame");
+            BenchReport(TextFormat("view at %.0f%%, %d threads%s", zoom * 100.0f, GetThreadPoolSize(pool),
+                        identical ? "" : " (MISMATCH)"), threadedSeconds, 1, "frame");
+            BenchReportSpeedup(TextFormat("%.0f%% threaded speedup", zoom * 100.0f), singleSeconds,
+                               threadedSeconds);
+        }
+    }
+
+    DestroyThreadPool(pool);
+    DestroySoftwareFramebuffer(threaded);
+    DestroySoftwareFramebuffer(single);
+    DestroyCanvas(canvas);
+}
@@ -0,0 +1,138 @@
+/**
+ * batch.h
+ *
+ * Headless Batch Processing for Pixel Art Tool
+ * Runs a scripted list of operations over many image files without a
+ * window, one file per work item on the thread pool, and reports how long
+ * each file took. Started with `--batch [--threads N] <script> <images...>`.
+ *
+ * Script format (one operation per line, lines starting with # are comments):
+ *   recolor <from> <to> [tolerance]  Palette swap; colors as RRGGBB or RRGGBBAA hex
+ *   scale <factor>                   Nearest-neighbor scale (e.g. 2 or 0.5)
+ *   resize <width> <height>          Nearest-neighbor resize to an exact size
+ *   flip <h|v|hv>                    Mirror horizontally and/or vertically
+ *   trim                             Crop away fully transparent borders
+ *   export <path>                    Write a PNG; {name} in the path is the
+ *                                    input file name without its extension
+ * Operations run in order, so a script can export several variants.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "canvas.h"
+#include "threadpool.h"
+#include <stdbool.h>
+
+#define BATCH_PATH_LENGTH 260
+
+typedef enum {
+    BATCH_RECOLOR = 0,
+    BATCH_SCALE,
+    BATCH_RESIZE,
+    BATCH_FLIP,
+    BATCH_TRIM,
+    BATCH_EXPORT
+} BatchOpType;
+
+/**
+ * One scripted operation
+ */
+typedef struct {
+    BatchOpType type;
+    Color from;                     // Recolor
+    Color to;
+    unsigned char tolerance;
+    float factor;                   // Scale
+    int width;                      // Resize
+    int height;
+    bool horizontal;                // Flip
+    bool vertical;
+    char path[BATCH_PATH_LENGTH];   // Export (with {name} still in it)
+} BatchOp;
+
+/**
+ * Parsed operation list
+ */
+typedef struct {
+    BatchOp* ops;
+    int count;
+    int capacity;
+} BatchScript;
+
+/**
+ * Outcome and timings of one file
+ */
+typedef struct {
+    const char* path;               // Input file
+    bool ok;
+    char error[128];                // Why the file failed
+    int width;                      // Input size
+    int height;
+    int outputWidth;                // Size after the last operation
+    int outputHeight;
+    int exportCount;
+    double loadSeconds;
+    double processSeconds;          // All operations except exports
+    double exportSeconds;
+    int workerIndex;                // Thread that processed the file
+} BatchFileResult;
+
+/**
+ * Parse a batch script
+ *
+ * @param text Script source
+ * @param error Receives a message naming the bad line on failure
+ * @param errorSize Size of the error buffer
+ * @return Pointer to newly created BatchScript (must be freed with DestroyBatchScript), or NULL
+ */
+BatchScript* ParseBatchScript(const char* text, char* error, int errorSize);
+
+/**
+ * Read and parse a batch script file
+ *
+ * @param path Script file
+ * @param error Receives a message on failure
+ * @param errorSize Size of the error buffer
+ * @return Pointer to newly created BatchScript (must be freed with DestroyBatchScript), or NULL
+ */
+BatchScript* LoadBatchScript(const char* path, char* error, int errorSize);
+
+/**
+ * Free a batch script
+ *
+ * @param script BatchScript to destroy
+ */
+void DestroyBatchScript(BatchScript* script);
+
+/**
+ * Load one file, run the script on it and write its exports
+ * Touches no shared state, so files can be processed concurrently
+ *
+ * @param script Operations to run
+ * @param path Input image
+ * @param result Receives the outcome and timings
+ */
+void ProcessBatchFile(const BatchScript* script, const char* path, BatchFileResult* result);
+
+/**
+ * Process a list of files, spread across the thread pool
+ *
+ * @param script Operations to run
+ * @param paths Input images
+ * @param count Number of input images
+ * @param pool Threads to use (NULL for the calling thread only)
+ * @param results Receives one result per input, in input order
+ */
+void RunBatch(const BatchScript* script, char** paths, int count, ThreadPool* pool, BatchFileResult* results);
+
+/**
+ * Command line entry point of batch mode: parse arguments, run and report
+ *
+ * @param argc Number of arguments after --batch
+ * @param argv Arguments after --batch: [--threads N] <script> <images...>
+ * @return Process exit code (0 when every file succeeded)
+ */
+int RunBatchCommand(int argc, char** argv);
+
+#endif // BATCH_H
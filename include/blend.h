@@ -0,0 +1,69 @@
+/**
+ * blend.h
+ *
+ * Color Blending for Pixel Art Tool
+ * Porter-Duff source-over compositing of straight-alpha colors, with the
+ * separable multiply/screen/add modes applied where source and destination
+ * overlap. Span kernels run 4 (SSE2) or 8 (AVX2) pixels per step using the
+ * backend selected in pixelops.h.
+ */
+
+#ifndef BLEND_H
+#define BLEND_H
+
+#include "raylib.h"
+#include <stddef.h>
+
+/**
+ * How a source color is combined with the destination pixel
+ * (named to stay clear of raylib's GPU BlendMode)
+ */
+typedef enum {
+    PIXEL_BLEND_REPLACE,    // Write the source as-is, alpha included
+    PIXEL_BLEND_NORMAL,     // Source over destination
+    PIXEL_BLEND_MULTIPLY,   // Darken: source * destination
+    PIXEL_BLEND_SCREEN,     // Lighten: inverse of multiplying the inverses
+    PIXEL_BLEND_ADD,        // Source + destination, clamped
+    PIXEL_BLEND_COUNT
+} PixelBlendMode;
+
+/**
+ * Get the name of a blend mode as a string
+ *
+ * @param mode Blend mode to name
+ * @return Name string (e.g., "Normal", "Multiply")
+ */
+const char* GetPixelBlendModeName(PixelBlendMode mode);
+
+/**
+ * Blend one source color over one destination color
+ *
+ * @param dst Destination color
+ * @param src Source color (its alpha is the coverage)
+ * @param mode Blend mode
+ * @return Blended color
+ */
+Color BlendColors(Color dst, Color src, PixelBlendMode mode);
+
+/**
+ * Blend one source color over a run of pixels
+ *
+ * @param pixels Destination pixels, updated in place
+ * @param count Number of pixels
+ * @param src Source color
+ * @param mode Blend mode
+ */
+void BlendColorSpan(Color* pixels, size_t count, Color src, PixelBlendMode mode);
+
+/**
+ * Blend a run of source pixels over a run of destination pixels
+ *
+ * @param dst Destination pixels, updated in place
+ * @param src Source pixels
+ * @param count Number of pixels
+ * @param opacity Extra opacity applied to every source pixel (255 = none)
+ * @param mode Blend mode
+ */
+void BlendPixelSpan(Color* dst, const Color* src, size_t count, unsigned char opacity, PixelBlendMode mode);
+
+#endif // BLEND_H
@@ -0,0 +1,131 @@
+/**
+ * brush.h
+ *
+ * Brush Engine for Pixel Art Tool
+ * Brushes are precomputed masks stored as per-row spans. Strokes stamp the
+ * mask along the path and only emit the pixels the previous stamp did not
+ * already cover, so the cost of a drag follows the newly covered area
+ * rather than (number of stamps x brush area)
+ */
+
+#ifndef BRUSH_H
+#define BRUSH_H
+
+#include "raster.h"
+#include <stdbool.h>
+
+#define MIN_BRUSH_SIZE 1
+#define MAX_BRUSH_SIZE 64
+
+/**
+ * Brush shapes
+ */
+typedef enum {
+    BRUSH_ROUND,    // Filled circle of the given diameter
+    BRUSH_SQUARE,   // Filled square of the given edge length
+    BRUSH_CUSTOM    // Arbitrary mask supplied by the caller
+} BrushShape;
+
+/**
+ * One horizontal run of the brush mask, relative to the brush origin
+ */
+typedef struct {
+    int x0;     // First covered column (inclusive)
+    int x1;     // Last covered column (inclusive)
+} BrushSpan;
+
+/**
+ * Brush structure
+ * Row r of the mask (offset r - originY from the stamp position) owns spans
+ * [rowStart[r], rowStart[r + 1]), sorted and non-overlapping
+ */
+typedef struct {
+    BrushShape shape;
+    int width;          // Mask width in pixels
+    int height;         // Mask height in pixels
+    int originX;        // Mask column placed on the stamp position
+    int originY;        // Mask row placed on the stamp position
+    BrushSpan* spans;
+    int spanCount;
+    int* rowStart;      // height + 1 entries
+} Brush;
+
+/**
+ * Create a round or square brush
+ *
+ * @param shape BRUSH_ROUND or BRUSH_SQUARE
+ * @param size Diameter/edge in pixels, clamped to [MIN_BRUSH_SIZE, MAX_BRUSH_SIZE]
+ * @return Pointer to newly created Brush (must be freed with DestroyBrush)
+ */
+Brush* CreateBrush(BrushShape shape, int size);
+
+/**
+ * Create a brush from a mask
+ * The mask origin is its center pixel
+ *
+ * @param mask width * height bytes, non-zero where the brush paints
+ * @param width Mask width in pixels (1 to MAX_BRUSH_SIZE)
+ * @param height Mask height in pixels (1 to MAX_BRUSH_SIZE)
+ * @return Pointer to newly created Brush, or NULL if the mask is invalid or empty
+ */
+Brush* CreateCustomBrush(const unsigned char* mask, int width, int height);
+
+/**
+ * Destroy brush and free memory
+ *
+ * @param brush Brush to destroy
+ */
+void DestroyBrush(Brush* brush);
+
+/**
+ * Check whether a brush covers exactly one pixel
+ *
+ * @param brush Brush to query
+ * @return true for 1x1 brushes
+ */
+bool IsSinglePixelBrush(const Brush* brush);
+
+/**
+ * Stamp the brush once and emit the covered spans
+ *
+ * @param brush Brush to stamp
+ * @param x Stamp position X
+ * @param y Stamp position Y
+ * @param clipMinX Clip rectangle left (inclusive)
+ * @param clipMinY Clip rectangle top (inclusive)
+ * @param clipMaxX Clip rectangle right (inclusive)
+ * @param clipMaxY Clip rectangle bottom (inclusive)
+ * @param callback Receives horizontal spans
+ * @param userData Passed through to callback
+ * @return Number of spans emitted
+ */
+int StampBrush(const Brush* brush, int x, int y,
+               int clipMinX, int clipMinY, int clipMaxX, int clipMaxY,
+               RasterSpanCallback callback, void* userData);
+
+/**
+ * Stamp the brush at every step of a line, excluding the start point
+ *
+ * The start point is treated as already stamped (it is the end of the
+ * previous segment of the stroke). Each stamp only emits pixels the
+ * previous stamp did not cover, and stamps that cannot reach the clip
+ * rectangle are skipped without being visited.
+ *
+ * @param brush Brush to stamp
+ * @param x0 Start X (already stamped)
+ * @param y0 Start Y
+ * @param x1 End X
+ * @param y1 End Y
+ * @param clipMinX Clip rectangle left (inclusive)
+ * @param clipMinY Clip rectangle top (inclusive)
+ * @param clipMaxX Clip rectangle right (inclusive)
+ * @param clipMaxY Clip rectangle bottom (inclusive)
+ * @param callback Receives horizontal spans
+ * @param userData Passed through to callback
+ * @return Number of spans emitted
+ */
+int StampBrushLine(const Brush* brush, int x0, int y0, int x1, int y1,
+                   int clipMinX, int clipMinY, int clipMaxX, int clipMaxY,
+                   RasterSpanCallback callback, void* userData);
+
+#endif // BRUSH_H
@@ -2,15 +2,103 @@
 #define CANVAS_H
 
 #include "raylib.h"
+#include "blend.h"
 #include <stdbool.h>
+#include <stddef.h>
 
-// Canvas structure for pixel data storage
+// Canvas storage is split into fixed-size square tiles that are allocated
+// on first write. Untouched tiles share no memory and read as emptyColor.
+#define CANVAS_TILE_SHIFT 7
+#define CANVAS_TILE_SIZE (1 << CANVAS_TILE_SHIFT)   // Tile edge in pixels (128)
+#define CANVAS_TILE_MASK (CANVAS_TILE_SIZE - 1)
+#define CANVAS_TILE_PIXELS (CANVAS_TILE_SIZE * CANVAS_TILE_SIZE)
+#define CANVAS_MAX_SIZE 65536                       // Largest supported width/height
+
+// A single tile of canvas storage
 typedef struct {
+    Color* pixels;          // CANVAS_TILE_PIXELS row-major pixels, NULL while empty
+
+    // GPU mirror of this tile, drawn as one scaled quad
+    Texture2D texture;      // Created lazily on first sync (needs a GL context)
+    bool hasTexture;        // Whether texture has been created
+
+    // Region modified since the last texture upload (tile-local, inclusive)
+    bool isDirty;
+    unsigned short dirtyMinX;
+    unsigned short dirtyMinY;
+    unsigned short dirtyMaxX;
+    unsigned short dirtyMaxY;
+
+    unsigned int writeSession;  // Last write session that reported this tile
+    bool isPending;             // Stored with the tile loader, loaded on first access
+} CanvasTile;
+
+struct Canvas;
+struct CanvasMipmap;
+
+// Called before a tile is modified for the first time in a write session
+typedef void (*CanvasTileWriteCallback)(void* userData, struct Canvas* canvas, int tileIndex);
+
+// Fills a pending tile (pixels stored elsewhere, e.g. compressed in a project
+// file) the first time it is accessed; returning false leaves the tile empty
+typedef bool (*CanvasTileLoader)(void* userData, struct Canvas* canvas, int tileIndex, Color* pixels);
+
+// Canvas structure for pixel data storage
+typedef struct Canvas {
     int width;              // Canvas width in pixels
     int height;             // Canvas height in pixels
-    Color* pixels;          // 2D array stored as 1D (width * height)
+    int tilesX;             // Number of tile columns
+    int tilesY;             // Number of tile rows
+    CanvasTile* tiles;      // Tile grid stored as 1D (tilesX * tilesY)
+    Color emptyColor;       // Color reported for pixels in unallocated tiles
+    size_t allocatedTiles;  // Number of tiles with pixel storage
+
+    // Tiles with pending texture uploads
+    int* dirtyTiles;
+    int dirtyCount;
+    int dirtyCapacity;
+
+    // Staging buffer used to pack dirty rectangles for partial uploads
+    Color* uploadBuffer;
+
+    // Write observer (e.g. undo history snapshotting tiles before a stroke)
+    CanvasTileWriteCallback onTileWrite;
+    void* onTileWriteUserData;
+    unsigned int writeSession;  // Number of the current/last write session
+    bool isTrackingWrites;      // Whether a write session is active
+
+    // Lazy loading of pending tiles
+    CanvasTileLoader tileLoader;
+    void* tileLoaderUserData;
+    size_t pendingTiles;        // Number of tiles not loaded yet
+
+    // Downsampled levels for zoomed-out drawing (see mipmap.h), NULL until first needed
+    struct CanvasMipmap* mipmap;
+
+    // Work done by the last DrawCanvas (for profiling)
+    int drawCalls;              // Quads drawn, checkerboard included
+    int textureUploads;         // Tile textures created or updated
 } Canvas;
 
+// Range of canvas pixels at least partly on screen (inclusive)
+typedef struct {
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+} CanvasRegion;
+
+// Read-only copy-on-write capture of a canvas (see CreateCanvasSnapshot)
+// Safe to read and destroy on another thread while the canvas keeps changing
+typedef struct {
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    Color emptyColor;
+    const Color** tiles;    // Shared tile pixels, NULL for empty tiles
+} CanvasSnapshot;
+
 // Canvas initialization and cleanup
 Canvas* CreateCanvas(int width, int height);
 void DestroyCanvas(Canvas* canvas);
@@ -21,12 +109,62 @@ void SetPixel(Canvas* canvas, int x, int y, Color color);
 Color GetPixel(Canvas* canvas, int x, int y);
 bool IsValidPixelCoord(Canvas* canvas, int x, int y);
 
+// Span operations (clipped to the canvas, one tile lookup per tile crossed)
+void FillCanvasSpan(Canvas* canvas, int x, int y, int length, Color color);
+void FillCanvasColumn(Canvas* canvas, int x, int y, int length, Color color);
+void BlendCanvasSpan(Canvas* canvas, int x, int y, int length, Color color, PixelBlendMode mode);
+void BlendCanvasColumn(Canvas* canvas, int x, int y, int length, Color color, PixelBlendMode mode);
+
+// Bulk operations (vectorized, see pixelops.h)
+size_t ReplaceCanvasColor(Canvas* canvas, Color from, Color to, unsigned char tolerance);
+
+// Tile access
+int GetCanvasTileIndex(Canvas* canvas, int x, int y);
+Color* GetCanvasTilePixels(Canvas* canvas, int tileIndex);
+Color* AcquireCanvasTilePixels(Canvas* canvas, int tileIndex);
+void RestoreCanvasTile(Canvas* canvas, int tileIndex, const Color* pixels);
+void ShareCanvasTile(Canvas* canvas, int tileIndex, Canvas* source);
+void ReadCanvasRow(Canvas* canvas, int y, Color* row);
+bool WriteCanvasRow(Canvas* canvas, int y, const Color* row);
+size_t GetCanvasMemoryUsage(Canvas* canvas);
+size_t GetCanvasTileAllocationCount(void);  // Tile buffers allocated by all canvases so far
+
+// Lazy loading (pending tiles load on first read or write)
+void SetCanvasTileLoader(Canvas* canvas, CanvasTileLoader loader, void* userData);
+void SetCanvasTilePending(Canvas* canvas, int tileIndex);
+bool IsCanvasTilePending(Canvas* canvas, int tileIndex);
+bool HasCanvasTileData(Canvas* canvas, int tileIndex);
+void LoadCanvasTiles(Canvas* canvas);
+
+// Snapshots (share tile storage until the canvas next writes a tile)
+CanvasSnapshot* CreateCanvasSnapshot(Canvas* canvas);
+void DestroyCanvasSnapshot(CanvasSnapshot* snapshot);
+void ReadCanvasSnapshotRow(const CanvasSnapshot* snapshot, int y, Color* row);
+
+// Write tracking
+void SetCanvasTileWriteCallback(Canvas* canvas, CanvasTileWriteCallback callback, void* userData);
+void BeginCanvasWriteSession(Canvas* canvas);
+void EndCanvasWriteSession(Canvas* canvas);
+
 // Coordinate conversion
 Vector2 PixelToScreen(int pixelX, int pixelY, Vector2 canvasOffset, float zoom, int pixelSize);
 Vector2 ScreenToPixel(int screenX, int screenY, Vector2 canvasOffset, float zoom, int pixelSize);
+bool GetVisibleCanvasRegion(int width, int height, Vector2 canvasOffset, float zoom, int pixelSize,
+                            int screenWidth, int screenHeight, CanvasRegion* region);
+
+// Texture mirror
+void MarkCanvasDirty(Canvas* canvas, int x, int y, int width, int height);
+void SyncCanvasTexture(Canvas* canvas);
+void ClearCanvasDirtyTiles(Canvas* canvas);
 
 // Rendering
 void DrawCanvas(Canvas* canvas, Vector2 offset, float zoom, int pixelSize);
-void DrawCheckerboardBackground(int x, int y, int width, int height, int pixelSize, float zoom);
+void DrawCheckerboardBackground(Vector2 offset, int width, int height, int pixelSize, float zoom);
+void UnloadCheckerboardTexture(void);
+
+// Overlays (clipped to the screen, so their cost follows the screen size)
+#define CANVAS_GRID_MIN_SCALE 8.0f  // Screen pixels per canvas pixel before the grid shows
+void DrawCanvasBorder(Vector2 offset, int width, int height, int pixelSize, float zoom, Color color);
+void DrawCanvasPixelGrid(Vector2 offset, int width, int height, int pixelSize, float zoom, Color color);
 
 #endif // CANVAS_H
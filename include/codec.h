@@ -0,0 +1,63 @@
+/**
+ * codec.h
+ *
+ * Pixel Compression for Pixel Art Tool
+ * Run-length encoding of 32-bit pixel data, used to keep tile snapshots
+ * (undo history, saved tiles) small. Pixel art is dominated by runs of
+ * identical colors, so this compresses well at very low cost.
+ * Also provides the CRC-32 and Adler-32 checksums used by file formats.
+ */
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Compress pixels with run-length encoding
+ *
+ * Stream format: a sequence of packets, each starting with a header byte.
+ * - Header bit 7 set:   run of (header & 0x7F) + 1 copies of the next 4-byte pixel
+ * - Header bit 7 clear: (header & 0x7F) + 1 literal 4-byte pixels follow
+ *
+ * @param pixels Pixels to compress
+ * @param count Number of pixels
+ * @param outSize Receives the compressed size in bytes
+ * @return Newly allocated compressed data (free with free()), or NULL on failure
+ */
+unsigned char* CompressPixelsRLE(const Color* pixels, size_t count, size_t* outSize);
+
+/**
+ * Decompress run-length encoded pixels
+ *
+ * @param data Compressed data produced by CompressPixelsRLE
+ * @param size Compressed size in bytes
+ * @param pixels Output buffer
+ * @param count Exact number of pixels expected
+ * @return true if the stream decoded to exactly count pixels
+ */
+bool DecompressPixelsRLE(const unsigned char* data, size_t size, Color* pixels, size_t count);
+
+/**
+ * Continue a CRC-32 (ISO-HDLC, as used by PNG and zip) over more data
+ *
+ * @param crc Checksum of the data so far (0 to start)
+ * @param data Next bytes
+ * @param size Number of bytes
+ * @return Updated checksum
+ */
+unsigned int UpdateCrc32(unsigned int crc, const unsigned char* data, size_t size);
+
+/**
+ * Continue an Adler-32 checksum (as used by zlib streams) over more data
+ *
+ * @param adler Checksum of the data so far (1 to start)
+ * @param data Next bytes
+ * @param size Number of bytes
+ * @return Updated checksum
+ */
+unsigned int UpdateAdler32(unsigned int adler, const unsigned char* data, size_t size);
+
+#endif // CODEC_H
@@ -0,0 +1,50 @@
+/**
+ * editor.h
+ *
+ * Editor Shortcuts for Pixel Art Tool
+ * Application-level shortcuts that are not tied to a single tool: opening
+ * the color picker, undo/redo and layer commands. They read input through
+ * input.h, so the interactive loop and a headless input replay run the
+ * same code.
+ */
+
+#ifndef EDITOR_H
+#define EDITOR_H
+
+#include "ui.h"
+#include "tool.h"
+#include "history.h"
+#include "layer.h"
+#include <stdbool.h>
+
+/**
+ * C toggles the color picker; clicking the color swatches opens it
+ * An opened picker starts from the current foreground color
+ *
+ * @param picker Color picker to toggle
+ * @param toolState Tool state holding the foreground color (may be NULL)
+ */
+void UpdateColorPickerShortcuts(ColorPicker* picker, ToolState* toolState);
+
+/**
+ * Ctrl+Z undoes, Ctrl+Y or Ctrl+Shift+Z redoes (not while a stroke is in progress)
+ *
+ * @param history History to step through
+ * @param toolState Tool state, to check for a stroke in progress
+ * @return true if a step was undone or redone
+ */
+bool UpdateHistoryShortcuts(History* history, ToolState* toolState);
+
+/**
+ * Layer commands (not while a stroke is painting on the active layer):
+ * N adds, Delete deletes, PgUp/PgDn select (with Shift: move), V toggles
+ * visibility, O cycles opacity, L cycles the blend mode
+ *
+ * @param layers Layer stack to edit
+ * @param history History recording deleted layers (may be NULL)
+ * @param toolState Tool state, to check for a stroke in progress
+ * @return true if the layer stack changed
+ */
+bool UpdateLayerShortcuts(LayerStack* layers, History* history, ToolState* toolState);
+
+#endif // EDITOR_H
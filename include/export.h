@@ -0,0 +1,89 @@
+/**
+ * export.h
+ *
+ * Background Image Export for Pixel Art Tool
+ * Captures a copy-on-write snapshot of a canvas on the calling thread and
+ * encodes it to PNG on a background thread, so painting continues while a
+ * large document is written. Progress and completion are published through
+ * atomics the main loop can poll every frame without locking.
+ */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "canvas.h"
+#include "threadpool.h"
+#include <stdbool.h>
+
+typedef enum {
+    EXPORT_RUNNING = 0,
+    EXPORT_DONE,
+    EXPORT_FAILED,
+    EXPORT_CANCELLED
+} ExportStatus;
+
+typedef struct {
+    char path[260];             // Final file
+    char tempPath[268];         // Written first, renamed over path on success
+    CanvasSnapshot* snapshot;   // Owned by the export thread once started
+    BackgroundThread* thread;
+
+    // Shared with the export thread (accessed atomically)
+    int rowsDone;
+    int totalRows;
+    int status;                 // ExportStatus
+    int cancelRequested;
+
+    double startTime;           // Seconds, GetMonotonicTime
+    double finishTime;          // Set by the export thread when it stops
+} ExportJob;
+
+/**
+ * Snapshot a canvas and start writing it as a PNG in the background
+ * Falls back to exporting on the calling thread if no thread can be started
+ *
+ * @param canvas Canvas to export (may keep changing after this returns)
+ * @param path File to write
+ * @return Pointer to newly created ExportJob (must be freed with DestroyExportJob), or NULL
+ */
+ExportJob* StartPngExport(Canvas* canvas, const char* path);
+
+/**
+ * Get the fraction of rows written so far
+ *
+ * @param job ExportJob to query
+ * @return Progress from 0.0 to 1.0
+ */
+float GetExportProgress(const ExportJob* job);
+
+/**
+ * Get the current state of an export
+ *
+ * @param job ExportJob to query
+ * @return EXPORT_RUNNING until the export thread has stopped
+ */
+ExportStatus GetExportStatus(const ExportJob* job);
+
+/**
+ * Get the time an export took, or has taken so far
+ *
+ * @param job ExportJob to query
+ * @return Elapsed seconds
+ */
+double GetExportElapsedTime(const ExportJob* job);
+
+/**
+ * Ask a running export to stop after the current row (removes the partial file)
+ *
+ * @param job ExportJob to cancel
+ */
+void CancelExport(ExportJob* job);
+
+/**
+ * Wait for the export thread to stop and free the job
+ *
+ * @param job ExportJob to destroy
+ */
+void DestroyExportJob(ExportJob* job);
+
+#endif // EXPORT_H
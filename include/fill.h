@@ -0,0 +1,74 @@
+/**
+ * fill.h
+ *
+ * Flood Fill for Pixel Art Tool
+ * Scanline span fill: each matching run of a row is found with one tile-aware
+ * scan and written with one span write, and pending work is kept on an
+ * explicit stack of row segments instead of the call stack
+ */
+
+#ifndef FILL_H
+#define FILL_H
+
+#include "raylib.h"
+#include "canvas.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Which pixels a fill replaces
+ */
+typedef enum {
+    FILL_CONTIGUOUS,    // Region connected (4-way) to the seed pixel
+    FILL_GLOBAL         // Every pixel on the canvas matching the seed color
+} FillMode;
+
+/**
+ * A row segment whose neighbouring row still has to be scanned
+ */
+typedef struct {
+    int x0;             // First column (inclusive)
+    int x1;             // Last column (inclusive)
+    int y;              // Row to scan
+    int dy;             // Direction the segment was reached from (+1 or -1)
+} FillSegment;
+
+/**
+ * Work stack for contiguous fills
+ * Kept between fills so repeated fills do not reallocate
+ */
+typedef struct {
+    FillSegment* segments;
+    int count;
+    int capacity;
+} FillArena;
+
+/**
+ * Create an empty fill arena
+ *
+ * @return Pointer to newly created FillArena (must be freed with DestroyFillArena)
+ */
+FillArena* CreateFillArena(void);
+
+/**
+ * Destroy a fill arena and free its stack
+ *
+ * @param arena FillArena to destroy
+ */
+void DestroyFillArena(FillArena* arena);
+
+/**
+ * Replace the color under a seed pixel
+ * Filling with the seed color itself changes nothing.
+ *
+ * @param canvas Canvas to fill
+ * @param arena Work stack to use (may be NULL for FILL_GLOBAL)
+ * @param x Seed X
+ * @param y Seed Y
+ * @param color Color to write
+ * @param mode Contiguous region or all matching pixels
+ * @return Number of pixels written
+ */
+size_t FloodFillCanvas(Canvas* canvas, FillArena* arena, int x, int y, Color color, FillMode mode);
+
+#endif // FILL_H
@@ -0,0 +1,179 @@
+/**
+ * history.h
+ *
+ * Undo/Redo History System for Pixel Art Tool
+ * Records each edit as compressed before/after snapshots of only the canvas
+ * tiles it touched, so undo/redo cost depends on the size of the edit and
+ * memory use follows the painted area rather than the canvas size
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "canvas.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Default memory budget for stored snapshots
+#define DEFAULT_HISTORY_BUDGET (64u * 1024u * 1024u)
+
+/**
+ * Snapshot of one tile before and after an edit
+ * A NULL snapshot means the tile was empty (unallocated)
+ */
+typedef struct {
+    int tileIndex;
+    unsigned char* before;      // RLE-compressed pixels before the edit
+    size_t beforeSize;
+    unsigned char* after;       // RLE-compressed pixels after the edit
+    size_t afterSize;
+} HistoryTileDelta;
+
+/**
+ * One undoable step (a stroke or other edit)
+ */
+typedef struct {
+    Canvas* canvas;             // Canvas the tiles belong to
+    HistoryTileDelta* tiles;
+    int tileCount;
+    int tileCapacity;
+    size_t byteSize;            // Memory held by this entry's snapshots
+} HistoryEntry;
+
+/**
+ * Called whenever the history changes canvas pixels: when a step is
+ * committed and after it is undone or redone
+ *
+ * @param userData Pointer given to SetHistoryApplyCallback
+ * @param entry Step whose tiles changed, or NULL if a step changed the canvas but could not be
+ *              recorded (out of memory; the history has been cleared)
+ * @param isAfter Whether the canvas now holds the after snapshots (false for undo)
+ */
+typedef void (*HistoryApplyCallback)(void* userData, const HistoryEntry* entry, bool isAfter);
+
+/**
+ * History structure
+ * Entries [0, cursor) can be undone, entries [cursor, count) can be redone
+ */
+typedef struct {
+    HistoryEntry* entries;      // Oldest entry first
+    int count;
+    int capacity;
+    int cursor;
+
+    size_t byteBudget;          // Oldest entries are evicted above this size
+    size_t bytesUsed;
+
+    // Step currently being recorded
+    HistoryEntry pending;
+    bool isRecording;
+    bool isPendingInvalid;      // A snapshot failed (out of memory): the step is dropped
+
+    Color* scratch;             // One tile of pixels for decompressing snapshots
+
+    HistoryApplyCallback onApply;
+    void* onApplyUserData;
+} History;
+
+/**
+ * Create an empty history
+ *
+ * @param byteBudget Maximum memory for stored snapshots (0 for the default)
+ * @return Pointer to newly created History (must be freed with DestroyHistory)
+ */
+History* CreateHistory(size_t byteBudget);
+
+/**
+ * Destroy history and free all snapshots
+ *
+ * @param history History to destroy
+ */
+void DestroyHistory(History* history);
+
+/**
+ * Start recording an undoable step on a canvas
+ * Tiles are snapshotted automatically the first time the step writes to them
+ *
+ * @param history History to record into
+ * @param canvas Canvas that is about to be modified
+ */
+void BeginHistoryStep(History* history, Canvas* canvas);
+
+/**
+ * Finish the current step and push it onto the undo stack
+ * Steps that did not modify any tile are discarded.
+ * Clears the redo stack and evicts old entries to stay within the budget.
+ * If a snapshot or the step itself could not be stored the step is dropped
+ * and the whole history cleared, since undo would no longer restore the
+ * right pixels.
+ *
+ * @param history History to update
+ */
+void EndHistoryStep(History* history);
+
+/**
+ * Undo the most recent step
+ *
+ * @param history History to update
+ * @return true if a step was undone
+ */
+bool UndoHistory(History* history);
+
+/**
+ * Redo the most recently undone step
+ *
+ * @param history History to update
+ * @return true if a step was redone
+ */
+bool RedoHistory(History* history);
+
+/**
+ * Check whether a step can be undone
+ *
+ * @param history History to query
+ * @return true if UndoHistory would succeed
+ */
+bool CanUndo(History* history);
+
+/**
+ * Check whether a step can be redone
+ *
+ * @param history History to query
+ * @return true if RedoHistory would succeed
+ */
+bool CanRedo(History* history);
+
+/**
+ * Remove all entries (e.g. after loading a new image)
+ *
+ * @param history History to clear
+ */
+void ClearHistory(History* history);
+
+/**
+ * Drop every entry that edits a canvas (e.g. before the canvas is destroyed)
+ * Entries for other canvases keep their order and stay undoable
+ *
+ * @param history History to update
+ * @param canvas Canvas whose entries are removed
+ */
+void ForgetHistoryCanvas(History* history, Canvas* canvas);
+
+/**
+ * Set the callback told about every committed, undone and redone step
+ *
+ * @param history History to update
+ * @param callback Function to call (NULL to disable)
+ * @param userData Pointer passed to the callback
+ */
+void SetHistoryApplyCallback(History* history, HistoryApplyCallback callback, void* userData);
+
+/**
+ * Change the memory budget, evicting old entries if needed
+ *
+ * @param history History to update
+ * @param byteBudget New budget in bytes
+ */
+void SetHistoryBudget(History* history, size_t byteBudget);
+
+#endif // HISTORY_H
@@ -0,0 +1,57 @@
+/**
+ * import.h
+ *
+ * Image Import for Pixel Art Tool
+ * Opens an image file as a new single-layer document. PNGs are decoded one
+ * row at a time straight into the layer's tile storage, so the only full
+ * copy of the image in memory is the canvas itself (the composite shares
+ * its tiles). Formats or PNG variants the streaming reader does not handle
+ * (e.g. interlaced PNGs) go through raylib's whole-image loader instead.
+ */
+
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include "layer.h"
+#include <stdbool.h>
+
+/**
+ * Timing report of an import
+ */
+typedef struct {
+    int width;
+    int height;
+    double seconds;                 // Decode and copy into the canvas
+    bool isStreamed;                // Decoded row by row (false: whole-image fallback)
+    size_t canvasBytes;             // Tile memory of the loaded layer
+} ImportStats;
+
+/**
+ * Load an image file as a document with one layer holding the image
+ *
+ * @param path Image file (PNG, or anything raylib's LoadImage accepts)
+ * @param stats Receives the timing report (may be NULL)
+ * @return Pointer to newly created LayerStack (must be freed with DestroyLayerStack), or NULL
+ */
+LayerStack* ImportImageDocument(const char* path, ImportStats* stats);
+
+/**
+ * Load an image file into a new canvas
+ * Needs no window and shares no state, so files can be loaded on several
+ * threads at once (as long as they are PNGs the streaming reader handles)
+ *
+ * @param path Image file (PNG, or anything raylib's LoadImage accepts)
+ * @param stats Receives the timing report (may be NULL)
+ * @return Pointer to newly created Canvas (must be freed with DestroyCanvas), or NULL
+ */
+Canvas* ImportImageCanvas(const char* path, ImportStats* stats);
+
+/**
+ * Get the pixel throughput of an import
+ *
+ * @param stats Report filled in by ImportImageDocument
+ * @return Megapixels per second
+ */
+double GetImportMegapixelsPerSecond(const ImportStats* stats);
+
+#endif // IMPORT_H
@@ -0,0 +1,202 @@
+/**
+ * input.h
+ *
+ * Input Abstraction and Recording for Pixel Art Tool
+ * Tools, camera and UI read input through this module instead of calling
+ * raylib directly. The main loop captures one InputFrame per iteration
+ * (mouse, wheel, buttons and the keys the application uses) and makes it
+ * current; a headless replay makes recorded frames current instead, so
+ * the same code runs without a window.
+ *
+ * Frames can be recorded to a compact log (little-endian):
+ *   header  "PXIN", u32 version, u32 tracked key count, u32 screen width,
+ *           u32 screen height, f32 camera x, y, zoom, f32 color picker
+ *           x, y, width, height, u16 length + document path
+ *   frames  u8 mask of the fields that changed since the last frame, then
+ *           those fields in mask bit order: f32 mouse x, y | f32 wheel |
+ *           u8 buttons down, pressed, released | u64 keys down |
+ *           u64 keys pressed | u16 screen width, height
+ *   end     u8 INPUT_LOG_END, u32 frame count, u32 final checksum
+ * An idle frame costs one byte.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define INPUT_LOG_VERSION 1
+#define INPUT_LOG_END 0x80          // Frame mask value marking the end record
+
+/**
+ * Input state of one main loop iteration
+ */
+typedef struct {
+    Vector2 mousePosition;
+    float wheelMove;
+    unsigned char buttonsDown;      // Bit per MOUSE_BUTTON_LEFT/RIGHT/MIDDLE
+    unsigned char buttonsPressed;
+    unsigned char buttonsReleased;
+    unsigned long long keysDown;    // Bit per tracked key (see input.c)
+    unsigned long long keysPressed;
+    int screenWidth;
+    int screenHeight;
+} InputFrame;
+
+/**
+ * What a replay needs to start from the recorded state
+ */
+typedef struct {
+    int screenWidth;
+    int screenHeight;
+    Vector2 cameraPosition;
+    float cameraZoom;
+    Rectangle pickerBounds;         // InitColorPicker arguments
+    char documentPath[260];         // Project holding the document at the first frame
+} InputLogHeader;
+
+typedef struct InputRecorder InputRecorder;
+typedef struct InputLog InputLog;
+
+/**
+ * Capture the current raylib input state (needs a window)
+ *
+ * @param frame Receives the input state
+ */
+void PollInputFrame(InputFrame* frame);
+
+/**
+ * Make a frame the input every query below answers from
+ *
+ * @param frame Input to use until the next call
+ */
+void SetInputFrame(const InputFrame* frame);
+
+/**
+ * Set the state of a key in a frame, for building synthetic input
+ *
+ * @param frame Frame to change
+ * @param key raylib KeyboardKey
+ * @param isDown Whether the key is held down
+ * @param isPressed Whether the key went down this frame
+ * @return false for keys the application does not use (the frame is unchanged)
+ */
+bool SetInputFrameKey(InputFrame* frame, int key, bool isDown, bool isPressed);
+
+/**
+ * Check whether a key is held down (keys the application does not use read as up)
+ *
+ * @param key raylib KeyboardKey
+ * @return true if the key is down
+ */
+bool IsInputKeyDown(int key);
+
+/**
+ * Check whether a key went down this frame
+ *
+ * @param key raylib KeyboardKey
+ * @return true if the key was pressed
+ */
+bool IsInputKeyPressed(int key);
+
+/**
+ * Check whether a mouse button is held down
+ *
+ * @param button raylib MouseButton (left, right or middle)
+ * @return true if the button is down
+ */
+bool IsInputMouseButtonDown(int button);
+
+/**
+ * Check whether a mouse button went down this frame
+ *
+ * @param button raylib MouseButton
+ * @return true if the button was pressed
+ */
+bool IsInputMouseButtonPressed(int button);
+
+/**
+ * Check whether a mouse button went up this frame
+ *
+ * @param button raylib MouseButton
+ * @return true if the button was released
+ */
+bool IsInputMouseButtonReleased(int button);
+
+/**
+ * Get the mouse position
+ *
+ * @return Position in screen pixels
+ */
+Vector2 GetInputMousePosition(void);
+
+/**
+ * Get the mouse wheel movement of this frame
+ *
+ * @return Wheel steps, positive away from the user
+ */
+float GetInputMouseWheelMove(void);
+
+/**
+ * Start recording input frames to a log file
+ *
+ * @param path Log file to create
+ * @param header Starting state written at the top of the log
+ * @return Pointer to newly created InputRecorder (must be freed with DestroyInputRecorder), or NULL
+ */
+InputRecorder* CreateInputRecorder(const char* path, const InputLogHeader* header);
+
+/**
+ * Append one frame to a log
+ *
+ * @param recorder Recorder to append to
+ * @param frame Input of the frame
+ * @return false if the write failed (the recorder stops recording)
+ */
+bool RecordInputFrame(InputRecorder* recorder, const InputFrame* frame);
+
+/**
+ * Write the end record and close the log
+ *
+ * @param recorder Recorder to destroy
+ * @param checksum Checksum of the document after the last frame, for replays to verify
+ */
+void DestroyInputRecorder(InputRecorder* recorder, unsigned int checksum);
+
+/**
+ * Open an input log for replay
+ *
+ * @param path Log file
+ * @param header Receives the starting state
+ * @return Pointer to newly opened InputLog (must be freed with CloseInputLog), or NULL
+ */
+InputLog* OpenInputLog(const char* path, InputLogHeader* header);
+
+/**
+ * Read the next frame of a log
+ *
+ * @param log Log to read
+ * @param frame Receives the input of the frame
+ * @return false at the end of the log (or at a truncated frame)
+ */
+bool ReadInputFrame(InputLog* log, InputFrame* frame);
+
+/**
+ * Get the end record of a log that has been read to the end
+ *
+ * @param log Log to query
+ * @param frameCount Receives the number of recorded frames
+ * @param checksum Receives the recorded final checksum
+ * @return false if the log has no end record (the recording was cut short)
+ */
+bool GetInputLogEnd(InputLog* log, int* frameCount, unsigned int* checksum);
+
+/**
+ * Close an input log
+ *
+ * @param log Log to close
+ */
+void CloseInputLog(InputLog* log);
+
+#endif // INPUT_H
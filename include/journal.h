@@ -0,0 +1,153 @@
+/**
+ * journal.h
+ *
+ * Autosave Journal for Pixel Art Tool
+ * Instead of saving the whole document every so often, every committed,
+ * undone or redone edit is appended to an operation journal as the
+ * compressed contents of the tiles it changed, and layer changes (add,
+ * delete, reorder, rename, opacity, visibility, blend mode) as a small
+ * layer table. Records are handed to the system as soon as they are
+ * written, so a crash of the program loses nothing; syncing them to the
+ * disk is batched to at most once per JOURNAL_SYNC_INTERVAL.
+ *
+ * The journal applies on top of a checkpoint, which is a project file.
+ * Once the journal has grown past the size of the checkpoint (and
+ * JOURNAL_MIN_COMPACT_BYTES) it is compacted: a new checkpoint is saved
+ * and the journal starts over, so autosave costs follow the edits rather
+ * than the document size. After a crash, recovery opens the checkpoint
+ * and replays the journal's intact records in order.
+ *
+ * Layout (little-endian):
+ *   header  "PXJL", u32 version, u32 checkpoint index checksum, u32 reserved
+ *   records 4-byte type, u32 payload size, u32 payload CRC-32, payload
+ *           "TILE" u32 layer id, u32 tile index, CompressPixelsRLE data
+ *                  (no data: the tile is empty)
+ *           "LAYR" u32 layer count, u32 active layer, then per layer
+ *                  u32 layer id, name[32], opacity, visible, blend mode, 0
+ * Layer ids stay with a layer while it is reordered; the checkpoint's
+ * layers have ids 0 to count - 1 from the bottom up.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "layer.h"
+#include "history.h"
+#include "project.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+#define JOURNAL_SYNC_INTERVAL 1.0                       // Seconds between syncs to disk
+#define JOURNAL_MIN_COMPACT_BYTES (8u * 1024u * 1024u)  // Smallest journal worth compacting
+
+/**
+ * Stable id of one layer's canvas in the journal
+ */
+typedef struct {
+    Canvas* canvas;
+    unsigned int id;
+} JournalLayerId;
+
+/**
+ * Journal structure
+ */
+typedef struct {
+    char checkpointPath[260];
+    char journalPath[260];
+    FILE* file;                     // Open for appending, NULL while journaling is off
+    LayerStack* stack;              // Document being journaled
+
+    JournalLayerId* layerIds;       // One per layer, bottom layer first
+    int layerIdCount;
+    unsigned int nextLayerId;
+    unsigned char* layerTable;      // Payload of the last layer record written
+    size_t layerTableSize;
+
+    unsigned char* record;          // Scratch space for building records
+    size_t recordCapacity;
+
+    size_t journalBytes;            // Written since the last checkpoint
+    size_t checkpointBytes;         // Size of the last checkpoint
+    bool needsSync;                 // Written but not yet synced to disk
+    bool needsCheckpoint;           // An edit could not be journaled; records wait for a checkpoint
+    double lastSyncTime;            // Seconds, GetMonotonicTime
+
+    // Statistics
+    int recordCount;                // Records since the last checkpoint
+    int checkpointCount;
+    double lastCheckpointSeconds;
+} Journal;
+
+/**
+ * Timing report of a recovery
+ */
+typedef struct {
+    int recordsReplayed;
+    double seconds;                 // Opening the checkpoint and replaying
+} JournalRecoveryStats;
+
+/**
+ * Create a journal that is not yet recording
+ *
+ * @param checkpointPath Project file the journal applies to
+ * @param journalPath Journal file
+ * @return Pointer to newly created Journal (must be freed with DestroyJournal), or NULL
+ */
+Journal* CreateJournal(const char* checkpointPath, const char* journalPath);
+
+/**
+ * Destroy a journal, syncing what it has written
+ *
+ * @param journal Journal to destroy
+ * @param removeFiles Also delete the checkpoint and journal (after a clean exit)
+ */
+void DestroyJournal(Journal* journal, bool removeFiles);
+
+/**
+ * Save a checkpoint of a document and start an empty journal for it
+ * Used when a document is opened and whenever the journal is compacted
+ *
+ * @param journal Journal to reset
+ * @param stack Document to journal from now on
+ * @param openFile Project the stack was opened from (see SaveProject)
+ * @return true if journaling is on (false: the checkpoint could not be written)
+ */
+bool ResetJournal(Journal* journal, LayerStack* stack, ProjectFile** openFile);
+
+/**
+ * History callback appending the tiles of a committed, undone or redone step
+ * Register with SetHistoryApplyCallback, passing the journal as user data.
+ * A step the history could not record (NULL entry) has no tiles to append,
+ * so the journal stops appending until UpdateJournal writes a checkpoint.
+ *
+ * @param userData Journal to append to
+ * @param entry Step whose tiles changed
+ * @param isAfter Whether the canvas now holds the after snapshots
+ */
+void RecordJournalHistoryStep(void* userData, const HistoryEntry* entry, bool isAfter);
+
+/**
+ * Record layer changes, sync to disk when due and compact when due
+ * (or write the checkpoint a lost edit is waiting for)
+ * Call once per frame
+ *
+ * @param journal Journal to update
+ * @param canCompact Whether a checkpoint may be written now (e.g. not mid-stroke)
+ * @param openFile Project the stack was opened from (see SaveProject)
+ */
+void UpdateJournal(Journal* journal, bool canCompact, ProjectFile** openFile);
+
+/**
+ * Rebuild the document left behind by a session that did not exit cleanly
+ *
+ * @param checkpointPath Project file the journal applies to
+ * @param journalPath Journal file
+ * @param outFile Receives the open checkpoint (see OpenProject)
+ * @param stats Receives the timing report (may be NULL)
+ * @return Pointer to newly created LayerStack (must be freed with DestroyLayerStack), or NULL if
+ *         there is nothing to recover
+ */
+LayerStack* RecoverJournal(const char* checkpointPath, const char* journalPath, ProjectFile** outFile,
+                           JournalRecoveryStats* stats);
+
+#endif // JOURNAL_H
@@ -0,0 +1,212 @@
+/**
+ * layer.h
+ *
+ * Layer Stack for Pixel Art Tool
+ * Each layer is its own tiled canvas with a name, opacity, visibility and
+ * blend mode. The stack keeps a flattened composite canvas that is the only
+ * thing drawn on screen; a composite tile is rebuilt only when a layer
+ * changed pixels inside it, and only over the changed rectangle
+ */
+
+#ifndef LAYER_H
+#define LAYER_H
+
+#include "canvas.h"
+#include "blend.h"
+#include "history.h"
+#include "threadpool.h"
+#include <stdbool.h>
+
+#define LAYER_NAME_LENGTH 32
+
+/**
+ * One layer of the document
+ */
+typedef struct {
+    Canvas* canvas;                 // Pixels of this layer (edited by the tools)
+    char name[LAYER_NAME_LENGTH];
+    unsigned char opacity;          // 0-255, applied on top of the pixel alpha
+    bool visible;
+    PixelBlendMode blendMode;       // How the layer combines with the layers below
+} Layer;
+
+/**
+ * Composite region waiting to be rebuilt (tile-local, inclusive)
+ */
+typedef struct {
+    bool isDirty;
+    unsigned short minX;
+    unsigned short minY;
+    unsigned short maxX;
+    unsigned short maxY;
+} LayerDirtyRect;
+
+/**
+ * Layer stack structure
+ */
+typedef struct {
+    int width;                      // Document size shared by all layers
+    int height;
+
+    Layer* layers;                  // Bottom layer first
+    int count;
+    int capacity;
+    int activeIndex;                // Layer the tools paint on
+    int nextLayerNumber;            // For default layer names
+
+    // Flattened image of all visible layers
+    Canvas* composite;
+    LayerDirtyRect* dirtyRects;     // One per composite tile
+    int* dirtyTiles;                // Tiles with a pending rebuild
+    int dirtyCount;
+    int dirtyCapacity;
+
+    int lastCompositedTiles;        // Tiles rebuilt by the last UpdateLayerComposite
+    ThreadPool* pool;               // Workers for compositing (NULL = calling thread only)
+} LayerStack;
+
+/**
+ * Create a layer stack with one empty layer
+ *
+ * @param width Document width in pixels
+ * @param height Document height in pixels
+ * @return Pointer to newly created LayerStack (must be freed with DestroyLayerStack)
+ */
+LayerStack* CreateLayerStack(int width, int height);
+
+/**
+ * Destroy a layer stack, its layers and its composite
+ *
+ * @param stack LayerStack to destroy
+ */
+void DestroyLayerStack(LayerStack* stack);
+
+/**
+ * Add an empty layer above the active layer and make it active
+ *
+ * @param stack LayerStack to update
+ * @param name Layer name (NULL for "Layer N")
+ * @return Index of the new layer, or -1 on failure
+ */
+int AddLayer(LayerStack* stack, const char* name);
+
+/**
+ * Delete a layer (the last remaining layer cannot be deleted)
+ * History entries that edit the layer are dropped, since they would
+ * refer to a canvas that no longer exists
+ *
+ * @param stack LayerStack to update
+ * @param index Layer to delete
+ * @param history History to purge (may be NULL)
+ * @return true if the layer was deleted
+ */
+bool DeleteLayer(LayerStack* stack, int index, History* history);
+
+/**
+ * Move a layer to a new position in the stack
+ * The active layer stays the same layer
+ *
+ * @param stack LayerStack to update
+ * @param index Layer to move
+ * @param newIndex Position to move it to (0 = bottom)
+ * @return true if the layer moved
+ */
+bool MoveLayer(LayerStack* stack, int index, int newIndex);
+
+/**
+ * Make a layer the one the tools paint on
+ *
+ * @param stack LayerStack to update
+ * @param index Layer to select (clamped to the valid range)
+ */
+void SelectLayer(LayerStack* stack, int index);
+
+/**
+ * Get the active layer
+ *
+ * @param stack LayerStack to query
+ * @return Active layer, or NULL if the stack is NULL
+ */
+Layer* GetActiveLayer(LayerStack* stack);
+
+/**
+ * Get the canvas of the active layer
+ *
+ * @param stack LayerStack to query
+ * @return Canvas the tools should paint on, or NULL
+ */
+Canvas* GetActiveLayerCanvas(LayerStack* stack);
+
+/**
+ * Show or hide a layer
+ *
+ * @param stack LayerStack to update
+ * @param index Layer to change
+ * @param visible Whether the layer is part of the composite
+ */
+void SetLayerVisible(LayerStack* stack, int index, bool visible);
+
+/**
+ * Set the opacity of a layer
+ *
+ * @param stack LayerStack to update
+ * @param index Layer to change
+ * @param opacity Opacity (0-255)
+ */
+void SetLayerOpacity(LayerStack* stack, int index, unsigned char opacity);
+
+/**
+ * Set how a layer combines with the layers below it
+ *
+ * @param stack LayerStack to update
+ * @param index Layer to change
+ * @param mode Blend mode (PIXEL_BLEND_REPLACE is treated as normal)
+ */
+void SetLayerBlendMode(LayerStack* stack, int index, PixelBlendMode mode);
+
+/**
+ * Drop the whole composite and compose each tile when it is first accessed
+ * Used after opening a document, so only the tiles that are shown get
+ * composed (and only their layer tiles get loaded)
+ *
+ * @param stack LayerStack to update
+ */
+void DeferLayerComposite(LayerStack* stack);
+
+/**
+ * Mark the whole composite for rebuilding
+ *
+ * @param stack LayerStack to update
+ */
+void InvalidateLayerComposite(LayerStack* stack);
+
+/**
+ * Bring the composite up to date
+ * Collects the tiles each layer modified since the last call and
+ * recomposites only those regions, split into row bands across the thread
+ * pool if one is set; the composite canvas then queues its own texture
+ * uploads as usual
+ *
+ * @param stack LayerStack to update
+ * @return Number of composite tiles rebuilt
+ */
+int UpdateLayerComposite(LayerStack* stack);
+
+/**
+ * Use a thread pool for compositing
+ * The result is identical to compositing on one thread
+ *
+ * @param stack LayerStack to update
+ * @param pool Pool to run on (NULL to composite on the calling thread)
+ */
+void SetLayerStackThreadPool(LayerStack* stack, ThreadPool* pool);
+
+/**
+ * Get the flattened image of all visible layers
+ *
+ * @param stack LayerStack to query
+ * @return Composite canvas (call UpdateLayerComposite first to refresh it)
+ */
+Canvas* GetLayerComposite(LayerStack* stack);
+
+#endif // LAYER_H
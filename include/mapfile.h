@@ -0,0 +1,61 @@
+/**
+ * mapfile.h
+ *
+ * File Mapping and Syncing for Pixel Art Tool
+ * Maps a whole file into memory so it can be read in place; pages are only
+ * read from disk when first touched. Wraps CreateFileMapping on Windows and
+ * mmap elsewhere, along with the matching call to force written data out
+ * to the disk.
+ */
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct MappedFile MappedFile;
+
+/**
+ * Map a file into memory for reading
+ *
+ * @param path File to map (must not be empty)
+ * @return Pointer to newly created MappedFile (must be freed with CloseMappedFile), or NULL
+ */
+MappedFile* OpenMappedFile(const char* path);
+
+/**
+ * Get the mapped contents of a file
+ *
+ * @param file MappedFile to read
+ * @return First byte of the file (valid until CloseMappedFile)
+ */
+const unsigned char* GetMappedFileData(const MappedFile* file);
+
+/**
+ * Get the size of a mapped file
+ *
+ * @param file MappedFile to query
+ * @return Size in bytes
+ */
+size_t GetMappedFileSize(const MappedFile* file);
+
+/**
+ * Unmap a file and free the MappedFile
+ *
+ * @param file MappedFile to close (may be NULL)
+ */
+void CloseMappedFile(MappedFile* file);
+
+/**
+ * Flush a file's buffers and wait until its data is on the disk
+ * Data that only reached the operating system survives the program
+ * crashing, but not a power failure
+ *
+ * @param file File open for writing
+ * @return true if the data was written out
+ */
+bool FlushFileToDisk(FILE* file);
+
+#endif // MAPFILE_H
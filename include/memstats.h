@@ -0,0 +1,36 @@
+/**
+ * memstats.h
+ *
+ * Process Memory Statistics for Pixel Art Tool
+ * Resident memory of the whole process as the operating system sees it,
+ * for stress runs and headless reports. Works without a window.
+ */
+
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Get the peak resident memory of the process
+ *
+ * @return Bytes at the high-water mark, or 0 if the system does not report it
+ */
+size_t GetPeakResidentBytes(void);
+
+/**
+ * Get the current resident memory of the process
+ *
+ * @return Bytes resident now, or 0 if the system does not report it
+ */
+size_t GetCurrentResidentBytes(void);
+
+/**
+ * Restart the peak from the current resident memory (Linux only)
+ *
+ * @return false if the peak cannot be reset and keeps growing for the process lifetime
+ */
+bool ResetPeakResidentBytes(void);
+
+#endif // MEMSTATS_H
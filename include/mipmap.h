@@ -0,0 +1,117 @@
+/**
+ * mipmap.h
+ *
+ * Canvas Mip Pyramid for Pixel Art Tool
+ * Downsampled copies of a canvas for drawing it zoomed out. Level n halves
+ * level n - 1 in each direction (2x2 box filter on premultiplied alpha) and
+ * is itself a tiled Canvas, so it shares the tile textures and drawing of
+ * the full-size canvas. Levels are added until one fits in a single tile.
+ *
+ * The pyramid is created the first time a canvas is drawn at half size or
+ * less. From then on the changed rectangle of every canvas tile is
+ * recorded, and only the footprint of those rectangles on each level is
+ * re-downsampled, the next time a level is drawn. Drawing picks the level whose
+ * pixels are between half and one screen pixel, so the number of tiles
+ * drawn stays bounded however far the view zooms out.
+ */
+
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include "canvas.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CANVAS_MIP_MAX_LEVELS 9     // CANVAS_MAX_SIZE halved down to one tile
+
+/**
+ * Changed part of a canvas tile (tile-local, inclusive)
+ */
+typedef struct {
+    unsigned short minX;
+    unsigned short minY;
+    unsigned short maxX;
+    unsigned short maxY;
+} CanvasMipmapRect;
+
+/**
+ * Mip pyramid of one canvas
+ */
+typedef struct CanvasMipmap {
+    int levelCount;
+    Canvas* levels[CANVAS_MIP_MAX_LEVELS];  // levels[n - 1] is level n (1/2^n size)
+
+    // Canvas tiles changed since the levels were last updated
+    int tileCount;                          // Tiles of the full-size canvas
+    unsigned char* isTileDirty;             // One flag per canvas tile
+    CanvasMipmapRect* dirtyRects;           // One rectangle per canvas tile, valid while flagged
+    int* dirtyTiles;
+    int dirtyCount;
+} CanvasMipmap;
+
+/**
+ * Create the mip pyramid of a canvas, with every level waiting for an update
+ *
+ * @param canvas Full-size canvas (the pyramid does not keep a pointer to it)
+ * @return Pointer to newly created CanvasMipmap (must be freed with DestroyCanvasMipmap), or NULL
+ *         if the canvas fits in one tile and needs no levels
+ */
+CanvasMipmap* CreateCanvasMipmap(Canvas* canvas);
+
+/**
+ * Destroy a mip pyramid and its level textures
+ *
+ * @param mipmap Pyramid to destroy
+ */
+void DestroyCanvasMipmap(CanvasMipmap* mipmap);
+
+/**
+ * Record a changed rectangle of a canvas tile
+ *
+ * @param mipmap Pyramid of the canvas
+ * @param tileIndex Changed tile
+ * @param minX Left edge, tile-local
+ * @param minY Top edge, tile-local
+ * @param maxX Right edge, tile-local and inclusive
+ * @param maxY Bottom edge, tile-local and inclusive
+ */
+void MarkCanvasMipmapTile(CanvasMipmap* mipmap, int tileIndex, int minX, int minY, int maxX, int maxY);
+
+/**
+ * Reset every level to a single color, as ClearCanvas does to the canvas
+ *
+ * @param mipmap Pyramid to clear
+ * @param color New empty color of the levels
+ */
+void ClearCanvasMipmap(CanvasMipmap* mipmap, Color color);
+
+/**
+ * Re-downsample the recorded rectangles into every level
+ *
+ * @param mipmap Pyramid to update
+ * @param canvas Full-size canvas the pyramid was created for
+ * @return Number of canvas tiles whose changes were processed
+ */
+int UpdateCanvasMipmap(CanvasMipmap* mipmap, Canvas* canvas);
+
+/**
+ * Get the bytes used by the levels and the dirty flags
+ *
+ * @param mipmap Pyramid to measure (NULL counts as 0)
+ * @return Bytes of pixel storage and bookkeeping
+ */
+size_t GetCanvasMipmapMemoryUsage(const CanvasMipmap* mipmap);
+
+/**
+ * Pick the canvas to draw for a zoom: the canvas itself, or the pyramid
+ * level whose pixels cover between half and one screen pixel
+ * Creates and updates the pyramid as needed.
+ *
+ * @param canvas Full-size canvas
+ * @param scale Screen pixels per canvas pixel (pixelSize * zoom)
+ * @param level Receives the level picked (0 for the canvas itself); draw it at scale * 2^level
+ * @return Canvas to draw
+ */
+Canvas* GetCanvasDrawLevel(Canvas* canvas, float scale, int* level);
+
+#endif // MIPMAP_H
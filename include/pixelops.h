@@ -0,0 +1,104 @@
+/**
+ * pixelops.h
+ *
+ * Bulk Pixel Kernels for Pixel Art Tool
+ * Fill, replace and masked-fill loops over runs of pixels, treating each
+ * Color as one packed 32-bit value. SSE2 and AVX2 versions are chosen at
+ * runtime from what the CPU supports, with a portable scalar fallback.
+ */
+
+#ifndef PIXELOPS_H
+#define PIXELOPS_H
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Kernel implementations
+ */
+typedef enum {
+    PIXELOPS_SCALAR,    // Portable C, one pixel at a time
+    PIXELOPS_SSE2,      // 4 pixels per step
+    PIXELOPS_AVX2       // 8 pixels per step
+} PixelOpsBackend;
+
+/**
+ * Get the kernel implementation currently in use
+ * The first call selects the best backend the CPU supports
+ *
+ * @return Active backend
+ */
+PixelOpsBackend GetPixelOpsBackend(void);
+
+/**
+ * Force a kernel implementation (e.g. to compare backends in benchmarks)
+ *
+ * @param backend Backend to use
+ * @return false if the CPU or the build does not support it (nothing changes)
+ */
+bool SetPixelOpsBackend(PixelOpsBackend backend);
+
+/**
+ * Get the name of a backend as a string
+ *
+ * @param backend Backend to name
+ * @return Name string (e.g., "SSE2")
+ */
+const char* GetPixelOpsBackendName(PixelOpsBackend backend);
+
+/**
+ * Set every pixel of a run to one color
+ *
+ * @param pixels Pixels to write
+ * @param count Number of pixels
+ * @param color Color to write
+ */
+void FillPixels(Color* pixels, size_t count, Color color);
+
+/**
+ * Replace every pixel exactly equal to one color with another
+ *
+ * @param pixels Pixels to update
+ * @param count Number of pixels
+ * @param from Color to look for
+ * @param to Replacement color
+ * @return Number of pixels replaced
+ */
+size_t ReplacePixels(Color* pixels, size_t count, Color from, Color to);
+
+/**
+ * Replace every pixel whose channels (including alpha) are all within
+ * tolerance of one color
+ *
+ * @param pixels Pixels to update
+ * @param count Number of pixels
+ * @param from Color to look for
+ * @param to Replacement color
+ * @param tolerance Largest allowed per-channel difference (0 = exact)
+ * @return Number of pixels replaced
+ */
+size_t ReplacePixelsTolerance(Color* pixels, size_t count, Color from, Color to, unsigned char tolerance);
+
+/**
+ * Count the pixels whose channels are all within tolerance of one color
+ *
+ * @param pixels Pixels to scan
+ * @param count Number of pixels
+ * @param color Color to look for
+ * @param tolerance Largest allowed per-channel difference (0 = exact)
+ * @return Number of matching pixels
+ */
+size_t CountMatchingPixels(const Color* pixels, size_t count, Color color, unsigned char tolerance);
+
+/**
+ * Set the pixels whose mask byte is non-zero to one color
+ *
+ * @param pixels Pixels to update
+ * @param mask One byte per pixel
+ * @param count Number of pixels
+ * @param color Color to write
+ */
+void MaskedFillPixels(Color* pixels, const unsigned char* mask, size_t count, Color color);
+
+#endif // PIXELOPS_H
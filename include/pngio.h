@@ -0,0 +1,86 @@
+/**
+ * pngio.h
+ *
+ * Streaming PNG Files for Pixel Art Tool
+ * Reads and writes PNGs one row at a time with a built-in inflater and
+ * deflate encoder, so large images pass through a fixed amount of memory
+ * (one row plus the 32 KB compression window) and the caller can place
+ * rows straight into their final storage, report progress and cancel
+ * between rows. Has no raylib state and is safe to use on a background
+ * thread.
+ */
+
+#ifndef PNGIO_H
+#define PNGIO_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+typedef struct PngReader PngReader;
+typedef struct PngWriter PngWriter;
+
+/**
+ * Open a PNG file and read everything up to the image data
+ * Accepts every non-interlaced PNG (any bit depth and color type,
+ * including palettes and tRNS transparency); interlaced images return
+ * NULL and need a whole-image decoder
+ *
+ * @param path File to read
+ * @param width Receives the image width in pixels
+ * @param height Receives the image height in pixels
+ * @return Reader producing height rows (must be freed with DestroyPngReader), or NULL
+ */
+PngReader* CreatePngReader(const char* path, int* width, int* height);
+
+/**
+ * Decode the next row of the image, top row first, as 8-bit RGBA
+ *
+ * @param reader PngReader to read from
+ * @param pixels Receives width pixels
+ * @return false if the data is corrupt or truncated
+ */
+bool ReadPngRow(PngReader* reader, Color* pixels);
+
+/**
+ * Close and free a reader
+ *
+ * @param reader PngReader to destroy
+ */
+void DestroyPngReader(PngReader* reader);
+
+/**
+ * Create a PNG file and write its header
+ *
+ * @param path File to create (overwritten if it exists)
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @return Writer expecting height rows (must be freed with FinishPngWriter or DestroyPngWriter), or NULL
+ */
+PngWriter* CreatePngWriter(const char* path, int width, int height);
+
+/**
+ * Encode the next row of the image, top row first
+ *
+ * @param writer PngWriter to append to
+ * @param pixels width pixels of the row
+ * @return false if the row could not be written
+ */
+bool WritePngRow(PngWriter* writer, const Color* pixels);
+
+/**
+ * Complete the file once every row was written, close it and free the writer
+ *
+ * @param writer PngWriter to finish
+ * @return true if the whole file was written successfully
+ */
+bool FinishPngWriter(PngWriter* writer);
+
+/**
+ * Close and free a writer without completing the file (e.g. on cancel)
+ * The partial file is left on disk for the caller to remove
+ *
+ * @param writer PngWriter to destroy
+ */
+void DestroyPngWriter(PngWriter* writer);
+
+#endif // PNGIO_H
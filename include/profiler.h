@@ -0,0 +1,200 @@
+/**
+ * profiler.h
+ *
+ * Frame Phase Profiler for Pixel Art Tool
+ * Times each phase of a main loop iteration (input, color picker, camera,
+ * tools, autosave, compositing, canvas and UI drawing) and records one
+ * ProfileFrame per iteration in a fixed ring buffer. The main loop is the
+ * only writer and publishes each finished frame with one atomic store, so
+ * readers never take a lock and never stall the frame being recorded.
+ * Summaries give p50/p95/p99 per phase over the recent rendered frames;
+ * the ring can be written out as CSV for offline analysis.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+#define PROFILER_FRAME_CAPACITY 1024    // Frames kept in the ring (power of two)
+#define PROFILER_SUMMARY_FRAMES 240     // Rendered frames summarized by the overlay (4 s at 60 FPS)
+#define PROFILER_OVERLAY_REFRESH 0.25   // Seconds between overlay summary updates
+
+/**
+ * Timed parts of a main loop iteration
+ */
+typedef enum {
+    PROFILE_INPUT = 0,      // Shortcuts, undo/redo, layer commands, file drop, save
+    PROFILE_COLOR_PICKER,   // Updating and drawing the color picker
+    PROFILE_CAMERA,         // UpdateCanvasCamera
+    PROFILE_TOOLS,          // UpdateToolState (painting)
+    PROFILE_AUTOSAVE,       // UpdateJournal
+    PROFILE_COMPOSITE,      // Layer compositing and export progress
+    PROFILE_DRAW_CANVAS,    // DrawCanvas, texture uploads included
+    PROFILE_DRAW_UI,        // Text, swatches and panels
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+/**
+ * One recorded main loop iteration
+ */
+typedef struct {
+    unsigned long long index;               // Frames recorded before this one
+    double startTime;                       // Seconds, GetMonotonicTime
+    float phaseMs[PROFILE_PHASE_COUNT];     // Time spent in each phase
+    float frameMs;                          // Whole iteration, event waits excluded
+    bool rendered;                          // Whether the view was re-rendered
+    int canvasDrawCalls;
+    int pickerDrawCalls;
+    int textureUploads;
+} ProfileFrame;
+
+/**
+ * Percentiles of one timing in milliseconds
+ */
+typedef struct {
+    float p50;
+    float p95;
+    float p99;
+    float max;
+} ProfilePercentiles;
+
+/**
+ * Statistics over the recent rendered frames
+ */
+typedef struct {
+    int frameCount;                                 // Frames summarized
+    ProfilePercentiles phases[PROFILE_PHASE_COUNT];
+    ProfilePercentiles frame;
+    float averageCanvasDrawCalls;
+    float averagePickerDrawCalls;
+    float averageTextureUploads;
+    int maxDrawCalls;                               // Canvas and picker together
+} ProfileSummary;
+
+/**
+ * Profiler structure
+ */
+typedef struct {
+    ProfileFrame* frames;                   // PROFILER_FRAME_CAPACITY entries
+    unsigned long long publishedCount;      // Frames published (atomic)
+    ProfileFrame current;                   // Frame being recorded
+    double phaseStart[PROFILE_PHASE_COUNT]; // Start of each open phase, 0 while closed
+
+    bool overlayVisible;
+    ProfileSummary overlaySummary;          // Refreshed every PROFILER_OVERLAY_REFRESH
+    double overlayUpdateTime;
+} Profiler;
+
+/**
+ * Create a profiler
+ *
+ * @return Pointer to newly created Profiler (must be freed with DestroyProfiler), or NULL
+ */
+Profiler* CreateProfiler(void);
+
+/**
+ * Destroy a profiler
+ *
+ * @param profiler Profiler to destroy
+ */
+void DestroyProfiler(Profiler* profiler);
+
+/**
+ * Start recording a main loop iteration
+ *
+ * @param profiler Profiler to record into (NULL: do nothing, as for all functions below)
+ */
+void BeginProfileFrame(Profiler* profiler);
+
+/**
+ * Start timing a phase; a phase entered several times in one frame adds up
+ *
+ * @param profiler Profiler to record into
+ * @param phase Phase starting now
+ */
+void BeginProfilePhase(Profiler* profiler, ProfilePhase phase);
+
+/**
+ * Stop timing a phase
+ *
+ * @param profiler Profiler to record into
+ * @param phase Phase ending now
+ */
+void EndProfilePhase(Profiler* profiler, ProfilePhase phase);
+
+/**
+ * Record the drawing work of the current frame
+ *
+ * @param profiler Profiler to record into
+ * @param canvasDrawCalls Quads drawn by DrawCanvas
+ * @param pickerDrawCalls Draw calls of the color picker
+ * @param textureUploads Tile textures created or updated
+ */
+void SetProfileDrawCounts(Profiler* profiler, int canvasDrawCalls, int pickerDrawCalls, int textureUploads);
+
+/**
+ * Finish the current frame and publish it to the ring buffer
+ *
+ * @param profiler Profiler to record into
+ * @param rendered Whether the view was re-rendered this iteration
+ */
+void EndProfileFrame(Profiler* profiler, bool rendered);
+
+/**
+ * Copy the most recent published frames, oldest first
+ * Safe on any thread while the main loop keeps recording
+ *
+ * @param profiler Profiler to read
+ * @param frames Receives up to maxFrames frames
+ * @param maxFrames Capacity of frames
+ * @return Number of frames copied
+ */
+int ReadProfileFrames(const Profiler* profiler, ProfileFrame* frames, int maxFrames);
+
+/**
+ * Compute percentiles over the most recent rendered frames
+ *
+ * @param profiler Profiler to read
+ * @param frameCount Number of recent rendered frames to include
+ * @return Summary of those frames (frameCount 0 if there are none)
+ */
+ProfileSummary GetProfileSummary(const Profiler* profiler, int frameCount);
+
+/**
+ * Nearest-rank percentiles of a list of timings
+ *
+ * @param values Timings in milliseconds (sorted in place)
+ * @param count Number of timings
+ * @return Percentiles (all 0 if count is 0)
+ */
+ProfilePercentiles GetProfilePercentiles(float* values, int count);
+
+/**
+ * Write the most recent frames as CSV, one row per frame
+ *
+ * @param profiler Profiler to read
+ * @param path Output file
+ * @param frameCount Number of recent frames to write
+ * @return Number of frames written, or -1 if the file could not be written
+ */
+int WriteProfileCsv(const Profiler* profiler, const char* path, int frameCount);
+
+/**
+ * Get the display name of a phase
+ *
+ * @param phase Phase to name
+ * @return Static string
+ */
+const char* GetProfilePhaseName(ProfilePhase phase);
+
+/**
+ * Draw the percentile table if the overlay is visible
+ *
+ * @param profiler Profiler to show
+ * @param x Left edge in screen pixels
+ * @param y Top edge in screen pixels
+ */
+void DrawProfilerOverlay(Profiler* profiler, int x, int y);
+
+#endif // PROFILER_H
@@ -0,0 +1,87 @@
+/**
+ * project.h
+ *
+ * Native Project Files for Pixel Art Tool
+ * Saves the whole layer stack (names, opacity, visibility, blend modes and
+ * pixels) to a chunked file where every non-empty tile of every layer is
+ * its own run-length compressed block, and a small index chunk at the end
+ * lists where each block lives.
+ *
+ * Opening a project maps the file and reads only the index: every stored
+ * tile starts out pending and is decompressed the first time something
+ * reads or paints it (usually because it scrolls into view), so opening
+ * takes about the same time whatever the document size. Saving copies the
+ * still-compressed blocks of tiles that were never loaded straight across.
+ *
+ * Layout (little-endian):
+ *   header  "PXPJ", u32 version, u64 index offset, u32 index size,
+ *           u32 index CRC-32, 8 reserved bytes
+ *   chunks  4-byte type, u32 payload size, payload
+ *           "TILE" one tile's CANVAS_TILE_PIXELS pixels, CompressPixelsRLE
+ *           "INDX" document size, tile size, layer count, active layer, then
+ *                  per layer its settings and one record per tile
+ *                  (u64 payload offset, u32 size (0 = empty), u32 encoding)
+ */
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "layer.h"
+#include <stdbool.h>
+
+#define PROJECT_FILE_EXTENSION ".pxp"
+
+typedef struct ProjectFile ProjectFile;
+
+/**
+ * Open a project file as a document whose tiles load on first access
+ *
+ * @param path Project file
+ * @param outFile Receives the open file backing the pending tiles (must be
+ *                closed with CloseProject after the returned stack is destroyed)
+ * @return Pointer to newly created LayerStack (must be freed with DestroyLayerStack), or NULL
+ */
+LayerStack* OpenProject(const char* path, ProjectFile** outFile);
+
+/**
+ * Save a document as a project file
+ * Writes a temporary file first and replaces path with it once complete.
+ * If path is the file backing openFile and the system will not replace a
+ * mapped file, every pending tile is loaded, the file is closed and
+ * *openFile set to NULL before trying again
+ *
+ * @param stack LayerStack to save
+ * @param path Destination file
+ * @param openFile Project the stack was opened from (may be NULL or point to NULL)
+ * @return true if the file was written
+ */
+bool SaveProject(LayerStack* stack, const char* path, ProjectFile** openFile);
+
+/**
+ * Read the index checksum from a project file's header
+ * Identifies one particular save of a project without opening it
+ *
+ * @param path Project file
+ * @param checksum Receives the CRC-32 of the file's index
+ * @return true if the file has a project header
+ */
+bool ReadProjectChecksum(const char* path, unsigned int* checksum);
+
+/**
+ * Get the number of stored tiles decompressed so far
+ *
+ * @param file Open project
+ * @return Tiles loaded since OpenProject
+ */
+size_t GetProjectTilesLoaded(const ProjectFile* file);
+
+/**
+ * Unmap a project file
+ * The layer stack opened from it must already be destroyed, or fully
+ * loaded with its layers' tile loaders removed
+ *
+ * @param file ProjectFile to close (may be NULL)
+ */
+void CloseProject(ProjectFile* file);
+
+#endif // PROJECT_H
@@ -0,0 +1,60 @@
+/**
+ * raster.h
+ *
+ * Line Rasterizer for Pixel Art Tool
+ * Rasterizes line segments into horizontal or vertical runs ("spans") after
+ * clipping them to a rectangle, so callers can write whole runs at once
+ * instead of stepping and bounds-checking one pixel at a time
+ */
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdbool.h>
+
+/**
+ * A run of pixels produced by the rasterizer
+ * Horizontal spans cover (x .. x + length - 1, y),
+ * vertical spans cover (x, y .. y + length - 1)
+ */
+typedef struct {
+    int x;
+    int y;
+    int length;
+    bool vertical;
+    signed char step;   // +1 if the line walks the span in increasing order, -1 otherwise
+                        // (a byte keeps the span at 16 bytes, passed in registers)
+} RasterSpan;
+
+/**
+ * Callback receiving each span of a rasterized line, in stepping order
+ */
+typedef void (*RasterSpanCallback)(void* userData, RasterSpan span);
+
+/**
+ * Rasterize a line segment (both endpoints included) clipped to a rectangle
+ *
+ * Lines that are mostly horizontal are emitted as horizontal spans, mostly
+ * vertical lines as vertical spans. Only the part of the segment inside the
+ * clip rectangle is visited; the off-rectangle part costs O(1).
+ *
+ * Pixel positions are exact Bresenham midpoint positions of the unclipped
+ * line, so clipping never shifts the visible part.
+ *
+ * @param x0 Start X
+ * @param y0 Start Y
+ * @param x1 End X
+ * @param y1 End Y
+ * @param clipMinX Clip rectangle left (inclusive)
+ * @param clipMinY Clip rectangle top (inclusive)
+ * @param clipMaxX Clip rectangle right (inclusive)
+ * @param clipMaxY Clip rectangle bottom (inclusive)
+ * @param callback Function called for each span
+ * @param userData Passed through to callback
+ * @return Number of spans emitted
+ */
+int RasterizeLine(int x0, int y0, int x1, int y1,
+                  int clipMinX, int clipMinY, int clipMaxX, int clipMaxY,
+                  RasterSpanCallback callback, void* userData);
+
+#endif // RASTER_H
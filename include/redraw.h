@@ -0,0 +1,74 @@
+/**
+ * redraw.h
+ *
+ * View Invalidation System for Pixel Art Tool
+ * Tracks whether anything visible changed so the main loop can skip
+ * re-rendering identical frames and sleep until the next input event
+ */
+
+#ifndef REDRAW_H
+#define REDRAW_H
+
+#include <stdbool.h>
+
+// Target share of one core the main loop may use while the app is idle
+#define IDLE_CPU_TARGET_PERCENT 1.0f
+
+/**
+ * Reasons a redraw can be requested (combined as a bitmask)
+ */
+typedef enum {
+    REDRAW_CANVAS = 1 << 0,  // Canvas pixels changed
+    REDRAW_CAMERA = 1 << 1,  // View was panned, zoomed or reset
+    REDRAW_TOOL   = 1 << 2,  // Tool selection or tool colors changed
+    REDRAW_UI     = 1 << 3,  // UI widget state changed
+    REDRAW_WINDOW = 1 << 4   // Window was resized, restored or refocused
+} RedrawReason;
+
+/**
+ * RedrawStats structure
+ * Counters describing how much work the main loop has been doing
+ */
+typedef struct {
+    unsigned long framesRendered;  // Loop iterations that re-rendered the view
+    unsigned long framesSkipped;   // Loop iterations that found nothing to draw
+    float busyPercent;             // Share of wall time spent outside event waits (last second)
+} RedrawStats;
+
+/**
+ * Mark the view as needing a redraw
+ *
+ * @param reason Why the view changed
+ */
+void RequestRedraw(RedrawReason reason);
+
+/**
+ * Check whether a redraw has been requested since the last frame
+ *
+ * @return true if the view must be re-rendered
+ */
+bool IsRedrawPending(void);
+
+/**
+ * Clear pending redraw requests once a frame has been rendered
+ *
+ * @return Bitmask of the RedrawReason values that were pending
+ */
+unsigned int ConsumeRedrawRequests(void);
+
+/**
+ * Record one main loop iteration for the busy/idle statistics
+ *
+ * @param rendered Whether this iteration re-rendered the view
+ * @param busySeconds Time spent in update/render work (excluding event waits)
+ */
+void RecordLoopIteration(bool rendered, double busySeconds);
+
+/**
+ * Get the current render loop statistics
+ *
+ * @return Copy of the statistics
+ */
+RedrawStats GetRedrawStats(void);
+
+#endif // REDRAW_H
@@ -0,0 +1,100 @@
+/**
+ * replay.h
+ *
+ * Headless Input Replay for Pixel Art Tool
+ * Plays an input log recorded with --record back through the color picker,
+ * history, camera, tool and layer code at full speed without a window, then
+ * compares the document checksum with the one recorded at the end of the
+ * session. Texture uploads and drawing are not part of a replay; the final
+ * view can be saved as a PNG with the software renderer. Started with
+ * `--replay [--threads N] [--snapshot <png>] <log>`.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "layer.h"
+#include "threadpool.h"
+#include <stdbool.h>
+
+/**
+ * What a replayed step did, for per-operation costs
+ */
+typedef enum {
+    REPLAY_STROKE_START = 0,    // Pencil or eraser pressed: first brush stamp
+    REPLAY_STROKE_DRAG,         // Frame of a stroke in progress
+    REPLAY_STROKE_END,          // Stroke finished: history step recorded
+    REPLAY_FILL,                // Flood fill click
+    REPLAY_EYEDROPPER,          // Color sample click
+    REPLAY_CAMERA,              // Pan, zoom or reset
+    REPLAY_UNDO_REDO,
+    REPLAY_LAYER,               // Layer command
+    REPLAY_COLOR_PICKER,        // Picker opened, closed or dragged
+    REPLAY_COMPOSITE,           // Composite tiles rebuilt
+    REPLAY_IDLE,                // Steps that changed nothing
+    REPLAY_OP_COUNT
+} ReplayOp;
+
+/**
+ * Cost of one kind of operation
+ */
+typedef struct {
+    int count;
+    double seconds;
+    double maxSeconds;
+} ReplayOpStats;
+
+/**
+ * Result of a replay
+ */
+typedef struct {
+    int frames;
+    double seconds;                         // Replaying the frames, document load excluded
+    double loadSeconds;                     // Opening the starting document
+    ReplayOpStats ops[REPLAY_OP_COUNT];
+    int width;                              // Document size
+    int height;
+    int layerCount;                         // Layers after the last frame
+    unsigned int checksum;                  // GetLayerStackChecksum after the last frame
+    bool hasExpectedChecksum;               // Whether the log has its end record
+    unsigned int expectedChecksum;          // Checksum recorded at the end of the session
+    bool hasSnapshot;                       // Whether the snapshot PNG was written
+} ReplayStats;
+
+/**
+ * Checksum of a document's layers: pixels, opacity, visibility and blend mode
+ *
+ * @param stack LayerStack to checksum
+ * @return CRC-32 of the document (0 for NULL)
+ */
+unsigned int GetLayerStackChecksum(LayerStack* stack);
+
+/**
+ * Replay an input log against the document it was recorded on
+ *
+ * @param path Input log
+ * @param pool Threads for compositing (NULL for the calling thread only)
+ * @param snapshotPath PNG to render the view after the last frame to (NULL for none)
+ * @param stats Receives timings and checksums
+ * @return false if the log or its starting document could not be opened
+ */
+bool ReplayInputLog(const char* path, ThreadPool* pool, const char* snapshotPath, ReplayStats* stats);
+
+/**
+ * Get the display name of an operation
+ *
+ * @param op Operation to name
+ * @return Static string
+ */
+const char* GetReplayOpName(ReplayOp op);
+
+/**
+ * Command line entry point of replay mode: parse arguments, run and report
+ *
+ * @param argc Number of arguments after --replay
+ * @param argv Arguments after --replay: [--threads N] [--snapshot <png>] <log>
+ * @return Process exit code (0 when the final checksum matches)
+ */
+int RunReplayCommand(int argc, char** argv);
+
+#endif // REPLAY_H
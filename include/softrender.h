@@ -0,0 +1,92 @@
+/**
+ * softrender.h
+ *
+ * Software Renderer for Pixel Art Tool
+ * Renders the canvas view (checkerboard, canvas pixels and border) into a
+ * plain RGBA framebuffer on the CPU, matching what DrawCanvas shows for
+ * the same camera: nearest-neighbour scaling, one screen pixel sampling the
+ * canvas pixel under its center, canvas alpha blended over the checkerboard.
+ * Row bands render in parallel on the thread pool. Needs no window or GPU,
+ * for thumbnails, previews, visual regression images and headless
+ * benchmarks.
+ */
+
+#ifndef SOFTRENDER_H
+#define SOFTRENDER_H
+
+#include "canvas.h"
+#include "threadpool.h"
+#include <stdbool.h>
+
+#define SOFTWARE_RENDER_BAND_ROWS 16    // Screen rows per parallel work item
+
+/**
+ * CPU framebuffer
+ */
+typedef struct {
+    int width;
+    int height;
+    Color* pixels;          // width * height, top row first
+} SoftwareFramebuffer;
+
+/**
+ * Create a framebuffer
+ *
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @return Pointer to newly created SoftwareFramebuffer (must be freed with DestroySoftwareFramebuffer), or NULL
+ */
+SoftwareFramebuffer* CreateSoftwareFramebuffer(int width, int height);
+
+/**
+ * Destroy a framebuffer
+ *
+ * @param framebuffer SoftwareFramebuffer to destroy
+ */
+void DestroySoftwareFramebuffer(SoftwareFramebuffer* framebuffer);
+
+/**
+ * Fill the whole framebuffer with one color (ClearBackground)
+ *
+ * @param framebuffer Framebuffer to clear
+ * @param color Background color
+ */
+void ClearSoftwareFramebuffer(SoftwareFramebuffer* framebuffer, Color color);
+
+/**
+ * Render a canvas over its checkerboard, as DrawCanvas does
+ * Pending tiles on screen are loaded first, on the calling thread; at half
+ * size or less the matching mip level is rendered (see mipmap.h)
+ *
+ * @param framebuffer Framebuffer to draw into (its size is the screen size)
+ * @param canvas Canvas to render
+ * @param offset Screen position of the canvas top-left corner
+ * @param zoom Camera zoom
+ * @param pixelSize Base pixel size before zoom
+ * @param pool Threads to render row bands on (NULL for the calling thread only)
+ */
+void RenderSoftwareCanvas(SoftwareFramebuffer* framebuffer, Canvas* canvas, Vector2 offset, float zoom,
+                          int pixelSize, ThreadPool* pool);
+
+/**
+ * Draw a one pixel rectangle outline, as DrawRectangleLines does
+ *
+ * @param framebuffer Framebuffer to draw into
+ * @param x Left edge
+ * @param y Top edge
+ * @param width Outline width
+ * @param height Outline height
+ * @param color Opaque outline color
+ */
+void DrawSoftwareRectangleLines(SoftwareFramebuffer* framebuffer, int x, int y, int width, int height, Color color);
+
+/**
+ * Save a framebuffer as a PNG file
+ *
+ * @param framebuffer Framebuffer to save
+ * @param path Output file
+ * @return true if the file was written
+ */
+bool WriteSoftwareFramebufferPng(const SoftwareFramebuffer* framebuffer, const char* path);
+
+#endif // SOFTRENDER_H
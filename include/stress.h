@@ -0,0 +1,81 @@
+/**
+ * stress.h
+ *
+ * Canvas Size Stress Runs for Pixel Art Tool
+ * Drives a synthetic editing session (strokes, outlined fills, zoom and pan
+ * sweeps) through the real camera, tool and compositing code at a series of
+ * canvas sizes and reports, per size, the p50/p99 cost of the update and
+ * draw paths, peak resident memory and tile allocations. The view is drawn
+ * with the software renderer, or with DrawCanvas in a hidden window. The session is
+ * generated as input frames from a fixed seed, so every size and every run
+ * sees the same sequence of actions. Started with
+ * `--stress [--sizes 64,256,...] [--frames N] [--threads N] [--window] [--csv <path>]`.
+ */
+
+#ifndef STRESS_H
+#define STRESS_H
+
+#include "profiler.h"
+#include "threadpool.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STRESS_MAX_SIZES 16
+#define STRESS_DEFAULT_FRAMES 600
+#define STRESS_SCREEN_WIDTH 1024    // Screen the synthetic session is played on
+#define STRESS_SCREEN_HEIGHT 768
+
+/**
+ * Result of one canvas size
+ */
+typedef struct {
+    int size;                       // Canvas width and height
+    int frames;
+    double createSeconds;           // CreateLayerStack and the first composite
+    ProfilePercentiles update;      // Input, camera, tools and compositing per frame
+    ProfilePercentiles draw;        // Drawing the canvas view per frame
+    ProfilePercentiles tools;
+    ProfilePercentiles composite;
+    bool drewInWindow;              // DrawCanvas on the GPU rather than the software renderer
+    size_t peakResidentBytes;       // Process high-water mark during this size (0 if unknown)
+    bool isPeakSinceStart;          // Peak could not be reset: it covers every size so far
+    size_t canvasBytes;             // Layer and composite pixel storage after the last frame
+    size_t historyBytes;            // Undo history after the last frame
+    size_t tileAllocations;         // Tile buffers allocated while running this size
+    int strokes;                    // Actions in the session
+    int fills;
+    int sweeps;                     // Zoom and pan sweeps
+} StressResult;
+
+/**
+ * Run the synthetic session on one canvas size
+ *
+ * @param size Canvas width and height in pixels
+ * @param frames Number of frames to run (at most PROFILER_FRAME_CAPACITY - 1)
+ * @param pool Threads for compositing (NULL for the calling thread only)
+ * @param useWindow Draw with DrawCanvas in the open window instead of the software renderer
+ * @param result Receives the measurements
+ * @return false if the canvas could not be created
+ */
+bool RunStressSize(int size, int frames, ThreadPool* pool, bool useWindow, StressResult* result);
+
+/**
+ * Write results as CSV, one row per canvas size
+ *
+ * @param path Output file
+ * @param results Results to write
+ * @param count Number of results
+ * @return false if the file could not be written
+ */
+bool WriteStressCsv(const char* path, const StressResult* results, int count);
+
+/**
+ * Command line entry point of stress mode: parse arguments, run and report
+ *
+ * @param argc Number of arguments after --stress
+ * @param argv Arguments after --stress
+ * @return Process exit code (0 when every size ran)
+ */
+int RunStressCommand(int argc, char** argv);
+
+#endif // STRESS_H
@@ -0,0 +1,68 @@
+/**
+ * stroke.h
+ *
+ * Stroke Coverage Mask for Pixel Art Tool
+ * Remembers which pixels the current stroke has already painted, so
+ * translucent or blending strokes affect each pixel once no matter how
+ * often stamps and line segments overlap
+ */
+
+#ifndef STROKE_H
+#define STROKE_H
+
+#include "canvas.h"
+#include "raster.h"
+#include <stdbool.h>
+
+/**
+ * One bit per canvas pixel, stored per canvas tile and allocated on first use
+ */
+typedef struct {
+    int tilesX;
+    int tilesY;
+    unsigned char** tiles;      // CANVAS_TILE_PIXELS / 8 bytes per tile, NULL until touched
+
+    // Tiles with set bits, cleared on reset
+    int* touched;
+    int touchedCount;
+    int touchedCapacity;
+} StrokeMask;
+
+/**
+ * Create an empty stroke mask
+ *
+ * @return Pointer to newly created StrokeMask (must be freed with DestroyStrokeMask)
+ */
+StrokeMask* CreateStrokeMask(void);
+
+/**
+ * Destroy a stroke mask and free memory
+ *
+ * @param mask StrokeMask to destroy
+ */
+void DestroyStrokeMask(StrokeMask* mask);
+
+/**
+ * Clear the mask for a new stroke on a canvas
+ * Only tiles touched by the previous stroke are cleared
+ *
+ * @param mask StrokeMask to reset
+ * @param canvas Canvas the stroke paints on
+ * @return false if the mask could not be sized for the canvas
+ */
+bool ResetStrokeMask(StrokeMask* mask, const Canvas* canvas);
+
+/**
+ * Mark the pixels of a span as painted and pass on the parts that were not
+ * painted yet, as sub-spans with the same orientation
+ * The span must lie inside the canvas the mask was reset for.
+ *
+ * @param mask StrokeMask to update
+ * @param span Span about to be painted
+ * @param callback Receives the newly covered sub-spans
+ * @param userData Passed through to callback
+ * @return Number of sub-spans emitted
+ */
+int ClaimStrokeSpan(StrokeMask* mask, RasterSpan span, RasterSpanCallback callback, void* userData);
+
+#endif // STROKE_H
@@ -0,0 +1,98 @@
+/**
+ * threadpool.h
+ *
+ * Worker Thread Pool for Pixel Art Tool
+ * A fixed set of worker threads that run data-parallel loops. Each worker
+ * starts on its own contiguous share of the index range and, once that is
+ * used up, steals chunks from the shares of slower workers. The calling
+ * thread works too, so a pool of N threads starts N - 1 workers.
+ * Also runs single long tasks (file export, ...) on their own thread.
+ * Independent of raylib so the core can use it headless.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/**
+ * Body of a parallel loop
+ *
+ * @param userData Pointer passed to ParallelFor
+ * @param begin First index of the chunk
+ * @param end One past the last index of the chunk
+ * @param workerIndex 0 for the calling thread, 1..N-1 for pool workers
+ */
+typedef void (*ThreadPoolTask)(void* userData, int begin, int end, int workerIndex);
+
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * Body of a background thread
+ *
+ * @param userData Pointer passed to StartBackgroundThread
+ */
+typedef void (*BackgroundTask)(void* userData);
+
+typedef struct BackgroundThread BackgroundThread;
+
+/**
+ * Get the number of processor cores available to the process
+ *
+ * @return Core count (at least 1)
+ */
+int GetCpuCoreCount(void);
+
+/**
+ * Create a thread pool
+ *
+ * @param threadCount Threads including the caller (0 for one per core)
+ * @return Pointer to newly created ThreadPool (must be freed with DestroyThreadPool)
+ */
+ThreadPool* CreateThreadPool(int threadCount);
+
+/**
+ * Stop the workers and free the pool
+ *
+ * @param pool ThreadPool to destroy
+ */
+void DestroyThreadPool(ThreadPool* pool);
+
+/**
+ * Get the number of threads that run a parallel loop
+ *
+ * @param pool ThreadPool to query (NULL counts as one thread)
+ * @return Thread count including the caller
+ */
+int GetThreadPoolSize(ThreadPool* pool);
+
+/**
+ * Run task over [0, count) in chunks of at most grain indices and wait for
+ * all chunks to finish
+ * Chunks run concurrently, so they must not write shared state. With a
+ * NULL pool, or too little work to split, the loop runs on the caller.
+ * Not reentrant: a task must not call ParallelFor on the same pool.
+ *
+ * @param pool ThreadPool to run on (may be NULL)
+ * @param count Number of indices
+ * @param grain Largest chunk handed out at once (<= 0 for 1)
+ * @param task Loop body
+ * @param userData Passed through to task
+ */
+void ParallelFor(ThreadPool* pool, int count, int grain, ThreadPoolTask task, void* userData);
+
+/**
+ * Run a task on a new thread
+ *
+ * @param task Function to run
+ * @param userData Passed through to task
+ * @return Handle to join with JoinBackgroundThread, or NULL if no thread could be started
+ */
+BackgroundThread* StartBackgroundThread(BackgroundTask task, void* userData);
+
+/**
+ * Wait for a background thread to finish and free its handle
+ *
+ * @param thread Thread to join
+ */
+void JoinBackgroundThread(BackgroundThread* thread);
+
+#endif // THREADPOOL_H
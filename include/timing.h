@@ -0,0 +1,19 @@
+/**
+ * timing.h
+ *
+ * High-resolution Timer for Pixel Art Tool
+ * Monotonic clock that works without a window (raylib's GetTime needs an
+ * initialized window), for benchmarks and headless runs
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+/**
+ * Get the current time of a monotonic clock
+ *
+ * @return Time in seconds since an arbitrary fixed point
+ */
+double GetMonotonicTime(void);
+
+#endif // TIMING_H
@@ -11,6 +11,11 @@
 #include "raylib.h"
 #include "canvas.h"
 #include "camera.h"
+#include "history.h"
+#include "brush.h"
+#include "fill.h"
+#include "blend.h"
+#include "stroke.h"
 #include <stdbool.h>
 
 /**
@@ -19,7 +24,8 @@
 typedef enum {
     TOOL_PENCIL,    // Draw with foreground color
     TOOL_ERASER,    // Erase pixels (set to transparent)
-    TOOL_EYEDROPPER // Sample color from canvas
+    TOOL_EYEDROPPER,// Sample color from canvas
+    TOOL_FILL       // Flood fill with foreground color
 } ToolType;
 
 /**
@@ -36,6 +42,22 @@ typedef struct {
     int lastPixelX;             // Last drawn pixel X coordinate
     int lastPixelY;             // Last drawn pixel Y coordinate
     bool hasLastPixel;          // Whether we have a valid last pixel position
+
+    History* history;           // Undo history strokes are recorded into (optional)
+
+    // Brush used by the pencil and eraser
+    int brushSize;              // Brush diameter in pixels (MIN_BRUSH_SIZE..MAX_BRUSH_SIZE)
+    BrushShape brushShape;      // Shape of the active brush
+    Brush* brush;               // Precomputed mask for brushSize/brushShape
+    Brush* customBrush;         // User-supplied mask used by BRUSH_CUSTOM (optional)
+
+    // Fill tool
+    FillMode fillMode;          // Contiguous region or all matching pixels
+    FillArena* fillArena;       // Work stack reused across fills
+
+    // Painting
+    PixelBlendMode blendMode;   // How the pencil combines its color with the canvas
+    StrokeMask* strokeMask;     // Pixels already painted by the current stroke
 } ToolState;
 
 /**
@@ -43,6 +65,8 @@ typedef struct {
  * Default tool: TOOL_PENCIL
  * Default foreground: BLACK
  * Default background: WHITE
+ * Default brush: 1px round
+ * Default blend mode: PIXEL_BLEND_NORMAL
  *
  * @return Pointer to newly created ToolState (must be freed with DestroyToolState)
  */
@@ -71,6 +95,70 @@ void SetCurrentTool(ToolState* state, ToolType tool);
  */
 ToolType GetCurrentTool(ToolState* state);
 
+/**
+ * Set the history that completed strokes are recorded into
+ * Each stroke (mouse press to release) becomes one undoable step
+ *
+ * @param state ToolState to update
+ * @param history History to record into, or NULL to disable recording
+ */
+void SetToolHistory(ToolState* state, History* history);
+
+/**
+ * Set the brush size (clamped to MIN_BRUSH_SIZE..MAX_BRUSH_SIZE)
+ * The brush mask is rebuilt once here, not per stamp
+ *
+ * @param state ToolState to update
+ * @param size Brush diameter in pixels
+ */
+void SetBrushSize(ToolState* state, int size);
+
+/**
+ * Set the brush shape
+ * BRUSH_CUSTOM falls back to BRUSH_ROUND until a custom mask is set
+ *
+ * @param state ToolState to update
+ * @param shape Brush shape to use
+ */
+void SetBrushShape(ToolState* state, BrushShape shape);
+
+/**
+ * Set the mask used by BRUSH_CUSTOM and switch to it
+ *
+ * @param state ToolState to update
+ * @param mask Row-major coverage mask (non-zero = covered), copied
+ * @param width Mask width (1..MAX_BRUSH_SIZE)
+ * @param height Mask height (1..MAX_BRUSH_SIZE)
+ * @return true if the mask was valid and is now active
+ */
+bool SetCustomBrush(ToolState* state, const unsigned char* mask, int width, int height);
+
+/**
+ * Get the name of the current brush shape as a string
+ *
+ * @param state ToolState to query
+ * @return Shape name string (e.g., "Round", "Square")
+ */
+const char* GetBrushShapeName(ToolState* state);
+
+/**
+ * Set the fill tool mode
+ *
+ * @param state ToolState to update
+ * @param mode FILL_CONTIGUOUS or FILL_GLOBAL
+ */
+void SetFillMode(ToolState* state, FillMode mode);
+
+/**
+ * Set the blend mode used by the pencil
+ * Blending strokes (translucent color or a non-Normal mode) affect each
+ * pixel once per stroke, however often the stroke passes over it
+ *
+ * @param state ToolState to update
+ * @param mode Blend mode to use
+ */
+void SetBlendMode(ToolState* state, PixelBlendMode mode);
+
 /**
  * Set the foreground color
  *
@@ -107,6 +195,9 @@ Color GetBackgroundColor(ToolState* state);
  * Update tool state based on user input
  * Handles:
  * - Tool switching with keyboard shortcuts (B for brush/pencil, E for eraser)
+ * - Brush size ([ and ]) and shape (K) shortcuts
+ * - Fill tool (G) and fill mode (Shift+G) shortcuts
+ * - Blend mode (M) shortcut
  * - Mouse input for drawing
  * - Click and drag drawing
  *
@@ -117,6 +208,22 @@ Color GetBackgroundColor(ToolState* state);
  */
 void UpdateToolState(ToolState* state, Canvas* canvas, CanvasCamera* camera, int pixelSize);
 
+/**
+ * Start a stroke (mouse press)
+ * Opens a history step and clears the stroke coverage mask
+ *
+ * @param state ToolState to update
+ * @param canvas Canvas the stroke paints on
+ */
+void BeginToolStroke(ToolState* state, Canvas* canvas);
+
+/**
+ * Finish the current stroke (mouse release) and commit it to the history
+ *
+ * @param state ToolState to update
+ */
+void EndToolStroke(ToolState* state);
+
 /**
  * Draw a single pixel with the current tool at the given canvas coordinates
  *
@@ -127,6 +234,33 @@ void UpdateToolState(ToolState* state, Canvas* canvas, CanvasCamera* camera, int
  */
 void DrawPixelWithTool(ToolState* state, Canvas* canvas, int pixelX, int pixelY);
 
+/**
+ * Stamp the current brush once with the current tool, centered on a pixel
+ *
+ * @param state ToolState containing current tool, colors and brush
+ * @param canvas Canvas to draw on
+ * @param pixelX Canvas X coordinate (may lie outside the canvas)
+ * @param pixelY Canvas Y coordinate
+ */
+void StampWithTool(ToolState* state, Canvas* canvas, int pixelX, int pixelY);
+
+/**
+ * Draw a line between two canvas coordinates with the current tool
+ * The segment is clipped to the canvas first and written as horizontal or
+ * vertical spans, so off-canvas parts of a fast drag cost nothing.
+ * With a brush larger than one pixel the brush is stamped along the line,
+ * writing only pixels the previous stamp did not already cover; the start
+ * point is assumed to be stamped already.
+ *
+ * @param state ToolState containing current tool and colors
+ * @param canvas Canvas to draw on
+ * @param x0 Start X (canvas coordinates, may lie outside the canvas)
+ * @param y0 Start Y
+ * @param x1 End X
+ * @param y1 End Y
+ */
+void DrawLineWithTool(ToolState* state, Canvas* canvas, int x0, int y0, int x1, int y1);
+
 /**
  * Get the name of the current tool as a string
  *
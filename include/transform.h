@@ -0,0 +1,66 @@
+/**
+ * transform.h
+ *
+ * Canvas Transforms for Pixel Art Tool
+ * Whole-canvas geometry operations: nearest-neighbor scaling (so pixel art
+ * stays crisp), flipping, cropping and trimming transparent borders. Each
+ * one reads the source a row at a time and builds a new canvas, leaving
+ * tiles that end up all empty unallocated. Works without a window.
+ */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "canvas.h"
+#include <stdbool.h>
+
+/**
+ * Pixel rectangle (inclusive minimum, exclusive maximum)
+ */
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} CanvasRect;
+
+/**
+ * Resize a canvas with nearest-neighbor sampling
+ *
+ * @param source Canvas to read
+ * @param width New width in pixels
+ * @param height New height in pixels
+ * @return Pointer to newly created Canvas (must be freed with DestroyCanvas), or NULL
+ */
+Canvas* ScaleCanvas(Canvas* source, int width, int height);
+
+/**
+ * Mirror a canvas
+ *
+ * @param source Canvas to read
+ * @param horizontal Mirror left to right
+ * @param vertical Mirror top to bottom
+ * @return Pointer to newly created Canvas (must be freed with DestroyCanvas), or NULL
+ */
+Canvas* FlipCanvas(Canvas* source, bool horizontal, bool vertical);
+
+/**
+ * Copy a rectangle of a canvas into a new canvas
+ *
+ * @param source Canvas to read
+ * @param rect Area to keep (must lie inside the canvas)
+ * @return Pointer to newly created Canvas (must be freed with DestroyCanvas), or NULL
+ */
+Canvas* CropCanvas(Canvas* source, CanvasRect rect);
+
+/**
+ * Find the smallest rectangle holding every pixel that is not fully transparent
+ * Empty tiles are skipped without reading their pixels
+ *
+ * @param canvas Canvas to scan
+ * @param bounds Receives the rectangle
+ * @return false if the whole canvas is transparent
+ */
+bool GetCanvasContentBounds(Canvas* canvas, CanvasRect* bounds);
+
+#endif // TRANSFORM_H
@@ -4,6 +4,14 @@
 #include <raylib.h>
 #include <stdbool.h>
 #include "color.h"
+#include "layer.h"
+
+// Per-frame color picker cost counters (reset every DrawColorPicker call)
+typedef struct {
+    int drawCalls;          // raylib draw calls issued by the picker this frame
+    int colorConversions;   // HSVToColor calls spent rebuilding gradients this frame
+    int gradientUpdates;    // Gradient textures re-uploaded this frame
+} ColorPickerStats;
 
 // Color picker state
 typedef struct {
@@ -20,6 +28,20 @@ typedef struct {
 
     // Which slider is being dragged
     int activeSlider; // 0=none, 1=hue, 2=sat, 3=val, 4=alpha
+
+    // Cached gradient strips (one texel per slider pixel, stretched vertically)
+    Texture2D hueTexture;
+    Texture2D saturationTexture;
+    Texture2D valueTexture;
+    Texture2D alphaTexture;
+    Texture2D checkerTexture;   // Repeating pattern behind the color preview
+    bool hasTextures;
+
+    // HSV the dependent gradients were last generated for
+    ColorHSV gradientHSV;
+    bool gradientsValid;
+
+    ColorPickerStats stats;
 } ColorPicker;
 
 // Initialize color picker
@@ -32,9 +54,18 @@ bool UpdateColorPicker(ColorPicker* picker, Color* outputColor);
 // Draw color picker UI
 void DrawColorPicker(ColorPicker* picker, Color currentColor);
 
+// Release the picker's cached textures (call before closing the window)
+void UnloadColorPicker(ColorPicker* picker);
+
+// Get the cost counters of the most recent DrawColorPicker call
+ColorPickerStats GetColorPickerStats(ColorPicker* picker);
+
 // Draw foreground/background color swatches
 void DrawColorSwatches(float x, float y, float size, Color foreground, Color background);
 
+// Draw the layer list, top layer first, with the active layer highlighted
+void DrawLayerPanel(LayerStack* stack, float x, float y);
+
 // Check if mouse is over color picker
 bool IsMouseOverColorPicker(ColorPicker* picker);
 
@@ -0,0 +1,433 @@
+/**
+ * batch.c
+ *
+ * Implementation of Headless Batch Processing
+ */
+
+#include "batch.h"
+#include "import.h"
+#include "pngio.h"
+#include "timing.h"
+#include "transform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_LINE_LENGTH 512
+
+/**
+ * Parse RRGGBB or RRGGBBAA hex, with or without a leading #
+ */
+static bool ParseHexColor(const char* text, Color* color) {
+    if (text[0] == '#') text++;
+    size_t length = strlen(text);
+    if (length != 6 && length != 8) return false;
+
+    char* end = NULL;
+    unsigned long value = strtoul(text, &end, 16);
+    if (*end != '\0') return false;
+    if (length == 6) value = (value << 8) | 0xFF;
+
+    *color = (Color){(unsigned char)(value >> 24), (unsigned char)(value >> 16), (unsigned char)(value >> 8),
+                     (unsigned char)value};
+    return true;
+}
+
+/**
+ * Parse one script line into an operation
+ * Returns false with a message in error if the line is not valid
+ */
+static bool ParseBatchOp(const char* line, BatchOp* op, char* error, int errorSize) {
+    char name[16] = {0};
+    char first[BATCH_PATH_LENGTH] = {0};
+    char second[32] = {0};
+    int tolerance = 0;
+    int fields = sscanf(line, "%15s %259s %31s %d", name, first, second, &tolerance);
+
+    *op = (BatchOp){0};
+    if (strcmp(name, "recolor") == 0) {
+        op->type = BATCH_RECOLOR;
+        if (fields < 3 || !ParseHexColor(first, &op->from) || !ParseHexColor(second, &op->to) ||
+            tolerance < 0 || tolerance > 255) {
+            snprintf(error, errorSize, "expected: recolor <RRGGBB[AA]> <RRGGBB[AA]> [tolerance 0-255]");
+            return false;
+        }
+        op->tolerance = (unsigned char)tolerance;
+    } else if (strcmp(name, "scale") == 0) {
+        op->type = BATCH_SCALE;
+        op->factor = (fields >= 2) ? (float)atof(first) : 0.0f;
+        if (op->factor <= 0.0f || op->factor > 64.0f) {
+            snprintf(error, errorSize, "expected: scale <factor> (above 0, up to 64)");
+            return false;
+        }
+    } else if (strcmp(name, "resize") == 0) {
+        op->type = BATCH_RESIZE;
+        op->width = (fields >= 2) ? atoi(first) : 0;
+        op->height = (fields >= 3) ? atoi(second) : 0;
+        if (op->width <= 0 || op->height <= 0 || op->width > CANVAS_MAX_SIZE || op->height > CANVAS_MAX_SIZE) {
+            snprintf(error, errorSize, "expected: resize <width> <height>");
+            return false;
+        }
+    } else if (strcmp(name, "flip") == 0) {
+        op->type = BATCH_FLIP;
+        op->horizontal = strchr(first, 'h') != NULL;
+        op->vertical = strchr(first, 'v') != NULL;
+        if (fields < 2 || strspn(first, "hv") != strlen(first)) {
+            snprintf(error, errorSize, "expected: flip <h|v|hv>");
+            return false;
+        }
+    } else if (strcmp(name, "trim") == 0) {
+        op->type = BATCH_TRIM;
+    } else if (strcmp(name, "export") == 0) {
+        op->type = BATCH_EXPORT;
+        if (fields < 2) {
+            snprintf(error, errorSize, "expected: export <path>");
+            return false;
+        }
+        strcpy(op->path, first);
+    } else {
+        snprintf(error, errorSize, "unknown operation '%s'", name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parse a batch script
+ */
+BatchScript* ParseBatchScript(const char* text, char* error, int errorSize) {
+    if (text == NULL) return NULL;
+
+    BatchScript* script = (BatchScript*)calloc(1, sizeof(BatchScript));
+    if (script == NULL) return NULL;
+
+    int lineNumber = 0;
+    while (*text != '\0') {
+        // Copy out one line
+        size_t length = strcspn(text, "\r\n");
+        char line[BATCH_LINE_LENGTH];
+        lineNumber++;
+        if (length >= sizeof(line)) {
+            snprintf(error, errorSize, "line %d: too long", lineNumber);
+            DestroyBatchScript(script);
+            return NULL;
+        }
+        memcpy(line, text, length);
+        line[length] = '\0';
+        text += length;
+        if (*text == '\r') text++;
+        if (*text == '\n') text++;
+
+        // Comments take whole lines, so colors may still start with #
+        char* content = line + strspn(line, " \t");
+        if (*content == '\0' || *content == '#') continue;
+
+        if (script->count == script->capacity) {
+            int capacity = script->capacity ? script->capacity * 2 : 8;
+            BatchOp* ops = (BatchOp*)realloc(script->ops, sizeof(BatchOp) * capacity);
+            if (ops == NULL) {
+                DestroyBatchScript(script);
+                return NULL;
+            }
+            script->ops = ops;
+            script->capacity = capacity;
+        }
+
+        char message[96];
+        if (!ParseBatchOp(line, &script->ops[script->count], message, sizeof(message))) {
+            snprintf(error, errorSize, "line %d: %s", lineNumber, message);
+            DestroyBatchScript(script);
+            return NULL;
+        }
+        script->count++;
+    }
+
+    if (script->count == 0) {
+        snprintf(error, errorSize, "script has no operations");
+        DestroyBatchScript(script);
+        return NULL;
+    }
+    return script;
+}
+
+/**
+ * Read and parse a batch script file
+ */
+BatchScript* LoadBatchScript(const char* path, char* error, int errorSize) {
+    FILE* in = (path != NULL) ? fopen(path, "rb") : NULL;
+    if (in == NULL) {
+        snprintf(error, errorSize, "cannot open %s", path ? path : "(null)");
+        return NULL;
+    }
+
+    long size = (fseek(in, 0, SEEK_END) == 0) ? ftell(in) : -1;
+    char* text = (size >= 0 && fseek(in, 0, SEEK_SET) == 0) ? (char*)malloc((size_t)size + 1) : NULL;
+    bool ok = text != NULL && fread(text, 1, (size_t)size, in) == (size_t)size;
+    fclose(in);
+    if (!ok) {
+        snprintf(error, errorSize, "cannot read %s", path);
+        free(text);
+        return NULL;
+    }
+    text[size] = '\0';
+
+    BatchScript* script = ParseBatchScript(text, error, errorSize);
+    free(text);
+    return script;
+}
+
+/**
+ * Free a batch script
+ */
+void DestroyBatchScript(BatchScript* script) {
+    if (script == NULL) return;
+
+    free(script->ops);
+    free(script);
+}
+
+/**
+ * Expand {name} in an export path with the input's file name minus extension
+ * (done by hand: raylib's path helpers return shared buffers)
+ */
+static bool FormatExportPath(const char* pattern, const char* inputPath, char* out, size_t outSize) {
+    const char* base = inputPath;
+    for (const char* c = inputPath; *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') base = c + 1;
+    }
+    const char* dot = strrchr(base, '.');
+    int baseLength = (dot != NULL && dot != base) ? (int)(dot - base) : (int)strlen(base);
+
+    size_t length = 0;
+    out[0] = '\0';
+    while (*pattern != '\0') {
+        const char* marker = strstr(pattern, "{name}");
+        int literal = (marker != NULL) ? (int)(marker - pattern) : (int)strlen(pattern);
+        int written = snprintf(out + length, outSize - length, "%.*s%.*s", literal, pattern,
+                               (marker != NULL) ? baseLength : 0, base);
+        if (written < 0 || (size_t)written >= outSize - length) return false;
+        length += (size_t)written;
+        pattern += literal + ((marker != NULL) ? 6 : 0);
+    }
+    return true;
+}
+
+/**
+ * Write a canvas to a PNG file, one row at a time
+ */
+static bool WriteCanvasPng(Canvas* canvas, const char* path) {
+    PngWriter* writer = CreatePngWriter(path, canvas->width, canvas->height);
+    Color* row = (Color*)malloc(sizeof(Color) * canvas->width);
+    if (writer == NULL || row == NULL) {
+        DestroyPngWriter(writer);
+        free(row);
+        return false;
+    }
+
+    bool ok = true;
+    for (int y = 0; y < canvas->height && ok; y++) {
+        ReadCanvasRow(canvas, y, row);
+        ok = WritePngRow(writer, row);
+    }
+
+    free(row);
+    if (!ok) {
+        DestroyPngWriter(writer);
+        return false;
+    }
+    return FinishPngWriter(writer);
+}
+
+/**
+ * Run one operation; transforms replace *canvas with their result
+ */
+static bool ApplyBatchOp(const BatchOp* op, Canvas** canvas, const char* inputPath, char* error, int errorSize) {
+    Canvas* source = *canvas;
+    Canvas* result = NULL;
+
+    switch (op->type) {
+        case BATCH_RECOLOR:
+            ReplaceCanvasColor(source, op->from, op->to, op->tolerance);
+            return true;
+        case BATCH_SCALE: {
+            int width = (int)(source->width * op->factor + 0.5f);
+            int height = (int)(source->height * op->factor + 0.5f);
+            result = ScaleCanvas(source, (width > 0) ? width : 1, (height > 0) ? height : 1);
+            break;
+        }
+        case BATCH_RESIZE:
+            result = ScaleCanvas(source, op->width, op->height);
+            break;
+        case BATCH_FLIP:
+            result = FlipCanvas(source, op->horizontal, op->vertical);
+            break;
+        case BATCH_TRIM: {
+            CanvasRect bounds;
+            if (!GetCanvasContentBounds(source, &bounds)) return true; // Nothing to keep: leave it as is
+            if (bounds.width == source->width && bounds.height == source->height) return true;
+            result = CropCanvas(source, bounds);
+            break;
+        }
+        case BATCH_EXPORT: {
+            char path[BATCH_PATH_LENGTH];
+            if (!FormatExportPath(op->path, inputPath, path, sizeof(path))) {
+                snprintf(error, errorSize, "export path too long");
+                return false;
+            }
+            if (!WriteCanvasPng(source, path)) {
+                snprintf(error, errorSize, "cannot write %s", path);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    if (result == NULL) {
+        snprintf(error, errorSize, "out of memory (%dx%d)", source->width, source->height);
+        return false;
+    }
+    DestroyCanvas(source);
+    *canvas = result;
+    return true;
+}
+
+/**
+ * Load one file, run the script on it and write its exports
+ */
+void ProcessBatchFile(const BatchScript* script, const char* path, BatchFileResult* result) {
+    *result = (BatchFileResult){0};
+    result->path = path;
+
+    double start = GetMonotonicTime();
+    Canvas* canvas = ImportImageCanvas(path, NULL);
+    result->loadSeconds = GetMonotonicTime() - start;
+    if (canvas == NULL) {
+        snprintf(result->error, sizeof(result->error), "cannot load image");
+        return;
+    }
+    result->width = canvas->width;
+    result->height = canvas->height;
+
+    result->ok = true;
+    for (int i = 0; i < script->count && result->ok; i++) {
+        const BatchOp* op = &script->ops[i];
+        start = GetMonotonicTime();
+        result->ok = ApplyBatchOp(op, &canvas, path, result->error, sizeof(result->error));
+
+        double seconds = GetMonotonicTime() - start;
+        if (op->type == BATCH_EXPORT) {
+            result->exportSeconds += seconds;
+            result->exportCount += result->ok ? 1 : 0;
+        } else {
+            result->processSeconds += seconds;
+        }
+    }
+
+    result->outputWidth = canvas->width;
+    result->outputHeight = canvas->height;
+    DestroyCanvas(canvas);
+}
+
+typedef struct {
+    const BatchScript* script;
+    char** paths;
+    BatchFileResult* results;
+} BatchJob;
+
+/**
+ * ParallelFor task: each index is one input file
+ */
+static void ProcessBatchFiles(void* userData, int begin, int end, int workerIndex) {
+    BatchJob* job = (BatchJob*)userData;
+    for (int i = begin; i < end; i++) {
+        ProcessBatchFile(job->script, job->paths[i], &job->results[i]);
+        job->results[i].workerIndex = workerIndex;
+    }
+}
+
+/**
+ * Process a list of files, spread across the thread pool
+ */
+void RunBatch(const BatchScript* script, char** paths, int count, ThreadPool* pool, BatchFileResult* results) {
+    if (script == NULL || paths == NULL || results == NULL || count <= 0) return;
+
+    // Files differ a lot in size, so hand them out one at a time
+    BatchJob job = {script, paths, results};
+    ParallelFor(pool, count, 1, ProcessBatchFiles, &job);
+}
+
+/**
+ * Print the batch mode usage
+ */
+static void PrintBatchUsage(void) {
+    printf("Usage: pixel_art_tool --batch [--threads N] <script> <images...>\n");
+    printf("Script operations, one per line:\n");
+    printf("  recolor <RRGGBB[AA]> <RRGGBB[AA]> [tolerance]\n");
+    printf("  scale <factor> | resize <width> <height> | flip <h|v|hv> | trim\n");
+    printf("  export <path>   ({name} = input file name without extension)\n");
+}
+
+/**
+ * Command line entry point of batch mode: parse arguments, run and report
+ */
+int RunBatchCommand(int argc, char** argv) {
+    int threadCount = 0;
+    int first = 0;
+    if (argc >= 2 && strcmp(argv[0], "--threads") == 0) {
+        threadCount = atoi(argv[1]);
+        first = 2;
+    }
+    if (argc - first < 2 || threadCount < 0) {
+        PrintBatchUsage();
+        return 2;
+    }
+
+    char error[160] = {0};
+    BatchScript* script = LoadBatchScript(argv[first], error, sizeof(error));
+    if (script == NULL) {
+        fprintf(stderr, "%s: %s\n", argv[first], error);
+        return 2;
+    }
+
+    char** paths = argv + first + 1;
+    int count = argc - first - 1;
+    BatchFileResult* results = (BatchFileResult*)calloc(count, sizeof(BatchFileResult));
+    ThreadPool* pool = CreateThreadPool(threadCount);
+    if (results == NULL) {
+        DestroyThreadPool(pool);
+        DestroyBatchScript(script);
+        return 2;
+    }
+
+    printf("Batch: %d files, %d operations, %d threads\n", count, script->count, GetThreadPoolSize(pool));
+    double start = GetMonotonicTime();
+    RunBatch(script, paths, count, pool, results);
+    double wallSeconds = GetMonotonicTime() - start;
+
+    printf("  %-32s %-22s %9s %9s %9s %9s %6s\n", "file", "size", "load ms", "ops ms", "export ms", "total ms",
+           "thread");
+    int failed = 0;
+    double fileSeconds = 0.0;
+    for (int i = 0; i < count; i++) {
+        const BatchFileResult* result = &results[i];
+        double total = result->loadSeconds + result->processSeconds + result->exportSeconds;
+        fileSeconds += total;
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d -> %dx%d", result->width, result->height, result->outputWidth,
+                 result->outputHeight);
+        printf("  %-32s %-22s %9.2f %9.2f %9.2f %9.2f %6d%s%s\n", result->path, result->ok ? size : "-",
+               result->loadSeconds * 1000.0, result->processSeconds * 1000.0, result->exportSeconds * 1000.0,
+               total * 1000.0, result->workerIndex, result->ok ? "" : "  FAILED: ", result->ok ? "" : result->error);
+        failed += result->ok ? 0 : 1;
+    }
+
+    printf("Done: %d ok, %d failed in %.3f s (%.1f files/s); %.3f s of file time, %.2fx parallel speedup\n",
+           count - failed, failed, wallSeconds, (wallSeconds > 0.0) ? count / wallSeconds : 0.0, fileSeconds,
+           (wallSeconds > 0.0) ? fileSeconds / wallSeconds : 0.0);
+
+    free(results);
+    DestroyThreadPool(pool);
+    DestroyBatchScript(script);
+    return (failed > 0) ? 1 : 0;
+}
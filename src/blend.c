@@ -0,0 +1,369 @@
+/**
+ * blend.c
+ *
+ * Implementation of Color Blending
+ *
+ * Straight-alpha compositing (W3C compositing, source-over) with 8-bit
+ * channels and integer weights:
+ *     ws = sa * (255 - da)     source only
+ *     wd = da * (255 - sa)     destination only
+ *     wb = sa * da             both (blend function B applies here)
+ *     out.c = (sc * ws + dc * wd + B(sc, dc) * wb) / (ws + wd + wb)
+ *     out.a = (ws + wd + wb) / 255
+ * Every product and sum stays below 2^24, so the final division can be done
+ * in single precision without rounding error, identically in the scalar and
+ * vector paths. It un-premultiplies the result, the only step that is not
+ * a multiply or shift.
+ */
+
+#include "blend.h"
+#include "pixelops.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLEND_X86 1
+#include <immintrin.h>
+#endif
+
+static unsigned int PackColor(Color color) {
+    unsigned int packed;
+    memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+//------------------------------------------------------------------------------
+// Scalar
+//------------------------------------------------------------------------------
+
+/**
+ * x / 255 rounded to nearest, exact for x <= 255 * 255
+ */
+static unsigned int Div255(unsigned int x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * Blend function B(source, destination) of one channel
+ */
+static unsigned int BlendChannel(unsigned int s, unsigned int d, PixelBlendMode mode) {
+    switch (mode) {
+        case PIXEL_BLEND_MULTIPLY:
+            return Div255(s * d);
+        case PIXEL_BLEND_SCREEN:
+            return s + d - Div255(s * d);
+        case PIXEL_BLEND_ADD:
+            return (s + d > 255) ? 255 : s + d;
+        default:
+            return s;
+    }
+}
+
+/**
+ * numerator / weight rounded to nearest (same operations as the vector paths)
+ */
+static unsigned char Normalize(unsigned int numerator, unsigned int weight) {
+    float quotient = (float)numerator / (float)weight;
+    quotient += 0.5f;
+    return (unsigned char)quotient;
+}
+
+static Color BlendPixel(Color dst, Color src, PixelBlendMode mode) {
+    unsigned int sa = src.a;
+    unsigned int da = dst.a;
+    unsigned int ws = sa * (255 - da);
+    unsigned int wd = da * (255 - sa);
+    unsigned int wb = sa * da;
+    unsigned int weight = ws + wd + wb;
+    if (weight == 0) return dst;
+
+    Color out;
+    out.r = Normalize(src.r * ws + dst.r * wd + BlendChannel(src.r, dst.r, mode) * wb, weight);
+    out.g = Normalize(src.g * ws + dst.g * wd + BlendChannel(src.g, dst.g, mode) * wb, weight);
+    out.b = Normalize(src.b * ws + dst.b * wd + BlendChannel(src.b, dst.b, mode) * wb, weight);
+    out.a = (unsigned char)Div255(weight);
+    return out;
+}
+
+static Color ScaleAlpha(Color color, unsigned char opacity) {
+    color.a = (unsigned char)Div255(color.a * opacity);
+    return color;
+}
+
+static void BlendColorSpanScalar(Color* pixels, size_t count, Color src, PixelBlendMode mode) {
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = BlendPixel(pixels[i], src, mode);
+    }
+}
+
+static void BlendPixelSpanScalar(Color* dst, const Color* src, size_t count, unsigned char opacity,
+                                 PixelBlendMode mode) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = BlendPixel(dst[i], ScaleAlpha(src[i], opacity), mode);
+    }
+}
+
+#ifdef BLEND_X86
+
+//------------------------------------------------------------------------------
+// SSE2 (4 pixels per step, one channel per 32-bit lane)
+//------------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static inline __m128i Div255SSE2(__m128i x) {
+    x = _mm_add_epi32(x, _mm_set1_epi32(128));
+    return _mm_srli_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i ScaleAlphaSSE2(__m128i s, __m128i opacity) {
+    __m128i alpha = Div255SSE2(_mm_mullo_epi16(_mm_srli_epi32(s, 24), opacity));
+    return _mm_or_si128(_mm_and_si128(s, _mm_set1_epi32(0x00FFFFFF)), _mm_slli_epi32(alpha, 24));
+}
+
+/**
+ * Blend 4 source pixels over 4 destination pixels
+ * Channel products of two 8-bit values fit in 16 bits, so the SSE2 16-bit
+ * multiply is exact on zero-extended 32-bit lanes
+ */
+__attribute__((target("sse2")))
+static inline __m128i BlendSSE2(__m128i d, __m128i s, PixelBlendMode mode) {
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+
+    __m128i sa = _mm_srli_epi32(s, 24);
+    __m128i da = _mm_srli_epi32(d, 24);
+    __m128i ws = _mm_mullo_epi16(sa, _mm_sub_epi32(byteMask, da));
+    __m128i wd = _mm_mullo_epi16(da, _mm_sub_epi32(byteMask, sa));
+    __m128i wb = _mm_mullo_epi16(sa, da);
+    __m128i weight = _mm_add_epi32(_mm_add_epi32(ws, wd), wb);
+
+    __m128 fws = _mm_cvtepi32_ps(ws);
+    __m128 fwd = _mm_cvtepi32_ps(wd);
+    __m128 fwb = _mm_cvtepi32_ps(wb);
+    __m128 fweight = _mm_cvtepi32_ps(weight);
+
+    __m128i out = _mm_slli_epi32(Div255SSE2(weight), 24);
+    for (int shift = 0; shift < 24; shift += 8) {
+        __m128i count = _mm_cvtsi32_si128(shift);
+        __m128i sc = _mm_and_si128(_mm_srl_epi32(s, count), byteMask);
+        __m128i dc = _mm_and_si128(_mm_srl_epi32(d, count), byteMask);
+
+        __m128i b = sc;
+        if (mode == PIXEL_BLEND_MULTIPLY) {
+            b = Div255SSE2(_mm_mullo_epi16(sc, dc));
+        } else if (mode == PIXEL_BLEND_SCREEN) {
+            b = _mm_sub_epi32(_mm_add_epi32(sc, dc), Div255SSE2(_mm_mullo_epi16(sc, dc)));
+        } else if (mode == PIXEL_BLEND_ADD) {
+            b = _mm_min_epi16(_mm_add_epi32(sc, dc), byteMask);
+        }
+
+        __m128 numerator = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sc), fws),
+                                                 _mm_mul_ps(_mm_cvtepi32_ps(dc), fwd)),
+                                      _mm_mul_ps(_mm_cvtepi32_ps(b), fwb));
+        __m128 quotient = _mm_add_ps(_mm_div_ps(numerator, fweight), _mm_set1_ps(0.5f));
+        out = _mm_or_si128(out, _mm_sll_epi32(_mm_cvttps_epi32(quotient), count));
+    }
+
+    // Fully transparent over fully transparent leaves the destination alone
+    __m128i empty = _mm_cmpeq_epi32(weight, _mm_setzero_si128());
+    return _mm_or_si128(_mm_and_si128(empty, d), _mm_andnot_si128(empty, out));
+}
+
+__attribute__((target("sse2")))
+static void BlendColorSpanSSE2(Color* pixels, size_t count, Color src, PixelBlendMode mode) {
+    __m128i s = _mm_set1_epi32((int)PackColor(src));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(pixels + i));
+        _mm_storeu_si128((__m128i*)(pixels + i), BlendSSE2(d, s, mode));
+    }
+    BlendColorSpanScalar(pixels + i, count - i, src, mode);
+}
+
+__attribute__((target("sse2")))
+static void BlendPixelSpanSSE2(Color* dst, const Color* src, size_t count, unsigned char opacity,
+                               PixelBlendMode mode) {
+    __m128i scale = _mm_set1_epi32(opacity);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i s = ScaleAlphaSSE2(_mm_loadu_si128((const __m128i*)(src + i)), scale);
+        _mm_storeu_si128((__m128i*)(dst + i), BlendSSE2(d, s, mode));
+    }
+    BlendPixelSpanScalar(dst + i, src + i, count - i, opacity, mode);
+}
+
+//------------------------------------------------------------------------------
+// AVX2 (8 pixels per step)
+//------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static inline __m256i Div255AVX2(__m256i x) {
+    x = _mm256_add_epi32(x, _mm256_set1_epi32(128));
+    return _mm256_srli_epi32(_mm256_add_epi32(x, _mm256_srli_epi32(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i ScaleAlphaAVX2(__m256i s, __m256i opacity) {
+    __m256i alpha = Div255AVX2(_mm256_mullo_epi16(_mm256_srli_epi32(s, 24), opacity));
+    return _mm256_or_si256(_mm256_and_si256(s, _mm256_set1_epi32(0x00FFFFFF)), _mm256_slli_epi32(alpha, 24));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i BlendAVX2(__m256i d, __m256i s, PixelBlendMode mode) {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+
+    __m256i sa = _mm256_srli_epi32(s, 24);
+    __m256i da = _mm256_srli_epi32(d, 24);
+    __m256i ws = _mm256_mullo_epi16(sa, _mm256_sub_epi32(byteMask, da));
+    __m256i wd = _mm256_mullo_epi16(da, _mm256_sub_epi32(byteMask, sa));
+    __m256i wb = _mm256_mullo_epi16(sa, da);
+    __m256i weight = _mm256_add_epi32(_mm256_add_epi32(ws, wd), wb);
+
+    __m256 fws = _mm256_cvtepi32_ps(ws);
+    __m256 fwd = _mm256_cvtepi32_ps(wd);
+    __m256 fwb = _mm256_cvtepi32_ps(wb);
+    __m256 fweight = _mm256_cvtepi32_ps(weight);
+
+    __m256i out = _mm256_slli_epi32(Div255AVX2(weight), 24);
+    for (int shift = 0; shift < 24; shift += 8) {
+        __m128i count = _mm_cvtsi32_si128(shift);
+        __m256i sc = _mm256_and_si256(_mm256_srl_epi32(s, count), byteMask);
+        __m256i dc = _mm256_and_si256(_mm256_srl_epi32(d, count), byteMask);
+
+        __m256i b = sc;
+        if (mode == PIXEL_BLEND_MULTIPLY) {
+            b = Div255AVX2(_mm256_mullo_epi16(sc, dc));
+        } else if (mode == PIXEL_BLEND_SCREEN) {
+            b = _mm256_sub_epi32(_mm256_add_epi32(sc, dc), Div255AVX2(_mm256_mullo_epi16(sc, dc)));
+        } else if (mode == PIXEL_BLEND_ADD) {
+            b = _mm256_min_epi16(_mm256_add_epi32(sc, dc), byteMask);
+        }
+
+        // Separate multiplies and adds (no FMA) keep results identical to scalar
+        __m256 numerator = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(sc), fws),
+                                                       _mm256_mul_ps(_mm256_cvtepi32_ps(dc), fwd)),
+                                         _mm256_mul_ps(_mm256_cvtepi32_ps(b), fwb));
+        __m256 quotient = _mm256_add_ps(_mm256_div_ps(numerator, fweight), _mm256_set1_ps(0.5f));
+        out = _mm256_or_si256(out, _mm256_sll_epi32(_mm256_cvttps_epi32(quotient), count));
+    }
+
+    __m256i empty = _mm256_cmpeq_epi32(weight, _mm256_setzero_si256());
+    return _mm256_blendv_epi8(out, d, empty);
+}
+
+__attribute__((target("avx2")))
+static void BlendColorSpanAVX2(Color* pixels, size_t count, Color src, PixelBlendMode mode) {
+    __m256i s = _mm256_set1_epi32((int)PackColor(src));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(pixels + i));
+        _mm256_storeu_si256((__m256i*)(pixels + i), BlendAVX2(d, s, mode));
+    }
+    BlendColorSpanScalar(pixels + i, count - i, src, mode);
+}
+
+__attribute__((target("avx2")))
+static void BlendPixelSpanAVX2(Color* dst, const Color* src, size_t count, unsigned char opacity,
+                               PixelBlendMode mode) {
+    __m256i scale = _mm256_set1_epi32(opacity);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = ScaleAlphaAVX2(_mm256_loadu_si256((const __m256i*)(src + i)), scale);
+        _mm256_storeu_si256((__m256i*)(dst + i), BlendAVX2(d, s, mode));
+    }
+    BlendPixelSpanScalar(dst + i, src + i, count - i, opacity, mode);
+}
+
+#endif // BLEND_X86
+
+//------------------------------------------------------------------------------
+// Public API
+//------------------------------------------------------------------------------
+
+/**
+ * Get the name of a blend mode as a string
+ */
+const char* GetPixelBlendModeName(PixelBlendMode mode) {
+    switch (mode) {
+        case PIXEL_BLEND_REPLACE:
+            return "Replace";
+        case PIXEL_BLEND_NORMAL:
+            return "Normal";
+        case PIXEL_BLEND_MULTIPLY:
+            return "Multiply";
+        case PIXEL_BLEND_SCREEN:
+            return "Screen";
+        case PIXEL_BLEND_ADD:
+            return "Add";
+        default:
+            return "Unknown";
+    }
+}
+
+/**
+ * Blend one source color over one destination color
+ */
+Color BlendColors(Color dst, Color src, PixelBlendMode mode) {
+    if (mode == PIXEL_BLEND_REPLACE) return src;
+    return BlendPixel(dst, src, mode);
+}
+
+/**
+ * Blend one source color over a run of pixels
+ */
+void BlendColorSpan(Color* pixels, size_t count, Color src, PixelBlendMode mode) {
+    if (pixels == NULL) return;
+
+    // Replacing, or covering fully with Normal, is a plain fill;
+    // a transparent source leaves every pixel as it is
+    if (mode == PIXEL_BLEND_REPLACE || (mode == PIXEL_BLEND_NORMAL && src.a == 255)) {
+        FillPixels(pixels, count, src);
+        return;
+    }
+    if (src.a == 0) return;
+
+    switch (GetPixelOpsBackend()) {
+#ifdef BLEND_X86
+        case PIXELOPS_AVX2:
+            BlendColorSpanAVX2(pixels, count, src, mode);
+            break;
+        case PIXELOPS_SSE2:
+            BlendColorSpanSSE2(pixels, count, src, mode);
+            break;
+#endif
+        default:
+            BlendColorSpanScalar(pixels, count, src, mode);
+            break;
+    }
+}
+
+/**
+ * Blend a run of source pixels over a run of destination pixels
+ */
+void BlendPixelSpan(Color* dst, const Color* src, size_t count, unsigned char opacity, PixelBlendMode mode) {
+    if (dst == NULL || src == NULL) return;
+
+    if (mode == PIXEL_BLEND_REPLACE) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = ScaleAlpha(src[i], opacity);
+        }
+        return;
+    }
+    if (opacity == 0) return;
+
+    switch (GetPixelOpsBackend()) {
+#ifdef BLEND_X86
+        case PIXELOPS_AVX2:
+            BlendPixelSpanAVX2(dst, src, count, opacity, mode);
+            break;
+        case PIXELOPS_SSE2:
+            BlendPixelSpanSSE2(dst, src, count, opacity, mode);
+            break;
+#endif
+        default:
+            BlendPixelSpanScalar(dst, src, count, opacity, mode);
+            break;
+    }
+}
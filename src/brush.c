@@ -0,0 +1,228 @@
+/**
+ * brush.c
+ *
+ * Implementation of Brush Engine
+ */
+
+#include "brush.h"
+#include <stdlib.h>
+
+/**
+ * Build a brush from a coverage mask
+ */
+static Brush* BuildBrush(BrushShape shape, const unsigned char* mask, int width, int height) {
+    Brush* brush = (Brush*)calloc(1, sizeof(Brush));
+    if (brush == NULL) return NULL;
+
+    brush->shape = shape;
+    brush->width = width;
+    brush->height = height;
+    brush->originX = width / 2;
+    brush->originY = height / 2;
+
+    // A row of width w has at most (w + 1) / 2 separate runs
+    brush->spans = (BrushSpan*)malloc(sizeof(BrushSpan) * height * ((width + 1) / 2));
+    brush->rowStart = (int*)malloc(sizeof(int) * (height + 1));
+    if (brush->spans == NULL || brush->rowStart == NULL) {
+        DestroyBrush(brush);
+        return NULL;
+    }
+
+    for (int row = 0; row < height; row++) {
+        brush->rowStart[row] = brush->spanCount;
+        const unsigned char* line = mask + row * width;
+
+        int col = 0;
+        while (col < width) {
+            if (!line[col]) {
+                col++;
+                continue;
+            }
+            int start = col;
+            while (col < width && line[col]) col++;
+            brush->spans[brush->spanCount++] = (BrushSpan){start - brush->originX, col - 1 - brush->originX};
+        }
+    }
+    brush->rowStart[height] = brush->spanCount;
+
+    if (brush->spanCount == 0) {
+        DestroyBrush(brush);
+        return NULL;
+    }
+
+    return brush;
+}
+
+/**
+ * Create a round or square brush
+ */
+Brush* CreateBrush(BrushShape shape, int size) {
+    if (size < MIN_BRUSH_SIZE) size = MIN_BRUSH_SIZE;
+    if (size > MAX_BRUSH_SIZE) size = MAX_BRUSH_SIZE;
+    if (shape != BRUSH_ROUND && shape != BRUSH_SQUARE) shape = BRUSH_ROUND;
+
+    unsigned char mask[MAX_BRUSH_SIZE * MAX_BRUSH_SIZE];
+    float radius = size / 2.0f;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            bool covered = true;
+            if (shape == BRUSH_ROUND) {
+                // Sample pixel centers against the circle inscribed in the square
+                float dx = x + 0.5f - radius;
+                float dy = y + 0.5f - radius;
+                covered = (dx * dx + dy * dy) <= radius * radius;
+            }
+            mask[y * size + x] = covered ? 1 : 0;
+        }
+    }
+
+    return BuildBrush(shape, mask, size, size);
+}
+
+/**
+ * Create a brush from a mask
+ */
+Brush* CreateCustomBrush(const unsigned char* mask, int width, int height) {
+    if (mask == NULL || width < 1 || height < 1 ||
+        width > MAX_BRUSH_SIZE || height > MAX_BRUSH_SIZE) {
+        return NULL;
+    }
+    return BuildBrush(BRUSH_CUSTOM, mask, width, height);
+}
+
+/**
+ * Destroy brush and free memory
+ */
+void DestroyBrush(Brush* brush) {
+    if (brush == NULL) return;
+    free(brush->spans);
+    free(brush->rowStart);
+    free(brush);
+}
+
+/**
+ * Check whether a brush covers exactly one pixel
+ */
+bool IsSinglePixelBrush(const Brush* brush) {
+    return brush != NULL && brush->width == 1 && brush->height == 1 && brush->spanCount == 1;
+}
+
+/**
+ * Shared state for stamping along a path
+ */
+typedef struct {
+    const Brush* brush;
+    int clipMinX, clipMinY, clipMaxX, clipMaxY;
+    RasterSpanCallback callback;
+    void* userData;
+    int previousX;      // Position of the most recent stamp
+    int previousY;
+    int spanCount;
+} StampContext;
+
+/**
+ * Emit the part of a horizontal run that is inside the clip rectangle
+ */
+static void EmitClipped(StampContext* context, int y, int x0, int x1) {
+    if (x0 < context->clipMinX) x0 = context->clipMinX;
+    if (x1 > context->clipMaxX) x1 = context->clipMaxX;
+    if (x0 > x1) return;
+
+    context->callback(context->userData, (RasterSpan){x0, y, x1 - x0 + 1, false, 1});
+    context->spanCount++;
+}
+
+/**
+ * Stamp at (x, y), skipping pixels covered by a stamp at (prevX, prevY)
+ */
+static void StampDelta(StampContext* context, int x, int y, bool hasPrevious, int prevX, int prevY) {
+    const Brush* brush = context->brush;
+
+    int firstRow = 0;
+    int lastRow = brush->height - 1;
+    if (y - brush->originY < context->clipMinY) firstRow = context->clipMinY - (y - brush->originY);
+    if (y - brush->originY + lastRow > context->clipMaxY) lastRow = context->clipMaxY - (y - brush->originY);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        int canvasY = y - brush->originY + row;
+
+        // Mask row of the previous stamp that lands on the same canvas row
+        int prevRow = canvasY - prevY + brush->originY;
+        bool overlaps = hasPrevious && prevRow >= 0 && prevRow < brush->height;
+        int prevFirst = overlaps ? brush->rowStart[prevRow] : 0;
+        int prevLast = overlaps ? brush->rowStart[prevRow + 1] : 0;
+
+        for (int i = brush->rowStart[row]; i < brush->rowStart[row + 1]; i++) {
+            int a = x + brush->spans[i].x0;
+            int b = x + brush->spans[i].x1;
+
+            // Subtract the previous stamp's runs (both lists are sorted)
+            int pos = a;
+            for (int j = prevFirst; j < prevLast && pos <= b; j++) {
+                int c = prevX + brush->spans[j].x0;
+                int d = prevX + brush->spans[j].x1;
+                if (d < pos) continue;
+                if (c > b) break;
+                if (c > pos) EmitClipped(context, canvasY, pos, c - 1);
+                pos = d + 1;
+            }
+            if (pos <= b) EmitClipped(context, canvasY, pos, b);
+        }
+    }
+}
+
+/**
+ * Stamp the brush once and emit the covered spans
+ */
+int StampBrush(const Brush* brush, int x, int y,
+               int clipMinX, int clipMinY, int clipMaxX, int clipMaxY,
+               RasterSpanCallback callback, void* userData) {
+    if (brush == NULL || callback == NULL) return 0;
+
+    StampContext context = {brush, clipMinX, clipMinY, clipMaxX, clipMaxY, callback, userData, x, y, 0};
+    StampDelta(&context, x, y, false, 0, 0);
+    return context.spanCount;
+}
+
+/**
+ * Path callback: stamp at every point of a rasterized center-line span
+ */
+static void StampPathSpan(void* userData, RasterSpan span) {
+    StampContext* context = (StampContext*)userData;
+
+    for (int i = 0; i < span.length; i++) {
+        int offset = (span.step > 0) ? i : span.length - 1 - i;
+        int x = span.vertical ? span.x : span.x + offset;
+        int y = span.vertical ? span.y + offset : span.y;
+
+        // The segment start was stamped by the previous segment
+        if (x == context->previousX && y == context->previousY) continue;
+
+        StampDelta(context, x, y, true, context->previousX, context->previousY);
+        context->previousX = x;
+        context->previousY = y;
+    }
+}
+
+/**
+ * Stamp the brush at every step of a line, excluding the start point
+ */
+int StampBrushLine(const Brush* brush, int x0, int y0, int x1, int y1,
+                   int clipMinX, int clipMinY, int clipMaxX, int clipMaxY,
+                   RasterSpanCallback callback, void* userData) {
+    if (brush == NULL || callback == NULL) return 0;
+
+    StampContext context = {brush, clipMinX, clipMinY, clipMaxX, clipMaxY, callback, userData, x0, y0, 0};
+
+    // Only stamp positions whose mask can reach the clip rectangle
+    int centerMinX = clipMinX - (brush->width - 1 - brush->originX);
+    int centerMaxX = clipMaxX + brush->originX;
+    int centerMinY = clipMinY - (brush->height - 1 - brush->originY);
+    int centerMaxY = clipMaxY + brush->originY;
+
+    RasterizeLine(x0, y0, x1, y1, centerMinX, centerMinY, centerMaxX, centerMaxY,
+                  StampPathSpan, &context);
+
+    return context.spanCount;
+}
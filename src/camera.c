@@ -5,6 +5,8 @@
  */
 
 #include "camera.h"
+#include "redraw.h"
+#include "input.h"
 #include "raylib.h"
 #include "raymath.h"
 #include <stdlib.h>
@@ -12,7 +14,7 @@
 
 // Default camera settings
 #define DEFAULT_ZOOM 1.0f
-#define DEFAULT_MIN_ZOOM 0.5f
+#define DEFAULT_MIN_ZOOM (1.0f / 128.0f)  // Mip levels keep zoomed-out views cheap
 #define DEFAULT_MAX_ZOOM 16.0f
 #define ZOOM_INCREMENT 1.1f  // 10% per scroll tick
 
@@ -54,6 +56,7 @@ void PanCanvasCamera(CanvasCamera* camera, Vector2 delta) {
 
     camera->position.x += delta.x;
     camera->position.y += delta.y;
+    RequestRedraw(REDRAW_CAMERA);
 }
 
 /**
@@ -100,6 +103,7 @@ void ZoomCanvasCamera(CanvasCamera* camera, float zoomFactor, Vector2 centerScre
 
     camera->position.x += worldDiff.x * camera->zoom;
     camera->position.y += worldDiff.y * camera->zoom;
+    RequestRedraw(REDRAW_CAMERA);
 }
 
 /**
@@ -111,6 +115,7 @@ void ResetCanvasCamera(CanvasCamera* camera) {
     camera->position = (Vector2){0.0f, 0.0f};
     camera->zoom = DEFAULT_ZOOM;
     camera->isPanning = false;
+    RequestRedraw(REDRAW_CAMERA);
 }
 
 /**
@@ -118,7 +123,8 @@ void ResetCanvasCamera(CanvasCamera* camera) {
  */
 int GetCanvasCameraZoomPercent(CanvasCamera* camera) {
     if (camera == NULL) return 100;
-    return (int)(camera->zoom * 100.0f);
+    int percent = (int)(camera->zoom * 100.0f + 0.5f);
+    return (percent > 0) ? percent : 1;  // Never show 0% at the deepest zoom levels
 }
 
 /**
@@ -130,31 +136,37 @@ void UpdateCanvasCamera(CanvasCamera* camera) {
     // --- Handle Pan Input ---
 
     // Check if panning should start
-    bool middleMousePressed = IsMouseButtonPressed(MOUSE_BUTTON_MIDDLE);
-    bool spacebarAndLeftMousePressed = IsKeyDown(KEY_SPACE) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    bool middleMousePressed = IsInputMouseButtonPressed(MOUSE_BUTTON_MIDDLE);
+    bool spacebarAndLeftMousePressed = IsInputKeyDown(KEY_SPACE) && IsInputMouseButtonPressed(MOUSE_BUTTON_LEFT);
 
     if (middleMousePressed || spacebarAndLeftMousePressed) {
         camera->isPanning = true;
-        camera->panStartPos = GetMousePosition();
+        camera->panStartPos = GetInputMousePosition();
         camera->camStartPos = camera->position;
     }
 
     // Check if panning should continue
-    bool middleMouseDown = IsMouseButtonDown(MOUSE_BUTTON_MIDDLE);
-    bool spacebarAndLeftMouseDown = IsKeyDown(KEY_SPACE) && IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+    bool middleMouseDown = IsInputMouseButtonDown(MOUSE_BUTTON_MIDDLE);
+    bool spacebarAndLeftMouseDown = IsInputKeyDown(KEY_SPACE) && IsInputMouseButtonDown(MOUSE_BUTTON_LEFT);
 
     if (camera->isPanning) {
         if (middleMouseDown || spacebarAndLeftMouseDown) {
             // Calculate pan delta
-            Vector2 currentMousePos = GetMousePosition();
+            Vector2 currentMousePos = GetInputMousePosition();
             Vector2 mouseDelta = {
                 currentMousePos.x - camera->panStartPos.x,
                 currentMousePos.y - camera->panStartPos.y
             };
 
             // Update camera position (relative to starting position)
-            camera->position.x = camera->camStartPos.x + mouseDelta.x;
-            camera->position.y = camera->camStartPos.y + mouseDelta.y;
+            Vector2 newPosition = {
+                camera->camStartPos.x + mouseDelta.x,
+                camera->camStartPos.y + mouseDelta.y
+            };
+            if (newPosition.x != camera->position.x || newPosition.y != camera->position.y) {
+                camera->position = newPosition;
+                RequestRedraw(REDRAW_CAMERA);
+            }
         } else {
             // Stop panning if mouse button released
             camera->isPanning = false;
@@ -163,19 +175,19 @@ void UpdateCanvasCamera(CanvasCamera* camera) {
 
     // --- Handle Zoom Input ---
 
-    float wheelMove = GetMouseWheelMove();
+    float wheelMove = GetInputMouseWheelMove();
     if (wheelMove != 0.0f) {
         // Determine zoom factor based on scroll direction
         float zoomFactor = (wheelMove > 0) ? ZOOM_INCREMENT : (1.0f / ZOOM_INCREMENT);
 
         // Zoom centered on mouse cursor
-        Vector2 mousePos = GetMousePosition();
+        Vector2 mousePos = GetInputMousePosition();
         ZoomCanvasCamera(camera, zoomFactor, mousePos);
     }
 
     // --- Handle Reset (optional: R key to reset camera) ---
 
-    if (IsKeyPressed(KEY_R)) {
+    if (IsInputKeyPressed(KEY_R)) {
         ResetCanvasCamera(camera);
     }
 }
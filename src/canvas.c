@@ -1,10 +1,54 @@
 #include "canvas.h"
+#include "mipmap.h"
+#include "pixelops.h"
+#include "rlgl.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Tile pixel buffers carry a reference count in front of the pixels so
+// snapshots can share them with the canvas. Writers copy a shared buffer
+// before modifying it; the last owner to let go frees it, from any thread.
+typedef struct {
+    int refs;
+    int reserved[7];        // Keeps the pixels as aligned as the allocation itself
+} TileBufferHeader;
+
+// Tile buffers allocated by all canvases since startup (for stress reports)
+static size_t tileAllocationCount = 0;
+
+static Color* AllocTileBuffer(void) {
+    TileBufferHeader* header = (TileBufferHeader*)malloc(sizeof(TileBufferHeader) + sizeof(Color) * CANVAS_TILE_PIXELS);
+    if (!header) {
+        return NULL;
+    }
+    __atomic_fetch_add(&tileAllocationCount, 1, __ATOMIC_RELAXED);
+    header->refs = 1;
+    return (Color*)(header + 1);
+}
+
+static void RetainTileBuffer(const Color* pixels) {
+    TileBufferHeader* header = (TileBufferHeader*)pixels - 1;
+    __atomic_fetch_add(&header->refs, 1, __ATOMIC_RELAXED);
+}
+
+static void ReleaseTileBuffer(const Color* pixels) {
+    TileBufferHeader* header = (TileBufferHeader*)pixels - 1;
+    if (__atomic_sub_fetch(&header->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(header);
+    }
+}
+
+static bool IsTileBufferShared(const Color* pixels) {
+    const TileBufferHeader* header = (const TileBufferHeader*)pixels - 1;
+    return __atomic_load_n(&header->refs, __ATOMIC_ACQUIRE) > 1;
+}
+
 // Create a new canvas with specified dimensions
+// Only the tile grid is allocated up front; pixel storage is created per tile
+// on first write, so memory scales with the painted area
 Canvas* CreateCanvas(int width, int height) {
-    if (width <= 0 || height <= 0) {
+    if (width <= 0 || height <= 0 || width > CANVAS_MAX_SIZE || height > CANVAS_MAX_SIZE) {
         return NULL;
     }
 
@@ -15,15 +59,33 @@ Canvas* CreateCanvas(int width, int height) {
 
     canvas->width = width;
     canvas->height = height;
-    canvas->pixels = (Color*)malloc(sizeof(Color) * width * height);
+    canvas->tilesX = (width + CANVAS_TILE_MASK) >> CANVAS_TILE_SHIFT;
+    canvas->tilesY = (height + CANVAS_TILE_MASK) >> CANVAS_TILE_SHIFT;
+    canvas->tiles = (CanvasTile*)calloc((size_t)canvas->tilesX * canvas->tilesY, sizeof(CanvasTile));
+    canvas->allocatedTiles = 0;
+    canvas->dirtyTiles = NULL;
+    canvas->dirtyCount = 0;
+    canvas->dirtyCapacity = 0;
+    canvas->uploadBuffer = NULL;
+    canvas->onTileWrite = NULL;
+    canvas->onTileWriteUserData = NULL;
+    canvas->writeSession = 0;
+    canvas->isTrackingWrites = false;
+    canvas->tileLoader = NULL;
+    canvas->tileLoaderUserData = NULL;
+    canvas->pendingTiles = 0;
+    canvas->mipmap = NULL;
+    canvas->drawCalls = 0;
+    canvas->textureUploads = 0;
 
-    if (!canvas->pixels) {
+    if (!canvas->tiles) {
         free(canvas);
         return NULL;
     }
 
-    // Initialize all pixels to transparent white
-    ClearCanvas(canvas, (Color){255, 255, 255, 0});
+    // Initialize all pixels to transparent (the same value the eraser writes,
+    // so erasing untouched areas never allocates tiles)
+    ClearCanvas(canvas, (Color){0, 0, 0, 0});
 
     return canvas;
 }
@@ -31,32 +93,432 @@ Canvas* CreateCanvas(int width, int height) {
 // Free canvas memory
 void DestroyCanvas(Canvas* canvas) {
     if (canvas) {
-        if (canvas->pixels) {
-            free(canvas->pixels);
+        if (canvas->tiles) {
+            size_t tileCount = (size_t)canvas->tilesX * canvas->tilesY;
+            for (size_t i = 0; i < tileCount; i++) {
+                if (canvas->tiles[i].hasTexture) {
+                    UnloadTexture(canvas->tiles[i].texture);
+                }
+                if (canvas->tiles[i].pixels) {
+                    ReleaseTileBuffer(canvas->tiles[i].pixels);
+                }
+            }
+            free(canvas->tiles);
         }
+        DestroyCanvasMipmap(canvas->mipmap);
+        free(canvas->dirtyTiles);
+        free(canvas->uploadBuffer);
         free(canvas);
     }
 }
 
+// Forget the stored contents of a pending tile without loading them
+static void DropPendingTile(Canvas* canvas, CanvasTile* tile) {
+    if (tile->isPending) {
+        tile->isPending = false;
+        canvas->pendingTiles--;
+    }
+}
+
+// Load a pending tile through the tile loader (no-op for other tiles)
+static void LoadPendingTile(Canvas* canvas, int tileIndex) {
+    CanvasTile* tile = &canvas->tiles[tileIndex];
+    if (!tile->isPending) {
+        return;
+    }
+    DropPendingTile(canvas, tile);
+
+    Color* pixels = AllocTileBuffer();
+    if (!pixels) {
+        return;
+    }
+    if (!canvas->tileLoader || !canvas->tileLoader(canvas->tileLoaderUserData, canvas, tileIndex, pixels)) {
+        ReleaseTileBuffer(pixels);
+        return;
+    }
+    tile->pixels = pixels;
+    canvas->allocatedTiles++;
+}
+
+// Pixels of a tile for reading, loading it first if pending (NULL if empty)
+static Color* GetTile(Canvas* canvas, int tileIndex) {
+    LoadPendingTile(canvas, tileIndex);
+    return canvas->tiles[tileIndex].pixels;
+}
+
+// Release the pixel storage of a tile so it reads as the canvas empty color
+static void ReleaseTile(Canvas* canvas, CanvasTile* tile) {
+    DropPendingTile(canvas, tile);
+    if (tile->hasTexture) {
+        UnloadTexture(tile->texture);
+        tile->hasTexture = false;
+    }
+    if (tile->pixels) {
+        ReleaseTileBuffer(tile->pixels);
+        tile->pixels = NULL;
+        canvas->allocatedTiles--;
+    }
+}
+
 // Clear the entire canvas with a color
+// Releases all tile storage; the color becomes the canvas empty color
 void ClearCanvas(Canvas* canvas, Color color) {
-    if (!canvas || !canvas->pixels) {
+    if (!canvas || !canvas->tiles) {
         return;
     }
 
-    for (int i = 0; i < canvas->width * canvas->height; i++) {
-        canvas->pixels[i] = color;
+    size_t tileCount = (size_t)canvas->tilesX * canvas->tilesY;
+    for (size_t i = 0; i < tileCount; i++) {
+        ReleaseTile(canvas, &canvas->tiles[i]);
+        canvas->tiles[i].isDirty = false;
+    }
+    canvas->dirtyCount = 0;
+    canvas->emptyColor = color;
+    ClearCanvasMipmap(canvas->mipmap, color);
+}
+
+// Queue a tile-local rectangle for upload to the tile's texture
+static void QueueTileUpload(Canvas* canvas, int tileIndex, int minX, int minY, int maxX, int maxY) {
+    CanvasTile* tile = &canvas->tiles[tileIndex];
+
+    if (tile->isDirty) {
+        if (minX < tile->dirtyMinX) tile->dirtyMinX = (unsigned short)minX;
+        if (minY < tile->dirtyMinY) tile->dirtyMinY = (unsigned short)minY;
+        if (maxX > tile->dirtyMaxX) tile->dirtyMaxX = (unsigned short)maxX;
+        if (maxY > tile->dirtyMaxY) tile->dirtyMaxY = (unsigned short)maxY;
+        return;
+    }
+
+    if (canvas->dirtyCount == canvas->dirtyCapacity) {
+        int capacity = canvas->dirtyCapacity ? canvas->dirtyCapacity * 2 : 64;
+        int* list = (int*)realloc(canvas->dirtyTiles, sizeof(int) * capacity);
+        if (!list) {
+            return;
+        }
+        canvas->dirtyTiles = list;
+        canvas->dirtyCapacity = capacity;
+    }
+
+    canvas->dirtyTiles[canvas->dirtyCount++] = tileIndex;
+    tile->isDirty = true;
+    tile->dirtyMinX = (unsigned short)minX;
+    tile->dirtyMinY = (unsigned short)minY;
+    tile->dirtyMaxX = (unsigned short)maxX;
+    tile->dirtyMaxY = (unsigned short)maxY;
+}
+
+// Record a change to a tile's pixels: queue the upload and flag the tile
+// for the mip levels
+static void MarkTileDirty(Canvas* canvas, int tileIndex, int minX, int minY, int maxX, int maxY) {
+    if (canvas->mipmap) {
+        MarkCanvasMipmapTile(canvas->mipmap, tileIndex, minX, minY, maxX, maxY);
+    }
+    QueueTileUpload(canvas, tileIndex, minX, minY, maxX, maxY);
+}
+
+// Get the pixel storage of a tile for writing, allocating it on first write
+// New tiles start filled with the canvas empty color; tiles shared with a
+// snapshot are copied first so the snapshot keeps its pixels
+static Color* AcquireTile(Canvas* canvas, int tileIndex) {
+    CanvasTile* tile = &canvas->tiles[tileIndex];
+    LoadPendingTile(canvas, tileIndex);
+    if (tile->pixels) {
+        if (IsTileBufferShared(tile->pixels)) {
+            Color* copy = AllocTileBuffer();
+            if (!copy) {
+                return NULL;
+            }
+            memcpy(copy, tile->pixels, sizeof(Color) * CANVAS_TILE_PIXELS);
+            ReleaseTileBuffer(tile->pixels);
+            tile->pixels = copy;
+        }
+        return tile->pixels;
+    }
+
+    tile->pixels = AllocTileBuffer();
+    if (!tile->pixels) {
+        return NULL;
+    }
+    FillPixels(tile->pixels, CANVAS_TILE_PIXELS, canvas->emptyColor);
+    canvas->allocatedTiles++;
+
+    return tile->pixels;
+}
+
+// Report the first modification of a tile in the current write session
+// A pending tile is loaded first so the observer sees its real contents
+static void NotifyTileWrite(Canvas* canvas, int tileIndex) {
+    CanvasTile* tile = &canvas->tiles[tileIndex];
+    LoadPendingTile(canvas, tileIndex);
+    if (canvas->isTrackingWrites && tile->writeSession != canvas->writeSession) {
+        tile->writeSession = canvas->writeSession;
+        if (canvas->onTileWrite) {
+            canvas->onTileWrite(canvas->onTileWriteUserData, canvas, tileIndex);
+        }
     }
 }
 
+static bool ColorsEqual(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
 // Set a pixel at the given coordinates
 void SetPixel(Canvas* canvas, int x, int y, Color color) {
     if (!IsValidPixelCoord(canvas, x, y)) {
         return;
     }
 
-    int index = y * canvas->width + x;
-    canvas->pixels[index] = color;
+    int tileIndex = GetCanvasTileIndex(canvas, x, y);
+
+    // Writing the empty color into an empty tile changes nothing
+    if (!GetTile(canvas, tileIndex) && ColorsEqual(color, canvas->emptyColor)) {
+        return;
+    }
+
+    NotifyTileWrite(canvas, tileIndex);
+
+    Color* pixels = AcquireTile(canvas, tileIndex);
+    if (!pixels) {
+        return;
+    }
+
+    int localX = x & CANVAS_TILE_MASK;
+    int localY = y & CANVAS_TILE_MASK;
+    pixels[(localY << CANVAS_TILE_SHIFT) + localX] = color;
+
+    MarkTileDirty(canvas, tileIndex, localX, localY, localX, localY);
+}
+
+// Clip a run (position .. position + length - 1, length > 0) to 0 .. size - 1
+// The end is computed in long long since callers may pass any position and length
+static bool ClipCanvasRun(int position, int length, int size, int* start, int* end) {
+    long long runEnd = (long long)position + length;
+    *start = (position < 0) ? 0 : position;
+    *end = (runEnd > size) ? size : (int)runEnd;
+    return *start < *end;
+}
+
+// Fill a horizontal run of pixels (x .. x + length - 1) on row y
+void FillCanvasSpan(Canvas* canvas, int x, int y, int length, Color color) {
+    if (!canvas || y < 0 || y >= canvas->height || length <= 0) {
+        return;
+    }
+
+    // Clip to the canvas
+    int start;
+    int end; // Exclusive
+    if (!ClipCanvasRun(x, length, canvas->width, &start, &end)) {
+        return;
+    }
+
+    int localY = y & CANVAS_TILE_MASK;
+    while (start < end) {
+        int tileIndex = GetCanvasTileIndex(canvas, start, y);
+        int localX = start & CANVAS_TILE_MASK;
+        int count = CANVAS_TILE_SIZE - localX;
+        if (count > end - start) {
+            count = end - start;
+        }
+
+        if (GetTile(canvas, tileIndex) || !ColorsEqual(color, canvas->emptyColor)) {
+            NotifyTileWrite(canvas, tileIndex);
+            Color* pixels = AcquireTile(canvas, tileIndex);
+            if (!pixels) {
+                return;
+            }
+
+            FillPixels(pixels + (localY << CANVAS_TILE_SHIFT) + localX, count, color);
+            MarkTileDirty(canvas, tileIndex, localX, localY, localX + count - 1, localY);
+        }
+
+        start += count;
+    }
+}
+
+// Fill a vertical run of pixels (y .. y + length - 1) on column x
+void FillCanvasColumn(Canvas* canvas, int x, int y, int length, Color color) {
+    if (!canvas || x < 0 || x >= canvas->width || length <= 0) {
+        return;
+    }
+
+    // Clip to the canvas
+    int start;
+    int end; // Exclusive
+    if (!ClipCanvasRun(y, length, canvas->height, &start, &end)) {
+        return;
+    }
+
+    int localX = x & CANVAS_TILE_MASK;
+    while (start < end) {
+        int tileIndex = GetCanvasTileIndex(canvas, x, start);
+        int localY = start & CANVAS_TILE_MASK;
+        int count = CANVAS_TILE_SIZE - localY;
+        if (count > end - start) {
+            count = end - start;
+        }
+
+        if (GetTile(canvas, tileIndex) || !ColorsEqual(color, canvas->emptyColor)) {
+            NotifyTileWrite(canvas, tileIndex);
+            Color* pixels = AcquireTile(canvas, tileIndex);
+            if (!pixels) {
+                return;
+            }
+
+            Color* cell = pixels + (localY << CANVAS_TILE_SHIFT) + localX;
+            for (int i = 0; i < count; i++) {
+                cell[i << CANVAS_TILE_SHIFT] = color;
+            }
+            MarkTileDirty(canvas, tileIndex, localX, localY, localX, localY + count - 1);
+        }
+
+        start += count;
+    }
+}
+
+// Whether blending a color changes nothing, or is the same as writing it
+static bool IsBlendNoOp(Color color, PixelBlendMode mode) {
+    return mode != PIXEL_BLEND_REPLACE && color.a == 0;
+}
+
+static bool IsBlendOverwrite(Color color, PixelBlendMode mode) {
+    return mode == PIXEL_BLEND_REPLACE || (mode == PIXEL_BLEND_NORMAL && color.a == 255);
+}
+
+// Blend a color over a horizontal run of pixels (x .. x + length - 1) on row y
+void BlendCanvasSpan(Canvas* canvas, int x, int y, int length, Color color, PixelBlendMode mode) {
+    if (IsBlendOverwrite(color, mode)) {
+        FillCanvasSpan(canvas, x, y, length, color);
+        return;
+    }
+    if (!canvas || y < 0 || y >= canvas->height || length <= 0 || IsBlendNoOp(color, mode)) {
+        return;
+    }
+
+    // Clip to the canvas
+    int start;
+    int end; // Exclusive
+    if (!ClipCanvasRun(x, length, canvas->width, &start, &end)) {
+        return;
+    }
+
+    int localY = y & CANVAS_TILE_MASK;
+    while (start < end) {
+        int tileIndex = GetCanvasTileIndex(canvas, start, y);
+        int localX = start & CANVAS_TILE_MASK;
+        int count = CANVAS_TILE_SIZE - localX;
+        if (count > end - start) {
+            count = end - start;
+        }
+
+        NotifyTileWrite(canvas, tileIndex);
+        Color* pixels = AcquireTile(canvas, tileIndex);
+        if (!pixels) {
+            return;
+        }
+
+        BlendColorSpan(pixels + (localY << CANVAS_TILE_SHIFT) + localX, count, color, mode);
+        MarkTileDirty(canvas, tileIndex, localX, localY, localX + count - 1, localY);
+
+        start += count;
+    }
+}
+
+// Blend a color over a vertical run of pixels (y .. y + length - 1) on column x
+void BlendCanvasColumn(Canvas* canvas, int x, int y, int length, Color color, PixelBlendMode mode) {
+    if (IsBlendOverwrite(color, mode)) {
+        FillCanvasColumn(canvas, x, y, length, color);
+        return;
+    }
+    if (!canvas || x < 0 || x >= canvas->width || length <= 0 || IsBlendNoOp(color, mode)) {
+        return;
+    }
+
+    // Clip to the canvas
+    int start;
+    int end; // Exclusive
+    if (!ClipCanvasRun(y, length, canvas->height, &start, &end)) {
+        return;
+    }
+
+    int localX = x & CANVAS_TILE_MASK;
+    while (start < end) {
+        int tileIndex = GetCanvasTileIndex(canvas, x, start);
+        int localY = start & CANVAS_TILE_MASK;
+        int count = CANVAS_TILE_SIZE - localY;
+        if (count > end - start) {
+            count = end - start;
+        }
+
+        NotifyTileWrite(canvas, tileIndex);
+        Color* pixels = AcquireTile(canvas, tileIndex);
+        if (!pixels) {
+            return;
+        }
+
+        Color* cell = pixels + (localY << CANVAS_TILE_SHIFT) + localX;
+        for (int i = 0; i < count; i++) {
+            cell[i << CANVAS_TILE_SHIFT] = BlendColors(cell[i << CANVAS_TILE_SHIFT], color, mode);
+        }
+        MarkTileDirty(canvas, tileIndex, localX, localY, localX, localY + count - 1);
+
+        start += count;
+    }
+}
+
+// Replace every pixel within tolerance of one color (0 = exact match)
+// Tiles without a match are only read; empty tiles are allocated only when
+// the empty color itself matches. Returns the number of pixels replaced.
+size_t ReplaceCanvasColor(Canvas* canvas, Color from, Color to, unsigned char tolerance) {
+    if (!canvas || !canvas->tiles) {
+        return 0;
+    }
+
+    Color emptyColor = canvas->emptyColor;
+    bool emptyMatches = CountMatchingPixels(&emptyColor, 1, from, tolerance) > 0;
+    size_t replaced = 0;
+
+    for (int tileY = 0; tileY < canvas->tilesY; tileY++) {
+        for (int tileX = 0; tileX < canvas->tilesX; tileX++) {
+            int tileIndex = tileY * canvas->tilesX + tileX;
+            Color* tilePixels = GetTile(canvas, tileIndex);
+
+            // Part of the tile inside the canvas
+            int width = canvas->width - (tileX << CANVAS_TILE_SHIFT);
+            int height = canvas->height - (tileY << CANVAS_TILE_SHIFT);
+            if (width > CANVAS_TILE_SIZE) width = CANVAS_TILE_SIZE;
+            if (height > CANVAS_TILE_SIZE) height = CANVAS_TILE_SIZE;
+
+            if (tilePixels) {
+                // Skip tiles with nothing to replace (no snapshot, no upload)
+                bool found = false;
+                for (int y = 0; y < height && !found; y++) {
+                    found = CountMatchingPixels(tilePixels + (y << CANVAS_TILE_SHIFT), width, from, tolerance) > 0;
+                }
+                if (!found) {
+                    continue;
+                }
+            } else if (!emptyMatches || ColorsEqual(to, emptyColor)) {
+                continue;
+            }
+
+            NotifyTileWrite(canvas, tileIndex);
+            Color* pixels = AcquireTile(canvas, tileIndex);
+            if (!pixels) {
+                return replaced;
+            }
+
+            if (width == CANVAS_TILE_SIZE) {
+                replaced += ReplacePixelsTolerance(pixels, (size_t)height << CANVAS_TILE_SHIFT, from, to, tolerance);
+            } else {
+                for (int y = 0; y < height; y++) {
+                    replaced += ReplacePixelsTolerance(pixels + (y << CANVAS_TILE_SHIFT), width, from, to, tolerance);
+                }
+            }
+            MarkTileDirty(canvas, tileIndex, 0, 0, width - 1, height - 1);
+        }
+    }
+
+    return replaced;
 }
 
 // Get a pixel color at the given coordinates
@@ -65,8 +527,12 @@ Color GetPixel(Canvas* canvas, int x, int y) {
         return (Color){0, 0, 0, 0};
     }
 
-    int index = y * canvas->width + x;
-    return canvas->pixels[index];
+    Color* pixels = GetTile(canvas, GetCanvasTileIndex(canvas, x, y));
+    if (!pixels) {
+        return canvas->emptyColor;
+    }
+
+    return pixels[((y & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT) + (x & CANVAS_TILE_MASK)];
 }
 
 // Check if pixel coordinates are within canvas bounds
@@ -77,6 +543,416 @@ bool IsValidPixelCoord(Canvas* canvas, int x, int y) {
     return (x >= 0 && x < canvas->width && y >= 0 && y < canvas->height);
 }
 
+// Get the index of the tile containing a (valid) pixel coordinate
+int GetCanvasTileIndex(Canvas* canvas, int x, int y) {
+    return (y >> CANVAS_TILE_SHIFT) * canvas->tilesX + (x >> CANVAS_TILE_SHIFT);
+}
+
+// Get read-only access to a tile's pixels (NULL if the tile is empty)
+// A pending tile is loaded first
+Color* GetCanvasTilePixels(Canvas* canvas, int tileIndex) {
+    if (!canvas || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) {
+        return NULL;
+    }
+    return GetTile(canvas, tileIndex);
+}
+
+// Get writable access to a tile's pixels, allocating the tile if needed
+// Bypasses write tracking and dirty marking; the caller marks what it changed
+Color* AcquireCanvasTilePixels(Canvas* canvas, int tileIndex) {
+    if (!canvas || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) {
+        return NULL;
+    }
+    return AcquireTile(canvas, tileIndex);
+}
+
+// Replace the full contents of a tile (NULL releases it back to the empty color)
+// Used to restore snapshots, so it bypasses write tracking
+void RestoreCanvasTile(Canvas* canvas, int tileIndex, const Color* pixels) {
+    if (!canvas || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) {
+        return;
+    }
+
+    if (pixels) {
+        DropPendingTile(canvas, &canvas->tiles[tileIndex]); // Overwritten anyway
+        Color* dest = AcquireTile(canvas, tileIndex);
+        if (!dest) {
+            return;
+        }
+        memcpy(dest, pixels, sizeof(Color) * CANVAS_TILE_PIXELS);
+    } else {
+        ReleaseTile(canvas, &canvas->tiles[tileIndex]);
+    }
+
+    MarkTileDirty(canvas, tileIndex, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK);
+}
+
+// Copy a full row of the canvas out of tile storage (bulk reading)
+// Unallocated tiles read as the empty color
+void ReadCanvasRow(Canvas* canvas, int y, Color* row) {
+    if (!canvas || !row || y < 0 || y >= canvas->height) {
+        return;
+    }
+
+    int tileRow = (y >> CANVAS_TILE_SHIFT) * canvas->tilesX;
+    int localY = y & CANVAS_TILE_MASK;
+    for (int tx = 0; tx < canvas->tilesX; tx++) {
+        int x0 = tx << CANVAS_TILE_SHIFT;
+        int count = (canvas->width - x0 < CANVAS_TILE_SIZE) ? canvas->width - x0 : CANVAS_TILE_SIZE;
+        const Color* pixels = GetTile(canvas, tileRow + tx);
+        if (pixels) {
+            memcpy(row + x0, pixels + (localY << CANVAS_TILE_SHIFT), sizeof(Color) * count);
+        } else {
+            FillPixels(row + x0, count, canvas->emptyColor);
+        }
+    }
+}
+
+// Copy a full row of pixels into tile storage (bulk loading)
+// Spans matching the empty color leave unallocated tiles empty, so
+// transparent areas of an imported image cost no memory. Bypasses write
+// tracking and dirty marking like AcquireCanvasTilePixels.
+bool WriteCanvasRow(Canvas* canvas, int y, const Color* row) {
+    if (!canvas || !row || y < 0 || y >= canvas->height) {
+        return false;
+    }
+
+    int tileRow = (y >> CANVAS_TILE_SHIFT) * canvas->tilesX;
+    int localY = y & CANVAS_TILE_MASK;
+    for (int tx = 0; tx < canvas->tilesX; tx++) {
+        int x0 = tx << CANVAS_TILE_SHIFT;
+        int count = (canvas->width - x0 < CANVAS_TILE_SIZE) ? canvas->width - x0 : CANVAS_TILE_SIZE;
+        if (!GetTile(canvas, tileRow + tx) &&
+            CountMatchingPixels(row + x0, count, canvas->emptyColor, 0) == (size_t)count) {
+            continue;
+        }
+
+        Color* pixels = AcquireTile(canvas, tileRow + tx);
+        if (!pixels) {
+            return false;
+        }
+        memcpy(pixels + (localY << CANVAS_TILE_SHIFT), row + x0, sizeof(Color) * count);
+    }
+    return true;
+}
+
+// Make a tile reference another canvas's tile storage instead of a copy
+// Both canvases must have the same tile grid. Whichever canvas writes to the
+// tile next gets its own copy, so neither sees the other's later edits.
+// Bypasses write tracking and dirty marking like AcquireCanvasTilePixels.
+void ShareCanvasTile(Canvas* canvas, int tileIndex, Canvas* source) {
+    if (!canvas || !source || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY ||
+        tileIndex >= source->tilesX * source->tilesY) {
+        return;
+    }
+
+    CanvasTile* tile = &canvas->tiles[tileIndex];
+    Color* pixels = GetTile(source, tileIndex);
+    DropPendingTile(canvas, tile);
+    if (tile->pixels == pixels) {
+        return;
+    }
+
+    if (tile->pixels) {
+        ReleaseTileBuffer(tile->pixels);
+        canvas->allocatedTiles--;
+    }
+    if (pixels) {
+        RetainTileBuffer(pixels);
+        canvas->allocatedTiles++;
+    }
+    tile->pixels = pixels;
+}
+
+// Set the function that fills pending tiles on first access
+void SetCanvasTileLoader(Canvas* canvas, CanvasTileLoader loader, void* userData) {
+    if (!canvas) {
+        return;
+    }
+    canvas->tileLoader = loader;
+    canvas->tileLoaderUserData = userData;
+}
+
+// Release a tile's pixels and leave its contents to the tile loader
+void SetCanvasTilePending(Canvas* canvas, int tileIndex) {
+    if (!canvas || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) {
+        return;
+    }
+
+    CanvasTile* tile = &canvas->tiles[tileIndex];
+    ReleaseTile(canvas, tile);
+    tile->isPending = true;
+    canvas->pendingTiles++;
+    if (canvas->mipmap) {
+        MarkCanvasMipmapTile(canvas->mipmap, tileIndex, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK);
+    }
+}
+
+// Whether a tile has not been loaded yet
+bool IsCanvasTilePending(Canvas* canvas, int tileIndex) {
+    if (!canvas || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) {
+        return false;
+    }
+    return canvas->tiles[tileIndex].isPending;
+}
+
+// Whether a tile has pixels, loaded or pending (without loading it)
+bool HasCanvasTileData(Canvas* canvas, int tileIndex) {
+    if (!canvas || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) {
+        return false;
+    }
+    return canvas->tiles[tileIndex].pixels || canvas->tiles[tileIndex].isPending;
+}
+
+// Load every pending tile
+void LoadCanvasTiles(Canvas* canvas) {
+    if (!canvas || canvas->pendingTiles == 0) {
+        return;
+    }
+
+    int tileCount = canvas->tilesX * canvas->tilesY;
+    for (int i = 0; i < tileCount && canvas->pendingTiles > 0; i++) {
+        LoadPendingTile(canvas, i);
+    }
+}
+
+// Capture the current pixels without copying them
+// The snapshot shares tile buffers with the canvas; the canvas copies a tile
+// the next time it writes to it, so later edits never show in the snapshot
+CanvasSnapshot* CreateCanvasSnapshot(Canvas* canvas) {
+    if (!canvas || !canvas->tiles) {
+        return NULL;
+    }
+
+    // Other threads read the snapshot, so nothing may load lazily later
+    LoadCanvasTiles(canvas);
+
+    CanvasSnapshot* snapshot = (CanvasSnapshot*)malloc(sizeof(CanvasSnapshot));
+    if (!snapshot) {
+        return NULL;
+    }
+
+    size_t tileCount = (size_t)canvas->tilesX * canvas->tilesY;
+    snapshot->tiles = (const Color**)malloc(sizeof(Color*) * tileCount);
+    if (!snapshot->tiles) {
+        free(snapshot);
+        return NULL;
+    }
+
+    snapshot->width = canvas->width;
+    snapshot->height = canvas->height;
+    snapshot->tilesX = canvas->tilesX;
+    snapshot->tilesY = canvas->tilesY;
+    snapshot->emptyColor = canvas->emptyColor;
+    for (size_t i = 0; i < tileCount; i++) {
+        snapshot->tiles[i] = canvas->tiles[i].pixels;
+        if (snapshot->tiles[i]) {
+            RetainTileBuffer(snapshot->tiles[i]);
+        }
+    }
+
+    return snapshot;
+}
+
+// Release a snapshot (safe on any thread, before or after the canvas is gone)
+void DestroyCanvasSnapshot(CanvasSnapshot* snapshot) {
+    if (!snapshot) {
+        return;
+    }
+
+    size_t tileCount = (size_t)snapshot->tilesX * snapshot->tilesY;
+    for (size_t i = 0; i < tileCount; i++) {
+        if (snapshot->tiles[i]) {
+            ReleaseTileBuffer(snapshot->tiles[i]);
+        }
+    }
+    free(snapshot->tiles);
+    free(snapshot);
+}
+
+// Copy one row of a snapshot (width pixels) into a buffer
+void ReadCanvasSnapshotRow(const CanvasSnapshot* snapshot, int y, Color* row) {
+    if (!snapshot || !row || y < 0 || y >= snapshot->height) {
+        return;
+    }
+
+    int tileRow = (y >> CANVAS_TILE_SHIFT) * snapshot->tilesX;
+    int localY = y & CANVAS_TILE_MASK;
+    for (int tx = 0; tx < snapshot->tilesX; tx++) {
+        int x0 = tx << CANVAS_TILE_SHIFT;
+        int count = (snapshot->width - x0 < CANVAS_TILE_SIZE) ? snapshot->width - x0 : CANVAS_TILE_SIZE;
+        const Color* pixels = snapshot->tiles[tileRow + tx];
+        if (pixels) {
+            memcpy(row + x0, pixels + (localY << CANVAS_TILE_SHIFT), sizeof(Color) * count);
+        } else {
+            FillPixels(row + x0, count, snapshot->emptyColor);
+        }
+    }
+}
+
+// Register the observer notified before tiles are first written in a session
+void SetCanvasTileWriteCallback(Canvas* canvas, CanvasTileWriteCallback callback, void* userData) {
+    if (!canvas) {
+        return;
+    }
+    canvas->onTileWrite = callback;
+    canvas->onTileWriteUserData = userData;
+}
+
+// Start a write session: each tile is reported once on its first write
+void BeginCanvasWriteSession(Canvas* canvas) {
+    if (!canvas) {
+        return;
+    }
+    canvas->writeSession++;
+    if (canvas->writeSession == 0) {
+        // Counter wrapped: forget old stamps so no tile is skipped by accident
+        size_t tileCount = (size_t)canvas->tilesX * canvas->tilesY;
+        for (size_t i = 0; i < tileCount; i++) {
+            canvas->tiles[i].writeSession = 0;
+        }
+        canvas->writeSession = 1;
+    }
+    canvas->isTrackingWrites = true;
+}
+
+// End the current write session
+void EndCanvasWriteSession(Canvas* canvas) {
+    if (!canvas) {
+        return;
+    }
+    canvas->isTrackingWrites = false;
+}
+
+// Get the number of bytes used for pixel storage and tile bookkeeping
+size_t GetCanvasMemoryUsage(Canvas* canvas) {
+    if (!canvas) {
+        return 0;
+    }
+    return canvas->allocatedTiles * sizeof(Color) * CANVAS_TILE_PIXELS +
+           (size_t)canvas->tilesX * canvas->tilesY * sizeof(CanvasTile) +
+           GetCanvasMipmapMemoryUsage(canvas->mipmap);
+}
+
+// Get the number of tile buffers allocated by all canvases so far
+size_t GetCanvasTileAllocationCount(void) {
+    return __atomic_load_n(&tileAllocationCount, __ATOMIC_RELAXED);
+}
+
+// Mark a rectangular region as needing upload to the texture mirror
+void MarkCanvasDirty(Canvas* canvas, int x, int y, int width, int height) {
+    if (!canvas || width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Clip to canvas bounds
+    int minX, minY, endX, endY;
+    if (!ClipCanvasRun(x, width, canvas->width, &minX, &endX) ||
+        !ClipCanvasRun(y, height, canvas->height, &minY, &endY)) {
+        return;
+    }
+    int maxX = endX - 1;
+    int maxY = endY - 1;
+
+    for (int ty = minY >> CANVAS_TILE_SHIFT; ty <= (maxY >> CANVAS_TILE_SHIFT); ty++) {
+        for (int tx = minX >> CANVAS_TILE_SHIFT; tx <= (maxX >> CANVAS_TILE_SHIFT); tx++) {
+            int tileX0 = tx << CANVAS_TILE_SHIFT;
+            int tileY0 = ty << CANVAS_TILE_SHIFT;
+            int localMinX = (minX > tileX0) ? minX - tileX0 : 0;
+            int localMinY = (minY > tileY0) ? minY - tileY0 : 0;
+            int localMaxX = (maxX < tileX0 + CANVAS_TILE_MASK) ? maxX - tileX0 : CANVAS_TILE_MASK;
+            int localMaxY = (maxY < tileY0 + CANVAS_TILE_MASK) ? maxY - tileY0 : CANVAS_TILE_MASK;
+            MarkTileDirty(canvas, ty * canvas->tilesX + tx, localMinX, localMinY, localMaxX, localMaxY);
+        }
+    }
+}
+
+// Push pending pixel changes to the GPU tile textures
+// Only tiles on the dirty list are visited, and each uploads only its dirty rectangle
+void SyncCanvasTexture(Canvas* canvas) {
+    if (!canvas) {
+        return;
+    }
+
+    int remaining = 0;
+    for (int i = 0; i < canvas->dirtyCount; i++) {
+        int tileIndex = canvas->dirtyTiles[i];
+        CanvasTile* tile = &canvas->tiles[tileIndex];
+
+        if (!tile->pixels) {
+            // Tile was never allocated (empty color region), nothing to upload
+            tile->isDirty = false;
+            continue;
+        }
+
+        if (!tile->hasTexture) {
+            Image image = {
+                .data = tile->pixels,
+                .width = CANVAS_TILE_SIZE,
+                .height = CANVAS_TILE_SIZE,
+                .mipmaps = 1,
+                .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+            };
+            tile->texture = LoadTextureFromImage(image);
+            if (tile->texture.id == 0) {
+                canvas->dirtyTiles[remaining++] = tileIndex; // Retry next frame
+                continue;
+            }
+            SetTextureFilter(tile->texture, TEXTURE_FILTER_POINT);
+            tile->hasTexture = true;
+            canvas->textureUploads++;
+            tile->isDirty = false; // Full contents were just uploaded
+            continue;
+        }
+
+        int rectWidth = tile->dirtyMaxX - tile->dirtyMinX + 1;
+        int rectHeight = tile->dirtyMaxY - tile->dirtyMinY + 1;
+        Rectangle rect = {
+            (float)tile->dirtyMinX, (float)tile->dirtyMinY,
+            (float)rectWidth, (float)rectHeight
+        };
+
+        if (rectWidth == CANVAS_TILE_SIZE) {
+            // Full-width rows are already contiguous in the tile
+            UpdateTextureRec(tile->texture, rect,
+                             tile->pixels + (tile->dirtyMinY << CANVAS_TILE_SHIFT));
+        } else {
+            // Pack the dirty rows into the staging buffer
+            if (!canvas->uploadBuffer) {
+                canvas->uploadBuffer = (Color*)malloc(sizeof(Color) * CANVAS_TILE_PIXELS);
+                if (!canvas->uploadBuffer) {
+                    canvas->dirtyTiles[remaining++] = tileIndex; // Retry next frame
+                    continue;
+                }
+            }
+
+            for (int row = 0; row < rectHeight; row++) {
+                memcpy(canvas->uploadBuffer + row * rectWidth,
+                       tile->pixels + ((tile->dirtyMinY + row) << CANVAS_TILE_SHIFT) + tile->dirtyMinX,
+                       sizeof(Color) * rectWidth);
+            }
+            UpdateTextureRec(tile->texture, rect, canvas->uploadBuffer);
+        }
+
+        tile->isDirty = false;
+        canvas->textureUploads++;
+    }
+    canvas->dirtyCount = remaining;
+}
+
+// Drop all pending dirty regions without uploading them
+// For canvases that are never drawn directly (e.g. layers feeding a composite)
+void ClearCanvasDirtyTiles(Canvas* canvas) {
+    if (!canvas) {
+        return;
+    }
+
+    for (int i = 0; i < canvas->dirtyCount; i++) {
+        canvas->tiles[canvas->dirtyTiles[i]].isDirty = false;
+    }
+    canvas->dirtyCount = 0;
+}
+
 // Convert pixel coordinates to screen coordinates
 Vector2 PixelToScreen(int pixelX, int pixelY, Vector2 canvasOffset, float zoom, int pixelSize) {
     Vector2 screenPos;
@@ -93,73 +969,261 @@ Vector2 ScreenToPixel(int screenX, int screenY, Vector2 canvasOffset, float zoom
     return pixelPos;
 }
 
+// Get the canvas pixels that are at least partly inside a screen of the given size
+// Returns false when no pixel is on screen
+bool GetVisibleCanvasRegion(int width, int height, Vector2 canvasOffset, float zoom, int pixelSize,
+                            int screenWidth, int screenHeight, CanvasRegion* region) {
+    float scale = pixelSize * zoom;
+    if (!region || scale <= 0.0f || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    // Clamp in floating point first: far off-screen values do not fit an int
+    float minX = floorf(-canvasOffset.x / scale);
+    float minY = floorf(-canvasOffset.y / scale);
+    float maxX = ceilf((screenWidth - canvasOffset.x) / scale) - 1.0f;
+    float maxY = ceilf((screenHeight - canvasOffset.y) / scale) - 1.0f;
+    if (minX < 0.0f) minX = 0.0f;
+    if (minY < 0.0f) minY = 0.0f;
+    if (maxX > width - 1) maxX = (float)(width - 1);
+    if (maxY > height - 1) maxY = (float)(height - 1);
+    if (minX > maxX || minY > maxY) {
+        return false;
+    }
+
+    region->minX = (int)minX;
+    region->minY = (int)minY;
+    region->maxX = (int)maxX;
+    region->maxY = (int)maxY;
+    return true;
+}
+
+// Cached 2x2-cell checker pattern, tiled across the canvas with texture repeat
+#define CHECKER_SIZE 8 // Size of checker squares in canvas pixels
+static Texture2D checkerTexture = {0};
+static bool hasCheckerTexture = false;
+
 // Draw checkerboard pattern for transparency background
-void DrawCheckerboardBackground(int x, int y, int width, int height, int pixelSize, float zoom) {
-    const int checkerSize = 8; // Size of checker squares in pixels
+// The pattern is one wrapped texture drawn as a single quad, clipped to the
+// part of the canvas that is on screen
+void DrawCheckerboardBackground(Vector2 offset, int width, int height, int pixelSize, float zoom) {
     const Color lightGray = (Color){200, 200, 200, 255};
     const Color darkGray = (Color){170, 170, 170, 255};
 
-    int scaledPixelSize = (int)(pixelSize * zoom);
+    if (!hasCheckerTexture) {
+        Image image = GenImageChecked(CHECKER_SIZE * 2, CHECKER_SIZE * 2,
+                                      CHECKER_SIZE, CHECKER_SIZE, lightGray, darkGray);
+        checkerTexture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        if (checkerTexture.id == 0) {
+            return;
+        }
+        SetTextureFilter(checkerTexture, TEXTURE_FILTER_POINT);
+        SetTextureWrap(checkerTexture, TEXTURE_WRAP_REPEAT);
+        hasCheckerTexture = true;
+    }
 
-    // Calculate how many checker squares fit in the canvas
-    int checkersWide = (width + checkerSize - 1) / checkerSize;
-    int checkersHigh = (height + checkerSize - 1) / checkerSize;
+    float scale = pixelSize * zoom;
+    if (scale <= 0.0f) {
+        return;
+    }
 
-    for (int cy = 0; cy < checkersHigh; cy++) {
-        for (int cx = 0; cx < checkersWide; cx++) {
-            // Determine checker color (alternating pattern)
-            Color checkerColor = ((cx + cy) % 2 == 0) ? lightGray : darkGray;
+    // Intersect the canvas screen rectangle with the screen
+    float left = (offset.x > 0.0f) ? offset.x : 0.0f;
+    float top = (offset.y > 0.0f) ? offset.y : 0.0f;
+    float right = offset.x + width * scale;
+    float bottom = offset.y + height * scale;
+    if (right > GetScreenWidth()) right = (float)GetScreenWidth();
+    if (bottom > GetScreenHeight()) bottom = (float)GetScreenHeight();
+    if (left >= right || top >= bottom) {
+        return;
+    }
 
-            // Calculate screen position and size for this checker square
-            int checkerPixelX = cx * checkerSize;
-            int checkerPixelY = cy * checkerSize;
+    // One texel of the checker texture covers one canvas pixel
+    Rectangle source = {
+        (left - offset.x) / scale, (top - offset.y) / scale,
+        (right - left) / scale, (bottom - top) / scale
+    };
+    Rectangle dest = {left, top, right - left, bottom - top};
+    DrawTexturePro(checkerTexture, source, dest, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+}
 
-            int screenX = x + (int)(checkerPixelX * scaledPixelSize);
-            int screenY = y + (int)(checkerPixelY * scaledPixelSize);
+// Release the shared checkerboard texture (call before closing the window)
+void UnloadCheckerboardTexture(void) {
+    if (hasCheckerTexture) {
+        UnloadTexture(checkerTexture);
+        hasCheckerTexture = false;
+    }
+}
 
-            // Calculate actual size (handle edge cases where checker extends beyond canvas)
-            int checkerWidthPixels = checkerSize;
-            int checkerHeightPixels = checkerSize;
+// Draw a one pixel outline just outside the canvas
+// Each edge is clipped to the screen, and edges off screen are skipped
+void DrawCanvasBorder(Vector2 offset, int width, int height, int pixelSize, float zoom, Color color) {
+    float scale = pixelSize * zoom;
+    if (scale <= 0.0f) {
+        return;
+    }
 
-            if (checkerPixelX + checkerSize > width) {
-                checkerWidthPixels = width - checkerPixelX;
-            }
-            if (checkerPixelY + checkerSize > height) {
-                checkerHeightPixels = height - checkerPixelY;
+    // Rows and columns of the four edges, kept in floating point because
+    // a far zoomed-in canvas can extend beyond the int range
+    float left = floorf(offset.x) - 1.0f;
+    float top = floorf(offset.y) - 1.0f;
+    float right = floorf(offset.x) + floorf(width * scale);
+    float bottom = floorf(offset.y) + floorf(height * scale);
+    float screenWidth = (float)GetScreenWidth();
+    float screenHeight = (float)GetScreenHeight();
+    if (right < 0.0f || bottom < 0.0f || left >= screenWidth || top >= screenHeight) {
+        return;
+    }
+
+    int x0 = (int)fmaxf(left, 0.0f);
+    int y0 = (int)fmaxf(top, 0.0f);
+    int x1 = (int)fminf(right, screenWidth - 1.0f);
+    int y1 = (int)fminf(bottom, screenHeight - 1.0f);
+    if (top >= 0.0f) DrawRectangle(x0, (int)top, x1 - x0 + 1, 1, color);
+    if (bottom < screenHeight) DrawRectangle(x0, (int)bottom, x1 - x0 + 1, 1, color);
+    if (left >= 0.0f) DrawRectangle((int)left, y0, 1, y1 - y0 + 1, color);
+    if (right < screenWidth) DrawRectangle((int)right, y0, 1, y1 - y0 + 1, color);
+}
+
+// Draw lines between canvas pixels once they are CANVAS_GRID_MIN_SCALE
+// screen pixels or larger
+// Only the lines crossing the visible pixels are emitted, all in one batch
+void DrawCanvasPixelGrid(Vector2 offset, int width, int height, int pixelSize, float zoom, Color color) {
+    float scale = pixelSize * zoom;
+    CanvasRegion visible;
+    if (scale < CANVAS_GRID_MIN_SCALE ||
+        !GetVisibleCanvasRegion(width, height, offset, zoom, pixelSize, GetScreenWidth(), GetScreenHeight(), &visible)) {
+        return;
+    }
+
+    // Line ends stop at the visible part of the canvas
+    float top = fmaxf(offset.y + visible.minY * scale, 0.0f);
+    float bottom = fminf(offset.y + (visible.maxY + 1) * scale, (float)GetScreenHeight());
+    float left = fmaxf(offset.x + visible.minX * scale, 0.0f);
+    float right = fminf(offset.x + (visible.maxX + 1) * scale, (float)GetScreenWidth());
+
+    // Inner edges only: the canvas border covers the outer ones
+    int firstX = (visible.minX > 0) ? visible.minX : 1;
+    int firstY = (visible.minY > 0) ? visible.minY : 1;
+    int lastX = (visible.maxX < width - 1) ? visible.maxX + 1 : width - 1;
+    int lastY = (visible.maxY < height - 1) ? visible.maxY + 1 : height - 1;
+    int lineCount = (lastX - firstX + 1) + (lastY - firstY + 1);
+    if (lineCount <= 0) {
+        return;
+    }
+
+    rlCheckRenderBatchLimit(lineCount * 2);
+    rlBegin(RL_LINES);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for (int x = firstX; x <= lastX; x++) {
+        // Half-pixel centers keep one-pixel lines on one screen column
+        float screenX = floorf(offset.x + x * scale) + 0.5f;
+        rlVertex2f(screenX, top);
+        rlVertex2f(screenX, bottom);
+    }
+    for (int y = firstY; y <= lastY; y++) {
+        float screenY = floorf(offset.y + y * scale) + 0.5f;
+        rlVertex2f(left, screenY);
+        rlVertex2f(right, screenY);
+    }
+    rlEnd();
+}
+
+// Draw one canvas (full size or a mip level) as one quad per tile
+static void DrawCanvasLevel(Canvas* canvas, Vector2 offset, float zoom, int pixelSize) {
+    // First, draw the checkerboard background
+    DrawCheckerboardBackground(offset, canvas->width, canvas->height, pixelSize, zoom);
+    canvas->drawCalls = 1;
+    canvas->textureUploads = 0;
+
+    // Only the tiles under the visible pixels are loaded, uploaded and drawn
+    CanvasRegion visible;
+    if (!GetVisibleCanvasRegion(canvas->width, canvas->height, offset, zoom, pixelSize,
+                                GetScreenWidth(), GetScreenHeight(), &visible)) {
+        return;
+    }
+    float scale = pixelSize * zoom;
+    int minTileX = visible.minX >> CANVAS_TILE_SHIFT;
+    int minTileY = visible.minY >> CANVAS_TILE_SHIFT;
+    int maxTileX = visible.maxX >> CANVAS_TILE_SHIFT;
+    int maxTileY = visible.maxY >> CANVAS_TILE_SHIFT;
+
+    // Pending tiles load once they come on screen; a tile that got pixels
+    // without a texture (loaded by a read since the last frame) is queued
+    for (int ty = minTileY; ty <= maxTileY; ty++) {
+        for (int tx = minTileX; tx <= maxTileX; tx++) {
+            int tileIndex = ty * canvas->tilesX + tx;
+            CanvasTile* tile = &canvas->tiles[tileIndex];
+            if (GetTile(canvas, tileIndex) && !tile->hasTexture && !tile->isDirty) {
+                QueueTileUpload(canvas, tileIndex, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK);
             }
+        }
+    }
 
-            int screenWidth = checkerWidthPixels * scaledPixelSize;
-            int screenHeight = checkerHeightPixels * scaledPixelSize;
+    // Off-screen tiles that have no texture yet do not need one: the loop
+    // above queues them in full once they come into view
+    int remaining = 0;
+    for (int i = 0; i < canvas->dirtyCount; i++) {
+        int tileIndex = canvas->dirtyTiles[i];
+        CanvasTile* tile = &canvas->tiles[tileIndex];
+        int tx = tileIndex % canvas->tilesX;
+        int ty = tileIndex / canvas->tilesX;
+        if (!tile->hasTexture && (tx < minTileX || tx > maxTileX || ty < minTileY || ty > maxTileY)) {
+            tile->isDirty = false;
+        } else {
+            canvas->dirtyTiles[remaining++] = tileIndex;
+        }
+    }
+    canvas->dirtyCount = remaining;
+
+    // Upload this frame's changes, then draw each visible tile as one quad
+    SyncCanvasTexture(canvas);
+
+    for (int ty = minTileY; ty <= maxTileY; ty++) {
+        for (int tx = minTileX; tx <= maxTileX; tx++) {
+            CanvasTile* tile = &canvas->tiles[ty * canvas->tilesX + tx];
+
+            // Edge tiles only show the part that lies inside the canvas
+            int tileX0 = tx << CANVAS_TILE_SHIFT;
+            int tileY0 = ty << CANVAS_TILE_SHIFT;
+            int tileWidth = (canvas->width - tileX0 < CANVAS_TILE_SIZE) ? canvas->width - tileX0 : CANVAS_TILE_SIZE;
+            int tileHeight = (canvas->height - tileY0 < CANVAS_TILE_SIZE) ? canvas->height - tileY0 : CANVAS_TILE_SIZE;
+
+            // Compute both edges from pixel coordinates so neighbouring tiles meet exactly
+            float x0 = offset.x + tileX0 * scale;
+            float y0 = offset.y + tileY0 * scale;
+            Rectangle dest = {
+                x0, y0,
+                offset.x + (tileX0 + tileWidth) * scale - x0,
+                offset.y + (tileY0 + tileHeight) * scale - y0
+            };
 
-            DrawRectangle(screenX, screenY, screenWidth, screenHeight, checkerColor);
+            if (tile->hasTexture) {
+                Rectangle source = {0.0f, 0.0f, (float)tileWidth, (float)tileHeight};
+                DrawTexturePro(tile->texture, source, dest, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+                canvas->drawCalls++;
+            } else if (!tile->pixels && canvas->emptyColor.a > 0) {
+                DrawRectangleRec(dest, canvas->emptyColor);
+                canvas->drawCalls++;
+            }
         }
     }
 }
 
 // Draw the canvas to the screen
+// At half size or less a mip level is drawn instead, so a zoomed-out view
+// costs about one texel per screen pixel however large the canvas is
 void DrawCanvas(Canvas* canvas, Vector2 offset, float zoom, int pixelSize) {
-    if (!canvas || !canvas->pixels) {
+    if (!canvas || !canvas->tiles) {
         return;
     }
 
-    int scaledPixelSize = (int)(pixelSize * zoom);
-
-    // First, draw the checkerboard background
-    DrawCheckerboardBackground((int)offset.x, (int)offset.y,
-                              canvas->width, canvas->height,
-                              pixelSize, zoom);
-
-    // Then draw each pixel
-    for (int y = 0; y < canvas->height; y++) {
-        for (int x = 0; x < canvas->width; x++) {
-            Color pixelColor = GetPixel(canvas, x, y);
-
-            // Only draw non-fully-transparent pixels
-            if (pixelColor.a > 0) {
-                Vector2 screenPos = PixelToScreen(x, y, offset, zoom, pixelSize);
-                DrawRectangle((int)screenPos.x, (int)screenPos.y,
-                            scaledPixelSize, scaledPixelSize, pixelColor);
-            }
-        }
+    int level = 0;
+    Canvas* source = GetCanvasDrawLevel(canvas, pixelSize * zoom, &level);
+    DrawCanvasLevel(source, offset, zoom * (float)(1 << level), pixelSize);
+    if (source != canvas) {
+        canvas->drawCalls = source->drawCalls;
+        canvas->textureUploads = source->textureUploads;
     }
 }
@@ -0,0 +1,142 @@
+/**
+ * codec.c
+ *
+ * Implementation of Pixel Compression
+ */
+
+#include "codec.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RLE_MAX_PACKET 128
+
+static bool PixelsEqual(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+/**
+ * Compress pixels with run-length encoding
+ */
+unsigned char* CompressPixelsRLE(const Color* pixels, size_t count, size_t* outSize) {
+    if (pixels == NULL || outSize == NULL) return NULL;
+
+    // Worst case: every packet is a full literal packet plus its header
+    size_t bound = count * sizeof(Color) + (count + RLE_MAX_PACKET - 1) / RLE_MAX_PACKET + 1;
+    unsigned char* out = (unsigned char*)malloc(bound);
+    if (out == NULL) return NULL;
+
+    size_t pos = 0;
+    size_t i = 0;
+    while (i < count) {
+        // Measure the run starting at i
+        size_t run = 1;
+        while (i + run < count && run < RLE_MAX_PACKET && PixelsEqual(pixels[i + run], pixels[i])) {
+            run++;
+        }
+
+        if (run >= 2) {
+            out[pos++] = (unsigned char)(0x80 | (run - 1));
+            memcpy(out + pos, &pixels[i], sizeof(Color));
+            pos += sizeof(Color);
+            i += run;
+            continue;
+        }
+
+        // Collect literals until the next run of at least two pixels
+        size_t start = i;
+        size_t literals = 0;
+        while (i < count && literals < RLE_MAX_PACKET) {
+            if (i + 1 < count && PixelsEqual(pixels[i], pixels[i + 1])) break;
+            i++;
+            literals++;
+        }
+
+        out[pos++] = (unsigned char)(literals - 1);
+        memcpy(out + pos, &pixels[start], literals * sizeof(Color));
+        pos += literals * sizeof(Color);
+    }
+
+    // Give back the unused worst-case slack
+    unsigned char* shrunk = (unsigned char*)realloc(out, pos ? pos : 1);
+    if (shrunk != NULL) out = shrunk;
+
+    *outSize = pos;
+    return out;
+}
+
+/**
+ * Decompress run-length encoded pixels
+ */
+bool DecompressPixelsRLE(const unsigned char* data, size_t size, Color* pixels, size_t count) {
+    if (data == NULL || pixels == NULL) return false;
+
+    size_t pos = 0;
+    size_t written = 0;
+    while (pos < size) {
+        unsigned char header = data[pos++];
+        size_t length = (size_t)(header & 0x7F) + 1;
+        if (written + length > count) return false;
+
+        if (header & 0x80) {
+            if (pos + sizeof(Color) > size) return false;
+            Color color;
+            memcpy(&color, data + pos, sizeof(Color));
+            pos += sizeof(Color);
+            for (size_t i = 0; i < length; i++) {
+                pixels[written + i] = color;
+            }
+        } else {
+            if (pos + length * sizeof(Color) > size) return false;
+            memcpy(pixels + written, data + pos, length * sizeof(Color));
+            pos += length * sizeof(Color);
+        }
+        written += length;
+    }
+
+    return written == count;
+}
+
+/**
+ * CRC-32 of every 4-bit value; two lookups per byte keep the table small
+ * enough to be a constant, so the checksum is safe to use from any thread
+ */
+static const unsigned int crcNibbleTable[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+
+/**
+ * Continue a CRC-32 over more data
+ */
+unsigned int UpdateCrc32(unsigned int crc, const unsigned char* data, size_t size) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        crc = crcNibbleTable[crc & 0x0F] ^ (crc >> 4);
+        crc = crcNibbleTable[crc & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+/**
+ * Continue an Adler-32 checksum over more data
+ */
+unsigned int UpdateAdler32(unsigned int adler, const unsigned char* data, size_t size) {
+    // 5552 is the most bytes that can be summed before the 32-bit sums overflow
+    const unsigned int modulus = 65521u;
+    unsigned int a = adler & 0xFFFF;
+    unsigned int b = adler >> 16;
+
+    while (size > 0) {
+        size_t block = (size > 5552) ? 5552 : size;
+        size -= block;
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        data += block;
+        a %= modulus;
+        b %= modulus;
+    }
+    return (b << 16) | a;
+}
@@ -0,0 +1,113 @@
+/**
+ * editor.c
+ *
+ * Implementation of Editor Shortcuts
+ */
+
+#include "editor.h"
+#include "input.h"
+#include "redraw.h"
+
+// Where DrawColorSwatches draws in the main window
+static const Rectangle swatchArea = {10, 55, 50, 50};
+
+/**
+ * Check whether either Ctrl key is down
+ */
+static bool IsControlDown(void) {
+    return IsInputKeyDown(KEY_LEFT_CONTROL) || IsInputKeyDown(KEY_RIGHT_CONTROL);
+}
+
+/**
+ * Check whether either Shift key is down
+ */
+static bool IsShiftDown(void) {
+    return IsInputKeyDown(KEY_LEFT_SHIFT) || IsInputKeyDown(KEY_RIGHT_SHIFT);
+}
+
+/**
+ * Toggle or open the color picker
+ */
+void UpdateColorPickerShortcuts(ColorPicker* picker, ToolState* toolState) {
+    if (picker == NULL) return;
+
+    // Toggle color picker with C key
+    if (IsInputKeyPressed(KEY_C)) {
+        ToggleColorPicker(picker);
+        // If opening, sync with current foreground color
+        if (picker->isOpen && toolState != NULL) {
+            SetColorPickerColor(picker, GetForegroundColor(toolState));
+        }
+    }
+
+    // Handle clicking on color swatches to open picker
+    if (IsInputMouseButtonPressed(MOUSE_BUTTON_LEFT) &&
+        CheckCollisionPointRec(GetInputMousePosition(), swatchArea) &&
+        !picker->isOpen) {
+        ToggleColorPicker(picker);
+        if (toolState != NULL) {
+            SetColorPickerColor(picker, GetForegroundColor(toolState));
+        }
+    }
+}
+
+/**
+ * Undo or redo one history step
+ */
+bool UpdateHistoryShortcuts(History* history, ToolState* toolState) {
+    if (history == NULL || toolState == NULL || toolState->isDrawing || !IsControlDown()) return false;
+
+    if (IsInputKeyPressed(KEY_Y) || (IsShiftDown() && IsInputKeyPressed(KEY_Z))) {
+        RedoHistory(history);
+        return true;
+    }
+    if (IsInputKeyPressed(KEY_Z)) {
+        UndoHistory(history);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Add, delete, select, move or restyle layers
+ */
+bool UpdateLayerShortcuts(LayerStack* layers, History* history, ToolState* toolState) {
+    if (layers == NULL || (toolState != NULL && toolState->isDrawing)) return false;
+    if (IsControlDown()) return false;
+
+    int active = layers->activeIndex;
+    Layer* layer = GetActiveLayer(layers);
+    bool changed = false;
+
+    if (IsInputKeyPressed(KEY_N)) {
+        changed |= AddLayer(layers, NULL) >= 0;
+    } else if (IsInputKeyPressed(KEY_DELETE)) {
+        changed |= DeleteLayer(layers, active, history);
+    } else if (IsInputKeyPressed(KEY_PAGE_UP) || IsInputKeyPressed(KEY_PAGE_DOWN)) {
+        int target = active + (IsInputKeyPressed(KEY_PAGE_UP) ? 1 : -1);
+        if (IsShiftDown()) {
+            changed |= MoveLayer(layers, active, target);
+        } else {
+            SelectLayer(layers, target);
+            changed |= layers->activeIndex != active;
+        }
+    } else if (IsInputKeyPressed(KEY_V)) {
+        SetLayerVisible(layers, active, !layer->visible);
+        changed = true;
+    } else if (IsInputKeyPressed(KEY_O)) {
+        // Cycle 100% -> 75% -> 50% -> 25% -> 100%
+        unsigned char opacity = (layer->opacity > 192) ? 192 : (layer->opacity > 128) ? 128 :
+                                (layer->opacity > 64) ? 64 : 255;
+        SetLayerOpacity(layers, active, opacity);
+        changed = true;
+    } else if (IsInputKeyPressed(KEY_L)) {
+        PixelBlendMode mode = (PixelBlendMode)(layer->blendMode + 1);
+        SetLayerBlendMode(layers, active, (mode >= PIXEL_BLEND_COUNT) ? PIXEL_BLEND_NORMAL : mode);
+        changed = true;
+    }
+
+    if (changed) {
+        RequestRedraw(REDRAW_UI);
+    }
+    return changed;
+}
@@ -0,0 +1,143 @@
+/**
+ * export.c
+ *
+ * Implementation of Background Image Export
+ */
+
+#include "export.h"
+#include "pngio.h"
+#include "timing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Encode the snapshot row by row (runs on the export thread)
+ * Publishes progress after every row and the final status last, with
+ * release ordering so finishTime is visible once the status is
+ */
+static void RunPngExport(void* userData) {
+    ExportJob* job = (ExportJob*)userData;
+    CanvasSnapshot* snapshot = job->snapshot;
+    ExportStatus status = EXPORT_FAILED;
+
+    Color* row = (Color*)malloc(sizeof(Color) * snapshot->width);
+    PngWriter* writer = (row != NULL) ? CreatePngWriter(job->tempPath, snapshot->width, snapshot->height) : NULL;
+
+    if (writer != NULL) {
+        bool ok = true;
+        for (int y = 0; y < snapshot->height && ok; y++) {
+            if (__atomic_load_n(&job->cancelRequested, __ATOMIC_RELAXED)) {
+                status = EXPORT_CANCELLED;
+                break;
+            }
+            ReadCanvasSnapshotRow(snapshot, y, row);
+            ok = WritePngRow(writer, row);
+            __atomic_store_n(&job->rowsDone, y + 1, __ATOMIC_RELAXED);
+        }
+
+        if (status == EXPORT_CANCELLED || !ok) {
+            DestroyPngWriter(writer);
+        } else if (FinishPngWriter(writer)) {
+            // rename() does not replace an existing file on Windows
+            remove(job->path);
+            if (rename(job->tempPath, job->path) == 0) {
+                status = EXPORT_DONE;
+            }
+        }
+        if (status != EXPORT_DONE) {
+            remove(job->tempPath);
+        }
+    }
+
+    free(row);
+
+    // The canvas may have moved on long ago; dropping the snapshot here
+    // releases whatever tiles it still shares
+    DestroyCanvasSnapshot(snapshot);
+    job->snapshot = NULL;
+
+    job->finishTime = GetMonotonicTime();
+    __atomic_store_n(&job->status, (int)status, __ATOMIC_RELEASE);
+}
+
+/**
+ * Snapshot a canvas and start writing it as a PNG in the background
+ */
+ExportJob* StartPngExport(Canvas* canvas, const char* path) {
+    if (canvas == NULL || path == NULL || strlen(path) >= sizeof(((ExportJob*)0)->path)) return NULL;
+
+    ExportJob* job = (ExportJob*)calloc(1, sizeof(ExportJob));
+    if (job == NULL) return NULL;
+
+    strcpy(job->path, path);
+    snprintf(job->tempPath, sizeof(job->tempPath), "%s.tmp", path);
+
+    // Only this step runs on the calling thread: it retains tile buffers
+    // instead of copying pixels
+    job->snapshot = CreateCanvasSnapshot(canvas);
+    if (job->snapshot == NULL) {
+        free(job);
+        return NULL;
+    }
+
+    job->totalRows = job->snapshot->height;
+    job->status = EXPORT_RUNNING;
+    job->startTime = GetMonotonicTime();
+
+    job->thread = StartBackgroundThread(RunPngExport, job);
+    if (job->thread == NULL) {
+        RunPngExport(job);
+    }
+
+    return job;
+}
+
+/**
+ * Get the fraction of rows written so far
+ */
+float GetExportProgress(const ExportJob* job) {
+    if (job == NULL || job->totalRows <= 0) return 0.0f;
+
+    return (float)__atomic_load_n(&job->rowsDone, __ATOMIC_RELAXED) / (float)job->totalRows;
+}
+
+/**
+ * Get the current state of an export
+ */
+ExportStatus GetExportStatus(const ExportJob* job) {
+    if (job == NULL) return EXPORT_FAILED;
+
+    return (ExportStatus)__atomic_load_n(&job->status, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Get the time an export took, or has taken so far
+ */
+double GetExportElapsedTime(const ExportJob* job) {
+    if (job == NULL) return 0.0;
+
+    if (GetExportStatus(job) == EXPORT_RUNNING) {
+        return GetMonotonicTime() - job->startTime;
+    }
+    return job->finishTime - job->startTime;
+}
+
+/**
+ * Ask a running export to stop after the current row
+ */
+void CancelExport(ExportJob* job) {
+    if (job == NULL) return;
+
+    __atomic_store_n(&job->cancelRequested, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Wait for the export thread to stop and free the job
+ */
+void DestroyExportJob(ExportJob* job) {
+    if (job == NULL) return;
+
+    JoinBackgroundThread(job->thread);
+    free(job);
+}
@@ -0,0 +1,219 @@
+/**
+ * fill.c
+ *
+ * Implementation of Flood Fill
+ *
+ * Contiguous fills use the span-based seed fill (Heckbert, Graphics Gems):
+ * a stack entry is a run that was just filled plus the row next to it that
+ * still has to be scanned. Each row run is found once, written once with
+ * FillCanvasSpan and produces at most three new entries, so the stack stays
+ * small and every pixel is read a small, bounded number of times.
+ */
+
+#include "fill.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Per-fill state shared by the row scanners
+ */
+typedef struct {
+    Canvas* canvas;
+    unsigned int target;    // Packed seed color
+    bool emptyMatches;      // Whether unallocated tiles read as the seed color
+} FillContext;
+
+/**
+ * Pack a color into one integer so a pixel test is a single compare
+ */
+static unsigned int PackColor(Color color) {
+    unsigned int packed;
+    memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+/**
+ * Get the pixels of one tile row (NULL if the tile is empty)
+ * A pending tile is loaded first, so its stored pixels are scanned instead
+ * of reading as empty and being painted over
+ */
+static const Color* GetTileRow(FillContext* context, int x, int y) {
+    const Color* pixels = GetCanvasTilePixels(context->canvas, GetCanvasTileIndex(context->canvas, x, y));
+    if (pixels == NULL) return NULL;
+    return pixels + ((y & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT);
+}
+
+static bool PixelMatches(FillContext* context, int x, int y) {
+    const Color* row = GetTileRow(context, x, y);
+    if (row == NULL) return context->emptyMatches;
+    return PackColor(row[x & CANVAS_TILE_MASK]) == context->target;
+}
+
+/**
+ * Scan right from x and return the first column in [x, xEnd] whose match
+ * state differs from `matching`, or xEnd + 1 if there is none
+ * Empty tiles are skipped a whole tile row at a time
+ */
+static int FindRunEnd(FillContext* context, int x, int y, int xEnd, bool matching) {
+    while (x <= xEnd) {
+        int tileEnd = x | CANVAS_TILE_MASK;
+        if (tileEnd > xEnd) tileEnd = xEnd;
+
+        const Color* row = GetTileRow(context, x, y);
+        if (row == NULL) {
+            if (context->emptyMatches != matching) return x;
+            x = tileEnd + 1;
+            continue;
+        }
+
+        for (; x <= tileEnd; x++) {
+            if ((PackColor(row[x & CANVAS_TILE_MASK]) == context->target) != matching) return x;
+        }
+    }
+    return x;
+}
+
+/**
+ * Scan left from a matching column and return the first column of its run
+ */
+static int FindRunStart(FillContext* context, int x, int y) {
+    while (x >= 0) {
+        int tileStart = x & ~CANVAS_TILE_MASK;
+
+        const Color* row = GetTileRow(context, x, y);
+        if (row == NULL) {
+            if (!context->emptyMatches) return x + 1;
+            x = tileStart - 1;
+            continue;
+        }
+
+        for (; x >= tileStart; x--) {
+            if (PackColor(row[x & CANVAS_TILE_MASK]) != context->target) return x + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Push a segment, growing the arena when needed
+ */
+static bool PushSegment(FillArena* arena, int x0, int x1, int y, int dy) {
+    if (arena->count == arena->capacity) {
+        int capacity = arena->capacity ? arena->capacity * 2 : 256;
+        FillSegment* segments = (FillSegment*)realloc(arena->segments, sizeof(FillSegment) * capacity);
+        if (segments == NULL) return false;
+        arena->segments = segments;
+        arena->capacity = capacity;
+    }
+
+    arena->segments[arena->count++] = (FillSegment){x0, x1, y, dy};
+    return true;
+}
+
+/**
+ * Write one run and verify it no longer matches
+ * A run that still matches means the write failed (out of memory); stopping
+ * there keeps the fill from revisiting the same run forever
+ */
+static bool FillRun(FillContext* context, int x0, int x1, int y, Color color, size_t* filled) {
+    FillCanvasSpan(context->canvas, x0, y, x1 - x0 + 1, color);
+    if (PixelMatches(context, x0, y)) return false;
+
+    *filled += (size_t)(x1 - x0 + 1);
+    return true;
+}
+
+/**
+ * Fill the 4-connected region around the seed
+ */
+static size_t FillContiguous(FillContext* context, FillArena* arena, int x, int y, Color color) {
+    Canvas* canvas = context->canvas;
+    size_t filled = 0;
+
+    int left = FindRunStart(context, x, y);
+    int right = FindRunEnd(context, x, y, canvas->width - 1, true) - 1;
+    if (!FillRun(context, left, right, y, color, &filled)) return filled;
+
+    arena->count = 0;
+    if (!PushSegment(arena, left, right, y + 1, 1) ||
+        !PushSegment(arena, left, right, y - 1, -1)) {
+        return filled;
+    }
+
+    while (arena->count > 0) {
+        FillSegment segment = arena->segments[--arena->count];
+        int row = segment.y;
+        if (row < 0 || row >= canvas->height) continue;
+
+        // The first run may extend left past the segment
+        int start = segment.x0;
+        if (PixelMatches(context, start, row)) {
+            left = FindRunStart(context, start, row);
+        } else {
+            start = FindRunEnd(context, start, row, segment.x1, false);
+            left = start;
+        }
+
+        while (start <= segment.x1) {
+            right = FindRunEnd(context, start, row, canvas->width - 1, true) - 1;
+            if (!FillRun(context, left, right, row, color, &filled)) return filled;
+
+            // Continue away from the parent row, and leak back toward it
+            // where the run overhangs the parent segment
+            bool ok = PushSegment(arena, left, right, row + segment.dy, segment.dy);
+            if (ok && left < segment.x0) {
+                ok = PushSegment(arena, left, segment.x0 - 1, row - segment.dy, -segment.dy);
+            }
+            if (ok && right > segment.x1) {
+                ok = PushSegment(arena, segment.x1 + 1, right, row - segment.dy, -segment.dy);
+            }
+            if (!ok) return filled;
+
+            // right + 1 is a boundary; find the next run inside the segment
+            start = FindRunEnd(context, right + 2, row, segment.x1, false);
+            left = start;
+        }
+    }
+
+    return filled;
+}
+
+/**
+ * Create an empty fill arena
+ */
+FillArena* CreateFillArena(void) {
+    return (FillArena*)calloc(1, sizeof(FillArena));
+}
+
+/**
+ * Destroy a fill arena and free its stack
+ */
+void DestroyFillArena(FillArena* arena) {
+    if (arena == NULL) return;
+    free(arena->segments);
+    free(arena);
+}
+
+/**
+ * Replace the color under a seed pixel
+ */
+size_t FloodFillCanvas(Canvas* canvas, FillArena* arena, int x, int y, Color color, FillMode mode) {
+    if (!IsValidPixelCoord(canvas, x, y)) return 0;
+
+    Color target = GetPixel(canvas, x, y);
+
+    FillContext context;
+    context.canvas = canvas;
+    context.target = PackColor(target);
+    context.emptyMatches = PackColor(canvas->emptyColor) == context.target;
+
+    // Nothing would change, and the fill would never see its own writes
+    if (PackColor(color) == context.target) return 0;
+
+    if (mode == FILL_GLOBAL) {
+        return ReplaceCanvasColor(canvas, target, color, 0);
+    }
+
+    if (arena == NULL) return 0;
+    return FillContiguous(&context, arena, x, y, color);
+}
@@ -0,0 +1,378 @@
+/**
+ * history.c
+ *
+ * Implementation of Undo/Redo History System
+ */
+
+#include "history.h"
+#include "codec.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Free the snapshots held by an entry
+ */
+static void FreeHistoryEntry(HistoryEntry* entry) {
+    for (int i = 0; i < entry->tileCount; i++) {
+        free(entry->tiles[i].before);
+        free(entry->tiles[i].after);
+    }
+    free(entry->tiles);
+    entry->tiles = NULL;
+    entry->tileCount = 0;
+    entry->tileCapacity = 0;
+    entry->byteSize = 0;
+}
+
+/**
+ * Compress a tile's current contents (NULL data for empty tiles)
+ * Returns false if the tile has pixels that could not be compressed
+ */
+static bool SnapshotTile(Canvas* canvas, int tileIndex, unsigned char** outData, size_t* outSize) {
+    *outData = NULL;
+    *outSize = 0;
+    Color* pixels = GetCanvasTilePixels(canvas, tileIndex);
+    if (pixels == NULL) return true;
+    *outData = CompressPixelsRLE(pixels, CANVAS_TILE_PIXELS, outSize);
+    return *outData != NULL;
+}
+
+/**
+ * Canvas callback: snapshot a tile right before the step first modifies it
+ */
+static void OnHistoryTileWrite(void* userData, Canvas* canvas, int tileIndex) {
+    History* history = (History*)userData;
+    HistoryEntry* entry = &history->pending;
+    if (history->isPendingInvalid) return;
+
+    // A tile missing from the step, or recorded as empty, would make undo
+    // restore the wrong pixels: the whole step is dropped instead
+    if (entry->tileCount == entry->tileCapacity) {
+        int capacity = entry->tileCapacity ? entry->tileCapacity * 2 : 8;
+        HistoryTileDelta* tiles = (HistoryTileDelta*)realloc(entry->tiles, sizeof(HistoryTileDelta) * capacity);
+        if (tiles == NULL) {
+            history->isPendingInvalid = true;
+            return;
+        }
+        entry->tiles = tiles;
+        entry->tileCapacity = capacity;
+    }
+
+    HistoryTileDelta* delta = &entry->tiles[entry->tileCount];
+    delta->tileIndex = tileIndex;
+    delta->after = NULL;
+    delta->afterSize = 0;
+    if (!SnapshotTile(canvas, tileIndex, &delta->before, &delta->beforeSize)) {
+        history->isPendingInvalid = true;
+        return;
+    }
+    entry->tileCount++;
+}
+
+/**
+ * Restore one side of an entry's snapshots onto its canvas
+ */
+static void ApplyHistoryEntry(History* history, HistoryEntry* entry, bool useAfter) {
+    for (int i = 0; i < entry->tileCount; i++) {
+        HistoryTileDelta* delta = &entry->tiles[i];
+        unsigned char* data = useAfter ? delta->after : delta->before;
+        size_t size = useAfter ? delta->afterSize : delta->beforeSize;
+
+        if (data == NULL) {
+            RestoreCanvasTile(entry->canvas, delta->tileIndex, NULL);
+        } else if (DecompressPixelsRLE(data, size, history->scratch, CANVAS_TILE_PIXELS)) {
+            RestoreCanvasTile(entry->canvas, delta->tileIndex, history->scratch);
+        }
+    }
+}
+
+/**
+ * Drop the oldest entries until the history fits its budget
+ * Only undoable entries are evicted from the front (dropping a redo entry from
+ * the middle of the chain would break later redos); the newest entry is
+ * always kept so the last edit stays undoable
+ */
+static void EnforceHistoryBudget(History* history) {
+    int evict = 0;
+    while (history->bytesUsed > history->byteBudget && evict < history->cursor &&
+           history->count - evict > 1) {
+        history->bytesUsed -= history->entries[evict].byteSize;
+        FreeHistoryEntry(&history->entries[evict]);
+        evict++;
+    }
+
+    if (evict > 0) {
+        memmove(history->entries, history->entries + evict, sizeof(HistoryEntry) * (history->count - evict));
+        history->count -= evict;
+        history->cursor -= evict;
+    }
+
+    // Still over budget: give up redo entries, newest first
+    while (history->bytesUsed > history->byteBudget && history->count > history->cursor &&
+           history->count > 1) {
+        history->count--;
+        history->bytesUsed -= history->entries[history->count].byteSize;
+        FreeHistoryEntry(&history->entries[history->count]);
+    }
+}
+
+/**
+ * Drop all redo entries
+ */
+static void TruncateRedo(History* history) {
+    for (int i = history->cursor; i < history->count; i++) {
+        history->bytesUsed -= history->entries[i].byteSize;
+        FreeHistoryEntry(&history->entries[i]);
+    }
+    history->count = history->cursor;
+}
+
+/**
+ * Create an empty history
+ */
+History* CreateHistory(size_t byteBudget) {
+    History* history = (History*)calloc(1, sizeof(History));
+    if (history == NULL) {
+        return NULL;
+    }
+
+    history->scratch = (Color*)malloc(sizeof(Color) * CANVAS_TILE_PIXELS);
+    if (history->scratch == NULL) {
+        free(history);
+        return NULL;
+    }
+
+    history->byteBudget = (byteBudget > 0) ? byteBudget : DEFAULT_HISTORY_BUDGET;
+
+    return history;
+}
+
+/**
+ * Destroy history and free all snapshots
+ */
+void DestroyHistory(History* history) {
+    if (history == NULL) return;
+
+    if (history->isRecording) {
+        EndCanvasWriteSession(history->pending.canvas);
+        SetCanvasTileWriteCallback(history->pending.canvas, NULL, NULL);
+        FreeHistoryEntry(&history->pending);
+    }
+    for (int i = 0; i < history->count; i++) {
+        FreeHistoryEntry(&history->entries[i]);
+    }
+    free(history->entries);
+    free(history->scratch);
+    free(history);
+}
+
+/**
+ * Start recording an undoable step on a canvas
+ */
+void BeginHistoryStep(History* history, Canvas* canvas) {
+    if (history == NULL || canvas == NULL) return;
+
+    if (history->isRecording) {
+        EndHistoryStep(history);
+    }
+
+    history->pending = (HistoryEntry){0};
+    history->pending.canvas = canvas;
+    history->isRecording = true;
+    history->isPendingInvalid = false;
+
+    SetCanvasTileWriteCallback(canvas, OnHistoryTileWrite, history);
+    BeginCanvasWriteSession(canvas);
+}
+
+/**
+ * Finish the current step and push it onto the undo stack
+ */
+void EndHistoryStep(History* history) {
+    if (history == NULL || !history->isRecording) return;
+
+    HistoryEntry entry = history->pending;
+    history->pending = (HistoryEntry){0};
+    history->isRecording = false;
+
+    EndCanvasWriteSession(entry.canvas);
+    SetCanvasTileWriteCallback(entry.canvas, NULL, NULL);
+
+    // Capture the after state
+    bool isValid = !history->isPendingInvalid;
+    history->isPendingInvalid = false;
+    for (int i = 0; i < entry.tileCount && isValid; i++) {
+        HistoryTileDelta* delta = &entry.tiles[i];
+        isValid = SnapshotTile(entry.canvas, delta->tileIndex, &delta->after, &delta->afterSize);
+    }
+    if (!isValid) {
+        // Snapshots are missing (out of memory): the step cannot be undone,
+        // and undoing older steps would no longer restore a consistent canvas.
+        // The edit stays on the canvas, so listeners still hear that it changed.
+        FreeHistoryEntry(&entry);
+        ClearHistory(history);
+        if (history->onApply != NULL) {
+            history->onApply(history->onApplyUserData, NULL, true);
+        }
+        return;
+    }
+
+    // Drop tiles the step left unchanged
+    int kept = 0;
+    for (int i = 0; i < entry.tileCount; i++) {
+        HistoryTileDelta delta = entry.tiles[i];
+        bool unchanged = (delta.beforeSize == delta.afterSize) &&
+                         ((delta.before == NULL && delta.after == NULL) ||
+                          (delta.before != NULL && delta.after != NULL &&
+                           memcmp(delta.before, delta.after, delta.afterSize) == 0));
+        if (unchanged) {
+            free(delta.before);
+            free(delta.after);
+            continue;
+        }
+
+        entry.byteSize += sizeof(HistoryTileDelta) + delta.beforeSize + delta.afterSize;
+        entry.tiles[kept++] = delta;
+    }
+    entry.tileCount = kept;
+
+    if (entry.tileCount == 0) {
+        FreeHistoryEntry(&entry);
+        return;
+    }
+
+    // The edit is on the canvas whether or not it can be stored below
+    if (history->onApply != NULL) {
+        history->onApply(history->onApplyUserData, &entry, true);
+    }
+
+    // A new edit invalidates everything that could have been redone
+    TruncateRedo(history);
+
+    if (history->count == history->capacity) {
+        int capacity = history->capacity ? history->capacity * 2 : 32;
+        HistoryEntry* entries = (HistoryEntry*)realloc(history->entries, sizeof(HistoryEntry) * capacity);
+        if (entries == NULL) {
+            // The step cannot be stored, and undoing older steps would no
+            // longer restore a consistent canvas without it
+            FreeHistoryEntry(&entry);
+            ClearHistory(history);
+            return;
+        }
+        history->entries = entries;
+        history->capacity = capacity;
+    }
+
+    history->entries[history->count++] = entry;
+    history->cursor = history->count;
+    history->bytesUsed += entry.byteSize;
+
+    EnforceHistoryBudget(history);
+}
+
+/**
+ * Undo the most recent step
+ */
+bool UndoHistory(History* history) {
+    if (history == NULL) return false;
+    if (history->isRecording) {
+        EndHistoryStep(history);
+    }
+    if (!CanUndo(history)) return false;
+
+    history->cursor--;
+    ApplyHistoryEntry(history, &history->entries[history->cursor], false);
+    if (history->onApply != NULL) {
+        history->onApply(history->onApplyUserData, &history->entries[history->cursor], false);
+    }
+    return true;
+}
+
+/**
+ * Redo the most recently undone step
+ */
+bool RedoHistory(History* history) {
+    if (history == NULL || history->isRecording || !CanRedo(history)) return false;
+
+    ApplyHistoryEntry(history, &history->entries[history->cursor], true);
+    if (history->onApply != NULL) {
+        history->onApply(history->onApplyUserData, &history->entries[history->cursor], true);
+    }
+    history->cursor++;
+    return true;
+}
+
+/**
+ * Check whether a step can be undone
+ */
+bool CanUndo(History* history) {
+    return history != NULL && history->cursor > 0;
+}
+
+/**
+ * Check whether a step can be redone
+ */
+bool CanRedo(History* history) {
+    return history != NULL && history->cursor < history->count;
+}
+
+/**
+ * Remove all entries
+ */
+void ClearHistory(History* history) {
+    if (history == NULL) return;
+
+    for (int i = 0; i < history->count; i++) {
+        FreeHistoryEntry(&history->entries[i]);
+    }
+    history->count = 0;
+    history->cursor = 0;
+    history->bytesUsed = 0;
+}
+
+/**
+ * Drop every entry that edits a canvas
+ */
+void ForgetHistoryCanvas(History* history, Canvas* canvas) {
+    if (history == NULL || canvas == NULL) return;
+
+    if (history->isRecording && history->pending.canvas == canvas) {
+        EndHistoryStep(history);
+    }
+
+    int kept = 0;
+    int cursor = history->cursor;
+    for (int i = 0; i < history->count; i++) {
+        if (history->entries[i].canvas == canvas) {
+            history->bytesUsed -= history->entries[i].byteSize;
+            FreeHistoryEntry(&history->entries[i]);
+            if (i < history->cursor) {
+                cursor--;
+            }
+            continue;
+        }
+        history->entries[kept++] = history->entries[i];
+    }
+    history->count = kept;
+    history->cursor = cursor;
+}
+
+/**
+ * Set the callback told about every committed, undone and redone step
+ */
+void SetHistoryApplyCallback(History* history, HistoryApplyCallback callback, void* userData) {
+    if (history == NULL) return;
+
+    history->onApply = callback;
+    history->onApplyUserData = userData;
+}
+
+/**
+ * Change the memory budget
+ */
+void SetHistoryBudget(History* history, size_t byteBudget) {
+    if (history == NULL) return;
+
+    history->byteBudget = byteBudget;
+    EnforceHistoryBudget(history);
+}
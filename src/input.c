@@ -0,0 +1,432 @@
+/**
+ * input.c
+ *
+ * Implementation of Input Abstraction and Recording
+ */
+
+#include "input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fields of a recorded frame (bits of its change mask)
+#define INPUT_FIELD_MOUSE 0x01
+#define INPUT_FIELD_WHEEL 0x02
+#define INPUT_FIELD_BUTTONS 0x04
+#define INPUT_FIELD_KEYS_DOWN 0x08
+#define INPUT_FIELD_KEYS_PRESSED 0x10
+#define INPUT_FIELD_SCREEN 0x20
+#define INPUT_FIELD_ALL 0x3F
+
+#define INPUT_HEADER_SIZE 48    // Up to the document path length
+
+// Keys the application reads, one bit each in InputFrame. Logs store the
+// bits, so new keys go at the end and existing ones never move.
+static const int trackedKeys[] = {
+    KEY_SPACE, KEY_LEFT_CONTROL, KEY_RIGHT_CONTROL, KEY_LEFT_SHIFT, KEY_RIGHT_SHIFT,
+    KEY_B, KEY_E, KEY_I, KEY_G, KEY_LEFT_BRACKET, KEY_RIGHT_BRACKET, KEY_K, KEY_M, KEY_X,
+    KEY_C, KEY_R, KEY_Z, KEY_Y, KEY_N, KEY_DELETE, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_V, KEY_O, KEY_L,
+    KEY_S, KEY_F3, KEY_F4, KEY_APOSTROPHE
+};
+#define INPUT_TRACKED_KEY_COUNT ((int)(sizeof(trackedKeys) / sizeof(trackedKeys[0])))
+
+static const int trackedButtons[] = {MOUSE_BUTTON_LEFT, MOUSE_BUTTON_RIGHT, MOUSE_BUTTON_MIDDLE};
+
+static InputFrame currentInput = {0};
+
+struct InputRecorder {
+    FILE* file;
+    InputFrame previous;
+    int frameCount;
+};
+
+struct InputLog {
+    FILE* file;
+    InputFrame current;
+    int frameCount;
+    bool hasEnd;
+    int endFrameCount;
+    unsigned int endChecksum;
+};
+
+/**
+ * Store a 32-bit value as little-endian bytes
+ */
+static void PutLittleEndian(unsigned char* out, unsigned int value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+/**
+ * Read a little-endian 32-bit value
+ */
+static unsigned int GetLittleEndian(const unsigned char* bytes) {
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) |
+           ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+/**
+ * Store a float as the little-endian bytes of its bit pattern
+ */
+static void PutFloat(unsigned char* out, float value) {
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutLittleEndian(out, bits);
+}
+
+/**
+ * Read a float stored by PutFloat
+ */
+static float GetFloat(const unsigned char* bytes) {
+    unsigned int bits = GetLittleEndian(bytes);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Bit of a key in InputFrame, or -1 for keys the application does not use
+ */
+static int GetTrackedKeyBit(int key) {
+    for (int i = 0; i < INPUT_TRACKED_KEY_COUNT; i++) {
+        if (trackedKeys[i] == key) return i;
+    }
+    return -1;
+}
+
+/**
+ * Bit of a mouse button in InputFrame
+ */
+static int GetTrackedButtonBit(int button) {
+    return (button >= MOUSE_BUTTON_LEFT && button <= MOUSE_BUTTON_MIDDLE) ? button : -1;
+}
+
+/**
+ * Capture the current raylib input state
+ */
+void PollInputFrame(InputFrame* frame) {
+    if (frame == NULL) return;
+
+    *frame = (InputFrame){0};
+    frame->mousePosition = GetMousePosition();
+    frame->wheelMove = GetMouseWheelMove();
+    for (int i = 0; i < 3; i++) {
+        if (IsMouseButtonDown(trackedButtons[i])) frame->buttonsDown |= (unsigned char)(1u << i);
+        if (IsMouseButtonPressed(trackedButtons[i])) frame->buttonsPressed |= (unsigned char)(1u << i);
+        if (IsMouseButtonReleased(trackedButtons[i])) frame->buttonsReleased |= (unsigned char)(1u << i);
+    }
+    for (int i = 0; i < INPUT_TRACKED_KEY_COUNT; i++) {
+        if (IsKeyDown(trackedKeys[i])) frame->keysDown |= 1ull << i;
+        if (IsKeyPressed(trackedKeys[i])) frame->keysPressed |= 1ull << i;
+    }
+    frame->screenWidth = GetScreenWidth();
+    frame->screenHeight = GetScreenHeight();
+}
+
+/**
+ * Make a frame the current input
+ */
+void SetInputFrame(const InputFrame* frame) {
+    if (frame == NULL) return;
+    currentInput = *frame;
+}
+
+/**
+ * Set the state of a key in a frame
+ */
+bool SetInputFrameKey(InputFrame* frame, int key, bool isDown, bool isPressed) {
+    int bit = GetTrackedKeyBit(key);
+    if (frame == NULL || bit < 0) return false;
+
+    unsigned long long mask = 1ull << bit;
+    frame->keysDown = isDown ? (frame->keysDown | mask) : (frame->keysDown & ~mask);
+    frame->keysPressed = isPressed ? (frame->keysPressed | mask) : (frame->keysPressed & ~mask);
+    return true;
+}
+
+/**
+ * Check whether a key is held down
+ */
+bool IsInputKeyDown(int key) {
+    int bit = GetTrackedKeyBit(key);
+    return bit >= 0 && (currentInput.keysDown & (1ull << bit)) != 0;
+}
+
+/**
+ * Check whether a key went down this frame
+ */
+bool IsInputKeyPressed(int key) {
+    int bit = GetTrackedKeyBit(key);
+    return bit >= 0 && (currentInput.keysPressed & (1ull << bit)) != 0;
+}
+
+/**
+ * Check whether a mouse button is held down
+ */
+bool IsInputMouseButtonDown(int button) {
+    int bit = GetTrackedButtonBit(button);
+    return bit >= 0 && (currentInput.buttonsDown & (1u << bit)) != 0;
+}
+
+/**
+ * Check whether a mouse button went down this frame
+ */
+bool IsInputMouseButtonPressed(int button) {
+    int bit = GetTrackedButtonBit(button);
+    return bit >= 0 && (currentInput.buttonsPressed & (1u << bit)) != 0;
+}
+
+/**
+ * Check whether a mouse button went up this frame
+ */
+bool IsInputMouseButtonReleased(int button) {
+    int bit = GetTrackedButtonBit(button);
+    return bit >= 0 && (currentInput.buttonsReleased & (1u << bit)) != 0;
+}
+
+/**
+ * Get the mouse position
+ */
+Vector2 GetInputMousePosition(void) {
+    return currentInput.mousePosition;
+}
+
+/**
+ * Get the mouse wheel movement of this frame
+ */
+float GetInputMouseWheelMove(void) {
+    return currentInput.wheelMove;
+}
+
+/**
+ * Start recording input frames to a log file
+ */
+InputRecorder* CreateInputRecorder(const char* path, const InputLogHeader* header) {
+    if (path == NULL || header == NULL) return NULL;
+
+    InputRecorder* recorder = (InputRecorder*)calloc(1, sizeof(InputRecorder));
+    if (recorder == NULL) return NULL;
+
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL) {
+        free(recorder);
+        return NULL;
+    }
+
+    unsigned char bytes[INPUT_HEADER_SIZE + 2];
+    size_t pathLength = strlen(header->documentPath);
+    memcpy(bytes, "PXIN", 4);
+    PutLittleEndian(bytes + 4, INPUT_LOG_VERSION);
+    PutLittleEndian(bytes + 8, (unsigned int)INPUT_TRACKED_KEY_COUNT);
+    PutLittleEndian(bytes + 12, (unsigned int)header->screenWidth);
+    PutLittleEndian(bytes + 16, (unsigned int)header->screenHeight);
+    PutFloat(bytes + 20, header->cameraPosition.x);
+    PutFloat(bytes + 24, header->cameraPosition.y);
+    PutFloat(bytes + 28, header->cameraZoom);
+    PutFloat(bytes + 32, header->pickerBounds.x);
+    PutFloat(bytes + 36, header->pickerBounds.y);
+    PutFloat(bytes + 40, header->pickerBounds.width);
+    PutFloat(bytes + 44, header->pickerBounds.height);
+    bytes[INPUT_HEADER_SIZE] = (unsigned char)pathLength;
+    bytes[INPUT_HEADER_SIZE + 1] = (unsigned char)(pathLength >> 8);
+
+    if (fwrite(bytes, 1, sizeof(bytes), recorder->file) != sizeof(bytes) ||
+        fwrite(header->documentPath, 1, pathLength, recorder->file) != pathLength) {
+        fclose(recorder->file);
+        free(recorder);
+        return NULL;
+    }
+    return recorder;
+}
+
+/**
+ * Append one frame to a log
+ */
+bool RecordInputFrame(InputRecorder* recorder, const InputFrame* frame) {
+    if (recorder == NULL || recorder->file == NULL || frame == NULL) return false;
+
+    const InputFrame* previous = &recorder->previous;
+    unsigned char bytes[1 + 8 + 4 + 3 + 8 + 8 + 4];
+    size_t size = 1;
+    unsigned char mask = 0;
+
+    if (memcmp(&frame->mousePosition, &previous->mousePosition, sizeof(Vector2)) != 0) {
+        mask |= INPUT_FIELD_MOUSE;
+        PutFloat(bytes + size, frame->mousePosition.x);
+        PutFloat(bytes + size + 4, frame->mousePosition.y);
+        size += 8;
+    }
+    if (memcmp(&frame->wheelMove, &previous->wheelMove, sizeof(float)) != 0) {
+        mask |= INPUT_FIELD_WHEEL;
+        PutFloat(bytes + size, frame->wheelMove);
+        size += 4;
+    }
+    if (frame->buttonsDown != previous->buttonsDown || frame->buttonsPressed != previous->buttonsPressed ||
+        frame->buttonsReleased != previous->buttonsReleased) {
+        mask |= INPUT_FIELD_BUTTONS;
+        bytes[size++] = frame->buttonsDown;
+        bytes[size++] = frame->buttonsPressed;
+        bytes[size++] = frame->buttonsReleased;
+    }
+    if (frame->keysDown != previous->keysDown) {
+        mask |= INPUT_FIELD_KEYS_DOWN;
+        PutLittleEndian(bytes + size, (unsigned int)frame->keysDown);
+        PutLittleEndian(bytes + size + 4, (unsigned int)(frame->keysDown >> 32));
+        size += 8;
+    }
+    if (frame->keysPressed != previous->keysPressed) {
+        mask |= INPUT_FIELD_KEYS_PRESSED;
+        PutLittleEndian(bytes + size, (unsigned int)frame->keysPressed);
+        PutLittleEndian(bytes + size + 4, (unsigned int)(frame->keysPressed >> 32));
+        size += 8;
+    }
+    if (frame->screenWidth != previous->screenWidth || frame->screenHeight != previous->screenHeight) {
+        mask |= INPUT_FIELD_SCREEN;
+        bytes[size++] = (unsigned char)frame->screenWidth;
+        bytes[size++] = (unsigned char)(frame->screenWidth >> 8);
+        bytes[size++] = (unsigned char)frame->screenHeight;
+        bytes[size++] = (unsigned char)(frame->screenHeight >> 8);
+    }
+    bytes[0] = mask;
+
+    if (fwrite(bytes, 1, size, recorder->file) != size) {
+        fclose(recorder->file);
+        recorder->file = NULL;
+        return false;
+    }
+    recorder->previous = *frame;
+    recorder->frameCount++;
+    return true;
+}
+
+/**
+ * Write the end record and close the log
+ */
+void DestroyInputRecorder(InputRecorder* recorder, unsigned int checksum) {
+    if (recorder == NULL) return;
+
+    if (recorder->file != NULL) {
+        unsigned char bytes[9];
+        bytes[0] = INPUT_LOG_END;
+        PutLittleEndian(bytes + 1, (unsigned int)recorder->frameCount);
+        PutLittleEndian(bytes + 5, checksum);
+        fwrite(bytes, 1, sizeof(bytes), recorder->file);
+        fclose(recorder->file);
+    }
+    free(recorder);
+}
+
+/**
+ * Open an input log for replay
+ */
+InputLog* OpenInputLog(const char* path, InputLogHeader* header) {
+    if (path == NULL || header == NULL) return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+
+    unsigned char bytes[INPUT_HEADER_SIZE + 2];
+    bool ok = fread(bytes, 1, sizeof(bytes), file) == sizeof(bytes) && memcmp(bytes, "PXIN", 4) == 0 &&
+              GetLittleEndian(bytes + 4) == INPUT_LOG_VERSION &&
+              GetLittleEndian(bytes + 8) <= (unsigned int)INPUT_TRACKED_KEY_COUNT;
+
+    size_t pathLength = (size_t)bytes[INPUT_HEADER_SIZE] | ((size_t)bytes[INPUT_HEADER_SIZE + 1] << 8);
+    *header = (InputLogHeader){0};
+    ok = ok && pathLength < sizeof(header->documentPath) &&
+         fread(header->documentPath, 1, pathLength, file) == pathLength;
+
+    InputLog* log = ok ? (InputLog*)calloc(1, sizeof(InputLog)) : NULL;
+    if (log == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    header->screenWidth = (int)GetLittleEndian(bytes + 12);
+    header->screenHeight = (int)GetLittleEndian(bytes + 16);
+    header->cameraPosition = (Vector2){GetFloat(bytes + 20), GetFloat(bytes + 24)};
+    header->cameraZoom = GetFloat(bytes + 28);
+    header->pickerBounds = (Rectangle){GetFloat(bytes + 32), GetFloat(bytes + 36), GetFloat(bytes + 40),
+                                       GetFloat(bytes + 44)};
+    log->file = file;
+    return log;
+}
+
+/**
+ * Read the next frame of a log
+ */
+bool ReadInputFrame(InputLog* log, InputFrame* frame) {
+    if (log == NULL || log->file == NULL || frame == NULL) return false;
+
+    int mask = fgetc(log->file);
+    if (mask == INPUT_LOG_END) {
+        unsigned char bytes[8];
+        if (fread(bytes, 1, sizeof(bytes), log->file) == sizeof(bytes)) {
+            log->hasEnd = true;
+            log->endFrameCount = (int)GetLittleEndian(bytes);
+            log->endChecksum = GetLittleEndian(bytes + 4);
+        }
+        return false;
+    }
+    if (mask == EOF || (mask & ~INPUT_FIELD_ALL) != 0) return false;
+
+    // Fields that did not change keep their value; pressed and released
+    // states are only ever set for one frame, so they are recorded as changes
+    InputFrame* current = &log->current;
+    unsigned char bytes[8];
+    bool ok = true;
+    if (mask & INPUT_FIELD_MOUSE) {
+        ok = ok && fread(bytes, 1, 8, log->file) == 8;
+        current->mousePosition = (Vector2){GetFloat(bytes), GetFloat(bytes + 4)};
+    }
+    if ((mask & INPUT_FIELD_WHEEL) && ok) {
+        ok = fread(bytes, 1, 4, log->file) == 4;
+        current->wheelMove = GetFloat(bytes);
+    }
+    if ((mask & INPUT_FIELD_BUTTONS) && ok) {
+        ok = fread(bytes, 1, 3, log->file) == 3;
+        current->buttonsDown = bytes[0];
+        current->buttonsPressed = bytes[1];
+        current->buttonsReleased = bytes[2];
+    }
+    if ((mask & INPUT_FIELD_KEYS_DOWN) && ok) {
+        ok = fread(bytes, 1, 8, log->file) == 8;
+        current->keysDown = GetLittleEndian(bytes) | ((unsigned long long)GetLittleEndian(bytes + 4) << 32);
+    }
+    if ((mask & INPUT_FIELD_KEYS_PRESSED) && ok) {
+        ok = fread(bytes, 1, 8, log->file) == 8;
+        current->keysPressed = GetLittleEndian(bytes) | ((unsigned long long)GetLittleEndian(bytes + 4) << 32);
+    }
+    if ((mask & INPUT_FIELD_SCREEN) && ok) {
+        ok = fread(bytes, 1, 4, log->file) == 4;
+        current->screenWidth = bytes[0] | (bytes[1] << 8);
+        current->screenHeight = bytes[2] | (bytes[3] << 8);
+    }
+    if (!ok) return false;
+
+    *frame = *current;
+    log->frameCount++;
+    return true;
+}
+
+/**
+ * Get the end record of a log that has been read to the end
+ */
+bool GetInputLogEnd(InputLog* log, int* frameCount, unsigned int* checksum) {
+    if (log == NULL || !log->hasEnd) return false;
+
+    if (frameCount != NULL) *frameCount = log->endFrameCount;
+    if (checksum != NULL) *checksum = log->endChecksum;
+    return true;
+}
+
+/**
+ * Close an input log
+ */
+void CloseInputLog(InputLog* log) {
+    if (log == NULL) return;
+
+    fclose(log->file);
+    free(log);
+}
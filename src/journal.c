@@ -0,0 +1,534 @@
+/**
+ * journal.c
+ *
+ * Implementation of Autosave Journal
+ */
+
+#include "journal.h"
+#include "codec.h"
+#include "mapfile.h"
+#include "timing.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 16
+#define JOURNAL_RECORD_HEADER_SIZE 12       // Type, payload size, payload CRC
+#define JOURNAL_TILE_HEADER_SIZE 8          // Layer id, tile index
+#define JOURNAL_LAYER_TABLE_HEADER_SIZE 8   // Layer count, active layer
+#define JOURNAL_LAYER_ENTRY_SIZE 40         // Id, name, opacity, visible, blend mode, padding
+
+/**
+ * Store a 32-bit value as little-endian bytes
+ */
+static void PutLittleEndian(unsigned char* out, unsigned int value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+/**
+ * Read a little-endian 32-bit value
+ */
+static unsigned int GetLittleEndian(const unsigned char* bytes) {
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) |
+           ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+/**
+ * Make sure the record scratch space holds at least size bytes
+ */
+static bool ReserveJournalRecord(Journal* journal, size_t size) {
+    if (size <= journal->recordCapacity) return true;
+
+    unsigned char* record = (unsigned char*)realloc(journal->record, size);
+    if (record == NULL) return false;
+    journal->record = record;
+    journal->recordCapacity = size;
+    return true;
+}
+
+/**
+ * Stop journaling after a write error (the checkpoint stays recoverable)
+ */
+static void DisableJournal(Journal* journal) {
+    if (journal->file != NULL) {
+        fclose(journal->file);
+        journal->file = NULL;
+    }
+}
+
+/**
+ * Append one record whose payload is already in the scratch space
+ * The record is handed to the system right away; syncing it waits for UpdateJournal
+ */
+static void AppendJournalRecord(Journal* journal, const char* type, size_t payloadSize) {
+    unsigned char header[JOURNAL_RECORD_HEADER_SIZE];
+    memcpy(header, type, 4);
+    PutLittleEndian(header + 4, (unsigned int)payloadSize);
+    PutLittleEndian(header + 8, UpdateCrc32(0, journal->record, payloadSize));
+
+    if (fwrite(header, 1, sizeof(header), journal->file) != sizeof(header) ||
+        fwrite(journal->record, 1, payloadSize, journal->file) != payloadSize || fflush(journal->file) != 0) {
+        DisableJournal(journal);
+        return;
+    }
+
+    journal->journalBytes += sizeof(header) + payloadSize;
+    journal->recordCount++;
+    journal->needsSync = true;
+}
+
+/**
+ * Find the id of a layer canvas (false if the journal has not seen it)
+ */
+static bool FindJournalLayerId(const JournalLayerId* ids, int count, const Canvas* canvas, unsigned int* id) {
+    for (int i = 0; i < count; i++) {
+        if (ids[i].canvas == canvas) {
+            *id = ids[i].id;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Bring the layer ids up to date with the stack and append a layer record
+ * if the layers changed since the last one
+ */
+static void SyncJournalLayers(Journal* journal) {
+    LayerStack* stack = journal->stack;
+    if (journal->file == NULL || stack == NULL) return;
+
+    // New layers get fresh ids; ids of deleted layers are dropped
+    JournalLayerId* ids = (JournalLayerId*)malloc(sizeof(JournalLayerId) * stack->count);
+    size_t tableSize = JOURNAL_LAYER_TABLE_HEADER_SIZE + (size_t)JOURNAL_LAYER_ENTRY_SIZE * stack->count;
+    if (ids == NULL || !ReserveJournalRecord(journal, tableSize)) {
+        free(ids);
+        DisableJournal(journal);
+        return;
+    }
+
+    unsigned char* table = journal->record;
+    memset(table, 0, tableSize);
+    PutLittleEndian(table, (unsigned int)stack->count);
+    PutLittleEndian(table + 4, (unsigned int)stack->activeIndex);
+    for (int i = 0; i < stack->count; i++) {
+        const Layer* layer = &stack->layers[i];
+        ids[i].canvas = layer->canvas;
+        if (!FindJournalLayerId(journal->layerIds, journal->layerIdCount, layer->canvas, &ids[i].id)) {
+            ids[i].id = journal->nextLayerId++;
+        }
+
+        unsigned char* entry = table + JOURNAL_LAYER_TABLE_HEADER_SIZE + (size_t)JOURNAL_LAYER_ENTRY_SIZE * i;
+        PutLittleEndian(entry, ids[i].id);
+        strncpy((char*)entry + 4, layer->name, LAYER_NAME_LENGTH);
+        entry[36] = layer->opacity;
+        entry[37] = layer->visible ? 1 : 0;
+        entry[38] = (unsigned char)layer->blendMode;
+    }
+
+    free(journal->layerIds);
+    journal->layerIds = ids;
+    journal->layerIdCount = stack->count;
+
+    if (tableSize == journal->layerTableSize && memcmp(table, journal->layerTable, tableSize) == 0) return;
+
+    unsigned char* saved = (unsigned char*)realloc(journal->layerTable, tableSize);
+    if (saved == NULL) {
+        DisableJournal(journal);
+        return;
+    }
+    memcpy(saved, table, tableSize);
+    journal->layerTable = saved;
+    journal->layerTableSize = tableSize;
+
+    AppendJournalRecord(journal, "LAYR", tableSize);
+}
+
+/**
+ * Sync what has been written to the disk
+ */
+static void SyncJournalFile(Journal* journal) {
+    if (!FlushFileToDisk(journal->file)) {
+        DisableJournal(journal);
+        return;
+    }
+    journal->needsSync = false;
+    journal->lastSyncTime = GetMonotonicTime();
+}
+
+/**
+ * Get the size of a file on disk (0 if it cannot be read)
+ */
+static size_t GetFileByteSize(const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) return 0;
+
+    long size = (fseek(in, 0, SEEK_END) == 0) ? ftell(in) : 0;
+    fclose(in);
+    return (size > 0) ? (size_t)size : 0;
+}
+
+/**
+ * Create a journal that is not yet recording
+ */
+Journal* CreateJournal(const char* checkpointPath, const char* journalPath) {
+    if (checkpointPath == NULL || journalPath == NULL) return NULL;
+
+    Journal* journal = (Journal*)calloc(1, sizeof(Journal));
+    if (journal == NULL) return NULL;
+
+    if (snprintf(journal->checkpointPath, sizeof(journal->checkpointPath), "%s", checkpointPath) >=
+            (int)sizeof(journal->checkpointPath) ||
+        snprintf(journal->journalPath, sizeof(journal->journalPath), "%s", journalPath) >=
+            (int)sizeof(journal->journalPath)) {
+        free(journal);
+        return NULL;
+    }
+    return journal;
+}
+
+/**
+ * Destroy a journal, syncing what it has written
+ */
+void DestroyJournal(Journal* journal, bool removeFiles) {
+    if (journal == NULL) return;
+
+    if (journal->file != NULL) {
+        FlushFileToDisk(journal->file);
+        fclose(journal->file);
+    }
+    if (removeFiles) {
+        // The journal goes first: on its own, a checkpoint is never replayed
+        remove(journal->journalPath);
+        remove(journal->checkpointPath);
+    }
+
+    free(journal->layerIds);
+    free(journal->layerTable);
+    free(journal->record);
+    free(journal);
+}
+
+/**
+ * Save a checkpoint of a document and start an empty journal for it
+ */
+bool ResetJournal(Journal* journal, LayerStack* stack, ProjectFile** openFile) {
+    if (journal == NULL) return false;
+
+    DisableJournal(journal);
+    journal->stack = stack;
+    journal->needsCheckpoint = false;
+    if (stack == NULL) return false;
+
+    // The old journal is only replaced once the new checkpoint is on disk.
+    // If that is as far as it gets, the old journal no longer matches the
+    // checkpoint's checksum and recovery ignores it.
+    double start = GetMonotonicTime();
+    unsigned int checksum = 0;
+    if (!SaveProject(stack, journal->checkpointPath, openFile) ||
+        !ReadProjectChecksum(journal->checkpointPath, &checksum)) {
+        return false;
+    }
+
+    journal->file = fopen(journal->journalPath, "wb");
+    if (journal->file == NULL) return false;
+
+    unsigned char header[JOURNAL_HEADER_SIZE] = {0};
+    memcpy(header, "PXJL", 4);
+    PutLittleEndian(header + 4, JOURNAL_VERSION);
+    PutLittleEndian(header + 8, checksum);
+    if (fwrite(header, 1, sizeof(header), journal->file) != sizeof(header)) {
+        DisableJournal(journal);
+        return false;
+    }
+
+    // The checkpoint numbers its layers from the bottom up
+    free(journal->layerIds);
+    journal->layerIds = (JournalLayerId*)malloc(sizeof(JournalLayerId) * stack->count);
+    if (journal->layerIds == NULL) {
+        journal->layerIdCount = 0;
+        DisableJournal(journal);
+        return false;
+    }
+    for (int i = 0; i < stack->count; i++) {
+        journal->layerIds[i] = (JournalLayerId){stack->layers[i].canvas, (unsigned int)i};
+    }
+    journal->layerIdCount = stack->count;
+    journal->nextLayerId = (unsigned int)stack->count;
+    journal->layerTableSize = 0;
+
+    journal->journalBytes = sizeof(header);
+    journal->checkpointBytes = GetFileByteSize(journal->checkpointPath);
+    journal->recordCount = 0;
+    SyncJournalLayers(journal);
+    if (journal->file != NULL) {
+        SyncJournalFile(journal);
+    }
+
+    journal->checkpointCount++;
+    journal->lastCheckpointSeconds = GetMonotonicTime() - start;
+    return journal->file != NULL;
+}
+
+/**
+ * History callback appending the tiles of a committed, undone or redone step
+ */
+void RecordJournalHistoryStep(void* userData, const HistoryEntry* entry, bool isAfter) {
+    Journal* journal = (Journal*)userData;
+    if (journal == NULL || journal->file == NULL) return;
+
+    // Records after an edit the journal never saw would replay onto the
+    // wrong pixels; recovery stops short of it until the next checkpoint
+    if (entry == NULL) {
+        journal->needsCheckpoint = true;
+        return;
+    }
+    if (journal->needsCheckpoint) return;
+
+    // The edit may be the first one on a layer added this frame
+    SyncJournalLayers(journal);
+
+    unsigned int layerId = 0;
+    if (!FindJournalLayerId(journal->layerIds, journal->layerIdCount, entry->canvas, &layerId)) return;
+
+    for (int i = 0; i < entry->tileCount && journal->file != NULL; i++) {
+        const HistoryTileDelta* delta = &entry->tiles[i];
+        const unsigned char* data = isAfter ? delta->after : delta->before;
+        size_t size = (data != NULL) ? (isAfter ? delta->afterSize : delta->beforeSize) : 0;
+
+        if (!ReserveJournalRecord(journal, JOURNAL_TILE_HEADER_SIZE + size)) {
+            DisableJournal(journal);
+            return;
+        }
+        PutLittleEndian(journal->record, layerId);
+        PutLittleEndian(journal->record + 4, (unsigned int)delta->tileIndex);
+        if (size > 0) {
+            memcpy(journal->record + JOURNAL_TILE_HEADER_SIZE, data, size);
+        }
+        AppendJournalRecord(journal, "TILE", JOURNAL_TILE_HEADER_SIZE + size);
+    }
+}
+
+/**
+ * Record layer changes, sync to disk when due and compact when due
+ */
+void UpdateJournal(Journal* journal, bool canCompact, ProjectFile** openFile) {
+    if (journal == NULL || journal->file == NULL) return;
+
+    SyncJournalLayers(journal);
+    if (journal->file == NULL) return;
+
+    if (journal->needsSync && GetMonotonicTime() - journal->lastSyncTime >= JOURNAL_SYNC_INTERVAL) {
+        SyncJournalFile(journal);
+    }
+
+    // Compacting costs about one checkpoint, so it waits until the journal
+    // is at least that big: over time it adds at most as much as the edits
+    if (canCompact && journal->file != NULL && (journal->needsCheckpoint ||
+        (journal->journalBytes >= JOURNAL_MIN_COMPACT_BYTES && journal->journalBytes >= journal->checkpointBytes))) {
+        ResetJournal(journal, journal->stack, openFile);
+    }
+}
+
+/**
+ * Replay a layer record: create, delete, reorder and set up layers to match it
+ */
+static bool ReplayLayerRecord(LayerStack* stack, JournalLayerId** ids, int* idCount, const unsigned char* payload,
+                              size_t size) {
+    if (size < JOURNAL_LAYER_TABLE_HEADER_SIZE) return false;
+    int count = (int)GetLittleEndian(payload);
+    int activeIndex = (int)GetLittleEndian(payload + 4);
+    if (count <= 0 || size != JOURNAL_LAYER_TABLE_HEADER_SIZE + (size_t)JOURNAL_LAYER_ENTRY_SIZE * count) {
+        return false;
+    }
+    const unsigned char* entries = payload + JOURNAL_LAYER_TABLE_HEADER_SIZE;
+
+    // Layers the record introduces
+    JournalLayerId* known = (JournalLayerId*)realloc(*ids, sizeof(JournalLayerId) * (*idCount + count));
+    if (known == NULL) return false;
+    *ids = known;
+    for (int i = 0; i < count; i++) {
+        unsigned int id = GetLittleEndian(entries + (size_t)JOURNAL_LAYER_ENTRY_SIZE * i);
+        bool isKnown = false;
+        for (int j = 0; j < *idCount && !isKnown; j++) {
+            isKnown = known[j].id == id;
+        }
+        if (isKnown) continue;
+
+        int index = AddLayer(stack, NULL);
+        if (index < 0) return false;
+        known[(*idCount)++] = (JournalLayerId){stack->layers[index].canvas, id};
+    }
+
+    // Layers it no longer lists
+    for (int i = *idCount - 1; i >= 0; i--) {
+        bool isListed = false;
+        for (int j = 0; j < count && !isListed; j++) {
+            isListed = GetLittleEndian(entries + (size_t)JOURNAL_LAYER_ENTRY_SIZE * j) == known[i].id;
+        }
+        if (isListed) continue;
+
+        for (int j = 0; j < stack->count; j++) {
+            if (stack->layers[j].canvas == known[i].canvas) {
+                DeleteLayer(stack, j, NULL);
+                break;
+            }
+        }
+        known[i] = known[--(*idCount)];
+    }
+
+    // Order and settings, bottom up
+    for (int i = 0; i < count; i++) {
+        const unsigned char* entry = entries + (size_t)JOURNAL_LAYER_ENTRY_SIZE * i;
+        Canvas* canvas = NULL;
+        for (int j = 0; j < *idCount && canvas == NULL; j++) {
+            if (known[j].id == GetLittleEndian(entry)) canvas = known[j].canvas;
+        }
+        for (int j = i; j < stack->count; j++) {
+            if (stack->layers[j].canvas == canvas) {
+                MoveLayer(stack, j, i);
+                break;
+            }
+        }
+
+        Layer* layer = &stack->layers[i];
+        if (layer->canvas != canvas || entry[38] >= PIXEL_BLEND_COUNT) return false;
+        snprintf(layer->name, sizeof(layer->name), "%.*s", LAYER_NAME_LENGTH - 1, (const char*)entry + 4);
+        SetLayerOpacity(stack, i, entry[36]);
+        SetLayerVisible(stack, i, entry[37] != 0);
+        SetLayerBlendMode(stack, i, (PixelBlendMode)entry[38]);
+    }
+    SelectLayer(stack, activeIndex);
+    return true;
+}
+
+/**
+ * Replay a tile record: put the stored pixels into the layer's tile
+ */
+static bool ReplayTileRecord(JournalLayerId* ids, int idCount, const unsigned char* payload, size_t size,
+                             Color* scratch) {
+    if (size < JOURNAL_TILE_HEADER_SIZE) return false;
+
+    Canvas* canvas = NULL;
+    for (int i = 0; i < idCount && canvas == NULL; i++) {
+        if (ids[i].id == GetLittleEndian(payload)) canvas = ids[i].canvas;
+    }
+    int tileIndex = (int)GetLittleEndian(payload + 4);
+    if (canvas == NULL || tileIndex < 0 || tileIndex >= canvas->tilesX * canvas->tilesY) return false;
+
+    size_t dataSize = size - JOURNAL_TILE_HEADER_SIZE;
+    if (dataSize == 0) {
+        RestoreCanvasTile(canvas, tileIndex, NULL);
+        return true;
+    }
+    if (!DecompressPixelsRLE(payload + JOURNAL_TILE_HEADER_SIZE, dataSize, scratch, CANVAS_TILE_PIXELS)) {
+        return false;
+    }
+    RestoreCanvasTile(canvas, tileIndex, scratch);
+    return true;
+}
+
+/**
+ * Replay the intact records of a journal, in order
+ * Stops at the first torn or corrupt record (the tail of a crashed write)
+ */
+static int ReplayJournal(LayerStack* stack, const unsigned char* data, size_t size) {
+    Color* scratch = (Color*)malloc(sizeof(Color) * CANVAS_TILE_PIXELS);
+    JournalLayerId* ids = (JournalLayerId*)malloc(sizeof(JournalLayerId) * stack->count);
+    if (scratch == NULL || ids == NULL) {
+        free(scratch);
+        free(ids);
+        return 0;
+    }
+    int idCount = stack->count;
+    for (int i = 0; i < stack->count; i++) {
+        ids[i] = (JournalLayerId){stack->layers[i].canvas, (unsigned int)i};
+    }
+
+    int replayed = 0;
+    size_t position = JOURNAL_HEADER_SIZE;
+    while (size - position >= JOURNAL_RECORD_HEADER_SIZE) {
+        const unsigned char* header = data + position;
+        size_t payloadSize = GetLittleEndian(header + 4);
+        const unsigned char* payload = header + JOURNAL_RECORD_HEADER_SIZE;
+        if (payloadSize > size - position - JOURNAL_RECORD_HEADER_SIZE ||
+            UpdateCrc32(0, payload, payloadSize) != GetLittleEndian(header + 8)) {
+            break;
+        }
+
+        bool ok = true;
+        if (memcmp(header, "TILE", 4) == 0) {
+            ok = ReplayTileRecord(ids, idCount, payload, payloadSize, scratch);
+        } else if (memcmp(header, "LAYR", 4) == 0) {
+            ok = ReplayLayerRecord(stack, &ids, &idCount, payload, payloadSize);
+        }
+        if (!ok) break;
+
+        replayed++;
+        position += JOURNAL_RECORD_HEADER_SIZE + payloadSize;
+    }
+
+    free(scratch);
+    free(ids);
+    return replayed;
+}
+
+/**
+ * Read a whole file into memory
+ */
+static unsigned char* ReadWholeFile(const char* path, size_t* outSize) {
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) return NULL;
+
+    long size = (fseek(in, 0, SEEK_END) == 0) ? ftell(in) : -1;
+    unsigned char* data = (size > 0 && fseek(in, 0, SEEK_SET) == 0) ? (unsigned char*)malloc((size_t)size) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)size, in) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(in);
+
+    *outSize = (data != NULL) ? (size_t)size : 0;
+    return data;
+}
+
+/**
+ * Rebuild the document left behind by a session that did not exit cleanly
+ */
+LayerStack* RecoverJournal(const char* checkpointPath, const char* journalPath, ProjectFile** outFile,
+                           JournalRecoveryStats* stats) {
+    if (checkpointPath == NULL || journalPath == NULL || outFile == NULL) return NULL;
+    *outFile = NULL;
+
+    // A clean exit removes the journal
+    double start = GetMonotonicTime();
+    size_t size = 0;
+    unsigned char* data = ReadWholeFile(journalPath, &size);
+    if (data == NULL) return NULL;
+
+    unsigned int checksum = 0;
+    LayerStack* stack = ReadProjectChecksum(checkpointPath, &checksum) ? OpenProject(checkpointPath, outFile) : NULL;
+    if (stack == NULL) {
+        free(data);
+        return NULL;
+    }
+
+    // A journal started for an older checkpoint is already part of this one
+    int replayed = 0;
+    if (size >= JOURNAL_HEADER_SIZE && memcmp(data, "PXJL", 4) == 0 &&
+        GetLittleEndian(data + 4) == JOURNAL_VERSION && GetLittleEndian(data + 8) == checksum) {
+        replayed = ReplayJournal(stack, data, size);
+    }
+    free(data);
+
+    DeferLayerComposite(stack);
+
+    if (stats != NULL) {
+        stats->recordsReplayed = replayed;
+        stats->seconds = GetMonotonicTime() - start;
+    }
+    return stack;
+}
@@ -0,0 +1,524 @@
+/**
+ * layer.c
+ *
+ * Implementation of Layer Stack
+ */
+
+#include "layer.h"
+#include "pixelops.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Row bands per tile handed to the thread pool as separate work items
+#define LAYER_COMPOSITE_BANDS 4
+
+static bool ComposeDeferredTile(void* userData, Canvas* canvas, int tileIndex, Color* pixels);
+
+/**
+ * Queue a tile-local rectangle of the composite for rebuilding
+ */
+static void MarkCompositeTile(LayerStack* stack, int tileIndex, int minX, int minY, int maxX, int maxY) {
+    LayerDirtyRect* rect = &stack->dirtyRects[tileIndex];
+
+    if (rect->isDirty) {
+        if (minX < rect->minX) rect->minX = (unsigned short)minX;
+        if (minY < rect->minY) rect->minY = (unsigned short)minY;
+        if (maxX > rect->maxX) rect->maxX = (unsigned short)maxX;
+        if (maxY > rect->maxY) rect->maxY = (unsigned short)maxY;
+        return;
+    }
+
+    if (stack->dirtyCount == stack->dirtyCapacity) {
+        int capacity = stack->dirtyCapacity ? stack->dirtyCapacity * 2 : 64;
+        int* list = (int*)realloc(stack->dirtyTiles, sizeof(int) * capacity);
+        if (list == NULL) return;
+        stack->dirtyTiles = list;
+        stack->dirtyCapacity = capacity;
+    }
+
+    stack->dirtyTiles[stack->dirtyCount++] = tileIndex;
+    rect->isDirty = true;
+    rect->minX = (unsigned short)minX;
+    rect->minY = (unsigned short)minY;
+    rect->maxX = (unsigned short)maxX;
+    rect->maxY = (unsigned short)maxY;
+}
+
+/**
+ * Whether a layer can affect the composite at all
+ */
+static bool IsLayerContributing(const Layer* layer) {
+    return layer->visible && layer->opacity > 0;
+}
+
+/**
+ * Queue every composite tile a layer has pixels in
+ * Used when a layer property changes, which alters all of its pixels at once
+ */
+static void InvalidateLayerTiles(LayerStack* stack, const Layer* layer) {
+    Canvas* canvas = layer->canvas;
+    if (canvas->emptyColor.a > 0) {
+        InvalidateLayerComposite(stack);
+        return;
+    }
+
+    int tileCount = canvas->tilesX * canvas->tilesY;
+    for (int i = 0; i < tileCount; i++) {
+        if (HasCanvasTileData(canvas, i)) {
+            MarkCompositeTile(stack, i, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK);
+        }
+    }
+}
+
+/**
+ * Create a layer stack with one empty layer
+ */
+LayerStack* CreateLayerStack(int width, int height) {
+    LayerStack* stack = (LayerStack*)calloc(1, sizeof(LayerStack));
+    if (stack == NULL) return NULL;
+
+    stack->width = width;
+    stack->height = height;
+    stack->activeIndex = -1;
+    stack->nextLayerNumber = 1;
+
+    stack->composite = CreateCanvas(width, height);
+    if (stack->composite == NULL) {
+        free(stack);
+        return NULL;
+    }
+
+    stack->dirtyRects = (LayerDirtyRect*)calloc((size_t)stack->composite->tilesX * stack->composite->tilesY,
+                                                sizeof(LayerDirtyRect));
+    if (stack->dirtyRects == NULL || AddLayer(stack, NULL) < 0) {
+        DestroyLayerStack(stack);
+        return NULL;
+    }
+    SetCanvasTileLoader(stack->composite, ComposeDeferredTile, stack);
+
+    return stack;
+}
+
+/**
+ * Destroy a layer stack, its layers and its composite
+ */
+void DestroyLayerStack(LayerStack* stack) {
+    if (stack == NULL) return;
+
+    for (int i = 0; i < stack->count; i++) {
+        DestroyCanvas(stack->layers[i].canvas);
+    }
+    free(stack->layers);
+    DestroyCanvas(stack->composite);
+    free(stack->dirtyRects);
+    free(stack->dirtyTiles);
+    free(stack);
+}
+
+/**
+ * Add an empty layer above the active layer and make it active
+ */
+int AddLayer(LayerStack* stack, const char* name) {
+    if (stack == NULL) return -1;
+
+    if (stack->count == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 8;
+        Layer* layers = (Layer*)realloc(stack->layers, sizeof(Layer) * capacity);
+        if (layers == NULL) return -1;
+        stack->layers = layers;
+        stack->capacity = capacity;
+    }
+
+    Layer layer = {0};
+    layer.canvas = CreateCanvas(stack->width, stack->height);
+    if (layer.canvas == NULL) return -1;
+    layer.opacity = 255;
+    layer.visible = true;
+    layer.blendMode = PIXEL_BLEND_NORMAL;
+    if (name != NULL) {
+        snprintf(layer.name, sizeof(layer.name), "%s", name);
+    } else {
+        snprintf(layer.name, sizeof(layer.name), "Layer %d", stack->nextLayerNumber);
+    }
+    stack->nextLayerNumber++;
+
+    // A new layer is empty and transparent: the composite is unchanged
+    int index = stack->activeIndex + 1;
+    memmove(&stack->layers[index + 1], &stack->layers[index], sizeof(Layer) * (stack->count - index));
+    stack->layers[index] = layer;
+    stack->count++;
+    stack->activeIndex = index;
+
+    return index;
+}
+
+/**
+ * Delete a layer
+ */
+bool DeleteLayer(LayerStack* stack, int index, History* history) {
+    if (stack == NULL || index < 0 || index >= stack->count || stack->count <= 1) return false;
+
+    Layer* layer = &stack->layers[index];
+    if (IsLayerContributing(layer)) {
+        InvalidateLayerTiles(stack, layer);
+    }
+    ForgetHistoryCanvas(history, layer->canvas);
+    DestroyCanvas(layer->canvas);
+
+    memmove(&stack->layers[index], &stack->layers[index + 1], sizeof(Layer) * (stack->count - index - 1));
+    stack->count--;
+
+    if (stack->activeIndex > index || stack->activeIndex >= stack->count) {
+        stack->activeIndex--;
+    }
+
+    return true;
+}
+
+/**
+ * Move a layer to a new position in the stack
+ */
+bool MoveLayer(LayerStack* stack, int index, int newIndex) {
+    if (stack == NULL || index < 0 || index >= stack->count) return false;
+    if (newIndex < 0) newIndex = 0;
+    if (newIndex >= stack->count) newIndex = stack->count - 1;
+    if (newIndex == index) return false;
+
+    Layer moved = stack->layers[index];
+    if (newIndex > index) {
+        memmove(&stack->layers[index], &stack->layers[index + 1], sizeof(Layer) * (newIndex - index));
+    } else {
+        memmove(&stack->layers[newIndex + 1], &stack->layers[newIndex], sizeof(Layer) * (index - newIndex));
+    }
+    stack->layers[newIndex] = moved;
+
+    // Keep the same layer active
+    if (stack->activeIndex == index) {
+        stack->activeIndex = newIndex;
+    } else if (index < stack->activeIndex && newIndex >= stack->activeIndex) {
+        stack->activeIndex--;
+    } else if (index > stack->activeIndex && newIndex <= stack->activeIndex) {
+        stack->activeIndex++;
+    }
+
+    // The order only matters where the moved layer has pixels
+    if (IsLayerContributing(&moved)) {
+        InvalidateLayerTiles(stack, &moved);
+    }
+    return true;
+}
+
+/**
+ * Make a layer the one the tools paint on
+ */
+void SelectLayer(LayerStack* stack, int index) {
+    if (stack == NULL || stack->count == 0) return;
+    if (index < 0) index = 0;
+    if (index >= stack->count) index = stack->count - 1;
+    stack->activeIndex = index;
+}
+
+/**
+ * Get the active layer
+ */
+Layer* GetActiveLayer(LayerStack* stack) {
+    if (stack == NULL || stack->activeIndex < 0) return NULL;
+    return &stack->layers[stack->activeIndex];
+}
+
+/**
+ * Get the canvas of the active layer
+ */
+Canvas* GetActiveLayerCanvas(LayerStack* stack) {
+    Layer* layer = GetActiveLayer(stack);
+    return (layer != NULL) ? layer->canvas : NULL;
+}
+
+/**
+ * Show or hide a layer
+ */
+void SetLayerVisible(LayerStack* stack, int index, bool visible) {
+    if (stack == NULL || index < 0 || index >= stack->count) return;
+
+    Layer* layer = &stack->layers[index];
+    if (layer->visible == visible) return;
+
+    layer->visible = visible;
+    if (layer->opacity > 0) {
+        InvalidateLayerTiles(stack, layer);
+    }
+}
+
+/**
+ * Set the opacity of a layer
+ */
+void SetLayerOpacity(LayerStack* stack, int index, unsigned char opacity) {
+    if (stack == NULL || index < 0 || index >= stack->count) return;
+
+    Layer* layer = &stack->layers[index];
+    if (layer->opacity == opacity) return;
+
+    layer->opacity = opacity;
+    if (layer->visible) {
+        InvalidateLayerTiles(stack, layer);
+    }
+}
+
+/**
+ * Set how a layer combines with the layers below it
+ */
+void SetLayerBlendMode(LayerStack* stack, int index, PixelBlendMode mode) {
+    if (stack == NULL || index < 0 || index >= stack->count) return;
+    if (mode <= PIXEL_BLEND_REPLACE || mode >= PIXEL_BLEND_COUNT) {
+        mode = PIXEL_BLEND_NORMAL;
+    }
+
+    Layer* layer = &stack->layers[index];
+    if (layer->blendMode == mode) return;
+
+    layer->blendMode = mode;
+    if (IsLayerContributing(layer)) {
+        InvalidateLayerTiles(stack, layer);
+    }
+}
+
+/**
+ * Drop the whole composite and compose each tile when it is first accessed
+ */
+void DeferLayerComposite(LayerStack* stack) {
+    if (stack == NULL) return;
+
+    int tileCount = stack->composite->tilesX * stack->composite->tilesY;
+    for (int i = 0; i < tileCount; i++) {
+        SetCanvasTilePending(stack->composite, i);
+    }
+    MarkCanvasDirty(stack->composite, 0, 0, stack->width, stack->height);
+}
+
+/**
+ * Mark the whole composite for rebuilding
+ */
+void InvalidateLayerComposite(LayerStack* stack) {
+    if (stack == NULL) return;
+
+    int tileCount = stack->composite->tilesX * stack->composite->tilesY;
+    for (int i = 0; i < tileCount; i++) {
+        MarkCompositeTile(stack, i, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK);
+    }
+}
+
+/**
+ * Whether any visible layer puts something into a tile
+ * Loads the tile of every visible layer that is still pending, so the
+ * tile can then be composed without touching the tile loaders
+ */
+static bool HasTileContributions(LayerStack* stack, int tileIndex) {
+    bool hasContributions = false;
+    for (int i = 0; i < stack->count; i++) {
+        Layer* layer = &stack->layers[i];
+        if (IsLayerContributing(layer) &&
+            (GetCanvasTilePixels(layer->canvas, tileIndex) != NULL || layer->canvas->emptyColor.a > 0)) {
+            hasContributions = true;
+        }
+    }
+    return hasContributions;
+}
+
+/**
+ * The layer whose tile the composite tile would be an exact copy of: the
+ * only visible layer with anything in the tile, at full opacity (NULL if
+ * the tile needs blending)
+ */
+static Canvas* GetSoleTileSource(LayerStack* stack, int tileIndex) {
+    Canvas* source = NULL;
+    for (int i = 0; i < stack->count; i++) {
+        Layer* layer = &stack->layers[i];
+        if (!IsLayerContributing(layer)) continue;
+
+        bool hasPixels = layer->canvas->tiles[tileIndex].pixels != NULL;
+        if (!hasPixels && layer->canvas->emptyColor.a == 0) continue;
+        if (source != NULL || !hasPixels || layer->opacity != 255) return NULL;
+        source = layer->canvas;
+    }
+    return source;
+}
+
+/**
+ * Rebuild rows [minY, maxY] of a composite tile's dirty rectangle into pixels
+ * Only reads the layers and writes this tile's pixels, so different tiles
+ * and different row bands can be composed concurrently
+ */
+static void ComposeTileRows(LayerStack* stack, int tileIndex, Color* pixels, const LayerDirtyRect* rect,
+                            int minY, int maxY) {
+    int width = rect->maxX - rect->minX + 1;
+
+    for (int y = minY; y <= maxY; y++) {
+        int offset = (y << CANVAS_TILE_SHIFT) + rect->minX;
+        Color* out = pixels + offset;
+        bool isFirst = true;
+
+        for (int i = 0; i < stack->count; i++) {
+            Layer* layer = &stack->layers[i];
+            if (!IsLayerContributing(layer)) continue;
+
+            const Color* source = layer->canvas->tiles[tileIndex].pixels;
+            Color empty = layer->canvas->emptyColor;
+            if (source == NULL && empty.a == 0) continue;
+
+            // Any mode over a transparent base is the source itself
+            if (isFirst && source != NULL && layer->opacity == 255) {
+                memcpy(out, source + offset, sizeof(Color) * width);
+                isFirst = false;
+                continue;
+            }
+            if (isFirst) {
+                FillPixels(out, width, (Color){0, 0, 0, 0});
+                isFirst = false;
+            }
+
+            if (source != NULL) {
+                BlendPixelSpan(out, source + offset, width, layer->opacity, layer->blendMode);
+            } else {
+                empty.a = (unsigned char)((empty.a * layer->opacity + 127) / 255);
+                BlendColorSpan(out, width, empty, layer->blendMode);
+            }
+        }
+    }
+}
+
+/**
+ * Tile loader of the composite: composes a deferred tile on first access
+ */
+static bool ComposeDeferredTile(void* userData, Canvas* canvas, int tileIndex, Color* pixels) {
+    (void)canvas;
+    LayerStack* stack = (LayerStack*)userData;
+    if (!HasTileContributions(stack, tileIndex)) return false;
+
+    const LayerDirtyRect full = {true, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK};
+    ComposeTileRows(stack, tileIndex, pixels, &full, 0, CANVAS_TILE_MASK);
+    return true;
+}
+
+/**
+ * ParallelFor task: each index is one row band of one tile to compose
+ */
+static void ComposeTileBands(void* userData, int begin, int end, int workerIndex) {
+    (void)workerIndex;
+    LayerStack* stack = (LayerStack*)userData;
+    const int bandHeight = CANVAS_TILE_SIZE / LAYER_COMPOSITE_BANDS;
+
+    for (int item = begin; item < end; item++) {
+        int tileIndex = stack->dirtyTiles[item / LAYER_COMPOSITE_BANDS];
+        const LayerDirtyRect* rect = &stack->dirtyRects[tileIndex];
+
+        int band = item % LAYER_COMPOSITE_BANDS;
+        int minY = band * bandHeight;
+        int maxY = minY + bandHeight - 1;
+        if (minY < rect->minY) minY = rect->minY;
+        if (maxY > rect->maxY) maxY = rect->maxY;
+        if (minY <= maxY) {
+            ComposeTileRows(stack, tileIndex, stack->composite->tiles[tileIndex].pixels, rect, minY, maxY);
+        }
+    }
+}
+
+/**
+ * Bring the composite up to date
+ */
+int UpdateLayerComposite(LayerStack* stack) {
+    if (stack == NULL) return 0;
+
+    // Collect what each layer changed since the last update; edits to hidden
+    // layers do not show, but their dirty lists are still drained
+    for (int i = 0; i < stack->count; i++) {
+        Layer* layer = &stack->layers[i];
+        Canvas* canvas = layer->canvas;
+
+        if (IsLayerContributing(layer)) {
+            for (int d = 0; d < canvas->dirtyCount; d++) {
+                int tileIndex = canvas->dirtyTiles[d];
+                CanvasTile* tile = &canvas->tiles[tileIndex];
+                MarkCompositeTile(stack, tileIndex, tile->dirtyMinX, tile->dirtyMinY,
+                                  tile->dirtyMaxX, tile->dirtyMaxY);
+            }
+        }
+        ClearCanvasDirtyTiles(canvas);
+    }
+    if (stack->dirtyCount == 0) {
+        stack->lastCompositedTiles = 0;
+        return 0;
+    }
+
+    // Allocation, releases and dirty marking touch shared canvas state, so
+    // they stay on this thread; only the pixel work below is split up
+    Canvas* composite = stack->composite;
+    int composeCount = 0;
+    for (int i = 0; i < stack->dirtyCount; i++) {
+        int tileIndex = stack->dirtyTiles[i];
+        LayerDirtyRect* rect = &stack->dirtyRects[tileIndex];
+
+        // Clip the rectangle to the part of the tile inside the canvas
+        int tileX0 = (tileIndex % composite->tilesX) << CANVAS_TILE_SHIFT;
+        int tileY0 = (tileIndex / composite->tilesX) << CANVAS_TILE_SHIFT;
+        if (tileX0 + rect->maxX >= composite->width) rect->maxX = (unsigned short)(composite->width - 1 - tileX0);
+        if (tileY0 + rect->maxY >= composite->height) rect->maxY = (unsigned short)(composite->height - 1 - tileY0);
+
+        Canvas* source = NULL;
+        if (IsCanvasTilePending(composite, tileIndex)) {
+            // Not composed yet: it will be, from the current layers, when first shown
+            rect->isDirty = false;
+        } else if (!HasTileContributions(stack, tileIndex)) {
+            // Nothing visible here: the composite tile can go back to empty
+            if (GetCanvasTilePixels(composite, tileIndex) != NULL) {
+                RestoreCanvasTile(composite, tileIndex, NULL);
+            }
+            rect->isDirty = false;
+        } else if ((source = GetSoleTileSource(stack, tileIndex)) != NULL) {
+            // A single opaque layer composites to itself: share its tile
+            // instead of keeping a second copy (either side copies on write)
+            if (rect->minX <= rect->maxX && rect->minY <= rect->maxY) {
+                ShareCanvasTile(composite, tileIndex, source);
+                MarkCanvasDirty(composite, tileX0 + rect->minX, tileY0 + rect->minY,
+                                rect->maxX - rect->minX + 1, rect->maxY - rect->minY + 1);
+            }
+            rect->isDirty = false;
+        } else if (rect->minX > rect->maxX || rect->minY > rect->maxY ||
+                   AcquireCanvasTilePixels(composite, tileIndex) == NULL) {
+            rect->isDirty = false;
+        } else {
+            stack->dirtyTiles[composeCount++] = tileIndex;
+        }
+    }
+
+    ParallelFor(stack->pool, composeCount * LAYER_COMPOSITE_BANDS, 1, ComposeTileBands, stack);
+
+    for (int i = 0; i < composeCount; i++) {
+        int tileIndex = stack->dirtyTiles[i];
+        LayerDirtyRect* rect = &stack->dirtyRects[tileIndex];
+        int tileX0 = (tileIndex % composite->tilesX) << CANVAS_TILE_SHIFT;
+        int tileY0 = (tileIndex / composite->tilesX) << CANVAS_TILE_SHIFT;
+        MarkCanvasDirty(composite, tileX0 + rect->minX, tileY0 + rect->minY,
+                        rect->maxX - rect->minX + 1, rect->maxY - rect->minY + 1);
+        rect->isDirty = false;
+    }
+
+    stack->lastCompositedTiles = stack->dirtyCount;
+    stack->dirtyCount = 0;
+    return stack->lastCompositedTiles;
+}
+
+/**
+ * Use a thread pool for compositing
+ */
+void SetLayerStackThreadPool(LayerStack* stack, ThreadPool* pool) {
+    if (stack == NULL) return;
+    stack->pool = pool;
+}
+
+/**
+ * Get the flattened image of all visible layers
+ */
+Canvas* GetLayerComposite(LayerStack* stack) {
+    return (stack != NULL) ? stack->composite : NULL;
+}
@@ -4,43 +4,291 @@
 #include "tool.h"
 #include "ui.h"
 #include "color.h"
+#include "redraw.h"
+#include "history.h"
+#include "layer.h"
+#include "threadpool.h"
+#include "export.h"
+#include "import.h"
+#include "project.h"
+#include "journal.h"
+#include "batch.h"
+#include "profiler.h"
+#include "input.h"
+#include "editor.h"
+#include "replay.h"
+#include "stress.h"
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
 #if defined(PLATFORM_WEB)
     #include <emscripten/emscripten.h>
 #endif
 
 // Global application state
-static Canvas* canvas = NULL;
+static LayerStack* layers = NULL;
 static CanvasCamera* camera = NULL;
 static ToolState* toolState = NULL;
+static History* history = NULL;
+static ThreadPool* threadPool = NULL;
+static ExportJob* exportJob = NULL;     // Latest export, kept to report its result
+static bool isExporting = false;
+static ImportStats importStats;          // Last image import, for the status line
+static bool hasImportStats = false;
+static ProjectFile* projectFile = NULL; // Backs the not yet loaded tiles of an opened project
+static char projectPath[260] = "project.pxp"; // Where Ctrl+S saves
+static Journal* journal = NULL;         // Crash-safe autosave of every edit
+static Profiler* profiler = NULL;       // Per-phase frame timings (F3 overlay, F4 CSV dump)
+static InputRecorder* inputRecorder = NULL; // --record: every frame's input, for --replay
 static ColorPicker colorPicker;
 static const int pixelSize = 1; // Base pixel size before zoom
+static bool continuousRendering = false; // --continuous: redraw every frame (profiling)
+static bool showPixelGrid = false;      // ' toggles lines between pixels at high zoom
+static const Color pixelGridColor = {128, 128, 128, 96};
+static bool wasFocused = true;
+static bool isEventWaiting = false;     // Sleeping in EndDrawing/PollInputEvents until input arrives
 
-static void UpdateDrawFrame(void)
+// Sleep until input arrives unless something must happen without it: a
+// running export reports its progress, and journal records not yet synced
+// to disk would otherwise stay unsynced until the next input
+static void UpdateEventWaiting(void)
+{
+    bool isSyncPending = journal != NULL && journal->file != NULL && journal->needsSync;
+    bool shouldWait = !continuousRendering && !isExporting && !isSyncPending;
+    if (shouldWait == isEventWaiting) return;
+
+    if (shouldWait) {
+        EnableEventWaiting();
+    } else {
+        DisableEventWaiting();
+    }
+    isEventWaiting = shouldWait;
+}
+
+// Ctrl+E exports the flattened image; while the export thread runs the
+// loop keeps rendering so its progress stays current
+static void UpdateExport(Canvas* composite)
 {
-    // Toggle color picker with C key
-    if (IsKeyPressed(KEY_C)) {
-        ToggleColorPicker(&colorPicker);
-        // If opening, sync with current foreground color
-        if (colorPicker.isOpen && toolState != NULL) {
-            SetColorPickerColor(&colorPicker, GetForegroundColor(toolState));
+    bool ctrlDown = IsInputKeyDown(KEY_LEFT_CONTROL) || IsInputKeyDown(KEY_RIGHT_CONTROL);
+    if (ctrlDown && IsInputKeyPressed(KEY_E) && !isExporting && composite != NULL) {
+        DestroyExportJob(exportJob);
+        exportJob = StartPngExport(composite, "export.png");
+        if (exportJob == NULL) {
+            TraceLog(LOG_WARNING, "Failed to start export");
         }
+        isExporting = exportJob != NULL;
+        UpdateEventWaiting();
+        RequestRedraw(REDRAW_UI);
+    }
+
+    if (isExporting) {
+        if (GetExportStatus(exportJob) != EXPORT_RUNNING) {
+            isExporting = false;
+            UpdateEventWaiting();
+        }
+        RequestRedraw(REDRAW_UI);
+    }
+}
+
+// Fit the document into the window (never zooming in) and center it
+static void CenterDocument(void)
+{
+    if (layers == NULL || camera == NULL) return;
+
+    float fitX = (float)GetScreenWidth() / (layers->width * pixelSize);
+    float fitY = (float)GetScreenHeight() / (layers->height * pixelSize);
+    float fit = (fitX < fitY) ? fitX : fitY;
+    camera->zoom = (fit < 1.0f) ? fit : 1.0f;
+    ClampCanvasCameraZoom(camera);
+
+    float scale = pixelSize * camera->zoom;
+    camera->position.x = (GetScreenWidth() - layers->width * scale) / 2.0f;
+    camera->position.y = (GetScreenHeight() - layers->height * scale) / 2.0f;
+    RequestRedraw(REDRAW_CAMERA);
+}
+
+// Swap in a newly opened document (and the project file backing it, if any)
+static void ReplaceDocument(LayerStack* loaded, ProjectFile* file)
+{
+    // A replay starts from the recorded document and cannot follow a switch
+    if (inputRecorder != NULL) {
+        TraceLog(LOG_WARNING, "Document replaced, input recording stopped");
+        DestroyInputRecorder(inputRecorder, GetLayerStackChecksum(layers));
+        inputRecorder = NULL;
+    }
+
+    // Undo steps refer to the old layers
+    ClearHistory(history);
+    SetLayerStackThreadPool(loaded, threadPool);
+    DestroyLayerStack(layers);
+    CloseProject(projectFile); // Only once no layer loads tiles from it
+    layers = loaded;
+    projectFile = file;
+
+    // Autosave from a checkpoint of the new document
+    if (journal != NULL && !ResetJournal(journal, layers, &projectFile)) {
+        TraceLog(LOG_WARNING, "Failed to write %s, autosave is off", journal->checkpointPath);
+    }
+
+    CenterDocument();
+    RequestRedraw(REDRAW_CANVAS | REDRAW_UI);
+}
+
+// Replace the document with a project file; its tiles load as they are shown
+static bool OpenProjectDocument(const char* path)
+{
+    if (strlen(path) >= sizeof(projectPath)) return false;
+
+    double start = GetTime();
+    ProjectFile* file = NULL;
+    LayerStack* loaded = OpenProject(path, &file);
+    if (loaded == NULL) {
+        TraceLog(LOG_WARNING, "Failed to open project %s", path);
+        return false;
+    }
+    TraceLog(LOG_INFO, "Opened project %s: %dx%d, %d layers in %.3f s", path, loaded->width, loaded->height,
+             loaded->count, GetTime() - start);
+
+    ReplaceDocument(loaded, file);
+    strcpy(projectPath, path);
+    hasImportStats = false;
+    return true;
+}
+
+// Replace the document with an image file
+static bool OpenImageDocument(const char* path)
+{
+    ImportStats stats = {0};
+    LayerStack* loaded = ImportImageDocument(path, &stats);
+    if (loaded == NULL) {
+        TraceLog(LOG_WARNING, "Failed to import %s", path);
+        return false;
     }
+    TraceLog(LOG_INFO, "Imported %s: %dx%d in %.3f s (%.1f MP/s, %s, %.1f MB)", path, stats.width, stats.height,
+             stats.seconds, GetImportMegapixelsPerSecond(&stats), stats.isStreamed ? "streamed" : "whole image",
+             stats.canvasBytes / (1024.0 * 1024.0));
+
+    ReplaceDocument(loaded, NULL);
+    strcpy(projectPath, "project.pxp");
+    importStats = stats;
+    hasImportStats = true;
+    return true;
+}
 
-    // Handle clicking on color swatches to open picker
-    Vector2 mousePos = GetMousePosition();
-    Rectangle swatchArea = {10, 55, 50, 50};
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) &&
-        CheckCollisionPointRec(mousePos, swatchArea) &&
-        !colorPicker.isOpen) {
-        ToggleColorPicker(&colorPicker);
-        if (toolState != NULL) {
-            SetColorPickerColor(&colorPicker, GetForegroundColor(toolState));
+// Replace the document with a project or an image, by file extension
+static bool OpenDocument(const char* path)
+{
+    if (IsFileExtension(path, PROJECT_FILE_EXTENSION)) {
+        return OpenProjectDocument(path);
+    }
+    return OpenImageDocument(path);
+}
+
+// Ctrl+S saves the document as a project, over the one it was opened from
+static void UpdateProjectSave(void)
+{
+    bool ctrlDown = IsInputKeyDown(KEY_LEFT_CONTROL) || IsInputKeyDown(KEY_RIGHT_CONTROL);
+    if (!ctrlDown || !IsInputKeyPressed(KEY_S) || layers == NULL) return;
+    if (toolState != NULL && toolState->isDrawing) return;
+
+    double start = GetTime();
+    if (SaveProject(layers, projectPath, &projectFile)) {
+        TraceLog(LOG_INFO, "Saved project %s in %.3f s", projectPath, GetTime() - start);
+    } else {
+        TraceLog(LOG_WARNING, "Failed to save project %s", projectPath);
+    }
+    RequestRedraw(REDRAW_UI);
+}
+
+// F3 toggles the profiler overlay, F4 dumps the recorded frames to CSV
+static void UpdateProfilerInput(void)
+{
+    if (profiler == NULL) return;
+
+    if (IsInputKeyPressed(KEY_F3)) {
+        profiler->overlayVisible = !profiler->overlayVisible;
+        RequestRedraw(REDRAW_UI);
+    }
+    if (IsInputKeyPressed(KEY_F4)) {
+        int written = WriteProfileCsv(profiler, "profile.csv", PROFILER_FRAME_CAPACITY);
+        if (written >= 0) {
+            TraceLog(LOG_INFO, "Wrote %d profiled frames to profile.csv", written);
+        } else {
+            TraceLog(LOG_WARNING, "Failed to write profile.csv");
         }
     }
+}
+
+// ' toggles the pixel grid (shown from CANVAS_GRID_MIN_SCALE screen pixels per pixel)
+static void UpdateViewInput(void)
+{
+    if (IsInputKeyPressed(KEY_APOSTROPHE)) {
+        showPixelGrid = !showPixelGrid;
+        RequestRedraw(REDRAW_UI);
+    }
+}
+
+// Save the current document next to an input log and start recording
+static void StartInputRecording(const char* path)
+{
+    InputLogHeader header = {0};
+    if (snprintf(header.documentPath, sizeof(header.documentPath), "%s%s", path, PROJECT_FILE_EXTENSION) >=
+        (int)sizeof(header.documentPath)) {
+        TraceLog(LOG_WARNING, "Input log path %s is too long", path);
+        return;
+    }
+    if (!SaveProject(layers, header.documentPath, &projectFile)) {
+        TraceLog(LOG_WARNING, "Failed to save %s, input is not recorded", header.documentPath);
+        return;
+    }
+
+    header.screenWidth = GetScreenWidth();
+    header.screenHeight = GetScreenHeight();
+    header.cameraPosition = camera->position;
+    header.cameraZoom = camera->zoom;
+    header.pickerBounds = colorPicker.bounds;
+    inputRecorder = CreateInputRecorder(path, &header);
+    if (inputRecorder != NULL) {
+        TraceLog(LOG_INFO, "Recording input to %s (replay with --replay %s)", path, path);
+    } else {
+        TraceLog(LOG_WARNING, "Failed to create input log %s", path);
+    }
+}
+
+// Open the first image or project dropped onto the window
+static void UpdateFileDrop(void)
+{
+    if (!IsFileDropped()) return;
+
+    FilePathList files = LoadDroppedFiles();
+    if (files.count > 0 && toolState != NULL && !toolState->isDrawing) {
+        OpenDocument(files.paths[0]);
+    }
+    UnloadDroppedFiles(files);
+}
+
+static void UpdateDrawFrame(void)
+{
+    double frameStart = GetTime();
+    BeginProfileFrame(profiler);
+    BeginProfilePhase(profiler, PROFILE_INPUT);
+
+    // Capture this frame's input; everything below reads it through input.h
+    InputFrame input;
+    PollInputFrame(&input);
+    SetInputFrame(&input);
+    if (inputRecorder != NULL && !RecordInputFrame(inputRecorder, &input)) {
+        TraceLog(LOG_WARNING, "Failed to write the input log, recording stopped");
+        DestroyInputRecorder(inputRecorder, 0);
+        inputRecorder = NULL;
+    }
+
+    UpdateColorPickerShortcuts(&colorPicker, toolState);
+    EndProfilePhase(profiler, PROFILE_INPUT);
 
     // Update color picker (handle input and get new color)
+    BeginProfilePhase(profiler, PROFILE_COLOR_PICKER);
     if (toolState != NULL) {
         Color newColor = GetForegroundColor(toolState);
         if (UpdateColorPicker(&colorPicker, &newColor)) {
@@ -48,43 +296,104 @@ static void UpdateDrawFrame(void)
             SetForegroundColor(toolState, newColor);
         }
     }
+    EndProfilePhase(profiler, PROFILE_COLOR_PICKER);
+
+    // Undo/redo (not while a stroke is in progress)
+    BeginProfilePhase(profiler, PROFILE_INPUT);
+    UpdateHistoryShortcuts(history, toolState);
+    EndProfilePhase(profiler, PROFILE_INPUT);
 
     // Only update camera and tools if not interacting with color picker
     bool isOverPicker = IsMouseOverColorPicker(&colorPicker);
 
     // Update camera based on input (only if not over color picker)
+    BeginProfilePhase(profiler, PROFILE_CAMERA);
     if (camera != NULL && !isOverPicker) {
         UpdateCanvasCamera(camera);
     }
+    EndProfilePhase(profiler, PROFILE_CAMERA);
 
-    // Update tool state and handle drawing (only if not over color picker)
-    if (toolState != NULL && canvas != NULL && camera != NULL && !isOverPicker) {
-        UpdateToolState(toolState, canvas, camera, pixelSize);
+    // Update tool state and handle drawing on the active layer (only if not over color picker)
+    BeginProfilePhase(profiler, PROFILE_TOOLS);
+    Canvas* activeCanvas = GetActiveLayerCanvas(layers);
+    if (toolState != NULL && activeCanvas != NULL && camera != NULL && !isOverPicker) {
+        UpdateToolState(toolState, activeCanvas, camera, pixelSize);
     }
+    EndProfilePhase(profiler, PROFILE_TOOLS);
+
+    BeginProfilePhase(profiler, PROFILE_INPUT);
+    UpdateLayerShortcuts(layers, history, toolState);
+    UpdateFileDrop();
+    UpdateProjectSave();
+    UpdateProfilerInput();
+    UpdateViewInput();
+    EndProfilePhase(profiler, PROFILE_INPUT);
+
+    BeginProfilePhase(profiler, PROFILE_AUTOSAVE);
+    UpdateJournal(journal, toolState == NULL || !toolState->isDrawing, &projectFile);
+    UpdateEventWaiting();
+    EndProfilePhase(profiler, PROFILE_AUTOSAVE);
+
+    // Fold this frame's layer edits into the flattened image
+    BeginProfilePhase(profiler, PROFILE_COMPOSITE);
+    UpdateLayerComposite(layers);
+    Canvas* composite = GetLayerComposite(layers);
+
+    UpdateExport(composite);
+    EndProfilePhase(profiler, PROFILE_COMPOSITE);
+
+    // Window changes invalidate whatever was last presented
+    bool isFocused = IsWindowFocused();
+    if (IsWindowResized() || isFocused != wasFocused) {
+        RequestRedraw(REDRAW_WINDOW);
+    }
+    wasFocused = isFocused;
+
+    // Pending texture uploads mean the canvas on screen is stale
+    if (composite != NULL && composite->dirtyCount > 0) {
+        RequestRedraw(REDRAW_CANVAS);
+    }
+
+    // Nothing visible changed: keep the last presented frame and go back to
+    // waiting for input instead of re-rendering an identical image
+    if (!continuousRendering && (!IsRedrawPending() || IsWindowMinimized())) {
+        RecordLoopIteration(false, GetTime() - frameStart);
+        EndProfileFrame(profiler, false);
+        PollInputEvents();
+        if (!isEventWaiting) {
+            WaitTime(1.0 / 60.0); // Not sleeping until input, and no EndDrawing to pace the loop
+        }
+        return;
+    }
+    ConsumeRedrawRequests();
 
     // Begin drawing
     BeginDrawing();
     ClearBackground(DARKGRAY);
 
     // Draw the canvas
-    if (canvas != NULL && camera != NULL) {
-        DrawCanvas(canvas, camera->position, camera->zoom, pixelSize);
+    BeginProfilePhase(profiler, PROFILE_DRAW_CANVAS);
+    if (composite != NULL && camera != NULL) {
+        DrawCanvas(composite, camera->position, camera->zoom, pixelSize);
+        if (showPixelGrid) {
+            DrawCanvasPixelGrid(camera->position, composite->width, composite->height, pixelSize, camera->zoom,
+                                pixelGridColor);
+        }
 
         // Draw a border around the canvas for visibility
-        int scaledPixelSize = (int)(pixelSize * camera->zoom);
-        int canvasScreenWidth = canvas->width * scaledPixelSize;
-        int canvasScreenHeight = canvas->height * scaledPixelSize;
-        DrawRectangleLines((int)camera->position.x - 1, (int)camera->position.y - 1,
-                          canvasScreenWidth + 2, canvasScreenHeight + 2, WHITE);
+        DrawCanvasBorder(camera->position, composite->width, composite->height, pixelSize, camera->zoom, WHITE);
     }
+    EndProfilePhase(profiler, PROFILE_DRAW_CANVAS);
 
     // Draw some info text
+    BeginProfilePhase(profiler, PROFILE_DRAW_UI);
     DrawText("Pixel Art Tool - Color System", 10, 10, 20, WHITE);
-    DrawText(TextFormat("Canvas: %dx%d pixels | Zoom: %d%% | Tool: %s",
-             canvas ? canvas->width : 0,
-             canvas ? canvas->height : 0,
+    DrawText(TextFormat("Canvas: %dx%d pixels | Zoom: %d%% | Tool: %s | Blend: %s (M)",
+             layers ? layers->width : 0,
+             layers ? layers->height : 0,
              camera ? GetCanvasCameraZoomPercent(camera) : 100,
-             toolState ? GetToolName(toolState) : "None"), 10, 35, 16, LIGHTGRAY);
+             toolState ? GetToolName(toolState) : "None",
+             toolState ? GetPixelBlendModeName(toolState->blendMode) : "Normal"), 10, 35, 16, LIGHTGRAY);
 
     // Draw color swatches (foreground/background)
     if (toolState != NULL) {
@@ -94,40 +403,141 @@ static void UpdateDrawFrame(void)
     }
 
     // Draw color picker UI
+    EndProfilePhase(profiler, PROFILE_DRAW_UI);
+    BeginProfilePhase(profiler, PROFILE_COLOR_PICKER);
     if (toolState != NULL) {
         Color currentColor = GetForegroundColor(toolState);
         DrawColorPicker(&colorPicker, currentColor);
     }
+    EndProfilePhase(profiler, PROFILE_COLOR_PICKER);
+    BeginProfilePhase(profiler, PROFILE_DRAW_UI);
 
     // Draw controls help text
-    DrawText("Tools: B = Pencil | E = Eraser | I = Eyedropper", 10, 110, 14, GRAY);
-    DrawText("Color: X = Swap | C = Color Picker | Click swatches to pick", 10, 128, 14, GRAY);
-    DrawText("Pan: Middle Mouse/Space+Drag | Zoom: Mouse Wheel | R = Reset", 10, 146, 14, GRAY);
+    DrawText(TextFormat("Tools: B = Pencil | E = Eraser | I = Eyedropper | G = Fill (Shift+G = Mode) | Brush: %dpx %s ([ ] = Size, K = Shape)",
+             toolState ? toolState->brushSize : 1,
+             toolState ? GetBrushShapeName(toolState) : "Round"), 10, 110, 14, GRAY);
+    DrawText("Color: X = Swap | C = Color Picker | Click swatches to pick | Ctrl+E = Export PNG | Ctrl+S = Save project", 10, 128, 14, GRAY);
+    DrawText("Pan: Middle Mouse/Space+Drag | Zoom: Mouse Wheel | R = Reset | ' = Pixel grid | Drop an image or project to open it", 10, 146, 14, GRAY);
+    if (history != NULL) {
+        DrawText(TextFormat("History: Ctrl+Z = Undo (%d) | Ctrl+Y = Redo (%d) | %.1f / %.0f MB | Autosave: %s",
+                 history->cursor, history->count - history->cursor,
+                 history->bytesUsed / (1024.0f * 1024.0f), history->byteBudget / (1024.0f * 1024.0f),
+                 (journal != NULL && journal->file != NULL) ?
+                 TextFormat("%d records, %.1f MB journal", journal->recordCount, journal->journalBytes / (1024.0f * 1024.0f)) :
+                 "off"),
+                 10, 200, 14, (CanUndo(history) || CanRedo(history)) ? LIGHTGRAY : GRAY);
+    }
+
+    // Draw the layer list
+    DrawLayerPanel(layers, 10, 236);
 
+    // Draw export progress or result, otherwise the last import
+    if (exportJob != NULL) {
+        ExportStatus status = GetExportStatus(exportJob);
+        const char* text = (status == EXPORT_RUNNING) ?
+            TextFormat("Exporting %s... %d%%", exportJob->path, (int)(GetExportProgress(exportJob) * 100.0f)) :
+            (status == EXPORT_DONE) ?
+            TextFormat("Exported %s in %.2f s", exportJob->path, GetExportElapsedTime(exportJob)) :
+            TextFormat("Export to %s failed", exportJob->path);
+        DrawText(text, 10, GetScreenHeight() - 24, 14, (status == EXPORT_FAILED) ? RED : LIGHTGRAY);
+    } else if (projectFile != NULL) {
+        DrawText(TextFormat("Project %s | %d tiles loaded", projectPath, (int)GetProjectTilesLoaded(projectFile)),
+                 10, GetScreenHeight() - 24, 14, GRAY);
+    } else if (hasImportStats) {
+        DrawText(TextFormat("Imported %dx%d in %.2f s (%.1f MP/s, %s)", importStats.width, importStats.height,
+                 importStats.seconds, GetImportMegapixelsPerSecond(&importStats),
+                 importStats.isStreamed ? "streamed" : "whole image"), 10, GetScreenHeight() - 24, 14, GRAY);
+    }
+
+    // Draw render loop statistics
+    RedrawStats redrawStats = GetRedrawStats();
+    DrawText(TextFormat("Render: %s | Frames drawn: %lu | Skipped: %lu | Busy: %.1f%% (idle target %.0f%%) | F3 = Profiler",
+             continuousRendering ? "continuous" : "on demand",
+             redrawStats.framesRendered, redrawStats.framesSkipped,
+             redrawStats.busyPercent, IDLE_CPU_TARGET_PERCENT), 10, 164, 14, GRAY);
+    if (colorPicker.isOpen) {
+        ColorPickerStats pickerStats = GetColorPickerStats(&colorPicker);
+        DrawText(TextFormat("Picker: %d draw calls | %d conversions | %d gradient uploads",
+                 pickerStats.drawCalls, pickerStats.colorConversions, pickerStats.gradientUpdates),
+                 10, 182, 14, GRAY);
+    }
+
+    DrawProfilerOverlay(profiler, GetScreenWidth() - 340, GetScreenHeight() - 250);
+    EndProfilePhase(profiler, PROFILE_DRAW_UI);
+
+    // Measure before EndDrawing, which blocks on frame pacing and input events
+    if (composite != NULL) {
+        SetProfileDrawCounts(profiler, composite->drawCalls,
+                             colorPicker.isOpen ? GetColorPickerStats(&colorPicker).drawCalls : 0,
+                             composite->textureUploads);
+    }
+    EndProfileFrame(profiler, true);
+    double busySeconds = GetTime() - frameStart;
     EndDrawing();
+    RecordLoopIteration(true, busySeconds);
 }
 
-int main(void)
+int main(int argc, char* argv[])
 {
     const int screenWidth = 1024;
     const int screenHeight = 768;
 
+    // Headless batch, replay and stress runs never open the main window
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+        return RunBatchCommand(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--replay") == 0) {
+        return RunReplayCommand(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--stress") == 0) {
+        return RunStressCommand(argc - 2, argv + 2);
+    }
+
+    // Parse command line flags; any other argument is an image or project to open
+    const char* openPath = NULL;
+    const char* recordPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--continuous") == 0) {
+            continuousRendering = true;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else {
+            openPath = argv[i];
+        }
+    }
+
+#if defined(PLATFORM_WEB)
+    continuousRendering = true; // The browser drives the frame loop
+#endif
+
     InitWindow(screenWidth, screenHeight, "Pixel Art Tool");
     SetTargetFPS(60);
 
-    // Create a 64x64 pixel canvas
-    canvas = CreateCanvas(64, 64);
-    if (!canvas) {
+    // Sleep in EndDrawing/PollInputEvents until input arrives instead of
+    // spinning at the target frame rate
+    UpdateEventWaiting();
+
+    // Create a 64x64 pixel document with one layer
+    layers = CreateLayerStack(64, 64);
+    if (!layers) {
         TraceLog(LOG_ERROR, "Failed to create canvas");
         CloseWindow();
         return 1;
     }
 
+    // Frame timings are recorded from the first frame; a failed profiler only hides the overlay
+    profiler = CreateProfiler();
+
+    // Composite layers on all cores (a failed pool just means one thread)
+    threadPool = CreateThreadPool(0);
+    SetLayerStackThreadPool(layers, threadPool);
+
     // Create the camera
     camera = CreateCanvasCamera();
     if (!camera) {
         TraceLog(LOG_ERROR, "Failed to create camera");
-        DestroyCanvas(canvas);
+        DestroyLayerStack(layers);
+        DestroyThreadPool(threadPool);
         CloseWindow();
         return 1;
     }
@@ -137,21 +547,74 @@ int main(void)
     if (!toolState) {
         TraceLog(LOG_ERROR, "Failed to create tool state");
         DestroyCanvasCamera(camera);
-        DestroyCanvas(canvas);
+        DestroyLayerStack(layers);
+        DestroyThreadPool(threadPool);
         CloseWindow();
         return 1;
     }
 
+    // Create the undo history and record strokes into it
+    history = CreateHistory(DEFAULT_HISTORY_BUDGET);
+    if (!history) {
+        TraceLog(LOG_WARNING, "Failed to create history, undo is disabled");
+    }
+    SetToolHistory(toolState, history);
+
     // Initialize color picker (positioned on the right side of screen)
     colorPicker = InitColorPicker(screenWidth - 270, 100, 250, 250);
 
-    // Center the canvas on screen
-    int scaledPixelSize = (int)(pixelSize * camera->zoom);
-    camera->position.x = (screenWidth - (canvas->width * scaledPixelSize)) / 2.0f;
-    camera->position.y = (screenHeight - (canvas->height * scaledPixelSize)) / 2.0f;
+    // Journal every edit; a journal left behind means the last session crashed
+    journal = CreateJournal("autosave.pxp", "autosave.journal");
+    if (journal != NULL && history != NULL) {
+        SetHistoryApplyCallback(history, RecordJournalHistoryStep, journal);
+    }
+    ProjectFile* recoveredFile = NULL;
+    JournalRecoveryStats recovery = {0};
+    LayerStack* recovered = (journal != NULL) ?
+        RecoverJournal(journal->checkpointPath, journal->journalPath, &recoveredFile, &recovery) : NULL;
+
+    // Opening a file starts a new journal over the crashed session's, so
+    // that session is saved as a project of its own first
+    if (recovered != NULL && openPath != NULL) {
+        // Never over an earlier recovery the user has not looked at yet
+        char savePath[32] = "recovered.pxp";
+        FILE* existing = NULL;
+        for (int i = 2; i < 100 && (existing = fopen(savePath, "rb")) != NULL; i++) {
+            fclose(existing);
+            snprintf(savePath, sizeof(savePath), "recovered-%d.pxp", i);
+        }
+
+        if (existing == NULL && SaveProject(recovered, savePath, &recoveredFile)) {
+            TraceLog(LOG_WARNING, "Saved the last session, which did not exit cleanly, to %s", savePath);
+        } else {
+            // Keep its autosave files for the next start instead
+            TraceLog(LOG_WARNING, "Failed to save the last session to %s, autosave is off", savePath);
+            SetHistoryApplyCallback(history, NULL, NULL);
+            DestroyJournal(journal, false);
+            journal = NULL;
+        }
+        DestroyLayerStack(recovered);
+        CloseProject(recoveredFile);
+        recovered = NULL;
+    }
 
-    // Canvas starts empty - ready for user to draw!
+    // Canvas starts empty - ready for user to draw! (unless a file was given or recovered)
+    if (recovered != NULL) {
+        TraceLog(LOG_INFO, "Recovered the last session: %d journal records in %.3f s",
+                 recovery.recordsReplayed, recovery.seconds);
+        ReplaceDocument(recovered, recoveredFile);
+    } else if (openPath == NULL || !OpenDocument(openPath)) {
+        if (journal != NULL && !ResetJournal(journal, layers, &projectFile)) {
+            TraceLog(LOG_WARNING, "Failed to write %s, autosave is off", journal->checkpointPath);
+        }
+    }
+    CenterDocument();
 
+    // Record input from the first frame on; the starting document is saved
+    // next to the log so a replay begins from exactly these pixels
+    if (recordPath != NULL) {
+        StartInputRecording(recordPath);
+    }
 
 #if defined(PLATFORM_WEB)
     emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
@@ -162,10 +625,21 @@ int main(void)
     }
 #endif
 
-    // Cleanup
+    // Cleanup (waits for a running export, which holds its own snapshot)
+    DestroyExportJob(exportJob);
     DestroyToolState(toolState);
+    DestroyHistory(history);
     DestroyCanvasCamera(camera);
-    DestroyCanvas(canvas);
+    if (inputRecorder != NULL) {
+        DestroyInputRecorder(inputRecorder, GetLayerStackChecksum(layers));
+    }
+    DestroyLayerStack(layers);
+    CloseProject(projectFile);
+    DestroyJournal(journal, true); // A clean exit leaves nothing to recover
+    DestroyThreadPool(threadPool);
+    UnloadColorPicker(&colorPicker);
+    UnloadCheckerboardTexture();
+    DestroyProfiler(profiler);
     CloseWindow();
 
     return 0;
@@ -0,0 +1,127 @@
+/**
+ * mapfile.c
+ *
+ * Implementation of File Mapping and Syncing
+ * Kept free of raylib.h so the Windows header can be included safely
+ */
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #include <io.h>
+#else
+    #define _POSIX_C_SOURCE 200112L
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "mapfile.h"
+#include <stdlib.h>
+
+struct MappedFile {
+    const unsigned char* data;
+    size_t size;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+/**
+ * Map a file into memory for reading
+ */
+MappedFile* OpenMappedFile(const char* path) {
+    if (path == NULL) return NULL;
+
+    MappedFile* mapped = (MappedFile*)calloc(1, sizeof(MappedFile));
+    if (mapped == NULL) return NULL;
+
+#if defined(_WIN32)
+    mapped->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (mapped->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(mapped->file, &size) ||
+        size.QuadPart <= 0 || (unsigned long long)size.QuadPart > (size_t)-1) {
+        if (mapped->file != INVALID_HANDLE_VALUE) CloseHandle(mapped->file);
+        free(mapped);
+        return NULL;
+    }
+    mapped->size = (size_t)size.QuadPart;
+
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapped->mapping != NULL) {
+        mapped->data = (const unsigned char*)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (mapped->data == NULL) {
+        if (mapped->mapping != NULL) CloseHandle(mapped->mapping);
+        CloseHandle(mapped->file);
+        free(mapped);
+        return NULL;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size <= 0) {
+        if (fd >= 0) close(fd);
+        free(mapped);
+        return NULL;
+    }
+    mapped->size = (size_t)info.st_size;
+
+    // The mapping keeps the file alive; the descriptor is not needed
+    void* data = mmap(NULL, mapped->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        free(mapped);
+        return NULL;
+    }
+    mapped->data = (const unsigned char*)data;
+#endif
+
+    return mapped;
+}
+
+/**
+ * Get the mapped contents of a file
+ */
+const unsigned char* GetMappedFileData(const MappedFile* file) {
+    return (file != NULL) ? file->data : NULL;
+}
+
+/**
+ * Get the size of a mapped file
+ */
+size_t GetMappedFileSize(const MappedFile* file) {
+    return (file != NULL) ? file->size : 0;
+}
+
+/**
+ * Unmap a file and free the MappedFile
+ */
+void CloseMappedFile(MappedFile* file) {
+    if (file == NULL) return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+    CloseHandle(file->file);
+#else
+    munmap((void*)file->data, file->size);
+#endif
+    free(file);
+}
+
+/**
+ * Flush a file's buffers and wait until its data is on the disk
+ */
+bool FlushFileToDisk(FILE* file) {
+    if (file == NULL || fflush(file) != 0) return false;
+
+#if defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
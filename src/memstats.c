@@ -0,0 +1,95 @@
+/**
+ * memstats.c
+ *
+ * Implementation of Process Memory Statistics
+ * Kept free of raylib.h so the Windows header can be included safely
+ */
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define PSAPI_VERSION 2     // K32 functions from kernel32, no psapi library needed
+    #include <windows.h>
+    #include <psapi.h>
+#elif !defined(__linux__)
+    #include <sys/resource.h>
+#endif
+
+#include "memstats.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+/**
+ * Read a "Name:  value kB" line of /proc/self/status
+ */
+static size_t ReadProcStatusBytes(const char* name) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file == NULL) return 0;
+
+    char line[128];
+    size_t nameLength = strlen(name);
+    size_t bytes = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long kilobytes;
+        if (strncmp(line, name, nameLength) == 0 && line[nameLength] == ':' &&
+            sscanf(line + nameLength + 1, "%lu", &kilobytes) == 1) {
+            bytes = (size_t)kilobytes * 1024;
+            break;
+        }
+    }
+    fclose(file);
+    return bytes;
+}
+#endif
+
+/**
+ * Get the peak resident memory of the process
+ */
+size_t GetPeakResidentBytes(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#elif defined(__linux__)
+    return ReadProcStatusBytes("VmHWM");
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    #if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;            // Bytes on macOS
+    #else
+    return (size_t)usage.ru_maxrss * 1024;     // Kilobytes elsewhere
+    #endif
+#endif
+}
+
+/**
+ * Get the current resident memory of the process
+ */
+size_t GetCurrentResidentBytes(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize;
+#elif defined(__linux__)
+    return ReadProcStatusBytes("VmRSS");
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Restart the peak from the current resident memory
+ */
+bool ResetPeakResidentBytes(void) {
+#if defined(__linux__)
+    // Writing 5 to clear_refs resets VmHWM to the current RSS (Linux 4.0+)
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (file == NULL) return false;
+    bool ok = fputs("5", file) >= 0;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+#else
+    return false;
+#endif
+}
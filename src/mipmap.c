@@ -0,0 +1,239 @@
+/**
+ * mipmap.c
+ *
+ * Implementation of Canvas Mip Pyramid
+ */
+
+#include "mipmap.h"
+#include "pixelops.h"
+#include <stdlib.h>
+
+/**
+ * Create the pyramid levels for a canvas, all reading as its empty color
+ */
+CanvasMipmap* CreateCanvasMipmap(Canvas* canvas) {
+    if (canvas == NULL || !canvas->tiles) return NULL;
+    if (canvas->width <= CANVAS_TILE_SIZE && canvas->height <= CANVAS_TILE_SIZE) return NULL;
+
+    CanvasMipmap* mipmap = (CanvasMipmap*)calloc(1, sizeof(CanvasMipmap));
+    if (mipmap == NULL) return NULL;
+
+    int tileCount = canvas->tilesX * canvas->tilesY;
+    mipmap->tileCount = tileCount;
+    mipmap->isTileDirty = (unsigned char*)calloc((size_t)tileCount, sizeof(unsigned char));
+    mipmap->dirtyRects = (CanvasMipmapRect*)malloc((size_t)tileCount * sizeof(CanvasMipmapRect));
+    mipmap->dirtyTiles = (int*)malloc((size_t)tileCount * sizeof(int));
+    if (mipmap->isTileDirty == NULL || mipmap->dirtyRects == NULL || mipmap->dirtyTiles == NULL) {
+        DestroyCanvasMipmap(mipmap);
+        return NULL;
+    }
+
+    int width = canvas->width;
+    int height = canvas->height;
+    while ((width > CANVAS_TILE_SIZE || height > CANVAS_TILE_SIZE) && mipmap->levelCount < CANVAS_MIP_MAX_LEVELS) {
+        width = (width + 1) >> 1;
+        height = (height + 1) >> 1;
+        Canvas* level = CreateCanvas(width, height);
+        if (level == NULL) {
+            DestroyCanvasMipmap(mipmap);
+            return NULL;
+        }
+        ClearCanvas(level, canvas->emptyColor);
+        mipmap->levels[mipmap->levelCount++] = level;
+    }
+
+    // Empty tiles already match the levels; everything else needs downsampling
+    for (int i = 0; i < tileCount; i++) {
+        if (HasCanvasTileData(canvas, i)) {
+            MarkCanvasMipmapTile(mipmap, i, 0, 0, CANVAS_TILE_MASK, CANVAS_TILE_MASK);
+        }
+    }
+    return mipmap;
+}
+
+/**
+ * Destroy a pyramid and its levels
+ */
+void DestroyCanvasMipmap(CanvasMipmap* mipmap) {
+    if (mipmap == NULL) return;
+
+    for (int i = 0; i < mipmap->levelCount; i++) {
+        DestroyCanvas(mipmap->levels[i]);
+    }
+    free(mipmap->isTileDirty);
+    free(mipmap->dirtyRects);
+    free(mipmap->dirtyTiles);
+    free(mipmap);
+}
+
+/**
+ * Record a changed tile rectangle, growing the one already recorded
+ */
+void MarkCanvasMipmapTile(CanvasMipmap* mipmap, int tileIndex, int minX, int minY, int maxX, int maxY) {
+    if (mipmap == NULL) return;
+
+    CanvasMipmapRect* rect = &mipmap->dirtyRects[tileIndex];
+    if (mipmap->isTileDirty[tileIndex]) {
+        if (minX < rect->minX) rect->minX = (unsigned short)minX;
+        if (minY < rect->minY) rect->minY = (unsigned short)minY;
+        if (maxX > rect->maxX) rect->maxX = (unsigned short)maxX;
+        if (maxY > rect->maxY) rect->maxY = (unsigned short)maxY;
+        return;
+    }
+
+    mipmap->isTileDirty[tileIndex] = 1;
+    *rect = (CanvasMipmapRect){(unsigned short)minX, (unsigned short)minY, (unsigned short)maxX, (unsigned short)maxY};
+    mipmap->dirtyTiles[mipmap->dirtyCount++] = tileIndex;
+}
+
+/**
+ * Clear every level and drop the flagged tiles
+ */
+void ClearCanvasMipmap(CanvasMipmap* mipmap, Color color) {
+    if (mipmap == NULL) return;
+
+    for (int i = 0; i < mipmap->levelCount; i++) {
+        ClearCanvas(mipmap->levels[i], color);
+    }
+    for (int i = 0; i < mipmap->dirtyCount; i++) {
+        mipmap->isTileDirty[mipmap->dirtyTiles[i]] = 0;
+    }
+    mipmap->dirtyCount = 0;
+}
+
+/**
+ * Average four pixels, weighting color by alpha so transparent pixels add no color
+ */
+static inline Color AverageQuad(Color a, Color b, Color c, Color d) {
+    unsigned int alpha = (unsigned int)a.a + b.a + c.a + d.a;
+    if (alpha == 0) {
+        return (Color){0, 0, 0, 0};
+    }
+    if (alpha == 4 * 255) {
+        return (Color){
+            (unsigned char)((a.r + b.r + c.r + d.r + 2) >> 2),
+            (unsigned char)((a.g + b.g + c.g + d.g + 2) >> 2),
+            (unsigned char)((a.b + b.b + c.b + d.b + 2) >> 2),
+            255
+        };
+    }
+
+    unsigned int half = alpha >> 1;
+    return (Color){
+        (unsigned char)((a.r * a.a + b.r * b.a + c.r * c.a + d.r * d.a + half) / alpha),
+        (unsigned char)((a.g * a.a + b.g * b.a + c.g * c.a + d.g * d.a + half) / alpha),
+        (unsigned char)((a.b * a.a + b.b * b.a + c.b * c.a + d.b * d.a + half) / alpha),
+        (unsigned char)((alpha + 2) >> 2)
+    };
+}
+
+/**
+ * Recompute a rectangle of one level from the level above it
+ * The rectangle lies inside one destination tile and its 2x2 sources inside
+ * one source tile (both lie in the footprint of a single canvas tile).
+ * The last row and column of an odd-sized source are repeated.
+ */
+static void DownsampleRegion(Canvas* source, Canvas* dest, int x, int y, int width, int height) {
+    const Color* sourcePixels = GetCanvasTilePixels(source, GetCanvasTileIndex(source, x << 1, y << 1));
+    int destTile = GetCanvasTileIndex(dest, x, y);
+    if (sourcePixels == NULL && GetCanvasTilePixels(dest, destTile) == NULL) {
+        return; // Empty on both sides already
+    }
+    Color* destPixels = AcquireCanvasTilePixels(dest, destTile);
+    if (destPixels == NULL) return;
+
+    for (int row = y; row < y + height; row++) {
+        Color* out = destPixels + ((row & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT) + (x & CANVAS_TILE_MASK);
+        if (sourcePixels == NULL) {
+            FillPixels(out, (size_t)width, source->emptyColor);
+            continue;
+        }
+
+        int sourceY0 = row << 1;
+        int sourceY1 = (sourceY0 + 1 < source->height) ? sourceY0 + 1 : sourceY0;
+        const Color* top = sourcePixels + ((sourceY0 & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT);
+        const Color* bottom = sourcePixels + ((sourceY1 & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT);
+        for (int column = x; column < x + width; column++) {
+            int sourceX0 = column << 1;
+            int sourceX1 = (sourceX0 + 1 < source->width) ? sourceX0 + 1 : sourceX0;
+            int left = sourceX0 & CANVAS_TILE_MASK;
+            int right = sourceX1 & CANVAS_TILE_MASK;
+            *out++ = AverageQuad(top[left], top[right], bottom[left], bottom[right]);
+        }
+    }
+    MarkCanvasDirty(dest, x, y, width, height);
+}
+
+/**
+ * Carry each recorded rectangle down the pyramid, one footprint per level
+ */
+int UpdateCanvasMipmap(CanvasMipmap* mipmap, Canvas* canvas) {
+    if (mipmap == NULL || canvas == NULL) return 0;
+
+    int updated = mipmap->dirtyCount;
+    for (int i = 0; i < mipmap->dirtyCount; i++) {
+        int tileIndex = mipmap->dirtyTiles[i];
+        const CanvasMipmapRect* rect = &mipmap->dirtyRects[tileIndex];
+        mipmap->isTileDirty[tileIndex] = 0;
+
+        // Canvas rectangle, clipped to the part of the tile inside the canvas
+        int tileX0 = (tileIndex % canvas->tilesX) << CANVAS_TILE_SHIFT;
+        int tileY0 = (tileIndex / canvas->tilesX) << CANVAS_TILE_SHIFT;
+        int minX = tileX0 + rect->minX;
+        int minY = tileY0 + rect->minY;
+        int maxX = (tileX0 + rect->maxX < canvas->width) ? tileX0 + rect->maxX : canvas->width - 1;
+        int maxY = (tileY0 + rect->maxY < canvas->height) ? tileY0 + rect->maxY : canvas->height - 1;
+        if (minX > maxX || minY > maxY) continue;
+
+        Canvas* source = canvas;
+        for (int level = 0; level < mipmap->levelCount; level++) {
+            // Inclusive edges halve separately so odd footprints keep their last pixel
+            minX >>= 1;
+            minY >>= 1;
+            maxX >>= 1;
+            maxY >>= 1;
+            DownsampleRegion(source, mipmap->levels[level], minX, minY, maxX - minX + 1, maxY - minY + 1);
+            source = mipmap->levels[level];
+        }
+    }
+    mipmap->dirtyCount = 0;
+    return updated;
+}
+
+/**
+ * Bytes held by the levels and the dirty tile bookkeeping
+ */
+size_t GetCanvasMipmapMemoryUsage(const CanvasMipmap* mipmap) {
+    if (mipmap == NULL) return 0;
+
+    size_t bytes = sizeof(CanvasMipmap);
+    for (int i = 0; i < mipmap->levelCount; i++) {
+        bytes += GetCanvasMemoryUsage(mipmap->levels[i]);
+    }
+    return bytes + (size_t)mipmap->tileCount * (sizeof(unsigned char) + sizeof(CanvasMipmapRect) + sizeof(int));
+}
+
+/**
+ * Pick the canvas or pyramid level to draw at a scale
+ */
+Canvas* GetCanvasDrawLevel(Canvas* canvas, float scale, int* level) {
+    if (level != NULL) *level = 0;
+    if (canvas == NULL || scale <= 0.0f || scale > 0.5f) return canvas;
+
+    if (canvas->mipmap == NULL) {
+        canvas->mipmap = CreateCanvasMipmap(canvas);
+        if (canvas->mipmap == NULL) return canvas;
+    }
+
+    // Deepest level whose pixels are no larger than a screen pixel
+    CanvasMipmap* mipmap = canvas->mipmap;
+    int picked = 0;
+    while (picked < mipmap->levelCount && scale * (float)(2 << picked) <= 1.0f) {
+        picked++;
+    }
+    if (picked == 0) return canvas;
+
+    UpdateCanvasMipmap(mipmap, canvas);
+    if (level != NULL) *level = picked;
+    return mipmap->levels[picked - 1];
+}
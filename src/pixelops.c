@@ -0,0 +1,433 @@
+/**
+ * pixelops.c
+ *
+ * Implementation of Bulk Pixel Kernels
+ *
+ * Every kernel exists in a scalar, an SSE2 and an AVX2 version. The vector
+ * versions are compiled with per-function target attributes, so the rest of
+ * the program needs no special compiler flags, and one is picked at runtime
+ * with the CPU feature checks. Vector loops handle whole registers; the
+ * remaining tail pixels go through the scalar version.
+ */
+
+#include "pixelops.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIXELOPS_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * One implementation of every kernel (colors passed packed)
+ */
+typedef struct {
+    PixelOpsBackend backend;
+    void (*fill)(Color* pixels, size_t count, unsigned int color);
+    size_t (*replace)(Color* pixels, size_t count, unsigned int from, unsigned int to);
+    size_t (*replaceTolerance)(Color* pixels, size_t count, unsigned int from, unsigned int to,
+                               unsigned char tolerance);
+    size_t (*countMatching)(const Color* pixels, size_t count, unsigned int color, unsigned char tolerance);
+    void (*maskedFill)(Color* pixels, const unsigned char* mask, size_t count, unsigned int color);
+} PixelKernels;
+
+static unsigned int PackColor(Color color) {
+    unsigned int packed;
+    memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+static Color UnpackColor(unsigned int packed) {
+    Color color;
+    memcpy(&color, &packed, sizeof(color));
+    return color;
+}
+
+//------------------------------------------------------------------------------
+// Scalar kernels
+//------------------------------------------------------------------------------
+
+static bool ChannelsWithin(Color a, Color b, unsigned char tolerance) {
+    return abs(a.r - b.r) <= tolerance && abs(a.g - b.g) <= tolerance &&
+           abs(a.b - b.b) <= tolerance && abs(a.a - b.a) <= tolerance;
+}
+
+static void FillScalar(Color* pixels, size_t count, unsigned int color) {
+    Color value = UnpackColor(color);
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = value;
+    }
+}
+
+static size_t ReplaceScalar(Color* pixels, size_t count, unsigned int from, unsigned int to) {
+    Color value = UnpackColor(to);
+    size_t replaced = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (PackColor(pixels[i]) == from) {
+            pixels[i] = value;
+            replaced++;
+        }
+    }
+    return replaced;
+}
+
+static size_t ReplaceToleranceScalar(Color* pixels, size_t count, unsigned int from, unsigned int to,
+                                     unsigned char tolerance) {
+    Color reference = UnpackColor(from);
+    Color value = UnpackColor(to);
+    size_t replaced = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ChannelsWithin(pixels[i], reference, tolerance)) {
+            pixels[i] = value;
+            replaced++;
+        }
+    }
+    return replaced;
+}
+
+static size_t CountMatchingScalar(const Color* pixels, size_t count, unsigned int color, unsigned char tolerance) {
+    Color reference = UnpackColor(color);
+    size_t matching = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ChannelsWithin(pixels[i], reference, tolerance)) {
+            matching++;
+        }
+    }
+    return matching;
+}
+
+static void MaskedFillScalar(Color* pixels, const unsigned char* mask, size_t count, unsigned int color) {
+    Color value = UnpackColor(color);
+    for (size_t i = 0; i < count; i++) {
+        if (mask[i]) {
+            pixels[i] = value;
+        }
+    }
+}
+
+static const PixelKernels scalarKernels = {
+    PIXELOPS_SCALAR, FillScalar, ReplaceScalar, ReplaceToleranceScalar, CountMatchingScalar, MaskedFillScalar
+};
+
+#ifdef PIXELOPS_X86
+
+// Set bits in a 4-bit lane mask (popcnt is not part of SSE2/AVX2)
+static const unsigned char laneCounts[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+//------------------------------------------------------------------------------
+// SSE2 kernels (4 pixels per register)
+//------------------------------------------------------------------------------
+
+// All-ones lanes where every byte of v is within tolerance of reference
+__attribute__((target("sse2")))
+static inline __m128i MatchWithinSSE2(__m128i v, __m128i reference, __m128i tolerance) {
+    __m128i diff = _mm_or_si128(_mm_subs_epu8(v, reference), _mm_subs_epu8(reference, v));
+    return _mm_cmpeq_epi32(_mm_subs_epu8(diff, tolerance), _mm_setzero_si128());
+}
+
+__attribute__((target("sse2")))
+static inline int CountLanesSSE2(__m128i lanes) {
+    return laneCounts[_mm_movemask_ps(_mm_castsi128_ps(lanes))];
+}
+
+__attribute__((target("sse2")))
+static void FillSSE2(Color* pixels, size_t count, unsigned int color) {
+    __m128i value = _mm_set1_epi32((int)color);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(pixels + i), value);
+    }
+    FillScalar(pixels + i, count - i, color);
+}
+
+__attribute__((target("sse2")))
+static size_t ReplaceSSE2(Color* pixels, size_t count, unsigned int from, unsigned int to) {
+    __m128i reference = _mm_set1_epi32((int)from);
+    __m128i value = _mm_set1_epi32((int)to);
+    size_t replaced = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+        __m128i match = _mm_cmpeq_epi32(v, reference);
+        v = _mm_or_si128(_mm_and_si128(match, value), _mm_andnot_si128(match, v));
+        _mm_storeu_si128((__m128i*)(pixels + i), v);
+        replaced += CountLanesSSE2(match);
+    }
+    return replaced + ReplaceScalar(pixels + i, count - i, from, to);
+}
+
+__attribute__((target("sse2")))
+static size_t ReplaceToleranceSSE2(Color* pixels, size_t count, unsigned int from, unsigned int to,
+                                   unsigned char tolerance) {
+    __m128i reference = _mm_set1_epi32((int)from);
+    __m128i value = _mm_set1_epi32((int)to);
+    __m128i limit = _mm_set1_epi8((char)tolerance);
+    size_t replaced = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+        __m128i match = MatchWithinSSE2(v, reference, limit);
+        v = _mm_or_si128(_mm_and_si128(match, value), _mm_andnot_si128(match, v));
+        _mm_storeu_si128((__m128i*)(pixels + i), v);
+        replaced += CountLanesSSE2(match);
+    }
+    return replaced + ReplaceToleranceScalar(pixels + i, count - i, from, to, tolerance);
+}
+
+__attribute__((target("sse2")))
+static size_t CountMatchingSSE2(const Color* pixels, size_t count, unsigned int color, unsigned char tolerance) {
+    __m128i reference = _mm_set1_epi32((int)color);
+    __m128i limit = _mm_set1_epi8((char)tolerance);
+    size_t matching = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+        matching += CountLanesSSE2(MatchWithinSSE2(v, reference, limit));
+    }
+    return matching + CountMatchingScalar(pixels + i, count - i, color, tolerance);
+}
+
+__attribute__((target("sse2")))
+static void MaskedFillSSE2(Color* pixels, const unsigned char* mask, size_t count, unsigned int color) {
+    __m128i value = _mm_set1_epi32((int)color);
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int bits;
+        memcpy(&bits, mask + i, sizeof(bits));
+
+        // Widen 4 mask bytes to 4 lanes; lanes with a zero byte keep their pixel
+        __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+        __m128i keep = _mm_cmpeq_epi32(lanes, zero);
+
+        __m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+        v = _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, value));
+        _mm_storeu_si128((__m128i*)(pixels + i), v);
+    }
+    MaskedFillScalar(pixels + i, mask + i, count - i, color);
+}
+
+static const PixelKernels sse2Kernels = {
+    PIXELOPS_SSE2, FillSSE2, ReplaceSSE2, ReplaceToleranceSSE2, CountMatchingSSE2, MaskedFillSSE2
+};
+
+//------------------------------------------------------------------------------
+// AVX2 kernels (8 pixels per register)
+//------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static inline __m256i MatchWithinAVX2(__m256i v, __m256i reference, __m256i tolerance) {
+    __m256i diff = _mm256_or_si256(_mm256_subs_epu8(v, reference), _mm256_subs_epu8(reference, v));
+    return _mm256_cmpeq_epi32(_mm256_subs_epu8(diff, tolerance), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static inline int CountLanesAVX2(__m256i lanes) {
+    int bits = _mm256_movemask_ps(_mm256_castsi256_ps(lanes));
+    return laneCounts[bits & 15] + laneCounts[bits >> 4];
+}
+
+__attribute__((target("avx2")))
+static void FillAVX2(Color* pixels, size_t count, unsigned int color) {
+    __m256i value = _mm256_set1_epi32((int)color);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i*)(pixels + i), value);
+    }
+    FillScalar(pixels + i, count - i, color);
+}
+
+__attribute__((target("avx2")))
+static size_t ReplaceAVX2(Color* pixels, size_t count, unsigned int from, unsigned int to) {
+    __m256i reference = _mm256_set1_epi32((int)from);
+    __m256i value = _mm256_set1_epi32((int)to);
+    size_t replaced = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(pixels + i));
+        __m256i match = _mm256_cmpeq_epi32(v, reference);
+        _mm256_storeu_si256((__m256i*)(pixels + i), _mm256_blendv_epi8(v, value, match));
+        replaced += CountLanesAVX2(match);
+    }
+    return replaced + ReplaceScalar(pixels + i, count - i, from, to);
+}
+
+__attribute__((target("avx2")))
+static size_t ReplaceToleranceAVX2(Color* pixels, size_t count, unsigned int from, unsigned int to,
+                                   unsigned char tolerance) {
+    __m256i reference = _mm256_set1_epi32((int)from);
+    __m256i value = _mm256_set1_epi32((int)to);
+    __m256i limit = _mm256_set1_epi8((char)tolerance);
+    size_t replaced = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(pixels + i));
+        __m256i match = MatchWithinAVX2(v, reference, limit);
+        _mm256_storeu_si256((__m256i*)(pixels + i), _mm256_blendv_epi8(v, value, match));
+        replaced += CountLanesAVX2(match);
+    }
+    return replaced + ReplaceToleranceScalar(pixels + i, count - i, from, to, tolerance);
+}
+
+__attribute__((target("avx2")))
+static size_t CountMatchingAVX2(const Color* pixels, size_t count, unsigned int color, unsigned char tolerance) {
+    __m256i reference = _mm256_set1_epi32((int)color);
+    __m256i limit = _mm256_set1_epi8((char)tolerance);
+    size_t matching = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(pixels + i));
+        matching += CountLanesAVX2(MatchWithinAVX2(v, reference, limit));
+    }
+    return matching + CountMatchingScalar(pixels + i, count - i, color, tolerance);
+}
+
+__attribute__((target("avx2")))
+static void MaskedFillAVX2(Color* pixels, const unsigned char* mask, size_t count, unsigned int color) {
+    __m256i value = _mm256_set1_epi32((int)color);
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Widen 8 mask bytes to 8 lanes; lanes with a zero byte keep their pixel
+        __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(mask + i)));
+        __m256i keep = _mm256_cmpeq_epi32(lanes, zero);
+
+        __m256i v = _mm256_loadu_si256((const __m256i*)(pixels + i));
+        _mm256_storeu_si256((__m256i*)(pixels + i), _mm256_blendv_epi8(value, v, keep));
+    }
+    MaskedFillScalar(pixels + i, mask + i, count - i, color);
+}
+
+static const PixelKernels avx2Kernels = {
+    PIXELOPS_AVX2, FillAVX2, ReplaceAVX2, ReplaceToleranceAVX2, CountMatchingAVX2, MaskedFillAVX2
+};
+
+#endif // PIXELOPS_X86
+
+//------------------------------------------------------------------------------
+// Dispatch
+//------------------------------------------------------------------------------
+
+// Read and written atomically: any thread may be the first to use a kernel.
+// The tables themselves are constant, so the pointer needs no ordering.
+static const PixelKernels* activeKernels = NULL;
+
+static bool IsBackendSupported(PixelOpsBackend backend) {
+    switch (backend) {
+        case PIXELOPS_SCALAR:
+            return true;
+#ifdef PIXELOPS_X86
+        case PIXELOPS_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case PIXELOPS_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+static const PixelKernels* GetBackendKernels(PixelOpsBackend backend) {
+    switch (backend) {
+#ifdef PIXELOPS_X86
+        case PIXELOPS_SSE2:
+            return &sse2Kernels;
+        case PIXELOPS_AVX2:
+            return &avx2Kernels;
+#endif
+        default:
+            return &scalarKernels;
+    }
+}
+
+/**
+ * Get the active kernels, choosing the best supported backend on first use
+ */
+static const PixelKernels* GetKernels(void) {
+    const PixelKernels* kernels = __atomic_load_n(&activeKernels, __ATOMIC_RELAXED);
+    if (kernels != NULL) return kernels;
+
+    PixelOpsBackend backend = PIXELOPS_SCALAR;
+    if (IsBackendSupported(PIXELOPS_AVX2)) {
+        backend = PIXELOPS_AVX2;
+    } else if (IsBackendSupported(PIXELOPS_SSE2)) {
+        backend = PIXELOPS_SSE2;
+    }
+
+    // Threads racing here pick the same kernels; a backend forced in the
+    // meantime by SetPixelOpsBackend is kept
+    const PixelKernels* expected = NULL;
+    kernels = GetBackendKernels(backend);
+    if (!__atomic_compare_exchange_n(&activeKernels, &expected, kernels, false, __ATOMIC_RELAXED,
+                                     __ATOMIC_RELAXED)) {
+        return expected;
+    }
+    return kernels;
+}
+
+/**
+ * Get the kernel implementation currently in use
+ */
+PixelOpsBackend GetPixelOpsBackend(void) {
+    return GetKernels()->backend;
+}
+
+/**
+ * Force a kernel implementation
+ */
+bool SetPixelOpsBackend(PixelOpsBackend backend) {
+    if (!IsBackendSupported(backend)) return false;
+    __atomic_store_n(&activeKernels, GetBackendKernels(backend), __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * Get the name of a backend as a string
+ */
+const char* GetPixelOpsBackendName(PixelOpsBackend backend) {
+    switch (backend) {
+        case PIXELOPS_SCALAR:
+            return "Scalar";
+        case PIXELOPS_SSE2:
+            return "SSE2";
+        case PIXELOPS_AVX2:
+            return "AVX2";
+        default:
+            return "Unknown";
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public kernels
+//------------------------------------------------------------------------------
+
+void FillPixels(Color* pixels, size_t count, Color color) {
+    if (pixels == NULL) return;
+    GetKernels()->fill(pixels, count, PackColor(color));
+}
+
+size_t ReplacePixels(Color* pixels, size_t count, Color from, Color to) {
+    if (pixels == NULL) return 0;
+    return GetKernels()->replace(pixels, count, PackColor(from), PackColor(to));
+}
+
+size_t ReplacePixelsTolerance(Color* pixels, size_t count, Color from, Color to, unsigned char tolerance) {
+    if (pixels == NULL) return 0;
+    if (tolerance == 0) {
+        return GetKernels()->replace(pixels, count, PackColor(from), PackColor(to));
+    }
+    return GetKernels()->replaceTolerance(pixels, count, PackColor(from), PackColor(to), tolerance);
+}
+
+size_t CountMatchingPixels(const Color* pixels, size_t count, Color color, unsigned char tolerance) {
+    if (pixels == NULL) return 0;
+    return GetKernels()->countMatching(pixels, count, PackColor(color), tolerance);
+}
+
+void MaskedFillPixels(Color* pixels, const unsigned char* mask, size_t count, Color color) {
+    if (pixels == NULL || mask == NULL) return;
+    GetKernels()->maskedFill(pixels, mask, count, PackColor(color));
+}
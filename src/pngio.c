@@ -0,0 +1,1100 @@
+/**
+ * pngio.c
+ *
+ * Implementation of Streaming PNG Files
+ */
+
+#include "pngio.h"
+#include "codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PNG_BYTES_PER_PIXEL 4
+#define PNG_IDAT_SIZE 65536         // Compressed bytes collected before an IDAT chunk is written
+
+//------------------------------------------------------------------------------
+// Deflate encoder (RFC 1951)
+// LZ77 over a 32 KB sliding window with hash chains, coded as a single
+// block with the fixed Huffman codes. Pixel art is mostly long repeats,
+// which the fixed codes handle nearly as well as dynamic ones.
+//------------------------------------------------------------------------------
+
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_WINDOW_MASK (DEFLATE_WINDOW_SIZE - 1)
+#define DEFLATE_BUFFER_SIZE (2 * DEFLATE_WINDOW_SIZE)
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_HASH_SIZE (1 << DEFLATE_HASH_BITS)
+#define DEFLATE_MAX_CHAIN 48        // Candidates tried per position
+
+static const unsigned short lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const unsigned char lengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const unsigned short distanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const unsigned char distanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+typedef struct {
+    unsigned char* window;          // DEFLATE_BUFFER_SIZE bytes: history, then pending input
+    int fill;                       // Bytes in window
+    int position;                   // Next byte to encode
+    int* head;                      // Newest position per hash, -1 if none
+    int* prev;                      // Older position with the same hash, per position
+
+    // Compressed output, drained by the PNG writer
+    unsigned char* out;
+    size_t outSize;
+    size_t outCapacity;
+    unsigned long long bits;
+    int bitCount;
+} DeflateEncoder;
+
+static bool InitDeflateEncoder(DeflateEncoder* encoder) {
+    memset(encoder, 0, sizeof(DeflateEncoder));
+    encoder->window = (unsigned char*)malloc(DEFLATE_BUFFER_SIZE);
+    encoder->head = (int*)malloc(sizeof(int) * DEFLATE_HASH_SIZE);
+    encoder->prev = (int*)malloc(sizeof(int) * DEFLATE_WINDOW_SIZE);
+    encoder->outCapacity = PNG_IDAT_SIZE * 2;
+    encoder->out = (unsigned char*)malloc(encoder->outCapacity);
+    if (encoder->window == NULL || encoder->head == NULL || encoder->prev == NULL || encoder->out == NULL) {
+        return false;
+    }
+    for (int i = 0; i < DEFLATE_HASH_SIZE; i++) {
+        encoder->head[i] = -1;
+    }
+    return true;
+}
+
+static void FreeDeflateEncoder(DeflateEncoder* encoder) {
+    free(encoder->window);
+    free(encoder->head);
+    free(encoder->prev);
+    free(encoder->out);
+}
+
+static bool ReserveDeflateOutput(DeflateEncoder* encoder, size_t extra) {
+    if (encoder->outSize + extra <= encoder->outCapacity) return true;
+
+    size_t capacity = encoder->outCapacity * 2;
+    while (capacity < encoder->outSize + extra) capacity *= 2;
+    unsigned char* out = (unsigned char*)realloc(encoder->out, capacity);
+    if (out == NULL) return false;
+    encoder->out = out;
+    encoder->outCapacity = capacity;
+    return true;
+}
+
+/**
+ * Append bits, least significant first (whole bytes go to the output)
+ */
+static void PutBits(DeflateEncoder* encoder, unsigned int value, int count) {
+    encoder->bits |= (unsigned long long)value << encoder->bitCount;
+    encoder->bitCount += count;
+    while (encoder->bitCount >= 8) {
+        encoder->out[encoder->outSize++] = (unsigned char)encoder->bits;
+        encoder->bits >>= 8;
+        encoder->bitCount -= 8;
+    }
+}
+
+/**
+ * Huffman codes are defined most significant bit first
+ */
+static unsigned int ReverseBits(unsigned int code, int length) {
+    unsigned int reversed = 0;
+    for (int i = 0; i < length; i++) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
+static void PutFixedSymbol(DeflateEncoder* encoder, int symbol) {
+    if (symbol < 144) {
+        PutBits(encoder, ReverseBits(0x30 + symbol, 8), 8);
+    } else if (symbol < 256) {
+        PutBits(encoder, ReverseBits(0x190 + symbol - 144, 9), 9);
+    } else if (symbol < 280) {
+        PutBits(encoder, ReverseBits(symbol - 256, 7), 7);
+    } else {
+        PutBits(encoder, ReverseBits(0xC0 + symbol - 280, 8), 8);
+    }
+}
+
+static void PutMatch(DeflateEncoder* encoder, int length, int distance) {
+    int code = 28;
+    while (lengthBase[code] > length) code--;
+    PutFixedSymbol(encoder, 257 + code);
+    PutBits(encoder, length - lengthBase[code], lengthExtra[code]);
+
+    code = 29;
+    while (distanceBase[code] > distance) code--;
+    PutBits(encoder, ReverseBits(code, 5), 5);
+    PutBits(encoder, distance - distanceBase[code], distanceExtra[code]);
+}
+
+static unsigned int HashAt(const unsigned char* bytes) {
+    unsigned int value = ((unsigned int)bytes[0] << 16) | ((unsigned int)bytes[1] << 8) | bytes[2];
+    return (value * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+static void InsertHash(DeflateEncoder* encoder, int position) {
+    if (position + DEFLATE_MIN_MATCH > encoder->fill) return;
+    unsigned int hash = HashAt(encoder->window + position);
+    encoder->prev[position & DEFLATE_WINDOW_MASK] = encoder->head[hash];
+    encoder->head[hash] = position;
+}
+
+/**
+ * Longest earlier match for the bytes at position (0 if under the minimum)
+ */
+static int FindMatch(DeflateEncoder* encoder, int position, int* outDistance) {
+    int maxLength = encoder->fill - position;
+    if (maxLength > DEFLATE_MAX_MATCH) maxLength = DEFLATE_MAX_MATCH;
+    if (maxLength < DEFLATE_MIN_MATCH) return 0;
+
+    const unsigned char* current = encoder->window + position;
+    int candidate = encoder->head[HashAt(current)];
+    int bestLength = 0;
+
+    for (int chain = 0; chain < DEFLATE_MAX_CHAIN && candidate >= 0; chain++) {
+        int distance = position - candidate;
+        if (distance <= 0 || distance > DEFLATE_WINDOW_SIZE) break;
+
+        const unsigned char* earlier = encoder->window + candidate;
+        if (earlier[bestLength] == current[bestLength]) {
+            int length = 0;
+            while (length < maxLength && earlier[length] == current[length]) length++;
+            if (length > bestLength) {
+                bestLength = length;
+                *outDistance = distance;
+                if (length == maxLength) break;
+            }
+        }
+        candidate = encoder->prev[candidate & DEFLATE_WINDOW_MASK];
+    }
+
+    return (bestLength >= DEFLATE_MIN_MATCH) ? bestLength : 0;
+}
+
+/**
+ * Encode buffered input, keeping a full match of lookahead unless final
+ */
+static bool CompressDeflateInput(DeflateEncoder* encoder, bool final) {
+    int limit = final ? encoder->fill : encoder->fill - DEFLATE_MAX_MATCH;
+
+    while (encoder->position < limit) {
+        // Worst case per step: one match of up to 31 bits
+        if (!ReserveDeflateOutput(encoder, 8)) return false;
+
+        int distance = 0;
+        int length = FindMatch(encoder, encoder->position, &distance);
+        if (length > 0) {
+            PutMatch(encoder, length, distance);
+            for (int i = 0; i < length; i++) {
+                InsertHash(encoder, encoder->position + i);
+            }
+            encoder->position += length;
+        } else {
+            PutFixedSymbol(encoder, encoder->window[encoder->position]);
+            InsertHash(encoder, encoder->position);
+            encoder->position++;
+        }
+    }
+    return true;
+}
+
+/**
+ * Drop the oldest half of the window once the input reaches its end
+ */
+static void SlideDeflateWindow(DeflateEncoder* encoder) {
+    memmove(encoder->window, encoder->window + DEFLATE_WINDOW_SIZE, encoder->fill - DEFLATE_WINDOW_SIZE);
+    encoder->fill -= DEFLATE_WINDOW_SIZE;
+    encoder->position -= DEFLATE_WINDOW_SIZE;
+
+    for (int i = 0; i < DEFLATE_HASH_SIZE; i++) {
+        encoder->head[i] = (encoder->head[i] >= DEFLATE_WINDOW_SIZE) ? encoder->head[i] - DEFLATE_WINDOW_SIZE : -1;
+    }
+    for (int i = 0; i < DEFLATE_WINDOW_SIZE; i++) {
+        encoder->prev[i] = (encoder->prev[i] >= DEFLATE_WINDOW_SIZE) ? encoder->prev[i] - DEFLATE_WINDOW_SIZE : -1;
+    }
+}
+
+static bool WriteDeflateInput(DeflateEncoder* encoder, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        if (encoder->fill == DEFLATE_BUFFER_SIZE) {
+            if (!CompressDeflateInput(encoder, false)) return false;
+            SlideDeflateWindow(encoder);
+        }
+
+        size_t space = DEFLATE_BUFFER_SIZE - encoder->fill;
+        size_t count = (size < space) ? size : space;
+        memcpy(encoder->window + encoder->fill, data, count);
+        encoder->fill += (int)count;
+        data += count;
+        size -= count;
+    }
+    return CompressDeflateInput(encoder, false);
+}
+
+/**
+ * Encode the remaining input, end the block and pad to a byte boundary
+ */
+static bool FinishDeflateInput(DeflateEncoder* encoder) {
+    if (!CompressDeflateInput(encoder, true) || !ReserveDeflateOutput(encoder, 8)) return false;
+    PutFixedSymbol(encoder, 256);
+    if (encoder->bitCount > 0) {
+        PutBits(encoder, 0, 8 - encoder->bitCount);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// PNG writer
+//------------------------------------------------------------------------------
+
+struct PngWriter {
+    FILE* file;
+    int width;
+    int height;
+    int rowsWritten;
+    bool failed;
+
+    size_t stride;                  // Bytes per row without the filter byte
+    unsigned char* previousRow;     // Unfiltered bytes of the row above (zeros for the first row)
+    unsigned char* currentRow;
+    unsigned char* candidates[5];   // Filter byte + filtered row, per filter type
+
+    DeflateEncoder encoder;
+    unsigned int adler;             // Of the uncompressed zlib payload
+};
+
+static void PutBigEndian(unsigned char* out, unsigned int value) {
+    out[0] = (unsigned char)(value >> 24);
+    out[1] = (unsigned char)(value >> 16);
+    out[2] = (unsigned char)(value >> 8);
+    out[3] = (unsigned char)value;
+}
+
+static bool WritePngChunk(PngWriter* writer, const char* type, const unsigned char* data, size_t size) {
+    unsigned char header[8];
+    unsigned char footer[4];
+    PutBigEndian(header, (unsigned int)size);
+    memcpy(header + 4, type, 4);
+
+    unsigned int crc = UpdateCrc32(0, header + 4, 4);
+    crc = UpdateCrc32(crc, data, size);
+    PutBigEndian(footer, crc);
+
+    if (fwrite(header, 1, 8, writer->file) != 8 ||
+        (size > 0 && fwrite(data, 1, size, writer->file) != size) ||
+        fwrite(footer, 1, 4, writer->file) != 4) {
+        writer->failed = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Move compressed bytes into IDAT chunks (all of them when flushing)
+ */
+static bool DrainPngOutput(PngWriter* writer, bool flush) {
+    DeflateEncoder* encoder = &writer->encoder;
+    size_t start = 0;
+    while (encoder->outSize - start >= PNG_IDAT_SIZE || (flush && encoder->outSize > start)) {
+        size_t size = encoder->outSize - start;
+        if (size > PNG_IDAT_SIZE) size = PNG_IDAT_SIZE;
+        if (!WritePngChunk(writer, "IDAT", encoder->out + start, size)) return false;
+        start += size;
+    }
+    memmove(encoder->out, encoder->out + start, encoder->outSize - start);
+    encoder->outSize -= start;
+    return true;
+}
+
+static int PaethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return (pb <= pc) ? b : c;
+}
+
+/**
+ * Filter the current row with every PNG filter and return the one with the
+ * smallest sum of absolute differences (the usual libpng heuristic)
+ */
+static unsigned char* FilterPngRow(PngWriter* writer) {
+    const unsigned char* row = writer->currentRow;
+    const unsigned char* above = writer->previousRow;
+    unsigned long best = (unsigned long)-1;
+    int bestFilter = 0;
+
+    for (int filter = 0; filter < 5; filter++) {
+        unsigned char* out = writer->candidates[filter];
+        out[0] = (unsigned char)filter;
+        unsigned long sum = 0;
+
+        for (size_t i = 0; i < writer->stride; i++) {
+            int left = (i >= PNG_BYTES_PER_PIXEL) ? row[i - PNG_BYTES_PER_PIXEL] : 0;
+            int up = above[i];
+            int upLeft = (i >= PNG_BYTES_PER_PIXEL) ? above[i - PNG_BYTES_PER_PIXEL] : 0;
+            int predicted = 0;
+            switch (filter) {
+                case 1: predicted = left; break;
+                case 2: predicted = up; break;
+                case 3: predicted = (left + up) >> 1; break;
+                case 4: predicted = PaethPredictor(left, up, upLeft); break;
+                default: break;
+            }
+            unsigned char value = (unsigned char)(row[i] - predicted);
+            out[i + 1] = value;
+            sum += (value < 128) ? value : 256 - value;
+        }
+
+        if (sum < best) {
+            best = sum;
+            bestFilter = filter;
+        }
+    }
+
+    return writer->candidates[bestFilter];
+}
+
+/**
+ * Create a PNG file and write its header
+ */
+PngWriter* CreatePngWriter(const char* path, int width, int height) {
+    if (path == NULL || width <= 0 || height <= 0) return NULL;
+
+    PngWriter* writer = (PngWriter*)calloc(1, sizeof(PngWriter));
+    if (writer == NULL) return NULL;
+
+    writer->width = width;
+    writer->height = height;
+    writer->stride = (size_t)width * PNG_BYTES_PER_PIXEL;
+    writer->adler = 1;
+
+    bool ok = InitDeflateEncoder(&writer->encoder);
+    writer->previousRow = (unsigned char*)calloc(writer->stride, 1);
+    writer->currentRow = (unsigned char*)malloc(writer->stride);
+    for (int i = 0; i < 5; i++) {
+        writer->candidates[i] = (unsigned char*)malloc(writer->stride + 1);
+        ok = ok && writer->candidates[i] != NULL;
+    }
+    ok = ok && writer->previousRow != NULL && writer->currentRow != NULL;
+    if (ok) {
+        writer->file = fopen(path, "wb");
+        ok = writer->file != NULL;
+    }
+    if (!ok) {
+        DestroyPngWriter(writer);
+        return NULL;
+    }
+
+    // Signature and IHDR: 8-bit RGBA, no interlacing
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    unsigned char header[13] = {0};
+    PutBigEndian(header, (unsigned int)width);
+    PutBigEndian(header + 4, (unsigned int)height);
+    header[8] = 8;
+    header[9] = 6;
+
+    if (fwrite(signature, 1, 8, writer->file) != 8 || !WritePngChunk(writer, "IHDR", header, sizeof(header))) {
+        DestroyPngWriter(writer);
+        return NULL;
+    }
+
+    // zlib stream header: deflate with a 32 KB window, fastest-level hint
+    writer->encoder.out[0] = 0x78;
+    writer->encoder.out[1] = 0x01;
+    writer->encoder.outSize = 2;
+
+    PutBits(&writer->encoder, 1, 1);    // BFINAL: the stream is one block
+    PutBits(&writer->encoder, 1, 2);    // BTYPE 01: fixed Huffman codes
+
+    return writer;
+}
+
+/**
+ * Encode the next row of the image
+ */
+bool WritePngRow(PngWriter* writer, const Color* pixels) {
+    if (writer == NULL || pixels == NULL || writer->failed || writer->rowsWritten >= writer->height) return false;
+
+    // Color is laid out as R, G, B, A bytes, exactly the PNG RGBA order
+    memcpy(writer->currentRow, pixels, writer->stride);
+    unsigned char* filtered = FilterPngRow(writer);
+
+    writer->adler = UpdateAdler32(writer->adler, filtered, writer->stride + 1);
+    if (!WriteDeflateInput(&writer->encoder, filtered, writer->stride + 1) || !DrainPngOutput(writer, false)) {
+        writer->failed = true;
+        return false;
+    }
+
+    unsigned char* swap = writer->previousRow;
+    writer->previousRow = writer->currentRow;
+    writer->currentRow = swap;
+    writer->rowsWritten++;
+    return true;
+}
+
+/**
+ * Complete the file, close it and free the writer
+ */
+bool FinishPngWriter(PngWriter* writer) {
+    if (writer == NULL) return false;
+
+    bool ok = !writer->failed && writer->rowsWritten == writer->height &&
+              FinishDeflateInput(&writer->encoder) && ReserveDeflateOutput(&writer->encoder, 4);
+    if (ok) {
+        PutBigEndian(writer->encoder.out + writer->encoder.outSize, writer->adler);
+        writer->encoder.outSize += 4;
+        ok = DrainPngOutput(writer, true) && WritePngChunk(writer, "IEND", NULL, 0);
+    }
+
+    if (writer->file != NULL) {
+        ok = (fclose(writer->file) == 0) && ok;
+        writer->file = NULL;
+    }
+    DestroyPngWriter(writer);
+    return ok;
+}
+
+/**
+ * Close and free a writer without completing the file
+ */
+void DestroyPngWriter(PngWriter* writer) {
+    if (writer == NULL) return;
+
+    if (writer->file != NULL) {
+        fclose(writer->file);
+    }
+    FreeDeflateEncoder(&writer->encoder);
+    free(writer->previousRow);
+    free(writer->currentRow);
+    for (int i = 0; i < 5; i++) {
+        free(writer->candidates[i]);
+    }
+    free(writer);
+}
+
+//------------------------------------------------------------------------------
+// Inflate decoder (RFC 1951)
+// Pull-based: the PNG reader asks for one scanline at a time, so decoding
+// can stop in the middle of a block or a match. The last 32 KB of output
+// are kept for back-references.
+//------------------------------------------------------------------------------
+
+#define INFLATE_FAST_BITS 9
+#define INFLATE_FAST_SIZE (1 << INFLATE_FAST_BITS)
+#define PNG_READ_BUFFER_SIZE 65536
+
+// Canonical Huffman code; codes up to INFLATE_FAST_BITS long decode with a
+// single table lookup
+typedef struct {
+    unsigned short fast[INFLATE_FAST_SIZE];  // (length << 9) | symbol, 0 for longer codes
+    unsigned short firstCode[17];
+    unsigned short firstSymbol[17];
+    int maxCode[17];                         // Exclusive limit per length, left-aligned to 16 bits
+    unsigned char sizes[288];
+    unsigned short values[288];
+} HuffmanTable;
+
+struct PngReader {
+    FILE* file;
+    unsigned char* buffer;          // Buffered file input
+    size_t bufferPos;
+    size_t bufferSize;
+    unsigned int chunkRemaining;    // Bytes left in the current IDAT chunk
+    bool inImageData;
+
+    // Header
+    int width;
+    int height;
+    int bitDepth;
+    int colorType;
+    size_t stride;                  // Bytes per row without the filter byte
+    int filterBpp;                  // Byte distance the filters look back
+    Color palette[256];
+    bool hasColorKey;               // tRNS for gray and truecolor images
+    unsigned short colorKey[3];
+
+    unsigned char* previousRow;     // Unfiltered, zeros before the first row
+    unsigned char* currentRow;
+    int rowsRead;
+
+    // Inflate state
+    unsigned long long bits;
+    int bitCount;
+    int overrunBytes;               // Zero bytes padded in after the data ran out
+    bool isLastBlock;
+    int blockType;                  // -1 between blocks
+    int storedRemaining;
+    int matchLength;                // Back-reference still being copied
+    int matchDistance;
+    size_t totalOut;
+    unsigned char* window;          // DEFLATE_WINDOW_SIZE ring of recent output
+    HuffmanTable literals;
+    HuffmanTable distances;
+};
+
+static unsigned int GetBigEndian(const unsigned char* bytes) {
+    return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 8) | bytes[3];
+}
+
+static bool FillReadBuffer(PngReader* reader) {
+    reader->bufferSize = fread(reader->buffer, 1, PNG_READ_BUFFER_SIZE, reader->file);
+    reader->bufferPos = 0;
+    return reader->bufferSize > 0;
+}
+
+/**
+ * Read (or skip, with a NULL destination) bytes from the file
+ */
+static bool ReadFileBytes(PngReader* reader, unsigned char* out, size_t count) {
+    while (count > 0) {
+        if (reader->bufferPos == reader->bufferSize && !FillReadBuffer(reader)) return false;
+
+        size_t available = reader->bufferSize - reader->bufferPos;
+        size_t n = (count < available) ? count : available;
+        if (out != NULL) {
+            memcpy(out, reader->buffer + reader->bufferPos, n);
+            out += n;
+        }
+        reader->bufferPos += n;
+        count -= n;
+    }
+    return true;
+}
+
+/**
+ * Next byte of the zlib stream, which may span several IDAT chunks (-1 at the end)
+ * Chunk CRCs are skipped, as most decoders do; the deflate structure
+ * itself still catches truncated and corrupt data
+ */
+static int NextImageDataByte(PngReader* reader) {
+    while (reader->chunkRemaining == 0) {
+        unsigned char header[12];
+        if (!reader->inImageData || !ReadFileBytes(reader, header, sizeof(header)) ||
+            memcmp(header + 8, "IDAT", 4) != 0) {
+            reader->inImageData = false;
+            return -1;
+        }
+        reader->chunkRemaining = GetBigEndian(header + 4);
+    }
+
+    if (reader->bufferPos == reader->bufferSize && !FillReadBuffer(reader)) {
+        reader->inImageData = false;
+        return -1;
+    }
+    reader->chunkRemaining--;
+    return reader->buffer[reader->bufferPos++];
+}
+
+static void RefillBits(PngReader* reader) {
+    while (reader->bitCount <= 56) {
+        int byte = NextImageDataByte(reader);
+        if (byte < 0) {
+            byte = 0;
+            reader->overrunBytes++;
+        }
+        reader->bits |= (unsigned long long)byte << reader->bitCount;
+        reader->bitCount += 8;
+    }
+}
+
+static unsigned int GetBits(PngReader* reader, int count) {
+    if (reader->bitCount < count) RefillBits(reader);
+
+    unsigned int value = (unsigned int)(reader->bits & ((1ull << count) - 1));
+    reader->bits >>= count;
+    reader->bitCount -= count;
+    return value;
+}
+
+static bool BuildHuffmanTable(HuffmanTable* table, const unsigned char* lengths, int count) {
+    int sizes[17] = {0};
+    int nextCode[16];
+
+    memset(table->fast, 0, sizeof(table->fast));
+    for (int i = 0; i < count; i++) {
+        sizes[lengths[i]]++;
+    }
+    sizes[0] = 0;
+
+    int code = 0;
+    int symbol = 0;
+    for (int length = 1; length < 16; length++) {
+        nextCode[length] = code;
+        table->firstCode[length] = (unsigned short)code;
+        table->firstSymbol[length] = (unsigned short)symbol;
+        code += sizes[length];
+        if (sizes[length] > 0 && code - 1 >= (1 << length)) return false;  // Oversubscribed
+        table->maxCode[length] = code << (16 - length);
+        code <<= 1;
+        symbol += sizes[length];
+    }
+    table->maxCode[16] = 0x10000;
+
+    for (int i = 0; i < count; i++) {
+        int length = lengths[i];
+        if (length == 0) continue;
+
+        int index = nextCode[length] - table->firstCode[length] + table->firstSymbol[length];
+        table->sizes[index] = (unsigned char)length;
+        table->values[index] = (unsigned short)i;
+        if (length <= INFLATE_FAST_BITS) {
+            for (int j = (int)ReverseBits(nextCode[length], length); j < INFLATE_FAST_SIZE; j += 1 << length) {
+                table->fast[j] = (unsigned short)((length << 9) | i);
+            }
+        }
+        nextCode[length]++;
+    }
+    return true;
+}
+
+/**
+ * Decode one Huffman symbol (-1 for an invalid code)
+ */
+static int DecodeSymbol(PngReader* reader, const HuffmanTable* table) {
+    if (reader->bitCount < 16) RefillBits(reader);
+
+    int fast = table->fast[reader->bits & (INFLATE_FAST_SIZE - 1)];
+    if (fast != 0) {
+        int length = fast >> 9;
+        reader->bits >>= length;
+        reader->bitCount -= length;
+        return fast & 511;
+    }
+
+    int code = (int)ReverseBits((unsigned int)(reader->bits & 0xFFFF), 16);
+    int length = INFLATE_FAST_BITS + 1;
+    while (length < 16 && code >= table->maxCode[length]) length++;
+    if (length == 16) return -1;
+
+    int index = (code >> (16 - length)) - table->firstCode[length] + table->firstSymbol[length];
+    if (index >= 288 || table->sizes[index] != length) return -1;
+    reader->bits >>= length;
+    reader->bitCount -= length;
+    return table->values[index];
+}
+
+static bool BuildFixedTables(PngReader* reader) {
+    unsigned char lengths[288];
+    for (int i = 0; i < 288; i++) {
+        lengths[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+    }
+    unsigned char distanceLengths[30];
+    memset(distanceLengths, 5, sizeof(distanceLengths));
+
+    return BuildHuffmanTable(&reader->literals, lengths, 288) &&
+           BuildHuffmanTable(&reader->distances, distanceLengths, 30);
+}
+
+static bool ReadDynamicTables(PngReader* reader) {
+    static const unsigned char order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    int literalCount = (int)GetBits(reader, 5) + 257;
+    int distanceCount = (int)GetBits(reader, 5) + 1;
+    int codeLengthCount = (int)GetBits(reader, 4) + 4;
+    if (literalCount > 286 || distanceCount > 30) return false;
+
+    unsigned char codeLengths[19] = {0};
+    for (int i = 0; i < codeLengthCount; i++) {
+        codeLengths[order[i]] = (unsigned char)GetBits(reader, 3);
+    }
+    if (!BuildHuffmanTable(&reader->literals, codeLengths, 19)) return false;
+
+    unsigned char lengths[286 + 30];
+    int total = literalCount + distanceCount;
+    int n = 0;
+    while (n < total) {
+        int symbol = DecodeSymbol(reader, &reader->literals);
+        if (symbol < 0) return false;
+
+        if (symbol < 16) {
+            lengths[n++] = (unsigned char)symbol;
+            continue;
+        }
+
+        int repeat = 0;
+        unsigned char value = 0;
+        if (symbol == 16) {
+            if (n == 0) return false;
+            repeat = 3 + (int)GetBits(reader, 2);
+            value = lengths[n - 1];
+        } else if (symbol == 17) {
+            repeat = 3 + (int)GetBits(reader, 3);
+        } else {
+            repeat = 11 + (int)GetBits(reader, 7);
+        }
+        if (n + repeat > total) return false;
+        memset(lengths + n, value, repeat);
+        n += repeat;
+    }
+
+    return BuildHuffmanTable(&reader->literals, lengths, literalCount) &&
+           BuildHuffmanTable(&reader->distances, lengths + literalCount, distanceCount);
+}
+
+static void PutOutputByte(PngReader* reader, unsigned char* out, unsigned char value) {
+    *out = value;
+    reader->window[reader->totalOut & DEFLATE_WINDOW_MASK] = value;
+    reader->totalOut++;
+}
+
+/**
+ * Decode exactly count bytes of the zlib payload
+ */
+static bool InflateBytes(PngReader* reader, unsigned char* out, int count) {
+    int produced = 0;
+
+    while (produced < count) {
+        if (reader->matchLength > 0) {
+            int n = (reader->matchLength < count - produced) ? reader->matchLength : count - produced;
+            size_t from = reader->totalOut - reader->matchDistance;
+            for (int i = 0; i < n; i++) {
+                PutOutputByte(reader, out + produced + i, reader->window[(from + i) & DEFLATE_WINDOW_MASK]);
+            }
+            produced += n;
+            reader->matchLength -= n;
+            continue;
+        }
+
+        // Decoding well past the end of the data means it was truncated
+        if (reader->overrunBytes > 8) return false;
+
+        if (reader->blockType < 0) {
+            if (reader->isLastBlock) return false;
+
+            reader->isLastBlock = GetBits(reader, 1) != 0;
+            int type = (int)GetBits(reader, 2);
+            if (type == 0) {
+                GetBits(reader, reader->bitCount & 7);
+                unsigned int length = GetBits(reader, 16);
+                unsigned int inverse = GetBits(reader, 16);
+                if (length != (~inverse & 0xFFFF)) return false;
+                reader->storedRemaining = (int)length;
+            } else if (type == 1) {
+                if (!BuildFixedTables(reader)) return false;
+            } else if (type == 2) {
+                if (!ReadDynamicTables(reader)) return false;
+            } else {
+                return false;
+            }
+            reader->blockType = type;
+            continue;
+        }
+
+        if (reader->blockType == 0) {
+            if (reader->storedRemaining == 0) {
+                reader->blockType = -1;
+                continue;
+            }
+            PutOutputByte(reader, out + produced++, (unsigned char)GetBits(reader, 8));
+            reader->storedRemaining--;
+            continue;
+        }
+
+        int symbol = DecodeSymbol(reader, &reader->literals);
+        if (symbol < 0) return false;
+        if (symbol < 256) {
+            PutOutputByte(reader, out + produced++, (unsigned char)symbol);
+            continue;
+        }
+        if (symbol == 256) {
+            reader->blockType = -1;
+            continue;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) return false;
+        int length = lengthBase[symbol] + (int)GetBits(reader, lengthExtra[symbol]);
+
+        int code = DecodeSymbol(reader, &reader->distances);
+        if (code < 0 || code >= 30) return false;
+        int distance = distanceBase[code] + (int)GetBits(reader, distanceExtra[code]);
+        if ((size_t)distance > reader->totalOut) return false;
+
+        reader->matchLength = length;
+        reader->matchDistance = distance;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// PNG reader
+//------------------------------------------------------------------------------
+
+static int GetPngChannelCount(int colorType) {
+    switch (colorType) {
+        case 0: return 1;   // Gray
+        case 2: return 3;   // RGB
+        case 3: return 1;   // Palette index
+        case 4: return 2;   // Gray + alpha
+        case 6: return 4;   // RGBA
+        default: return 0;
+    }
+}
+
+static bool IsValidPngBitDepth(int colorType, int bitDepth) {
+    switch (colorType) {
+        case 0: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+        case 3: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+        case 2:
+        case 4:
+        case 6: return bitDepth == 8 || bitDepth == 16;
+        default: return false;
+    }
+}
+
+/**
+ * Read the chunks in front of the image data (IHDR, PLTE, tRNS)
+ */
+static bool ReadPngHeader(PngReader* reader) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    unsigned char bytes[13];
+    if (!ReadFileBytes(reader, bytes, 8) || memcmp(bytes, signature, 8) != 0) return false;
+
+    bool hasHeader = false;
+    bool hasPalette = false;
+    while (1) {
+        unsigned char chunk[8];
+        if (!ReadFileBytes(reader, chunk, 8)) return false;
+        unsigned int length = GetBigEndian(chunk);
+        const unsigned char* type = chunk + 4;
+
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13 || !ReadFileBytes(reader, bytes, 13)) return false;
+            reader->width = (int)GetBigEndian(bytes);
+            reader->height = (int)GetBigEndian(bytes + 4);
+            reader->bitDepth = bytes[8];
+            reader->colorType = bytes[9];
+            // Compression and filter method must be 0; interlaced images
+            // are not streamed row by row
+            if (reader->width <= 0 || reader->height <= 0 || bytes[10] != 0 || bytes[11] != 0 || bytes[12] != 0 ||
+                !IsValidPngBitDepth(reader->colorType, reader->bitDepth)) {
+                return false;
+            }
+            hasHeader = true;
+        } else if (!hasHeader) {
+            return false;
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            unsigned char entry[3];
+            if (length % 3 != 0 || length > 768) return false;
+            for (unsigned int i = 0; i < length / 3; i++) {
+                if (!ReadFileBytes(reader, entry, 3)) return false;
+                reader->palette[i] = (Color){entry[0], entry[1], entry[2], 255};
+            }
+            hasPalette = true;
+        } else if (memcmp(type, "tRNS", 4) == 0) {
+            if (reader->colorType == 3) {
+                if (length > 256) return false;
+                for (unsigned int i = 0; i < length; i++) {
+                    if (!ReadFileBytes(reader, &reader->palette[i].a, 1)) return false;
+                }
+            } else if ((reader->colorType == 0 && length == 2) || (reader->colorType == 2 && length == 6)) {
+                if (!ReadFileBytes(reader, bytes, length)) return false;
+                for (unsigned int i = 0; i < length / 2; i++) {
+                    reader->colorKey[i] = (unsigned short)((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+                }
+                reader->hasColorKey = true;
+            } else if (!ReadFileBytes(reader, NULL, length)) {
+                return false;
+            }
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (reader->colorType == 3 && !hasPalette) return false;
+            reader->chunkRemaining = length;
+            reader->inImageData = true;
+            return true;
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            return false;
+        } else if (!ReadFileBytes(reader, NULL, length)) {
+            return false;
+        }
+
+        // Chunk CRC
+        if (!ReadFileBytes(reader, NULL, 4)) return false;
+    }
+}
+
+/**
+ * Open a PNG file and read everything up to the image data
+ */
+PngReader* CreatePngReader(const char* path, int* width, int* height) {
+    if (path == NULL) return NULL;
+
+    PngReader* reader = (PngReader*)calloc(1, sizeof(PngReader));
+    if (reader == NULL) return NULL;
+
+    reader->blockType = -1;
+    reader->buffer = (unsigned char*)malloc(PNG_READ_BUFFER_SIZE);
+    reader->window = (unsigned char*)malloc(DEFLATE_WINDOW_SIZE);
+    reader->file = fopen(path, "rb");
+    if (reader->buffer == NULL || reader->window == NULL || reader->file == NULL || !ReadPngHeader(reader)) {
+        DestroyPngReader(reader);
+        return NULL;
+    }
+
+    int bitsPerPixel = GetPngChannelCount(reader->colorType) * reader->bitDepth;
+    reader->stride = ((size_t)reader->width * bitsPerPixel + 7) / 8;
+    reader->filterBpp = (bitsPerPixel + 7) / 8;
+    reader->previousRow = (unsigned char*)calloc(reader->stride, 1);
+    reader->currentRow = (unsigned char*)malloc(reader->stride);
+    if (reader->previousRow == NULL || reader->currentRow == NULL) {
+        DestroyPngReader(reader);
+        return NULL;
+    }
+
+    // zlib stream header: deflate, no preset dictionary
+    unsigned int cmf = GetBits(reader, 8);
+    unsigned int flags = GetBits(reader, 8);
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flags) % 31 != 0 || (flags & 0x20) != 0) {
+        DestroyPngReader(reader);
+        return NULL;
+    }
+
+    if (width != NULL) *width = reader->width;
+    if (height != NULL) *height = reader->height;
+    return reader;
+}
+
+static bool UnfilterPngRow(PngReader* reader, int filter) {
+    unsigned char* row = reader->currentRow;
+    const unsigned char* above = reader->previousRow;
+    size_t bpp = (size_t)reader->filterBpp;
+
+    switch (filter) {
+        case 0:
+            break;
+        case 1:
+            for (size_t i = bpp; i < reader->stride; i++) row[i] += row[i - bpp];
+            break;
+        case 2:
+            for (size_t i = 0; i < reader->stride; i++) row[i] += above[i];
+            break;
+        case 3:
+            for (size_t i = 0; i < reader->stride; i++) {
+                int left = (i >= bpp) ? row[i - bpp] : 0;
+                row[i] += (unsigned char)((left + above[i]) >> 1);
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < reader->stride; i++) {
+                int left = (i >= bpp) ? row[i - bpp] : 0;
+                int upLeft = (i >= bpp) ? above[i - bpp] : 0;
+                row[i] += (unsigned char)PaethPredictor(left, above[i], upLeft);
+            }
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Sample index of an unfiltered row at the image bit depth
+ */
+static unsigned int GetPngSample(const unsigned char* row, size_t index, int bitDepth) {
+    if (bitDepth == 8) return row[index];
+    if (bitDepth == 16) return ((unsigned int)row[2 * index] << 8) | row[2 * index + 1];
+
+    size_t bit = index * bitDepth;
+    return (row[bit >> 3] >> (8 - bitDepth - (bit & 7))) & ((1u << bitDepth) - 1);
+}
+
+static void ConvertPngRow(PngReader* reader, Color* pixels) {
+    const unsigned char* row = reader->currentRow;
+    int depth = reader->bitDepth;
+    unsigned int maxSample = (1u << depth) - 1;
+
+    // Color is laid out as R, G, B, A bytes, so 8-bit RGBA is a plain copy
+    if (reader->colorType == 6 && depth == 8) {
+        memcpy(pixels, row, reader->stride);
+        return;
+    }
+
+    int channels = GetPngChannelCount(reader->colorType);
+    for (int x = 0; x < reader->width; x++) {
+        size_t base = (size_t)x * channels;
+        unsigned int samples[4];
+        unsigned char values[4];
+        for (int c = 0; c < channels; c++) {
+            samples[c] = GetPngSample(row, base + c, depth);
+            values[c] = (unsigned char)((depth == 16) ? samples[c] >> 8 : samples[c] * 255 / maxSample);
+        }
+
+        switch (reader->colorType) {
+            case 0: {
+                bool isKey = reader->hasColorKey && samples[0] == reader->colorKey[0];
+                pixels[x] = (Color){values[0], values[0], values[0], isKey ? 0 : 255};
+            } break;
+            case 2: {
+                bool isKey = reader->hasColorKey && samples[0] == reader->colorKey[0] &&
+                             samples[1] == reader->colorKey[1] && samples[2] == reader->colorKey[2];
+                pixels[x] = (Color){values[0], values[1], values[2], isKey ? 0 : 255};
+            } break;
+            case 3:
+                pixels[x] = reader->palette[samples[0]];
+                break;
+            case 4:
+                pixels[x] = (Color){values[0], values[0], values[0], values[1]};
+                break;
+            default:
+                pixels[x] = (Color){values[0], values[1], values[2], values[3]};
+                break;
+        }
+    }
+}
+
+/**
+ * Decode the next row of the image
+ */
+bool ReadPngRow(PngReader* reader, Color* pixels) {
+    if (reader == NULL || pixels == NULL || reader->rowsRead >= reader->height) return false;
+
+    unsigned char filter = 0;
+    if (!InflateBytes(reader, &filter, 1) || !InflateBytes(reader, reader->currentRow, (int)reader->stride) ||
+        !UnfilterPngRow(reader, filter)) {
+        reader->rowsRead = reader->height;  // Stop at the first error
+        return false;
+    }
+
+    ConvertPngRow(reader, pixels);
+
+    unsigned char* swap = reader->previousRow;
+    reader->previousRow = reader->currentRow;
+    reader->currentRow = swap;
+    reader->rowsRead++;
+    return true;
+}
+
+/**
+ * Close and free a reader
+ */
+void DestroyPngReader(PngReader* reader) {
+    if (reader == NULL) return;
+
+    if (reader->file != NULL) {
+        fclose(reader->file);
+    }
+    free(reader->buffer);
+    free(reader->window);
+    free(reader->previousRow);
+    free(reader->currentRow);
+    free(reader);
+}
@@ -0,0 +1,320 @@
+/**
+ * profiler.c
+ *
+ * Implementation of Frame Phase Profiler
+ */
+
+#include "profiler.h"
+#include "timing.h"
+#include "raylib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROFILER_FRAME_MASK (PROFILER_FRAME_CAPACITY - 1)
+
+static const char* phaseNames[PROFILE_PHASE_COUNT] = {
+    "Input", "Color picker", "Camera", "Tools", "Autosave", "Composite", "Draw canvas", "Draw UI"
+};
+
+/**
+ * Create a profiler
+ */
+Profiler* CreateProfiler(void) {
+    Profiler* profiler = (Profiler*)calloc(1, sizeof(Profiler));
+    if (profiler == NULL) return NULL;
+
+    profiler->frames = (ProfileFrame*)calloc(PROFILER_FRAME_CAPACITY, sizeof(ProfileFrame));
+    if (profiler->frames == NULL) {
+        free(profiler);
+        return NULL;
+    }
+    profiler->overlayUpdateTime = -1.0;
+    return profiler;
+}
+
+/**
+ * Destroy a profiler
+ */
+void DestroyProfiler(Profiler* profiler) {
+    if (profiler == NULL) return;
+
+    free(profiler->frames);
+    free(profiler);
+}
+
+/**
+ * Start recording a main loop iteration
+ */
+void BeginProfileFrame(Profiler* profiler) {
+    if (profiler == NULL) return;
+
+    memset(&profiler->current, 0, sizeof(profiler->current));
+    memset(profiler->phaseStart, 0, sizeof(profiler->phaseStart));
+    profiler->current.index = profiler->publishedCount;
+    profiler->current.startTime = GetMonotonicTime();
+}
+
+/**
+ * Start timing a phase
+ */
+void BeginProfilePhase(Profiler* profiler, ProfilePhase phase) {
+    if (profiler == NULL || phase < 0 || phase >= PROFILE_PHASE_COUNT) return;
+
+    profiler->phaseStart[phase] = GetMonotonicTime();
+}
+
+/**
+ * Stop timing a phase
+ */
+void EndProfilePhase(Profiler* profiler, ProfilePhase phase) {
+    if (profiler == NULL || phase < 0 || phase >= PROFILE_PHASE_COUNT) return;
+    if (profiler->phaseStart[phase] <= 0.0) return;
+
+    profiler->current.phaseMs[phase] += (float)((GetMonotonicTime() - profiler->phaseStart[phase]) * 1000.0);
+    profiler->phaseStart[phase] = 0.0;
+}
+
+/**
+ * Record the drawing work of the current frame
+ */
+void SetProfileDrawCounts(Profiler* profiler, int canvasDrawCalls, int pickerDrawCalls, int textureUploads) {
+    if (profiler == NULL) return;
+
+    profiler->current.canvasDrawCalls = canvasDrawCalls;
+    profiler->current.pickerDrawCalls = pickerDrawCalls;
+    profiler->current.textureUploads = textureUploads;
+}
+
+/**
+ * Finish the current frame and publish it to the ring buffer
+ */
+void EndProfileFrame(Profiler* profiler, bool rendered) {
+    if (profiler == NULL) return;
+
+    ProfileFrame* frame = &profiler->current;
+    frame->frameMs = (float)((GetMonotonicTime() - frame->startTime) * 1000.0);
+    frame->rendered = rendered;
+
+    // Fill the slot first, then publish it; readers only trust frames the
+    // count says are complete and not yet being overwritten
+    // The fence keeps the previous publish ahead of the slot writes, so a
+    // reader never sees a reused slot change before the count that retires it
+    unsigned long long count = profiler->publishedCount;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    profiler->frames[count & PROFILER_FRAME_MASK] = *frame;
+    __atomic_store_n(&profiler->publishedCount, count + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Copy the most recent published frames, oldest first
+ */
+int ReadProfileFrames(const Profiler* profiler, ProfileFrame* frames, int maxFrames) {
+    if (profiler == NULL || frames == NULL || maxFrames <= 0) return 0;
+
+    // The slot of the oldest frame is the one the next frame is written to
+    unsigned long long end = __atomic_load_n(&profiler->publishedCount, __ATOMIC_ACQUIRE);
+    unsigned long long available = (end < PROFILER_FRAME_CAPACITY - 1) ? end : PROFILER_FRAME_CAPACITY - 1;
+    unsigned long long count = ((unsigned long long)maxFrames < available) ? (unsigned long long)maxFrames : available;
+    unsigned long long begin = end - count;
+
+    for (unsigned long long i = begin; i < end; i++) {
+        frames[i - begin] = profiler->frames[i & PROFILER_FRAME_MASK];
+    }
+
+    // The writer may have started reusing the oldest slots while they were
+    // copied (the slot of frame end + n is the one of end + n - capacity).
+    // The fence keeps the copies ahead of the re-check, as in a seqlock read
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    unsigned long long after = __atomic_load_n(&profiler->publishedCount, __ATOMIC_ACQUIRE);
+    unsigned long long firstIntact = (after + 1 > PROFILER_FRAME_CAPACITY) ? after + 1 - PROFILER_FRAME_CAPACITY : 0;
+    if (firstIntact > begin) {
+        unsigned long long dropped = (firstIntact < end) ? firstIntact - begin : count;
+        memmove(frames, frames + dropped, sizeof(ProfileFrame) * (size_t)(count - dropped));
+        count -= dropped;
+    }
+    return (int)count;
+}
+
+/**
+ * qsort comparison of floats
+ */
+static int CompareFloats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Nearest-rank percentiles of a list of timings (sorts it)
+ */
+ProfilePercentiles GetProfilePercentiles(float* values, int count) {
+    ProfilePercentiles result = {0};
+    if (count <= 0) return result;
+
+    qsort(values, (size_t)count, sizeof(float), CompareFloats);
+    result.p50 = values[(count - 1) * 50 / 100];
+    result.p95 = values[(count - 1) * 95 / 100];
+    result.p99 = values[(count - 1) * 99 / 100];
+    result.max = values[count - 1];
+    return result;
+}
+
+/**
+ * Compute percentiles over the most recent rendered frames
+ */
+ProfileSummary GetProfileSummary(const Profiler* profiler, int frameCount) {
+    ProfileSummary summary = {0};
+    if (profiler == NULL || frameCount <= 0) return summary;
+
+    ProfileFrame* frames = (ProfileFrame*)malloc(sizeof(ProfileFrame) * PROFILER_FRAME_CAPACITY);
+    float* values = (float*)malloc(sizeof(float) * PROFILER_FRAME_CAPACITY);
+    if (frames == NULL || values == NULL) {
+        free(frames);
+        free(values);
+        return summary;
+    }
+
+    // Keep the newest rendered frames only; skipped iterations draw nothing
+    int read = ReadProfileFrames(profiler, frames, PROFILER_FRAME_CAPACITY);
+    int count = 0;
+    for (int i = read - 1; i >= 0 && count < frameCount; i--) {
+        if (frames[i].rendered) {
+            frames[count++] = frames[i];
+        }
+    }
+    summary.frameCount = count;
+
+    if (count > 0) {
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            for (int i = 0; i < count; i++) {
+                values[i] = frames[i].phaseMs[phase];
+            }
+            summary.phases[phase] = GetProfilePercentiles(values, count);
+        }
+        for (int i = 0; i < count; i++) {
+            values[i] = frames[i].frameMs;
+        }
+        summary.frame = GetProfilePercentiles(values, count);
+
+        for (int i = 0; i < count; i++) {
+            int drawCalls = frames[i].canvasDrawCalls + frames[i].pickerDrawCalls;
+            summary.averageCanvasDrawCalls += frames[i].canvasDrawCalls;
+            summary.averagePickerDrawCalls += frames[i].pickerDrawCalls;
+            summary.averageTextureUploads += frames[i].textureUploads;
+            if (drawCalls > summary.maxDrawCalls) summary.maxDrawCalls = drawCalls;
+        }
+        summary.averageCanvasDrawCalls /= count;
+        summary.averagePickerDrawCalls /= count;
+        summary.averageTextureUploads /= count;
+    }
+
+    free(frames);
+    free(values);
+    return summary;
+}
+
+/**
+ * Write the most recent frames as CSV, one row per frame
+ */
+int WriteProfileCsv(const Profiler* profiler, const char* path, int frameCount) {
+    if (profiler == NULL || path == NULL) return -1;
+
+    int capacity = (frameCount < PROFILER_FRAME_CAPACITY) ? frameCount : PROFILER_FRAME_CAPACITY;
+    ProfileFrame* frames = (ProfileFrame*)malloc(sizeof(ProfileFrame) * (capacity > 0 ? capacity : 1));
+    FILE* out = (frames != NULL) ? fopen(path, "w") : NULL;
+    if (out == NULL) {
+        free(frames);
+        return -1;
+    }
+
+    int count = ReadProfileFrames(profiler, frames, capacity);
+
+    fprintf(out, "frame,time_s,rendered");
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        // Column names without spaces: "Draw canvas" -> draw_canvas_ms
+        char name[32];
+        int length = 0;
+        for (const char* c = phaseNames[phase]; *c != '\0' && length < (int)sizeof(name) - 1; c++) {
+            name[length++] = (*c == ' ') ? '_' : (char)((*c >= 'A' && *c <= 'Z') ? *c - 'A' + 'a' : *c);
+        }
+        name[length] = '\0';
+        fprintf(out, ",%s_ms", name);
+    }
+    fprintf(out, ",frame_ms,canvas_draw_calls,picker_draw_calls,texture_uploads\n");
+
+    double firstTime = (count > 0) ? frames[0].startTime : 0.0;
+    for (int i = 0; i < count; i++) {
+        const ProfileFrame* frame = &frames[i];
+        fprintf(out, "%llu,%.6f,%d", frame->index, frame->startTime - firstTime, frame->rendered ? 1 : 0);
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            fprintf(out, ",%.4f", frame->phaseMs[phase]);
+        }
+        fprintf(out, ",%.4f,%d,%d,%d\n", frame->frameMs, frame->canvasDrawCalls, frame->pickerDrawCalls,
+                frame->textureUploads);
+    }
+
+    bool ok = !ferror(out);
+    ok = (fclose(out) == 0) && ok;
+    free(frames);
+    return ok ? count : -1;
+}
+
+/**
+ * Get the display name of a phase
+ */
+const char* GetProfilePhaseName(ProfilePhase phase) {
+    if (phase < 0 || phase >= PROFILE_PHASE_COUNT) return "Unknown";
+    return phaseNames[phase];
+}
+
+/**
+ * Draw the percentile table if the overlay is visible
+ */
+void DrawProfilerOverlay(Profiler* profiler, int x, int y) {
+    if (profiler == NULL || !profiler->overlayVisible) return;
+
+    // Sorting every frame would make the numbers flicker unreadably
+    double now = GetMonotonicTime();
+    if (profiler->overlayUpdateTime < 0.0 || now - profiler->overlayUpdateTime >= PROFILER_OVERLAY_REFRESH) {
+        profiler->overlaySummary = GetProfileSummary(profiler, PROFILER_SUMMARY_FRAMES);
+        profiler->overlayUpdateTime = now;
+    }
+    const ProfileSummary* summary = &profiler->overlaySummary;
+
+    const int lineHeight = 16;
+    const int width = 330;
+    const int height = lineHeight * (PROFILE_PHASE_COUNT + 5) + 8;
+    DrawRectangle(x, y, width, height, (Color){0, 0, 0, 200});
+    DrawRectangleLines(x, y, width, height, GRAY);
+
+    x += 6;
+    y += 4;
+    DrawText(TextFormat("Profiler (F3) | last %d frames | F4 = CSV", summary->frameCount), x, y, 14, WHITE);
+    y += lineHeight;
+    // The default font is proportional, so each column gets its own x
+    const char* headers[5] = {"phase (ms)", "p50", "p95", "p99", "max"};
+    const int columns[5] = {0, 110, 160, 210, 260};
+    for (int i = 0; i < 5; i++) {
+        DrawText(headers[i], x + columns[i], y, 12, GRAY);
+    }
+    y += lineHeight;
+
+    for (int phase = 0; phase <= PROFILE_PHASE_COUNT; phase++) {
+        bool isTotal = phase == PROFILE_PHASE_COUNT;
+        const ProfilePercentiles* p = isTotal ? &summary->frame : &summary->phases[phase];
+        float values[4] = {p->p50, p->p95, p->p99, p->max};
+
+        // Phases that take half a 60 FPS frame at p95 stand out
+        Color color = isTotal ? WHITE : (p->p95 >= 8.0f) ? ORANGE : LIGHTGRAY;
+        DrawText(isTotal ? "Frame" : phaseNames[phase], x, y, 12, color);
+        for (int i = 0; i < 4; i++) {
+            DrawText(TextFormat("%.2f", values[i]), x + columns[i + 1], y, 12, color);
+        }
+        y += lineHeight;
+    }
+
+    DrawText(TextFormat("Draw calls: canvas %.0f, picker %.0f (max %d) | uploads %.1f",
+             summary->averageCanvasDrawCalls, summary->averagePickerDrawCalls, summary->maxDrawCalls,
+             summary->averageTextureUploads), x, y + 4, 12, LIGHTGRAY);
+}
@@ -0,0 +1,434 @@
+/**
+ * project.c
+ *
+ * Implementation of Native Project Files
+ */
+
+#include "project.h"
+#include "codec.h"
+#include "mapfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROJECT_VERSION 1
+#define PROJECT_HEADER_SIZE 32
+#define PROJECT_CHUNK_HEADER_SIZE 8         // Type and payload size
+#define PROJECT_INDEX_HEADER_SIZE 20        // Width, height, tile size, layer count, active layer
+#define PROJECT_LAYER_HEADER_SIZE 44        // Name, settings, empty color, tile count
+#define PROJECT_TILE_RECORD_SIZE 16         // Payload offset, size, encoding
+#define PROJECT_TILE_ENCODING_RLE 1
+#define PROJECT_MAX_LAYERS 1024
+
+/**
+ * Stored tiles of one layer (the tile loader's user data)
+ */
+typedef struct {
+    ProjectFile* file;
+    const unsigned char* records;   // tileCount index records, inside the mapping
+    int tileCount;
+} ProjectLayerSource;
+
+struct ProjectFile {
+    MappedFile* map;
+    ProjectLayerSource* layers;
+    int layerCount;
+    size_t tilesLoaded;
+};
+
+/**
+ * Store a 32-bit value as little-endian bytes
+ */
+static void PutLittleEndian(unsigned char* out, unsigned int value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+/**
+ * Store a 64-bit value as little-endian bytes
+ */
+static void PutLittleEndian64(unsigned char* out, unsigned long long value) {
+    PutLittleEndian(out, (unsigned int)value);
+    PutLittleEndian(out + 4, (unsigned int)(value >> 32));
+}
+
+/**
+ * Read a little-endian 32-bit value
+ */
+static unsigned int GetLittleEndian(const unsigned char* bytes) {
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) |
+           ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+/**
+ * Read a little-endian 64-bit value
+ */
+static unsigned long long GetLittleEndian64(const unsigned char* bytes) {
+    return (unsigned long long)GetLittleEndian(bytes) | ((unsigned long long)GetLittleEndian(bytes + 4) << 32);
+}
+
+/**
+ * Tile loader of a layer opened from a project: decompress its stored block
+ */
+static bool LoadProjectTile(void* userData, Canvas* canvas, int tileIndex, Color* pixels) {
+    (void)canvas;
+    ProjectLayerSource* source = (ProjectLayerSource*)userData;
+    if (tileIndex < 0 || tileIndex >= source->tileCount) return false;
+
+    // Records were bounds-checked against the file when it was opened
+    const unsigned char* record = source->records + (size_t)tileIndex * PROJECT_TILE_RECORD_SIZE;
+    const unsigned char* data = GetMappedFileData(source->file->map) + GetLittleEndian64(record);
+    if (!DecompressPixelsRLE(data, GetLittleEndian(record + 8), pixels, CANVAS_TILE_PIXELS)) return false;
+
+    source->file->tilesLoaded++;
+    return true;
+}
+
+/**
+ * Check the header and index checksum of a mapped project
+ * Returns the index payload, or NULL if the file is not a valid project
+ */
+static const unsigned char* FindProjectIndex(const MappedFile* map, size_t* outSize) {
+    const unsigned char* data = GetMappedFileData(map);
+    size_t size = GetMappedFileSize(map);
+    if (data == NULL || size < PROJECT_HEADER_SIZE) return NULL;
+    if (memcmp(data, "PXPJ", 4) != 0 || GetLittleEndian(data + 4) != PROJECT_VERSION) return NULL;
+
+    unsigned long long offset = GetLittleEndian64(data + 8);
+    size_t indexSize = GetLittleEndian(data + 16);
+    if (offset < PROJECT_HEADER_SIZE + PROJECT_CHUNK_HEADER_SIZE || offset > size || indexSize > size - offset ||
+        indexSize < PROJECT_INDEX_HEADER_SIZE) {
+        return NULL;
+    }
+
+    const unsigned char* index = data + offset;
+    if (UpdateCrc32(0, index, indexSize) != GetLittleEndian(data + 20)) return NULL;
+
+    *outSize = indexSize;
+    return index;
+}
+
+/**
+ * Mark every stored tile of a layer pending, after checking its records
+ */
+static bool AttachLayerSource(Canvas* canvas, ProjectLayerSource* source) {
+    size_t fileSize = GetMappedFileSize(source->file->map);
+
+    for (int i = 0; i < source->tileCount; i++) {
+        const unsigned char* record = source->records + (size_t)i * PROJECT_TILE_RECORD_SIZE;
+        unsigned long long offset = GetLittleEndian64(record);
+        unsigned int size = GetLittleEndian(record + 8);
+        if (size == 0) continue;
+
+        if (GetLittleEndian(record + 12) != PROJECT_TILE_ENCODING_RLE || offset > fileSize ||
+            size > fileSize - offset) {
+            return false;
+        }
+        SetCanvasTilePending(canvas, i);
+    }
+
+    SetCanvasTileLoader(canvas, LoadProjectTile, source);
+    return true;
+}
+
+/**
+ * Open a project file as a document whose tiles load on first access
+ */
+LayerStack* OpenProject(const char* path, ProjectFile** outFile) {
+    if (path == NULL || outFile == NULL) return NULL;
+    *outFile = NULL;
+
+    ProjectFile* file = (ProjectFile*)calloc(1, sizeof(ProjectFile));
+    if (file == NULL) return NULL;
+
+    size_t indexSize = 0;
+    file->map = OpenMappedFile(path);
+    const unsigned char* index = (file->map != NULL) ? FindProjectIndex(file->map, &indexSize) : NULL;
+    if (index == NULL) {
+        CloseProject(file);
+        return NULL;
+    }
+
+    int width = (int)GetLittleEndian(index);
+    int height = (int)GetLittleEndian(index + 4);
+    int layerCount = (int)GetLittleEndian(index + 12);
+    int activeIndex = (int)GetLittleEndian(index + 16);
+    if (width <= 0 || height <= 0 || width > CANVAS_MAX_SIZE || height > CANVAS_MAX_SIZE ||
+        GetLittleEndian(index + 8) != CANVAS_TILE_SIZE || layerCount <= 0 || layerCount > PROJECT_MAX_LAYERS) {
+        CloseProject(file);
+        return NULL;
+    }
+
+    file->layers = (ProjectLayerSource*)calloc(layerCount, sizeof(ProjectLayerSource));
+    LayerStack* stack = (file->layers != NULL) ? CreateLayerStack(width, height) : NULL;
+    for (int i = 1; i < layerCount && stack != NULL; i++) {
+        if (AddLayer(stack, NULL) < 0) {
+            DestroyLayerStack(stack);
+            stack = NULL;
+        }
+    }
+    if (stack == NULL) {
+        CloseProject(file);
+        return NULL;
+    }
+
+    int tileCount = stack->composite->tilesX * stack->composite->tilesY;
+    size_t recordsSize = (size_t)tileCount * PROJECT_TILE_RECORD_SIZE;
+    size_t position = PROJECT_INDEX_HEADER_SIZE;
+    bool ok = true;
+
+    for (int i = 0; i < layerCount && ok; i++) {
+        const unsigned char* entry = index + position;
+        if (indexSize - position < PROJECT_LAYER_HEADER_SIZE + recordsSize ||
+            (int)GetLittleEndian(entry + 40) != tileCount || entry[34] >= PIXEL_BLEND_COUNT) {
+            ok = false;
+            break;
+        }
+
+        Layer* layer = &stack->layers[i];
+        snprintf(layer->name, sizeof(layer->name), "%.*s", LAYER_NAME_LENGTH - 1, (const char*)entry);
+        layer->opacity = entry[32];
+        layer->visible = entry[33] != 0;
+        layer->blendMode = (PixelBlendMode)entry[34];
+        ClearCanvas(layer->canvas, (Color){entry[36], entry[37], entry[38], entry[39]});
+
+        ProjectLayerSource* source = &file->layers[i];
+        source->file = file;
+        source->records = entry + PROJECT_LAYER_HEADER_SIZE;
+        source->tileCount = tileCount;
+        file->layerCount++;
+        ok = AttachLayerSource(layer->canvas, source);
+
+        position += PROJECT_LAYER_HEADER_SIZE + recordsSize;
+    }
+
+    if (!ok) {
+        DestroyLayerStack(stack);
+        CloseProject(file);
+        return NULL;
+    }
+
+    stack->activeIndex = (activeIndex >= 0 && activeIndex < layerCount) ? activeIndex : layerCount - 1;
+    stack->nextLayerNumber = layerCount + 1;
+
+    // Nothing is composed until it is needed either
+    DeferLayerComposite(stack);
+
+    *outFile = file;
+    return stack;
+}
+
+/**
+ * Write a tile chunk, returning the offset of its payload (0 on failure)
+ */
+static unsigned long long WriteTileChunk(FILE* out, unsigned long long* offset, const unsigned char* data,
+                                         size_t size) {
+    unsigned char chunkHeader[PROJECT_CHUNK_HEADER_SIZE];
+    memcpy(chunkHeader, "TILE", 4);
+    PutLittleEndian(chunkHeader + 4, (unsigned int)size);
+    if (fwrite(chunkHeader, 1, sizeof(chunkHeader), out) != sizeof(chunkHeader) ||
+        fwrite(data, 1, size, out) != size) {
+        return 0;
+    }
+
+    unsigned long long payloadOffset = *offset + PROJECT_CHUNK_HEADER_SIZE;
+    *offset = payloadOffset + size;
+    return payloadOffset;
+}
+
+/**
+ * Write one layer's settings and tiles, filling in its part of the index
+ * Tiles still pending from an open project are copied across compressed
+ */
+static bool WriteProjectLayer(FILE* out, unsigned long long* offset, const Layer* layer, unsigned char* entry,
+                              int tileCount) {
+    Canvas* canvas = layer->canvas;
+    memset(entry, 0, PROJECT_LAYER_HEADER_SIZE);
+    strncpy((char*)entry, layer->name, LAYER_NAME_LENGTH);
+    entry[32] = layer->opacity;
+    entry[33] = layer->visible ? 1 : 0;
+    entry[34] = (unsigned char)layer->blendMode;
+    entry[36] = canvas->emptyColor.r;
+    entry[37] = canvas->emptyColor.g;
+    entry[38] = canvas->emptyColor.b;
+    entry[39] = canvas->emptyColor.a;
+    PutLittleEndian(entry + 40, (unsigned int)tileCount);
+
+    for (int i = 0; i < tileCount; i++) {
+        unsigned char* record = entry + PROJECT_LAYER_HEADER_SIZE + (size_t)i * PROJECT_TILE_RECORD_SIZE;
+        memset(record, 0, PROJECT_TILE_RECORD_SIZE);
+
+        const unsigned char* data = NULL;
+        size_t size = 0;
+        unsigned char* compressed = NULL;
+        if (IsCanvasTilePending(canvas, i) && canvas->tileLoader == LoadProjectTile) {
+            const ProjectLayerSource* source = (const ProjectLayerSource*)canvas->tileLoaderUserData;
+            const unsigned char* stored = source->records + (size_t)i * PROJECT_TILE_RECORD_SIZE;
+            data = GetMappedFileData(source->file->map) + GetLittleEndian64(stored);
+            size = GetLittleEndian(stored + 8);
+        } else {
+            const Color* pixels = GetCanvasTilePixels(canvas, i);
+            if (pixels == NULL) continue;
+            compressed = CompressPixelsRLE(pixels, CANVAS_TILE_PIXELS, &size);
+            if (compressed == NULL) return false;
+            data = compressed;
+        }
+
+        unsigned long long payloadOffset = WriteTileChunk(out, offset, data, size);
+        free(compressed);
+        if (payloadOffset == 0) return false;
+
+        PutLittleEndian64(record, payloadOffset);
+        PutLittleEndian(record + 8, (unsigned int)size);
+        PutLittleEndian(record + 12, PROJECT_TILE_ENCODING_RLE);
+    }
+    return true;
+}
+
+/**
+ * Write the whole project file: header, tile chunks, then the index
+ */
+static bool WriteProjectFile(LayerStack* stack, const char* path) {
+    int tileCount = stack->composite->tilesX * stack->composite->tilesY;
+    size_t layerSize = PROJECT_LAYER_HEADER_SIZE + (size_t)tileCount * PROJECT_TILE_RECORD_SIZE;
+    size_t indexSize = PROJECT_INDEX_HEADER_SIZE + layerSize * stack->count;
+    if (indexSize > 0xFFFFFFFFu) return false;
+
+    unsigned char* index = (unsigned char*)malloc(indexSize);
+    FILE* out = (index != NULL) ? fopen(path, "wb") : NULL;
+    if (out == NULL) {
+        free(index);
+        return false;
+    }
+
+    // The header is written again once the index location is known
+    unsigned char header[PROJECT_HEADER_SIZE] = {0};
+    bool ok = fwrite(header, 1, sizeof(header), out) == sizeof(header);
+    unsigned long long offset = PROJECT_HEADER_SIZE;
+
+    PutLittleEndian(index, (unsigned int)stack->width);
+    PutLittleEndian(index + 4, (unsigned int)stack->height);
+    PutLittleEndian(index + 8, CANVAS_TILE_SIZE);
+    PutLittleEndian(index + 12, (unsigned int)stack->count);
+    PutLittleEndian(index + 16, (unsigned int)stack->activeIndex);
+    for (int i = 0; i < stack->count && ok; i++) {
+        unsigned char* entry = index + PROJECT_INDEX_HEADER_SIZE + layerSize * i;
+        ok = WriteProjectLayer(out, &offset, &stack->layers[i], entry, tileCount);
+    }
+
+    if (ok) {
+        unsigned char chunkHeader[PROJECT_CHUNK_HEADER_SIZE];
+        memcpy(chunkHeader, "INDX", 4);
+        PutLittleEndian(chunkHeader + 4, (unsigned int)indexSize);
+        ok = fwrite(chunkHeader, 1, sizeof(chunkHeader), out) == sizeof(chunkHeader) &&
+             fwrite(index, 1, indexSize, out) == indexSize;
+    }
+
+    if (ok) {
+        memcpy(header, "PXPJ", 4);
+        PutLittleEndian(header + 4, PROJECT_VERSION);
+        PutLittleEndian64(header + 8, offset + PROJECT_CHUNK_HEADER_SIZE);
+        PutLittleEndian(header + 16, (unsigned int)indexSize);
+        PutLittleEndian(header + 20, UpdateCrc32(0, index, indexSize));
+        ok = fseek(out, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), out) == sizeof(header);
+    }
+
+    // The file replaces the previous save once renamed, so it must be complete on disk first
+    ok = ok && FlushFileToDisk(out);
+
+    free(index);
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * Load every tile a project still backs and close it, so its file can be replaced
+ */
+static void DetachProject(LayerStack* stack, ProjectFile* file) {
+    for (int i = 0; i < stack->count; i++) {
+        Canvas* canvas = stack->layers[i].canvas;
+        if (canvas->tileLoader == LoadProjectTile &&
+            ((const ProjectLayerSource*)canvas->tileLoaderUserData)->file == file) {
+            LoadCanvasTiles(canvas);
+            SetCanvasTileLoader(canvas, NULL, NULL);
+        }
+    }
+    CloseProject(file);
+}
+
+/**
+ * Move a finished save over the previous one
+ * POSIX rename() replaces the target atomically, so a crash leaves either
+ * the old or the new project; only Windows needs the target removed first
+ */
+static bool ReplaceProjectFile(const char* tempPath, const char* path) {
+#if defined(_WIN32)
+    remove(path);
+#endif
+    return rename(tempPath, path) == 0;
+}
+
+/**
+ * Save a document as a project file
+ */
+bool SaveProject(LayerStack* stack, const char* path, ProjectFile** openFile) {
+    if (stack == NULL || path == NULL) return false;
+
+    char tempPath[272];
+    if (snprintf(tempPath, sizeof(tempPath), "%s.tmp", path) >= (int)sizeof(tempPath)) return false;
+
+    if (!WriteProjectFile(stack, tempPath)) {
+        remove(tempPath);
+        return false;
+    }
+
+    // A file that is still mapped cannot be replaced on Windows
+    bool ok = ReplaceProjectFile(tempPath, path);
+    if (!ok && openFile != NULL && *openFile != NULL) {
+        DetachProject(stack, *openFile);
+        *openFile = NULL;
+        ok = ReplaceProjectFile(tempPath, path);
+    }
+    if (!ok) {
+        remove(tempPath);
+    }
+    return ok;
+}
+
+/**
+ * Read the index checksum from a project file's header
+ */
+bool ReadProjectChecksum(const char* path, unsigned int* checksum) {
+    if (path == NULL || checksum == NULL) return false;
+
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) return false;
+
+    unsigned char header[PROJECT_HEADER_SIZE];
+    bool ok = fread(header, 1, sizeof(header), in) == sizeof(header) && memcmp(header, "PXPJ", 4) == 0 &&
+              GetLittleEndian(header + 4) == PROJECT_VERSION;
+    fclose(in);
+    if (!ok) return false;
+
+    *checksum = GetLittleEndian(header + 20);
+    return true;
+}
+
+/**
+ * Get the number of stored tiles decompressed so far
+ */
+size_t GetProjectTilesLoaded(const ProjectFile* file) {
+    return (file != NULL) ? file->tilesLoaded : 0;
+}
+
+/**
+ * Unmap a project file
+ */
+void CloseProject(ProjectFile* file) {
+    if (file == NULL) return;
+
+    CloseMappedFile(file->map);
+    free(file->layers);
+    free(file);
+}
@@ -0,0 +1,131 @@
+/**
+ * raster.c
+ *
+ * Implementation of Line Rasterizer
+ *
+ * The line is parameterized along its major axis: at step i the major
+ * coordinate is start + i and the minor offset is
+ *     k(i) = floor((2 * i * minor + major) / (2 * major))
+ * (Bresenham's midpoint rule). Because k(i) has a closed form and its
+ * inverse is cheap, clipping and run boundaries are computed directly
+ * instead of by stepping pixel by pixel.
+ */
+
+#include "raster.h"
+
+/**
+ * Minor-axis offset at major step i
+ */
+static long long MinorOffsetAt(long long i, long long major, long long minor) {
+    return (2 * i * minor + major) / (2 * major);
+}
+
+/**
+ * First major step whose minor offset is at least k (requires minor > 0)
+ */
+static long long FirstStepOfMinor(long long k, long long major, long long minor) {
+    if (k <= 0) return 0;
+    long long numerator = 2 * major * k - major;
+    long long denominator = 2 * minor;
+    return (numerator + denominator - 1) / denominator;
+}
+
+/**
+ * Rasterize a line segment clipped to a rectangle
+ */
+int RasterizeLine(int x0, int y0, int x1, int y1,
+                  int clipMinX, int clipMinY, int clipMaxX, int clipMaxY,
+                  RasterSpanCallback callback, void* userData) {
+    if (callback == 0 || clipMinX > clipMaxX || clipMinY > clipMaxY) return 0;
+
+    long long dx = (long long)x1 - x0;
+    long long dy = (long long)y1 - y0;
+    long long adx = (dx < 0) ? -dx : dx;
+    long long ady = (dy < 0) ? -dy : dy;
+
+    // Work in major/minor axis terms so one code path serves all octants
+    bool yMajor = ady > adx;
+    long long major = yMajor ? ady : adx;
+    long long minor = yMajor ? adx : ady;
+    long long majorStart = yMajor ? y0 : x0;
+    long long minorStart = yMajor ? x0 : y0;
+    int majorSign = ((yMajor ? dy : dx) < 0) ? -1 : 1;
+    int minorSign = ((yMajor ? dx : dy) < 0) ? -1 : 1;
+    long long majorClipMin = yMajor ? clipMinY : clipMinX;
+    long long majorClipMax = yMajor ? clipMaxY : clipMaxX;
+    long long minorClipMin = yMajor ? clipMinX : clipMinY;
+    long long minorClipMax = yMajor ? clipMaxX : clipMaxY;
+
+    // Single point
+    if (major == 0) {
+        if (x0 < clipMinX || x0 > clipMaxX || y0 < clipMinY || y0 > clipMaxY) return 0;
+        callback(userData, (RasterSpan){x0, y0, 1, false, 1});
+        return 1;
+    }
+
+    // Step range allowed by the major-axis clip
+    long long firstStep, lastStep;
+    if (majorSign > 0) {
+        firstStep = majorClipMin - majorStart;
+        lastStep = majorClipMax - majorStart;
+    } else {
+        firstStep = majorStart - majorClipMax;
+        lastStep = majorStart - majorClipMin;
+    }
+    if (firstStep < 0) firstStep = 0;
+    if (lastStep > major) lastStep = major;
+
+    // Minor offset range allowed by the minor-axis clip
+    long long minorLow, minorHigh;
+    if (minorSign > 0) {
+        minorLow = minorClipMin - minorStart;
+        minorHigh = minorClipMax - minorStart;
+    } else {
+        minorLow = minorStart - minorClipMax;
+        minorHigh = minorStart - minorClipMin;
+    }
+
+    if (minor == 0) {
+        if (minorLow > 0 || minorHigh < 0) return 0;
+    } else {
+        // Narrow the step range to where the minor offset is inside the clip
+        if (minorLow > 0) {
+            long long step = FirstStepOfMinor(minorLow, major, minor);
+            if (step > firstStep) firstStep = step;
+        }
+        if (minorHigh < minor) {
+            long long step = FirstStepOfMinor(minorHigh + 1, major, minor) - 1;
+            if (step < lastStep) lastStep = step;
+        }
+    }
+    if (firstStep > lastStep) return 0;
+
+    // Emit one span per minor offset
+    int spanCount = 0;
+    long long k = MinorOffsetAt(firstStep, major, minor);
+    long long step = firstStep;
+    while (step <= lastStep) {
+        long long runEnd = (minor == 0) ? lastStep : FirstStepOfMinor(k + 1, major, minor) - 1;
+        if (runEnd > lastStep) runEnd = lastStep;
+
+        long long a = majorStart + majorSign * step;
+        long long b = majorStart + majorSign * runEnd;
+        int runStart = (int)((a < b) ? a : b);
+        int runLength = (int)(runEnd - step + 1);
+        int minorPos = (int)(minorStart + minorSign * k);
+
+        RasterSpan span;
+        if (yMajor) {
+            span = (RasterSpan){minorPos, runStart, runLength, true, majorSign};
+        } else {
+            span = (RasterSpan){runStart, minorPos, runLength, false, majorSign};
+        }
+        callback(userData, span);
+        spanCount++;
+
+        step = runEnd + 1;
+        k++;
+    }
+
+    return spanCount;
+}
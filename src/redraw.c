@@ -0,0 +1,73 @@
+/**
+ * redraw.c
+ *
+ * Implementation of View Invalidation System
+ */
+
+#include "redraw.h"
+#include "raylib.h"
+
+// Pending redraw reasons; start dirty so the first frame is always drawn
+static unsigned int pendingReasons = REDRAW_WINDOW;
+
+static RedrawStats stats = {0};
+
+// Busy time accumulated over the current measurement window
+static double windowStart = -1.0;
+static double windowBusy = 0.0;
+
+/**
+ * Mark the view as needing a redraw
+ */
+void RequestRedraw(RedrawReason reason) {
+    pendingReasons |= (unsigned int)reason;
+}
+
+/**
+ * Check whether a redraw has been requested since the last frame
+ */
+bool IsRedrawPending(void) {
+    return pendingReasons != 0;
+}
+
+/**
+ * Clear pending redraw requests
+ */
+unsigned int ConsumeRedrawRequests(void) {
+    unsigned int reasons = pendingReasons;
+    pendingReasons = 0;
+    return reasons;
+}
+
+/**
+ * Record one main loop iteration
+ * Busy percentage is recomputed once per second of wall time
+ */
+void RecordLoopIteration(bool rendered, double busySeconds) {
+    if (rendered) {
+        stats.framesRendered++;
+    } else {
+        stats.framesSkipped++;
+    }
+
+    double now = GetTime();
+    if (windowStart < 0.0) {
+        windowStart = now;
+    }
+
+    windowBusy += busySeconds;
+
+    double elapsed = now - windowStart;
+    if (elapsed >= 1.0) {
+        stats.busyPercent = (float)(windowBusy / elapsed * 100.0);
+        windowStart = now;
+        windowBusy = 0.0;
+    }
+}
+
+/**
+ * Get the current render loop statistics
+ */
+RedrawStats GetRedrawStats(void) {
+    return stats;
+}
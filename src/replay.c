@@ -0,0 +1,290 @@
+/**
+ * replay.c
+ *
+ * Implementation of Headless Input Replay
+ */
+
+#include "replay.h"
+#include "input.h"
+#include "editor.h"
+#include "camera.h"
+#include "tool.h"
+#include "history.h"
+#include "ui.h"
+#include "project.h"
+#include "codec.h"
+#include "softrender.h"
+#include "timing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int pixelSize = 1; // Base pixel size before zoom, as in the main loop
+
+static const char* replayOpNames[REPLAY_OP_COUNT] = {
+    "stroke start", "stroke drag", "stroke end", "fill", "eyedropper", "camera",
+    "undo/redo", "layer", "color picker", "composite", "idle"
+};
+
+/**
+ * Add one timed step to an operation's statistics
+ */
+static void AddReplayStep(ReplayStats* stats, ReplayOp op, double seconds) {
+    ReplayOpStats* opStats = &stats->ops[op];
+    opStats->count++;
+    opStats->seconds += seconds;
+    if (seconds > opStats->maxSeconds) opStats->maxSeconds = seconds;
+}
+
+/**
+ * Classify a tool update by the stroke state before and after it
+ */
+static ReplayOp GetToolStepOp(const ToolState* toolState, bool wasDrawing, bool leftPressed) {
+    if (wasDrawing) {
+        return toolState->isDrawing ? REPLAY_STROKE_DRAG : REPLAY_STROKE_END;
+    }
+    if (!leftPressed || !toolState->isDrawing) return REPLAY_IDLE;
+
+    switch (toolState->currentTool) {
+        case TOOL_FILL:
+            return REPLAY_FILL;
+        case TOOL_EYEDROPPER:
+            return REPLAY_EYEDROPPER;
+        default:
+            return REPLAY_STROKE_START;
+    }
+}
+
+/**
+ * Checksum a document's layers
+ */
+unsigned int GetLayerStackChecksum(LayerStack* stack) {
+    if (stack == NULL) return 0;
+
+    Color* row = (Color*)malloc(stack->width * sizeof(Color));
+    if (row == NULL) return 0;
+
+    unsigned int crc = 0;
+    for (int i = 0; i < stack->count; i++) {
+        const Layer* layer = &stack->layers[i];
+        unsigned char properties[3] = {layer->opacity, layer->visible ? 1 : 0, (unsigned char)layer->blendMode};
+        crc = UpdateCrc32(crc, properties, sizeof(properties));
+        for (int y = 0; y < stack->height; y++) {
+            ReadCanvasRow(layer->canvas, y, row);
+            crc = UpdateCrc32(crc, (const unsigned char*)row, stack->width * sizeof(Color));
+        }
+    }
+    free(row);
+    return crc;
+}
+
+/**
+ * Render the view as the main window shows it (canvas and border) to a PNG
+ */
+static bool WriteReplaySnapshot(const char* path, LayerStack* layers, const CanvasCamera* camera, int screenWidth,
+                                int screenHeight, ThreadPool* pool) {
+    SoftwareFramebuffer* framebuffer = CreateSoftwareFramebuffer(screenWidth, screenHeight);
+    if (framebuffer == NULL) return false;
+
+    ClearSoftwareFramebuffer(framebuffer, DARKGRAY);
+    RenderSoftwareCanvas(framebuffer, GetLayerComposite(layers), camera->position, camera->zoom, pixelSize, pool);
+    float scale = pixelSize * camera->zoom;
+    DrawSoftwareRectangleLines(framebuffer, (int)camera->position.x - 1, (int)camera->position.y - 1,
+                               (int)(layers->width * scale) + 2, (int)(layers->height * scale) + 2, WHITE);
+
+    bool written = WriteSoftwareFramebufferPng(framebuffer, path);
+    DestroySoftwareFramebuffer(framebuffer);
+    return written;
+}
+
+/**
+ * Replay an input log against the document it was recorded on
+ */
+bool ReplayInputLog(const char* path, ThreadPool* pool, const char* snapshotPath, ReplayStats* stats) {
+    if (path == NULL || stats == NULL) return false;
+    *stats = (ReplayStats){0};
+
+    InputLogHeader header;
+    InputLog* log = OpenInputLog(path, &header);
+    if (log == NULL) return false;
+
+    double loadStart = GetMonotonicTime();
+    ProjectFile* projectFile = NULL;
+    LayerStack* layers = OpenProject(header.documentPath, &projectFile);
+    CanvasCamera* camera = CreateCanvasCamera();
+    ToolState* toolState = CreateToolState();
+    History* history = CreateHistory(DEFAULT_HISTORY_BUDGET);
+    if (layers == NULL || camera == NULL || toolState == NULL) {
+        DestroyHistory(history);
+        DestroyToolState(toolState);
+        DestroyCanvasCamera(camera);
+        DestroyLayerStack(layers);
+        CloseProject(projectFile);
+        CloseInputLog(log);
+        return false;
+    }
+    SetLayerStackThreadPool(layers, pool);
+    SetToolHistory(toolState, history);
+    UpdateLayerComposite(layers);
+    stats->loadSeconds = GetMonotonicTime() - loadStart;
+
+    // Start from the state the recording started from
+    camera->position = header.cameraPosition;
+    camera->zoom = header.cameraZoom;
+    ColorPicker colorPicker = InitColorPicker(header.pickerBounds.x, header.pickerBounds.y,
+                                              header.pickerBounds.width, header.pickerBounds.height);
+
+    // Same steps in the same order as the main loop, each timed on its own
+    InputFrame frame = {.screenWidth = header.screenWidth, .screenHeight = header.screenHeight};
+    double start = GetMonotonicTime();
+    while (ReadInputFrame(log, &frame)) {
+        SetInputFrame(&frame);
+
+        double stepStart = GetMonotonicTime();
+        bool wasOpen = colorPicker.isOpen;
+        UpdateColorPickerShortcuts(&colorPicker, toolState);
+        Color color = GetForegroundColor(toolState);
+        bool wasDragging = colorPicker.activeSlider != 0;
+        if (UpdateColorPicker(&colorPicker, &color)) {
+            SetForegroundColor(toolState, color);
+        }
+        bool pickerChanged = colorPicker.isOpen != wasOpen || wasDragging || colorPicker.activeSlider != 0;
+        double stepEnd = GetMonotonicTime();
+        AddReplayStep(stats, pickerChanged ? REPLAY_COLOR_PICKER : REPLAY_IDLE, stepEnd - stepStart);
+
+        stepStart = stepEnd;
+        bool undone = UpdateHistoryShortcuts(history, toolState);
+        stepEnd = GetMonotonicTime();
+        AddReplayStep(stats, undone ? REPLAY_UNDO_REDO : REPLAY_IDLE, stepEnd - stepStart);
+
+        bool isOverPicker = IsMouseOverColorPicker(&colorPicker);
+        if (!isOverPicker) {
+            stepStart = stepEnd;
+            Vector2 position = camera->position;
+            float zoom = camera->zoom;
+            bool wasPanning = camera->isPanning;
+            UpdateCanvasCamera(camera);
+            bool moved = camera->position.x != position.x || camera->position.y != position.y ||
+                         camera->zoom != zoom || camera->isPanning || wasPanning;
+            stepEnd = GetMonotonicTime();
+            AddReplayStep(stats, moved ? REPLAY_CAMERA : REPLAY_IDLE, stepEnd - stepStart);
+
+            stepStart = stepEnd;
+            bool wasDrawing = toolState->isDrawing;
+            UpdateToolState(toolState, GetActiveLayerCanvas(layers), camera, pixelSize);
+            stepEnd = GetMonotonicTime();
+            AddReplayStep(stats, GetToolStepOp(toolState, wasDrawing, IsInputMouseButtonPressed(MOUSE_BUTTON_LEFT)),
+                          stepEnd - stepStart);
+        }
+
+        stepStart = stepEnd;
+        bool layersChanged = UpdateLayerShortcuts(layers, history, toolState);
+        stepEnd = GetMonotonicTime();
+        AddReplayStep(stats, layersChanged ? REPLAY_LAYER : REPLAY_IDLE, stepEnd - stepStart);
+
+        // No window to upload to: drop the queued texture updates
+        stepStart = stepEnd;
+        int rebuilt = UpdateLayerComposite(layers);
+        ClearCanvasDirtyTiles(GetLayerComposite(layers));
+        stepEnd = GetMonotonicTime();
+        AddReplayStep(stats, (rebuilt > 0) ? REPLAY_COMPOSITE : REPLAY_IDLE, stepEnd - stepStart);
+
+        stats->frames++;
+    }
+    stats->seconds = GetMonotonicTime() - start;
+
+    int recordedFrames = 0;
+    stats->hasExpectedChecksum = GetInputLogEnd(log, &recordedFrames, &stats->expectedChecksum) &&
+                                 recordedFrames == stats->frames;
+    stats->checksum = GetLayerStackChecksum(layers);
+    stats->width = layers->width;
+    stats->height = layers->height;
+    stats->layerCount = layers->count;
+    if (snapshotPath != NULL) {
+        stats->hasSnapshot = WriteReplaySnapshot(snapshotPath, layers, camera, frame.screenWidth,
+                                                 frame.screenHeight, pool);
+    }
+
+    UnloadColorPicker(&colorPicker);
+    DestroyToolState(toolState);
+    DestroyHistory(history);
+    DestroyCanvasCamera(camera);
+    DestroyLayerStack(layers);
+    CloseProject(projectFile);
+    CloseInputLog(log);
+    return true;
+}
+
+/**
+ * Get the display name of an operation
+ */
+const char* GetReplayOpName(ReplayOp op) {
+    return (op >= 0 && op < REPLAY_OP_COUNT) ? replayOpNames[op] : "unknown";
+}
+
+/**
+ * Print command line help for replay mode
+ */
+static void PrintReplayUsage(void) {
+    printf("Usage: pixel_art_tool --replay [--threads N] [--snapshot <png>] <log>\n");
+    printf("Record a log with: pixel_art_tool --record <log> [image or project]\n");
+}
+
+/**
+ * Command line entry point of replay mode: parse arguments, run and report
+ */
+int RunReplayCommand(int argc, char** argv) {
+    int threadCount = 0;
+    const char* snapshotPath = NULL;
+    int first = 0;
+    while (argc - first >= 3) {
+        if (strcmp(argv[first], "--threads") == 0) {
+            threadCount = atoi(argv[first + 1]);
+        } else if (strcmp(argv[first], "--snapshot") == 0) {
+            snapshotPath = argv[first + 1];
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (argc - first != 1 || threadCount < 0) {
+        PrintReplayUsage();
+        return 2;
+    }
+
+    ThreadPool* pool = CreateThreadPool(threadCount);
+    ReplayStats stats;
+    bool ok = ReplayInputLog(argv[first], pool, snapshotPath, &stats);
+    int threads = GetThreadPoolSize(pool);
+    DestroyThreadPool(pool);
+    if (!ok) {
+        fprintf(stderr, "%s: not an input log, or its starting document could not be opened\n", argv[first]);
+        return 2;
+    }
+
+    printf("Replay: %s, %dx%d, %d layers, %d threads\n", argv[first], stats.width, stats.height, stats.layerCount,
+           threads);
+    printf("  %-14s %9s %11s %10s %10s %7s\n", "operation", "count", "total ms", "avg us", "max ms", "share");
+    for (int i = 0; i < REPLAY_OP_COUNT; i++) {
+        const ReplayOpStats* op = &stats.ops[i];
+        if (op->count == 0) continue;
+        printf("  %-14s %9d %11.3f %10.2f %10.3f %6.1f%%\n", GetReplayOpName((ReplayOp)i), op->count,
+               op->seconds * 1000.0, op->seconds * 1e6 / op->count, op->maxSeconds * 1000.0,
+               (stats.seconds > 0.0) ? op->seconds / stats.seconds * 100.0 : 0.0);
+    }
+    printf("Done: %d frames in %.3f s (%.0f frames/s), document load %.3f s\n", stats.frames, stats.seconds,
+           (stats.seconds > 0.0) ? stats.frames / stats.seconds : 0.0, stats.loadSeconds);
+    if (snapshotPath != NULL) {
+        printf(stats.hasSnapshot ? "Snapshot %s\n" : "Failed to write snapshot %s\n", snapshotPath);
+    }
+
+    bool snapshotFailed = snapshotPath != NULL && !stats.hasSnapshot;
+    if (!stats.hasExpectedChecksum) {
+        printf("Checksum %08x (log has no end record, nothing to compare)\n", stats.checksum);
+        return snapshotFailed ? 1 : 0;
+    }
+    bool matches = stats.checksum == stats.expectedChecksum;
+    printf("Checksum %08x, recorded %08x: %s\n", stats.checksum, stats.expectedChecksum,
+           matches ? "match" : "MISMATCH");
+    return (matches && !snapshotFailed) ? 0 : 1;
+}
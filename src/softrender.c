@@ -0,0 +1,302 @@
+/**
+ * softrender.c
+ *
+ * Implementation of Software Renderer
+ */
+
+#include "softrender.h"
+#include "blend.h"
+#include "mipmap.h"
+#include "pixelops.h"
+#include "pngio.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECKER_SHIFT 3     // Checker squares of 8 canvas pixels, as DrawCheckerboardBackground
+
+static const Color checkerLight = {200, 200, 200, 255};
+static const Color checkerDark = {170, 170, 170, 255};
+
+/**
+ * Screen columns that show the same canvas pixel
+ */
+typedef struct {
+    int start;              // First framebuffer column
+    int length;
+    int pixelX;             // Canvas column
+} SoftwareColumnRun;
+
+/**
+ * Everything the row band workers share for one RenderSoftwareCanvas call
+ */
+typedef struct {
+    SoftwareFramebuffer* framebuffer;
+    const Color** tiles;            // Visible tile rectangle, NULL for empty tiles
+    int tileColumns;
+    int firstTileX;
+    int firstTileY;
+    Color emptyColor;
+
+    int left;                       // Framebuffer columns [left, right) show the canvas
+    int right;
+    int top;                        // Framebuffer rows [top, bottom) show the canvas
+    int bottom;
+    const int* rowMap;              // Canvas row of each visible framebuffer row
+    const int* columnMap;           // Canvas column of each visible framebuffer column
+    const SoftwareColumnRun* runs;  // columnMap merged into runs
+    int runCount;
+    bool useRuns;                   // Zoomed in: blend once per canvas pixel and fill its run
+    Color* scratch;                 // One row of source pixels per worker
+} SoftwareRenderJob;
+
+/**
+ * Create a framebuffer
+ */
+SoftwareFramebuffer* CreateSoftwareFramebuffer(int width, int height) {
+    if (width <= 0 || height <= 0) return NULL;
+
+    SoftwareFramebuffer* framebuffer = (SoftwareFramebuffer*)malloc(sizeof(SoftwareFramebuffer));
+    if (framebuffer == NULL) return NULL;
+
+    framebuffer->width = width;
+    framebuffer->height = height;
+    framebuffer->pixels = (Color*)malloc((size_t)width * height * sizeof(Color));
+    if (framebuffer->pixels == NULL) {
+        free(framebuffer);
+        return NULL;
+    }
+    return framebuffer;
+}
+
+/**
+ * Destroy a framebuffer
+ */
+void DestroySoftwareFramebuffer(SoftwareFramebuffer* framebuffer) {
+    if (framebuffer == NULL) return;
+
+    free(framebuffer->pixels);
+    free(framebuffer);
+}
+
+/**
+ * Fill the whole framebuffer with one color
+ */
+void ClearSoftwareFramebuffer(SoftwareFramebuffer* framebuffer, Color color) {
+    if (framebuffer == NULL) return;
+    FillPixels(framebuffer->pixels, (size_t)framebuffer->width * framebuffer->height, color);
+}
+
+/**
+ * Canvas pixel over its checker square
+ */
+static inline Color ShadeCanvasPixel(Color src, int pixelX, int checkerRow) {
+    if (src.a == 255) return src;
+
+    Color checker = (((pixelX >> CHECKER_SHIFT) & 1) ^ checkerRow) ? checkerDark : checkerLight;
+    return (src.a == 0) ? checker : BlendColors(checker, src, PIXEL_BLEND_NORMAL);
+}
+
+/**
+ * ParallelFor task: each index is one band of SOFTWARE_RENDER_BAND_ROWS framebuffer rows
+ */
+static void RenderSoftwareBands(void* userData, int begin, int end, int workerIndex) {
+    const SoftwareRenderJob* job = (const SoftwareRenderJob*)userData;
+    SoftwareFramebuffer* framebuffer = job->framebuffer;
+    int width = job->right - job->left;
+    Color* scratch = job->scratch + (size_t)workerIndex * width;
+
+    for (int band = begin; band < end; band++) {
+        int firstRow = job->top + band * SOFTWARE_RENDER_BAND_ROWS;
+        int lastRow = firstRow + SOFTWARE_RENDER_BAND_ROWS;
+        if (lastRow > job->bottom) lastRow = job->bottom;
+
+        for (int y = firstRow; y < lastRow; y++) {
+            Color* dst = framebuffer->pixels + (size_t)y * framebuffer->width + job->left;
+            int pixelY = job->rowMap[y - job->top];
+
+            // Zoomed in, neighbouring rows show the same canvas row
+            if (y > firstRow && pixelY == job->rowMap[y - job->top - 1]) {
+                memcpy(dst, dst - framebuffer->width, (size_t)width * sizeof(Color));
+                continue;
+            }
+
+            const Color** tileRow = job->tiles + (size_t)((pixelY >> CANVAS_TILE_SHIFT) - job->firstTileY) *
+                                    job->tileColumns;
+            int rowOffset = (pixelY & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT;
+            int checkerRow = (pixelY >> CHECKER_SHIFT) & 1;
+
+            if (job->useRuns) {
+                for (int i = 0; i < job->runCount; i++) {
+                    const SoftwareColumnRun* run = &job->runs[i];
+                    const Color* tile = tileRow[(run->pixelX >> CANVAS_TILE_SHIFT) - job->firstTileX];
+                    Color src = tile ? tile[rowOffset + (run->pixelX & CANVAS_TILE_MASK)] : job->emptyColor;
+                    FillPixels(dst + run->start - job->left, (size_t)run->length,
+                               ShadeCanvasPixel(src, run->pixelX, checkerRow));
+                }
+                continue;
+            }
+
+            // One canvas pixel per screen pixel or fewer: gather the sampled
+            // pixels and blend the whole row over its checkerboard at once
+            bool isOpaque = true;
+            for (int x = 0; x < width; x++) {
+                int pixelX = job->columnMap[x];
+                const Color* tile = tileRow[(pixelX >> CANVAS_TILE_SHIFT) - job->firstTileX];
+                scratch[x] = tile ? tile[rowOffset + (pixelX & CANVAS_TILE_MASK)] : job->emptyColor;
+                isOpaque &= scratch[x].a == 255;
+            }
+            if (isOpaque) {
+                memcpy(dst, scratch, (size_t)width * sizeof(Color));
+                continue;
+            }
+            for (int x = 0; x < width; x++) {
+                dst[x] = (((job->columnMap[x] >> CHECKER_SHIFT) & 1) ^ checkerRow) ? checkerDark : checkerLight;
+            }
+            BlendPixelSpan(dst, scratch, (size_t)width, 255, PIXEL_BLEND_NORMAL);
+        }
+    }
+}
+
+/**
+ * Framebuffer range whose pixel centers fall inside [start, start + length)
+ * and the canvas coordinate each of them samples
+ */
+static int MapSoftwareAxis(float start, float scale, int canvasLength, int screenLength, int* first, int** map) {
+    float end = start + canvasLength * scale;
+    int from = (int)ceilf(start - 0.5f);
+    int to = (int)ceilf(end - 0.5f);
+    if (from < 0) from = 0;
+    if (to > screenLength) to = screenLength;
+    *first = from;
+    *map = NULL;
+    if (from >= to) return 0;
+
+    int* values = (int*)malloc((size_t)(to - from) * sizeof(int));
+    if (values == NULL) return 0;
+    for (int i = from; i < to; i++) {
+        int pixel = (int)floorf(((float)i + 0.5f - start) / scale);
+        values[i - from] = (pixel < 0) ? 0 : (pixel >= canvasLength) ? canvasLength - 1 : pixel;
+    }
+    *map = values;
+    return to - from;
+}
+
+/**
+ * Render a canvas over its checkerboard
+ */
+void RenderSoftwareCanvas(SoftwareFramebuffer* framebuffer, Canvas* canvas, Vector2 offset, float zoom,
+                          int pixelSize, ThreadPool* pool) {
+    if (framebuffer == NULL || canvas == NULL || !canvas->tiles) return;
+
+    float scale = pixelSize * zoom;
+    if (scale <= 0.0f) return;
+
+    // Zoomed out, sample the mip level whose pixels are about one screen pixel
+    int level = 0;
+    canvas = GetCanvasDrawLevel(canvas, scale, &level);
+    scale *= (float)(1 << level);
+
+    SoftwareRenderJob job = {0};
+    int* columnMap = NULL;
+    int* rowMap = NULL;
+    int width = MapSoftwareAxis(offset.x, scale, canvas->width, framebuffer->width, &job.left, &columnMap);
+    int height = MapSoftwareAxis(offset.y, scale, canvas->height, framebuffer->height, &job.top, &rowMap);
+    if (width <= 0 || height <= 0) {
+        free(columnMap);
+        free(rowMap);
+        return;
+    }
+    job.framebuffer = framebuffer;
+    job.right = job.left + width;
+    job.bottom = job.top + height;
+    job.columnMap = columnMap;
+    job.rowMap = rowMap;
+    job.emptyColor = canvas->emptyColor;
+
+    // Resolve the visible tiles up front: loading pending tiles is not thread-safe
+    job.firstTileX = columnMap[0] >> CANVAS_TILE_SHIFT;
+    job.firstTileY = rowMap[0] >> CANVAS_TILE_SHIFT;
+    job.tileColumns = (columnMap[width - 1] >> CANVAS_TILE_SHIFT) - job.firstTileX + 1;
+    int tileRows = (rowMap[height - 1] >> CANVAS_TILE_SHIFT) - job.firstTileY + 1;
+
+    int workers = GetThreadPoolSize(pool);
+    const Color** tiles = (const Color**)malloc((size_t)job.tileColumns * tileRows * sizeof(Color*));
+    SoftwareColumnRun* runs = (SoftwareColumnRun*)malloc((size_t)width * sizeof(SoftwareColumnRun));
+    Color* scratch = (Color*)malloc((size_t)workers * width * sizeof(Color));
+    if (tiles != NULL && runs != NULL && scratch != NULL) {
+        for (int ty = 0; ty < tileRows; ty++) {
+            for (int tx = 0; tx < job.tileColumns; tx++) {
+                int tileIndex = (job.firstTileY + ty) * canvas->tilesX + job.firstTileX + tx;
+                tiles[ty * job.tileColumns + tx] = GetCanvasTilePixels(canvas, tileIndex);
+            }
+        }
+
+        for (int x = 0; x < width; x++) {
+            if (job.runCount > 0 && runs[job.runCount - 1].pixelX == columnMap[x]) {
+                runs[job.runCount - 1].length++;
+            } else {
+                runs[job.runCount++] = (SoftwareColumnRun){job.left + x, 1, columnMap[x]};
+            }
+        }
+        job.tiles = tiles;
+        job.runs = runs;
+        job.useRuns = job.runCount * 2 <= width;
+        job.scratch = scratch;
+
+        int bands = (height + SOFTWARE_RENDER_BAND_ROWS - 1) / SOFTWARE_RENDER_BAND_ROWS;
+        ParallelFor(pool, bands, 1, RenderSoftwareBands, &job);
+    }
+
+    free(scratch);
+    free(runs);
+    free(tiles);
+    free(columnMap);
+    free(rowMap);
+}
+
+/**
+ * Draw a one pixel rectangle outline
+ */
+void DrawSoftwareRectangleLines(SoftwareFramebuffer* framebuffer, int x, int y, int width, int height, Color color) {
+    if (framebuffer == NULL || width <= 0 || height <= 0) return;
+
+    int left = (x > 0) ? x : 0;
+    int right = (x + width < framebuffer->width) ? x + width : framebuffer->width;
+    int top = (y > 0) ? y : 0;
+    int bottom = (y + height < framebuffer->height) ? y + height : framebuffer->height;
+    if (left >= right || top >= bottom) return;
+
+    int edgeRows[2] = {y, y + height - 1};
+    for (int i = 0; i < 2; i++) {
+        if (edgeRows[i] >= top && edgeRows[i] < bottom) {
+            FillPixels(framebuffer->pixels + (size_t)edgeRows[i] * framebuffer->width + left, (size_t)(right - left),
+                       color);
+        }
+    }
+    int edgeColumns[2] = {x, x + width - 1};
+    for (int i = 0; i < 2; i++) {
+        if (edgeColumns[i] < left || edgeColumns[i] >= right) continue;
+        for (int row = top; row < bottom; row++) {
+            framebuffer->pixels[(size_t)row * framebuffer->width + edgeColumns[i]] = color;
+        }
+    }
+}
+
+/**
+ * Save a framebuffer as a PNG file
+ */
+bool WriteSoftwareFramebufferPng(const SoftwareFramebuffer* framebuffer, const char* path) {
+    if (framebuffer == NULL || path == NULL) return false;
+
+    PngWriter* writer = CreatePngWriter(path, framebuffer->width, framebuffer->height);
+    if (writer == NULL) return false;
+
+    for (int y = 0; y < framebuffer->height; y++) {
+        if (!WritePngRow(writer, framebuffer->pixels + (size_t)y * framebuffer->width)) {
+            DestroyPngWriter(writer);
+            return false;
+        }
+    }
+    return FinishPngWriter(writer);
+}
@@ -0,0 +1,451 @@
+/**
+ * stress.c
+ *
+ * Implementation of Canvas Size Stress Runs
+ */
+
+#include "stress.h"
+#include "input.h"
+#include "layer.h"
+#include "camera.h"
+#include "tool.h"
+#include "history.h"
+#include "memstats.h"
+#include "softrender.h"
+#include "timing.h"
+#include "raylib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRESS_QUEUE_CAPACITY 80    // Frames of the longest action
+#define STRESS_SEED 13579u
+
+static const int pixelSize = 1; // Base pixel size before zoom, as in the main loop
+static const int defaultSizes[] = {64, 256, 1024, 4096, 16384};
+
+/**
+ * Synthetic input generator: queues the frames of one action at a time
+ */
+typedef struct {
+    unsigned int seed;
+    InputFrame queue[STRESS_QUEUE_CAPACITY];
+    int queued;
+    int next;
+    Vector2 mouse;                  // Position carried over between frames
+    int strokes;
+    int fills;
+    int sweeps;
+} StressWorkload;
+
+/**
+ * Deterministic pseudo-random numbers so every size sees the same session
+ */
+static int StressRandom(StressWorkload* workload, int range) {
+    workload->seed = workload->seed * 1103515245u + 12345u;
+    return (range > 0) ? (int)((workload->seed >> 8) % (unsigned int)range) : 0;
+}
+
+/**
+ * Append a frame with the mouse at a position
+ */
+static InputFrame* QueueStressFrame(StressWorkload* workload, Vector2 mouse, unsigned char buttonsDown) {
+    if (workload->queued >= STRESS_QUEUE_CAPACITY) return NULL;
+
+    InputFrame* frame = &workload->queue[workload->queued++];
+    *frame = (InputFrame){0};
+    frame->mousePosition = mouse;
+    frame->buttonsDown = buttonsDown;
+    frame->screenWidth = STRESS_SCREEN_WIDTH;
+    frame->screenHeight = STRESS_SCREEN_HEIGHT;
+    workload->mouse = mouse;
+    return frame;
+}
+
+/**
+ * Append a frame that presses a key and nothing else
+ */
+static void QueueStressKey(StressWorkload* workload, int key) {
+    InputFrame* frame = QueueStressFrame(workload, workload->mouse, 0);
+    if (frame != NULL) SetInputFrameKey(frame, key, true, true);
+}
+
+/**
+ * Append a left button drag through some points (one point: a click)
+ */
+static void QueueStressDrag(StressWorkload* workload, const Vector2* points, int count) {
+    for (int i = 0; i < count; i++) {
+        InputFrame* frame = QueueStressFrame(workload, points[i], 1);
+        if (frame != NULL && i == 0) frame->buttonsPressed = 1;
+    }
+    InputFrame* frame = QueueStressFrame(workload, points[count - 1], 0);
+    if (frame != NULL) frame->buttonsReleased = 1;
+}
+
+/**
+ * Random point inside a screen rectangle
+ */
+static Vector2 GetStressPoint(StressWorkload* workload, Rectangle area) {
+    return (Vector2){area.x + (float)StressRandom(workload, (int)area.width),
+                     area.y + (float)StressRandom(workload, (int)area.height)};
+}
+
+/**
+ * Queue the frames of the next action, chosen from where the canvas is on screen
+ */
+static void QueueStressAction(StressWorkload* workload, const CanvasCamera* camera, int size) {
+    workload->queued = 0;
+    workload->next = 0;
+
+    // Part of the canvas on screen, one screen pixel in from its edges
+    float scale = pixelSize * camera->zoom;
+    float left = (camera->position.x > 0.0f) ? camera->position.x : 0.0f;
+    float top = (camera->position.y > 0.0f) ? camera->position.y : 0.0f;
+    float right = camera->position.x + size * scale;
+    float bottom = camera->position.y + size * scale;
+    if (right > STRESS_SCREEN_WIDTH) right = STRESS_SCREEN_WIDTH;
+    if (bottom > STRESS_SCREEN_HEIGHT) bottom = STRESS_SCREEN_HEIGHT;
+    Rectangle visible = {left + 1.0f, top + 1.0f, right - left - 2.0f, bottom - top - 2.0f};
+
+    // An outline needs room for at least two pixels inside it
+    float minOutline = (4.0f * scale > 8.0f) ? 4.0f * scale : 8.0f;
+    if (visible.width < minOutline || visible.height < minOutline) {
+        QueueStressKey(workload, KEY_R);    // Canvas panned or zoomed out of view
+        return;
+    }
+
+    int kind = StressRandom(workload, 8);
+    if (kind >= 4 && kind <= 5) {
+        // Outline a rectangle with the pencil and fill it in the other color
+        float width = minOutline + (float)StressRandom(workload, (int)(visible.width - minOutline) + 1);
+        float height = minOutline + (float)StressRandom(workload, (int)(visible.height - minOutline) + 1);
+        float x = visible.x + (float)StressRandom(workload, (int)(visible.width - width) + 1);
+        float y = visible.y + (float)StressRandom(workload, (int)(visible.height - height) + 1);
+        Vector2 corners[5] = {{x, y}, {x + width, y}, {x + width, y + height}, {x, y + height}, {x, y}};
+        Vector2 center = {x + width / 2.0f, y + height / 2.0f};
+
+        QueueStressKey(workload, KEY_B);
+        QueueStressDrag(workload, corners, 5);
+        QueueStressKey(workload, KEY_X);
+        QueueStressKey(workload, KEY_G);
+        QueueStressDrag(workload, &center, 1);
+        QueueStressKey(workload, KEY_X);
+        workload->fills++;
+    } else if (kind == 6) {
+        // Zoom in and back out (or the reverse) around one point
+        Vector2 point = GetStressPoint(workload, visible);
+        int steps = 4 + StressRandom(workload, 9);
+        float direction = StressRandom(workload, 2) ? 1.0f : -1.0f;
+        for (int i = 0; i < steps * 2; i++) {
+            InputFrame* frame = QueueStressFrame(workload, point, 0);
+            if (frame != NULL) frame->wheelMove = (i < steps) ? direction : -direction;
+        }
+        workload->sweeps++;
+    } else if (kind == 7) {
+        // Pan away with the middle button and back to the start
+        Vector2 start = GetStressPoint(workload, visible);
+        Vector2 delta = {(float)(StressRandom(workload, 401) - 200), (float)(StressRandom(workload, 301) - 150)};
+        int steps = 8 + StressRandom(workload, 17);
+        for (int i = 0; i <= steps * 2; i++) {
+            float t = (float)((i <= steps) ? i : steps * 2 - i) / steps;
+            InputFrame* frame = QueueStressFrame(workload, (Vector2){start.x + delta.x * t, start.y + delta.y * t}, 4);
+            if (frame != NULL && i == 0) frame->buttonsPressed = 4;
+        }
+        InputFrame* frame = QueueStressFrame(workload, start, 0);
+        if (frame != NULL) frame->buttonsReleased = 4;
+        workload->sweeps++;
+    } else {
+        // Freehand pencil stroke
+        Vector2 points[STRESS_QUEUE_CAPACITY / 2];
+        int count = 8 + StressRandom(workload, 17);
+        for (int i = 0; i < count; i++) {
+            points[i] = GetStressPoint(workload, visible);
+        }
+        QueueStressKey(workload, KEY_B);
+        QueueStressDrag(workload, points, count);
+        workload->strokes++;
+    }
+}
+
+/**
+ * Next frame of the session
+ */
+static InputFrame NextStressFrame(StressWorkload* workload, const CanvasCamera* camera, int size) {
+    if (workload->next >= workload->queued) {
+        QueueStressAction(workload, camera, size);
+    }
+    return workload->queue[workload->next++];
+}
+
+/**
+ * Fit the canvas on the stress screen (within the zoom limits) and center it
+ */
+static void CenterStressCamera(CanvasCamera* camera, int size) {
+    float fitX = (float)STRESS_SCREEN_WIDTH / (size * pixelSize);
+    float fitY = (float)STRESS_SCREEN_HEIGHT / (size * pixelSize);
+    float fit = (fitX < fitY) ? fitX : fitY;
+    camera->zoom = (fit < 1.0f) ? fit : 1.0f;
+    ClampCanvasCameraZoom(camera);
+
+    float scale = pixelSize * camera->zoom;
+    camera->position.x = (STRESS_SCREEN_WIDTH - size * scale) / 2.0f;
+    camera->position.y = (STRESS_SCREEN_HEIGHT - size * scale) / 2.0f;
+}
+
+/**
+ * Percentiles of one per-frame value over the recorded frames
+ */
+static ProfilePercentiles GetStressPercentiles(const ProfileFrame* frames, int count, unsigned int phaseMask,
+                                               float* values) {
+    for (int i = 0; i < count; i++) {
+        values[i] = 0.0f;
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            if (phaseMask & (1u << phase)) values[i] += frames[i].phaseMs[phase];
+        }
+    }
+    return GetProfilePercentiles(values, count);
+}
+
+/**
+ * Run the synthetic session on one canvas size
+ */
+bool RunStressSize(int size, int frames, ThreadPool* pool, bool useWindow, StressResult* result) {
+    if (result == NULL || frames <= 0 || size <= 0 || size > CANVAS_MAX_SIZE) return false;
+    *result = (StressResult){0};
+    result->size = size;
+    if (frames > PROFILER_FRAME_CAPACITY - 1) frames = PROFILER_FRAME_CAPACITY - 1;
+
+    result->isPeakSinceStart = !ResetPeakResidentBytes();
+    size_t allocationsBefore = GetCanvasTileAllocationCount();
+
+    double createStart = GetMonotonicTime();
+    LayerStack* layers = CreateLayerStack(size, size);
+    CanvasCamera* camera = CreateCanvasCamera();
+    ToolState* toolState = CreateToolState();
+    History* history = CreateHistory(DEFAULT_HISTORY_BUDGET);
+    Profiler* profiler = CreateProfiler();
+    ProfileFrame* recorded = (ProfileFrame*)malloc(sizeof(ProfileFrame) * PROFILER_FRAME_CAPACITY);
+    float* values = (float*)malloc(sizeof(float) * PROFILER_FRAME_CAPACITY);
+    SoftwareFramebuffer* framebuffer = useWindow ? NULL :
+        CreateSoftwareFramebuffer(STRESS_SCREEN_WIDTH, STRESS_SCREEN_HEIGHT);
+    bool ok = layers != NULL && camera != NULL && toolState != NULL && profiler != NULL &&
+              recorded != NULL && values != NULL && (useWindow || framebuffer != NULL);
+    if (ok) {
+        SetLayerStackThreadPool(layers, pool);
+        SetToolHistory(toolState, history);
+        UpdateLayerComposite(layers);
+        CenterStressCamera(camera, size);
+    }
+    result->createSeconds = GetMonotonicTime() - createStart;
+
+    StressWorkload workload = {.seed = STRESS_SEED};
+    for (int i = 0; ok && i < frames; i++) {
+        BeginProfileFrame(profiler);
+
+        BeginProfilePhase(profiler, PROFILE_INPUT);
+        InputFrame input = NextStressFrame(&workload, camera, size);
+        SetInputFrame(&input);
+        EndProfilePhase(profiler, PROFILE_INPUT);
+
+        BeginProfilePhase(profiler, PROFILE_CAMERA);
+        UpdateCanvasCamera(camera);
+        EndProfilePhase(profiler, PROFILE_CAMERA);
+
+        BeginProfilePhase(profiler, PROFILE_TOOLS);
+        UpdateToolState(toolState, GetActiveLayerCanvas(layers), camera, pixelSize);
+        EndProfilePhase(profiler, PROFILE_TOOLS);
+
+        BeginProfilePhase(profiler, PROFILE_COMPOSITE);
+        UpdateLayerComposite(layers);
+        EndProfilePhase(profiler, PROFILE_COMPOSITE);
+
+        // Texture uploads included, as in the main loop; the software
+        // renderer reads the tiles directly and drops the queued uploads
+        BeginProfilePhase(profiler, PROFILE_DRAW_CANVAS);
+        Canvas* composite = GetLayerComposite(layers);
+        if (useWindow) {
+            BeginDrawing();
+            ClearBackground(DARKGRAY);
+            DrawCanvas(composite, camera->position, camera->zoom, pixelSize);
+            EndProfilePhase(profiler, PROFILE_DRAW_CANVAS);
+            SetProfileDrawCounts(profiler, composite->drawCalls, 0, composite->textureUploads);
+            EndDrawing();
+        } else {
+            ClearSoftwareFramebuffer(framebuffer, DARKGRAY);
+            RenderSoftwareCanvas(framebuffer, composite, camera->position, camera->zoom, pixelSize, pool);
+            ClearCanvasDirtyTiles(composite);
+            EndProfilePhase(profiler, PROFILE_DRAW_CANVAS);
+        }
+        EndProfileFrame(profiler, true);
+        result->frames++;
+    }
+
+    if (ok) {
+        int count = ReadProfileFrames(profiler, recorded, PROFILER_FRAME_CAPACITY);
+        unsigned int updateMask = (1u << PROFILE_INPUT) | (1u << PROFILE_CAMERA) | (1u << PROFILE_TOOLS) |
+                                  (1u << PROFILE_COMPOSITE);
+        result->update = GetStressPercentiles(recorded, count, updateMask, values);
+        result->tools = GetStressPercentiles(recorded, count, 1u << PROFILE_TOOLS, values);
+        result->composite = GetStressPercentiles(recorded, count, 1u << PROFILE_COMPOSITE, values);
+        result->draw = GetStressPercentiles(recorded, count, 1u << PROFILE_DRAW_CANVAS, values);
+        result->drewInWindow = useWindow;
+
+        result->canvasBytes = GetCanvasMemoryUsage(layers->composite);
+        for (int i = 0; i < layers->count; i++) {
+            result->canvasBytes += GetCanvasMemoryUsage(layers->layers[i].canvas);
+        }
+        result->historyBytes = (history != NULL) ? history->bytesUsed : 0;
+        result->strokes = workload.strokes;
+        result->fills = workload.fills;
+        result->sweeps = workload.sweeps;
+    }
+    result->peakResidentBytes = GetPeakResidentBytes();
+    result->tileAllocations = GetCanvasTileAllocationCount() - allocationsBefore;
+
+    DestroySoftwareFramebuffer(framebuffer);
+    free(values);
+    free(recorded);
+    DestroyProfiler(profiler);
+    DestroyToolState(toolState);
+    DestroyHistory(history);
+    DestroyCanvasCamera(camera);
+    DestroyLayerStack(layers);
+    return ok;
+}
+
+/**
+ * Write results as CSV, one row per canvas size
+ */
+bool WriteStressCsv(const char* path, const StressResult* results, int count) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "size,frames,create_ms,update_p50_ms,update_p99_ms,draw_p50_ms,draw_p99_ms,renderer,tools_p99_ms,"
+                  "composite_p99_ms,peak_rss_bytes,canvas_bytes,history_bytes,tile_allocations,"
+                  "strokes,fills,sweeps\n");
+    for (int i = 0; i < count; i++) {
+        const StressResult* r = &results[i];
+        fprintf(file, "%d,%d,%.3f,%.4f,%.4f,%.4f,%.4f,%s,", r->size, r->frames, r->createSeconds * 1000.0,
+                r->update.p50, r->update.p99, r->draw.p50, r->draw.p99, r->drewInWindow ? "gpu" : "software");
+        fprintf(file, "%.4f,%.4f,%zu,%zu,%zu,%zu,%d,%d,%d\n", r->tools.p99, r->composite.p99,
+                r->peakResidentBytes, r->canvasBytes, r->historyBytes, r->tileAllocations,
+                r->strokes, r->fills, r->sweeps);
+    }
+    return fclose(file) == 0;
+}
+
+/**
+ * Parse a comma-separated list of canvas sizes
+ */
+static int ParseStressSizes(const char* text, int* sizes) {
+    int count = 0;
+    while (*text != '\0' && count < STRESS_MAX_SIZES) {
+        char* end;
+        long size = strtol(text, &end, 10);
+        if (end == text || size <= 0 || size > CANVAS_MAX_SIZE || (*end != ',' && *end != '\0')) return 0;
+        sizes[count++] = (int)size;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return (*text == '\0') ? count : 0;
+}
+
+/**
+ * Print command line help for stress mode
+ */
+static void PrintStressUsage(void) {
+    printf("Usage: pixel_art_tool --stress [--sizes 64,256,...] [--frames N] [--threads N] [--window] [--csv <path>]\n");
+    printf("  --sizes    Canvas sizes to run (default 64,256,1024,4096,16384)\n");
+    printf("  --frames   Frames per size, at most %d (default %d)\n", PROFILER_FRAME_CAPACITY - 1,
+           STRESS_DEFAULT_FRAMES);
+    printf("  --window   Draw with DrawCanvas in a hidden window instead of the software renderer\n");
+    printf("  --csv      Also write the results as CSV\n");
+}
+
+/**
+ * Command line entry point of stress mode: parse arguments, run and report
+ */
+int RunStressCommand(int argc, char** argv) {
+    int sizes[STRESS_MAX_SIZES];
+    int sizeCount = (int)(sizeof(defaultSizes) / sizeof(defaultSizes[0]));
+    memcpy(sizes, defaultSizes, sizeof(defaultSizes));
+    int frames = STRESS_DEFAULT_FRAMES;
+    int threadCount = 0;
+    bool useWindow = false;
+    const char* csvPath = NULL;
+
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--sizes") == 0 && hasValue) {
+            sizeCount = ParseStressSizes(argv[++i], sizes);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--window") == 0) {
+            useWindow = true;
+        } else {
+            sizeCount = 0;
+            break;
+        }
+    }
+    if (sizeCount <= 0 || frames <= 0 || frames > PROFILER_FRAME_CAPACITY - 1 || threadCount < 0) {
+        PrintStressUsage();
+        return 2;
+    }
+
+    if (useWindow) {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(STRESS_SCREEN_WIDTH, STRESS_SCREEN_HEIGHT, "Pixel Art Tool - stress");
+        if (!IsWindowReady()) {
+            fprintf(stderr, "No window available, drawing with the software renderer\n");
+            useWindow = false;
+        }
+    }
+
+    ThreadPool* pool = CreateThreadPool(threadCount);
+    StressResult results[STRESS_MAX_SIZES];
+    int failed = 0;
+    printf("Stress: %d frames per size on a %dx%d screen, %d threads%s\n", frames, STRESS_SCREEN_WIDTH,
+           STRESS_SCREEN_HEIGHT, GetThreadPoolSize(pool), useWindow ? ", GPU drawing" : ", software drawing");
+    printf("  %-11s %9s %21s %21s %9s %9s %9s %9s %9s %8s\n", "canvas", "create ms", "update p50/p99 ms",
+           "draw p50/p99 ms", "tools p99", "comp p99", "peak MB", "canvas MB", "undo MB", "tiles");
+    for (int i = 0; i < sizeCount; i++) {
+        StressResult* r = &results[i];
+        bool ok = RunStressSize(sizes[i], frames, pool, useWindow, r);
+
+        char canvas[24];
+        char update[32];
+        char draw[32];
+        snprintf(canvas, sizeof(canvas), "%dx%d", sizes[i], sizes[i]);
+        snprintf(update, sizeof(update), "%.3f / %.3f", r->update.p50, r->update.p99);
+        snprintf(draw, sizeof(draw), "%.3f / %.3f", r->draw.p50, r->draw.p99);
+        if (!ok) {
+            printf("  %-11s FAILED after %d frames (out of memory?)\n", canvas, r->frames);
+            failed++;
+            continue;
+        }
+        printf("  %-11s %9.2f %21s %21s %9.3f %9.3f %8.1f%s %9.1f %9.1f %8zu\n", canvas, r->createSeconds * 1000.0,
+               update, draw, r->tools.p99, r->composite.p99, r->peakResidentBytes / (1024.0 * 1024.0),
+               r->isPeakSinceStart ? "*" : " ", r->canvasBytes / (1024.0 * 1024.0),
+               r->historyBytes / (1024.0 * 1024.0), r->tileAllocations);
+    }
+    if (sizeCount > 0 && results[0].isPeakSinceStart) {
+        printf("  * peak resident memory since the process started (cannot be reset on this system)\n");
+    }
+    printf("Session per size: %d strokes, %d outlined fills, %d zoom/pan sweeps\n", results[0].strokes,
+           results[0].fills, results[0].sweeps);
+
+    if (csvPath != NULL && !WriteStressCsv(csvPath, results, sizeCount)) {
+        fprintf(stderr, "Failed to write %s\n", csvPath);
+        failed++;
+    }
+
+    DestroyThreadPool(pool);
+    if (useWindow) {
+        UnloadCheckerboardTexture();
+        CloseWindow();
+    }
+    return (failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * stroke.c
+ *
+ * Implementation of Stroke Coverage Mask
+ */
+
+#include "stroke.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STROKE_TILE_BYTES (CANVAS_TILE_PIXELS / 8)
+
+/**
+ * Create an empty stroke mask
+ */
+StrokeMask* CreateStrokeMask(void) {
+    return (StrokeMask*)calloc(1, sizeof(StrokeMask));
+}
+
+/**
+ * Free the tile grid
+ */
+static void ReleaseStrokeTiles(StrokeMask* mask) {
+    if (mask->tiles != NULL) {
+        for (int i = 0; i < mask->tilesX * mask->tilesY; i++) {
+            free(mask->tiles[i]);
+        }
+        free(mask->tiles);
+    }
+    mask->tiles = NULL;
+    mask->tilesX = 0;
+    mask->tilesY = 0;
+    mask->touchedCount = 0;
+}
+
+/**
+ * Destroy a stroke mask and free memory
+ */
+void DestroyStrokeMask(StrokeMask* mask) {
+    if (mask == NULL) return;
+    ReleaseStrokeTiles(mask);
+    free(mask->touched);
+    free(mask);
+}
+
+/**
+ * Clear the mask for a new stroke on a canvas
+ */
+bool ResetStrokeMask(StrokeMask* mask, const Canvas* canvas) {
+    if (mask == NULL || canvas == NULL) return false;
+
+    if (mask->tiles != NULL && mask->tilesX == canvas->tilesX && mask->tilesY == canvas->tilesY) {
+        for (int i = 0; i < mask->touchedCount; i++) {
+            memset(mask->tiles[mask->touched[i]], 0, STROKE_TILE_BYTES);
+        }
+        mask->touchedCount = 0;
+        return true;
+    }
+
+    // Different canvas size: rebuild the grid
+    ReleaseStrokeTiles(mask);
+    mask->tiles = (unsigned char**)calloc((size_t)canvas->tilesX * canvas->tilesY, sizeof(unsigned char*));
+    if (mask->tiles == NULL) return false;
+    mask->tilesX = canvas->tilesX;
+    mask->tilesY = canvas->tilesY;
+    return true;
+}
+
+/**
+ * Get the bits of a tile, allocating them on first use
+ */
+static unsigned char* AcquireStrokeTile(StrokeMask* mask, int tileIndex) {
+    if (mask->tiles[tileIndex] != NULL) {
+        return mask->tiles[tileIndex];
+    }
+
+    if (mask->touchedCount == mask->touchedCapacity) {
+        int capacity = mask->touchedCapacity ? mask->touchedCapacity * 2 : 64;
+        int* list = (int*)realloc(mask->touched, sizeof(int) * capacity);
+        if (list == NULL) return NULL;
+        mask->touched = list;
+        mask->touchedCapacity = capacity;
+    }
+
+    unsigned char* bits = (unsigned char*)calloc(STROKE_TILE_BYTES, 1);
+    if (bits == NULL) return NULL;
+
+    mask->tiles[tileIndex] = bits;
+    mask->touched[mask->touchedCount++] = tileIndex;
+    return bits;
+}
+
+/**
+ * Mark the pixels of a span and pass on the newly covered parts
+ */
+int ClaimStrokeSpan(StrokeMask* mask, RasterSpan span, RasterSpanCallback callback, void* userData) {
+    if (mask == NULL || mask->tiles == NULL || callback == NULL) return 0;
+
+    int emitted = 0;
+    int runStart = -1;      // Offset along the span where the current new run began
+
+    for (int i = 0; i <= span.length; i++) {
+        bool isNew = false;
+        if (i < span.length) {
+            int x = span.vertical ? span.x : span.x + i;
+            int y = span.vertical ? span.y + i : span.y;
+            int tileIndex = (y >> CANVAS_TILE_SHIFT) * mask->tilesX + (x >> CANVAS_TILE_SHIFT);
+            int bit = ((y & CANVAS_TILE_MASK) << CANVAS_TILE_SHIFT) + (x & CANVAS_TILE_MASK);
+
+            unsigned char* bits = AcquireStrokeTile(mask, tileIndex);
+            if (bits != NULL && !(bits[bit >> 3] & (1 << (bit & 7)))) {
+                bits[bit >> 3] |= (unsigned char)(1 << (bit & 7));
+                isNew = true;
+            }
+        }
+
+        if (isNew && runStart < 0) {
+            runStart = i;
+        } else if (!isNew && runStart >= 0) {
+            RasterSpan part = span;
+            part.length = i - runStart;
+            if (span.vertical) {
+                part.y = span.y + runStart;
+            } else {
+                part.x = span.x + runStart;
+            }
+            callback(userData, part);
+            emitted++;
+            runStart = -1;
+        }
+    }
+
+    return emitted;
+}
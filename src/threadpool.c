@@ -0,0 +1,333 @@
+/**
+ * threadpool.c
+ *
+ * Implementation of Worker Thread Pool
+ * Kept free of raylib.h so the Windows header can be included safely
+ */
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #define _POSIX_C_SOURCE 200809L
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#include "threadpool.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define THREADPOOL_MAX_THREADS 64
+#define THREADPOOL_CACHE_LINE 64
+
+//------------------------------------------------------------------------------
+// Platform threads
+//------------------------------------------------------------------------------
+
+#if defined(_WIN32)
+typedef HANDLE PoolThread;
+typedef CRITICAL_SECTION PoolMutex;
+typedef CONDITION_VARIABLE PoolCondition;
+
+#define POOL_THREAD_PROC DWORD WINAPI
+#define POOL_THREAD_RETURN 0
+
+static void InitPoolMutex(PoolMutex* mutex) { InitializeCriticalSection(mutex); }
+static void DestroyPoolMutex(PoolMutex* mutex) { DeleteCriticalSection(mutex); }
+static void LockPoolMutex(PoolMutex* mutex) { EnterCriticalSection(mutex); }
+static void UnlockPoolMutex(PoolMutex* mutex) { LeaveCriticalSection(mutex); }
+static void InitPoolCondition(PoolCondition* condition) { InitializeConditionVariable(condition); }
+static void DestroyPoolCondition(PoolCondition* condition) { (void)condition; }
+static void WaitPoolCondition(PoolCondition* condition, PoolMutex* mutex) {
+    SleepConditionVariableCS(condition, mutex, INFINITE);
+}
+static void WakeAllPoolCondition(PoolCondition* condition) { WakeAllConditionVariable(condition); }
+
+static bool StartPoolThread(PoolThread* thread, LPTHREAD_START_ROUTINE proc, void* arg) {
+    *thread = CreateThread(NULL, 0, proc, arg, 0, NULL);
+    return *thread != NULL;
+}
+
+static void JoinPoolThread(PoolThread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+typedef pthread_t PoolThread;
+typedef pthread_mutex_t PoolMutex;
+typedef pthread_cond_t PoolCondition;
+
+#define POOL_THREAD_PROC void*
+#define POOL_THREAD_RETURN NULL
+
+static void InitPoolMutex(PoolMutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static void DestroyPoolMutex(PoolMutex* mutex) { pthread_mutex_destroy(mutex); }
+static void LockPoolMutex(PoolMutex* mutex) { pthread_mutex_lock(mutex); }
+static void UnlockPoolMutex(PoolMutex* mutex) { pthread_mutex_unlock(mutex); }
+static void InitPoolCondition(PoolCondition* condition) { pthread_cond_init(condition, NULL); }
+static void DestroyPoolCondition(PoolCondition* condition) { pthread_cond_destroy(condition); }
+static void WaitPoolCondition(PoolCondition* condition, PoolMutex* mutex) {
+    pthread_cond_wait(condition, mutex);
+}
+static void WakeAllPoolCondition(PoolCondition* condition) { pthread_cond_broadcast(condition); }
+
+static bool StartPoolThread(PoolThread* thread, void* (*proc)(void*), void* arg) {
+    return pthread_create(thread, NULL, proc, arg) == 0;
+}
+
+static void JoinPoolThread(PoolThread thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Pool
+//------------------------------------------------------------------------------
+
+/**
+ * One worker's share of the current loop
+ * The owner and thieves both claim chunks by advancing next atomically;
+ * padded so neighbouring shares do not contend for a cache line
+ */
+typedef struct {
+    int next;
+    int end;
+    char padding[THREADPOOL_CACHE_LINE - 2 * sizeof(int)];
+} ThreadPoolShare;
+
+typedef struct {
+    ThreadPool* pool;
+    int index;
+    unsigned int generation;        // Last loop this worker ran
+} ThreadPoolWorker;
+
+struct ThreadPool {
+    int threadCount;                // Including the thread calling ParallelFor
+    PoolThread* threads;            // threadCount - 1 workers
+    ThreadPoolWorker* workers;
+
+    PoolMutex mutex;
+    PoolCondition wake;             // Signals a new loop or shutdown
+    PoolCondition done;             // Signals the last worker finishing a loop
+    unsigned int generation;        // Incremented for every loop
+    int busyWorkers;
+    bool shutdown;
+
+    // Current loop
+    ThreadPoolTask task;
+    void* userData;
+    int grain;
+    ThreadPoolShare* shares;        // One per thread
+};
+
+/**
+ * Work through the own share, then steal from the others in turn
+ */
+static void RunThreadPoolShares(ThreadPool* pool, int workerIndex) {
+    for (int k = 0; k < pool->threadCount; k++) {
+        ThreadPoolShare* share = &pool->shares[(workerIndex + k) % pool->threadCount];
+
+        while (1) {
+            int begin = __atomic_fetch_add(&share->next, pool->grain, __ATOMIC_RELAXED);
+            if (begin >= share->end) break;
+
+            int end = (share->end - begin > pool->grain) ? begin + pool->grain : share->end;
+            pool->task(pool->userData, begin, end, workerIndex);
+        }
+    }
+}
+
+static POOL_THREAD_PROC ThreadPoolWorkerMain(void* arg) {
+    ThreadPoolWorker* worker = (ThreadPoolWorker*)arg;
+    ThreadPool* pool = worker->pool;
+
+    // The generation was recorded at creation, so a loop started before this
+    // thread got to run is not missed
+    LockPoolMutex(&pool->mutex);
+    while (1) {
+        while (!pool->shutdown && pool->generation == worker->generation) {
+            WaitPoolCondition(&pool->wake, &pool->mutex);
+        }
+        if (pool->shutdown) break;
+        worker->generation = pool->generation;
+        UnlockPoolMutex(&pool->mutex);
+
+        RunThreadPoolShares(pool, worker->index);
+
+        LockPoolMutex(&pool->mutex);
+        if (--pool->busyWorkers == 0) {
+            WakeAllPoolCondition(&pool->done);
+        }
+    }
+    UnlockPoolMutex(&pool->mutex);
+
+    return POOL_THREAD_RETURN;
+}
+
+/**
+ * Get the number of processor cores available to the process
+ */
+int GetCpuCoreCount(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0) ? count : 1;
+}
+
+/**
+ * Create a thread pool
+ */
+ThreadPool* CreateThreadPool(int threadCount) {
+    if (threadCount <= 0) threadCount = GetCpuCoreCount();
+    if (threadCount > THREADPOOL_MAX_THREADS) threadCount = THREADPOOL_MAX_THREADS;
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) return NULL;
+
+    pool->shares = (ThreadPoolShare*)calloc(threadCount, sizeof(ThreadPoolShare));
+    pool->threads = (PoolThread*)calloc(threadCount, sizeof(PoolThread));
+    pool->workers = (ThreadPoolWorker*)calloc(threadCount, sizeof(ThreadPoolWorker));
+    if (pool->shares == NULL || pool->threads == NULL || pool->workers == NULL) {
+        free(pool->shares);
+        free(pool->threads);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    InitPoolMutex(&pool->mutex);
+    InitPoolCondition(&pool->wake);
+    InitPoolCondition(&pool->done);
+
+    // Worker 0 is whoever calls ParallelFor; a pool that cannot start all
+    // its threads simply runs with fewer
+    pool->threadCount = 1;
+    for (int i = 1; i < threadCount; i++) {
+        pool->workers[i] = (ThreadPoolWorker){pool, i, pool->generation};
+        if (!StartPoolThread(&pool->threads[i - 1], ThreadPoolWorkerMain, &pool->workers[i])) {
+            break;
+        }
+        pool->threadCount++;
+    }
+
+    return pool;
+}
+
+/**
+ * Stop the workers and free the pool
+ */
+void DestroyThreadPool(ThreadPool* pool) {
+    if (pool == NULL) return;
+
+    LockPoolMutex(&pool->mutex);
+    pool->shutdown = true;
+    WakeAllPoolCondition(&pool->wake);
+    UnlockPoolMutex(&pool->mutex);
+
+    for (int i = 0; i < pool->threadCount - 1; i++) {
+        JoinPoolThread(pool->threads[i]);
+    }
+
+    DestroyPoolCondition(&pool->done);
+    DestroyPoolCondition(&pool->wake);
+    DestroyPoolMutex(&pool->mutex);
+    free(pool->shares);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
+
+/**
+ * Get the number of threads that run a parallel loop
+ */
+int GetThreadPoolSize(ThreadPool* pool) {
+    return (pool != NULL) ? pool->threadCount : 1;
+}
+
+/**
+ * Run task over [0, count) and wait for all chunks to finish
+ */
+void ParallelFor(ThreadPool* pool, int count, int grain, ThreadPoolTask task, void* userData) {
+    if (count <= 0 || task == NULL) return;
+    if (grain <= 0) grain = 1;
+
+    if (pool == NULL || pool->threadCount == 1 || count <= grain) {
+        for (int begin = 0; begin < count; begin += grain) {
+            task(userData, begin, (count - begin > grain) ? begin + grain : count, 0);
+        }
+        return;
+    }
+
+    // Contiguous shares keep each worker on neighbouring data until it steals
+    int threads = pool->threadCount;
+    for (int i = 0; i < threads; i++) {
+        pool->shares[i].next = (int)((long long)count * i / threads);
+        pool->shares[i].end = (int)((long long)count * (i + 1) / threads);
+    }
+
+    LockPoolMutex(&pool->mutex);
+    pool->task = task;
+    pool->userData = userData;
+    pool->grain = grain;
+    pool->busyWorkers = threads - 1;
+    pool->generation++;
+    WakeAllPoolCondition(&pool->wake);
+    UnlockPoolMutex(&pool->mutex);
+
+    RunThreadPoolShares(pool, 0);
+
+    LockPoolMutex(&pool->mutex);
+    while (pool->busyWorkers > 0) {
+        WaitPoolCondition(&pool->done, &pool->mutex);
+    }
+    UnlockPoolMutex(&pool->mutex);
+}
+
+//------------------------------------------------------------------------------
+// Background threads
+//------------------------------------------------------------------------------
+
+struct BackgroundThread {
+    PoolThread thread;
+    BackgroundTask task;
+    void* userData;
+};
+
+static POOL_THREAD_PROC BackgroundThreadMain(void* arg) {
+    BackgroundThread* thread = (BackgroundThread*)arg;
+    thread->task(thread->userData);
+    return POOL_THREAD_RETURN;
+}
+
+/**
+ * Run a task on a new thread
+ */
+BackgroundThread* StartBackgroundThread(BackgroundTask task, void* userData) {
+    if (task == NULL) return NULL;
+
+    BackgroundThread* thread = (BackgroundThread*)malloc(sizeof(BackgroundThread));
+    if (thread == NULL) return NULL;
+
+    thread->task = task;
+    thread->userData = userData;
+    if (!StartPoolThread(&thread->thread, BackgroundThreadMain, thread)) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+/**
+ * Wait for a background thread to finish and free its handle
+ */
+void JoinBackgroundThread(BackgroundThread* thread) {
+    if (thread == NULL) return;
+
+    JoinPoolThread(thread->thread);
+    free(thread);
+}
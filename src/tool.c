@@ -5,6 +5,11 @@
  */
 
 #include "tool.h"
+#include "redraw.h"
+#include "raster.h"
+#include "brush.h"
+#include "stroke.h"
+#include "input.h"
 #include "raylib.h"
 #include <stdlib.h>
 #include <math.h>
@@ -26,6 +31,23 @@ ToolState* CreateToolState(void) {
     state->lastPixelX = 0;
     state->lastPixelY = 0;
     state->hasLastPixel = false;
+    state->history = NULL;
+    state->brushSize = MIN_BRUSH_SIZE;
+    state->brushShape = BRUSH_ROUND;
+    state->brush = CreateBrush(BRUSH_ROUND, MIN_BRUSH_SIZE);
+    state->customBrush = NULL;
+    state->fillMode = FILL_CONTIGUOUS;
+    state->fillArena = CreateFillArena();
+    state->blendMode = PIXEL_BLEND_NORMAL;
+    state->strokeMask = CreateStrokeMask();
+
+    if (state->brush == NULL || state->fillArena == NULL || state->strokeMask == NULL) {
+        DestroyBrush(state->brush);
+        DestroyFillArena(state->fillArena);
+        DestroyStrokeMask(state->strokeMask);
+        free(state);
+        return NULL;
+    }
 
     return state;
 }
@@ -35,6 +57,10 @@ ToolState* CreateToolState(void) {
  */
 void DestroyToolState(ToolState* state) {
     if (state != NULL) {
+        DestroyBrush(state->brush);
+        DestroyBrush(state->customBrush);
+        DestroyFillArena(state->fillArena);
+        DestroyStrokeMask(state->strokeMask);
         free(state);
     }
 }
@@ -44,7 +70,10 @@ void DestroyToolState(ToolState* state) {
  */
 void SetCurrentTool(ToolState* state, ToolType tool) {
     if (state == NULL) return;
-    state->currentTool = tool;
+    if (state->currentTool != tool) {
+        state->currentTool = tool;
+        RequestRedraw(REDRAW_TOOL);
+    }
 }
 
 /**
@@ -55,12 +84,119 @@ ToolType GetCurrentTool(ToolState* state) {
     return state->currentTool;
 }
 
+/**
+ * Set the history that completed strokes are recorded into
+ */
+void SetToolHistory(ToolState* state, History* history) {
+    if (state == NULL) return;
+    state->history = history;
+}
+
+/**
+ * Get the brush strokes are stamped with
+ */
+static const Brush* GetActiveBrush(ToolState* state) {
+    if (state->brushShape == BRUSH_CUSTOM && state->customBrush != NULL) {
+        return state->customBrush;
+    }
+    return state->brush;
+}
+
+/**
+ * Rebuild the generated brush mask after a size or shape change
+ */
+static void RebuildBrush(ToolState* state) {
+    Brush* brush = CreateBrush(state->brushShape, state->brushSize);
+    if (brush == NULL) return; // Keep the previous mask on allocation failure
+
+    DestroyBrush(state->brush);
+    state->brush = brush;
+    RequestRedraw(REDRAW_TOOL);
+}
+
+/**
+ * Set the brush size
+ */
+void SetBrushSize(ToolState* state, int size) {
+    if (state == NULL) return;
+
+    if (size < MIN_BRUSH_SIZE) size = MIN_BRUSH_SIZE;
+    if (size > MAX_BRUSH_SIZE) size = MAX_BRUSH_SIZE;
+    if (size == state->brushSize) return;
+
+    state->brushSize = size;
+    RebuildBrush(state);
+}
+
+/**
+ * Set the brush shape
+ */
+void SetBrushShape(ToolState* state, BrushShape shape) {
+    if (state == NULL || shape == state->brushShape) return;
+
+    state->brushShape = shape;
+    RebuildBrush(state);
+}
+
+/**
+ * Set the mask used by BRUSH_CUSTOM
+ */
+bool SetCustomBrush(ToolState* state, const unsigned char* mask, int width, int height) {
+    if (state == NULL) return false;
+
+    Brush* brush = CreateCustomBrush(mask, width, height);
+    if (brush == NULL) return false;
+
+    DestroyBrush(state->customBrush);
+    state->customBrush = brush;
+    state->brushShape = BRUSH_CUSTOM;
+    RequestRedraw(REDRAW_TOOL);
+    return true;
+}
+
+/**
+ * Get the name of the current brush shape as a string
+ */
+const char* GetBrushShapeName(ToolState* state) {
+    if (state == NULL) return "Unknown";
+
+    switch (state->brushShape) {
+        case BRUSH_ROUND:
+            return "Round";
+        case BRUSH_SQUARE:
+            return "Square";
+        case BRUSH_CUSTOM:
+            return (state->customBrush != NULL) ? "Custom" : "Round";
+        default:
+            return "Unknown";
+    }
+}
+
+/**
+ * Set the fill tool mode
+ */
+void SetFillMode(ToolState* state, FillMode mode) {
+    if (state == NULL || state->fillMode == mode) return;
+    state->fillMode = mode;
+    RequestRedraw(REDRAW_TOOL);
+}
+
+/**
+ * Set the blend mode used by the pencil
+ */
+void SetBlendMode(ToolState* state, PixelBlendMode mode) {
+    if (state == NULL || (unsigned int)mode >= PIXEL_BLEND_COUNT || state->blendMode == mode) return;
+    state->blendMode = mode;
+    RequestRedraw(REDRAW_TOOL);
+}
+
 /**
  * Set the foreground color
  */
 void SetForegroundColor(ToolState* state, Color color) {
     if (state == NULL) return;
     state->foregroundColor = color;
+    RequestRedraw(REDRAW_TOOL);
 }
 
 /**
@@ -69,6 +205,7 @@ void SetForegroundColor(ToolState* state, Color color) {
 void SetBackgroundColor(ToolState* state, Color color) {
     if (state == NULL) return;
     state->backgroundColor = color;
+    RequestRedraw(REDRAW_TOOL);
 }
 
 /**
@@ -102,19 +239,29 @@ void DrawPixelWithTool(ToolState* state, Canvas* canvas, int pixelX, int pixelY)
     switch (state->currentTool) {
         case TOOL_PENCIL:
             // Draw with foreground color
-            SetPixel(canvas, pixelX, pixelY, state->foregroundColor);
+            BlendCanvasSpan(canvas, pixelX, pixelY, 1, state->foregroundColor, state->blendMode);
+            RequestRedraw(REDRAW_CANVAS);
             break;
 
         case TOOL_ERASER:
             // Erase by setting to transparent
             SetPixel(canvas, pixelX, pixelY, (Color){0, 0, 0, 0});
+            RequestRedraw(REDRAW_CANVAS);
             break;
 
         case TOOL_EYEDROPPER:
             // Sample color from canvas and set as foreground color
             {
                 Color sampledColor = GetPixel(canvas, pixelX, pixelY);
-                state->foregroundColor = sampledColor;
+                SetForegroundColor(state, sampledColor);
+            }
+            break;
+
+        case TOOL_FILL:
+            // Fill the region under the pixel with foreground color
+            if (FloodFillCanvas(canvas, state->fillArena, pixelX, pixelY,
+                                state->foregroundColor, state->fillMode) > 0) {
+                RequestRedraw(REDRAW_CANVAS);
             }
             break;
 
@@ -124,100 +271,247 @@ void DrawPixelWithTool(ToolState* state, Canvas* canvas, int pixelX, int pixelY)
 }
 
 /**
- * Draw a line between two points using Bresenham's line algorithm
- * This is used for smooth drag drawing
+ * Per-line state shared by the span callback
+ */
+typedef struct {
+    Canvas* canvas;
+    Color color;
+    PixelBlendMode mode;
+    StrokeMask* mask;       // Set when pixels must be painted at most once per stroke
+} ToolSpanContext;
+
+/**
+ * Write one span with the resolved tool color and blend mode
+ * The canvas lookup and bounds handling happen once per run, not once per pixel
+ */
+static void WriteToolSpan(void* userData, RasterSpan span) {
+    ToolSpanContext* context = (ToolSpanContext*)userData;
+
+    if (span.vertical) {
+        BlendCanvasColumn(context->canvas, span.x, span.y, span.length, context->color, context->mode);
+    } else {
+        BlendCanvasSpan(context->canvas, span.x, span.y, span.length, context->color, context->mode);
+    }
+}
+
+/**
+ * Write one rasterized span, skipping pixels this stroke already painted
+ * when repeated painting would change the result
+ */
+static void ApplyToolSpan(void* userData, RasterSpan span) {
+    ToolSpanContext* context = (ToolSpanContext*)userData;
+
+    if (context->mask != NULL) {
+        ClaimStrokeSpan(context->mask, span, WriteToolSpan, context);
+    } else {
+        WriteToolSpan(context, span);
+    }
+}
+
+/**
+ * Resolve the color and blend mode the current tool paints with
+ * Returns false for tools that do not paint
  */
-static void DrawLineBetweenPixels(ToolState* state, Canvas* canvas, int x0, int y0, int x1, int y1) {
-    // Bresenham's line algorithm
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-
-    int x = x0;
-    int y = y0;
-
-    while (true) {
-        // Draw pixel at current position
-        DrawPixelWithTool(state, canvas, x, y);
-
-        // Check if we've reached the end
-        if (x == x1 && y == y1) {
+static bool ResolveToolPaint(ToolState* state, Canvas* canvas, ToolSpanContext* context) {
+    context->canvas = canvas;
+    context->mask = NULL;
+
+    switch (state->currentTool) {
+        case TOOL_PENCIL:
+            context->color = state->foregroundColor;
+            context->mode = state->blendMode;
             break;
-        }
 
-        // Calculate error and step
-        int e2 = 2 * err;
+        case TOOL_ERASER:
+            context->color = (Color){0, 0, 0, 0};
+            context->mode = PIXEL_BLEND_REPLACE;
+            break;
 
-        if (e2 > -dy) {
-            err -= dy;
-            x += sx;
-        }
+        default:
+            return false;
+    }
+
+    // Overwriting is idempotent; blending the same pixel twice is not
+    bool overwrites = context->mode == PIXEL_BLEND_REPLACE ||
+                      (context->mode == PIXEL_BLEND_NORMAL && context->color.a == 255);
+    if (!overwrites && state->isDrawing) {
+        context->mask = state->strokeMask;
+    }
+    return true;
+}
+
+/**
+ * Stamp the current brush once with the current tool
+ */
+void StampWithTool(ToolState* state, Canvas* canvas, int pixelX, int pixelY) {
+    if (state == NULL || canvas == NULL) return;
 
-        if (e2 < dx) {
-            err += dx;
-            y += sy;
+    ToolSpanContext context;
+    if (!ResolveToolPaint(state, canvas, &context)) {
+        DrawPixelWithTool(state, canvas, pixelX, pixelY);
+        return;
+    }
+
+    int spans = StampBrush(GetActiveBrush(state), pixelX, pixelY, 0, 0, canvas->width - 1, canvas->height - 1,
+                           ApplyToolSpan, &context);
+    if (spans > 0) {
+        RequestRedraw(REDRAW_CANVAS);
+    }
+}
+
+/**
+ * Draw a line between two points with the current tool
+ */
+void DrawLineWithTool(ToolState* state, Canvas* canvas, int x0, int y0, int x1, int y1) {
+    if (state == NULL || canvas == NULL) return;
+
+    // Resolve the tool effect once for the whole line
+    ToolSpanContext context;
+    if (!ResolveToolPaint(state, canvas, &context)) {
+        if (state->currentTool == TOOL_EYEDROPPER) {
+            // No line effect: sample where the drag ends
+            DrawPixelWithTool(state, canvas, x1, y1);
         }
+        return;
+    }
+
+    int spans;
+    const Brush* brush = GetActiveBrush(state);
+    if (IsSinglePixelBrush(brush)) {
+        spans = RasterizeLine(x0, y0, x1, y1, 0, 0, canvas->width - 1, canvas->height - 1,
+                              ApplyToolSpan, &context);
+    } else {
+        spans = StampBrushLine(brush, x0, y0, x1, y1, 0, 0, canvas->width - 1, canvas->height - 1,
+                               ApplyToolSpan, &context);
+    }
+    if (spans > 0) {
+        RequestRedraw(REDRAW_CANVAS);
     }
 }
 
 /**
- * Update tool state based on user input
+ * Start a stroke: open a history step and forget the previous stroke's coverage
  */
-void UpdateToolState(ToolState* state, Canvas* canvas, CanvasCamera* camera, int pixelSize) {
-    if (state == NULL || canvas == NULL || camera == NULL) return;
+void BeginToolStroke(ToolState* state, Canvas* canvas) {
+    if (state == NULL || canvas == NULL) return;
+
+    state->isDrawing = true;
+    state->hasLastPixel = false; // Reset for new stroke
+    BeginHistoryStep(state->history, canvas);
+    ResetStrokeMask(state->strokeMask, canvas);
+}
+
+/**
+ * Finish the current stroke and commit it to the history
+ */
+void EndToolStroke(ToolState* state) {
+    if (state == NULL) return;
+
+    state->isDrawing = false;
+    state->hasLastPixel = false;
+    EndHistoryStep(state->history);
+    RequestRedraw(REDRAW_TOOL); // Undo/redo availability changed
+}
+
+/**
+ * Handle tool, brush and color keyboard shortcuts
+ */
+static void UpdateToolShortcuts(ToolState* state) {
+    // Ctrl combinations belong to the application (Ctrl+E exports, ...)
+    if (IsInputKeyDown(KEY_LEFT_CONTROL) || IsInputKeyDown(KEY_RIGHT_CONTROL)) return;
 
     // --- Handle Tool Switching with Keyboard Shortcuts ---
 
-    if (IsKeyPressed(KEY_B)) {
+    if (IsInputKeyPressed(KEY_B)) {
         SetCurrentTool(state, TOOL_PENCIL);
     }
 
-    if (IsKeyPressed(KEY_E)) {
+    if (IsInputKeyPressed(KEY_E)) {
         SetCurrentTool(state, TOOL_ERASER);
     }
 
-    if (IsKeyPressed(KEY_I)) {
+    if (IsInputKeyPressed(KEY_I)) {
         SetCurrentTool(state, TOOL_EYEDROPPER);
     }
 
+    if (IsInputKeyPressed(KEY_G)) {
+        if (IsInputKeyDown(KEY_LEFT_SHIFT) || IsInputKeyDown(KEY_RIGHT_SHIFT)) {
+            SetFillMode(state, (state->fillMode == FILL_CONTIGUOUS) ? FILL_GLOBAL : FILL_CONTIGUOUS);
+        }
+        SetCurrentTool(state, TOOL_FILL);
+    }
+
+    // --- Handle Brush Size and Shape ---
+
+    if (IsInputKeyPressed(KEY_LEFT_BRACKET)) {
+        SetBrushSize(state, state->brushSize - 1);
+    }
+
+    if (IsInputKeyPressed(KEY_RIGHT_BRACKET)) {
+        SetBrushSize(state, state->brushSize + 1);
+    }
+
+    if (IsInputKeyPressed(KEY_K)) {
+        // Cycle round -> square -> custom (if one is loaded) -> round
+        BrushShape next = BRUSH_ROUND;
+        if (state->brushShape == BRUSH_ROUND) {
+            next = BRUSH_SQUARE;
+        } else if (state->brushShape == BRUSH_SQUARE && state->customBrush != NULL) {
+            next = BRUSH_CUSTOM;
+        }
+        SetBrushShape(state, next);
+    }
+
+    // --- Handle Blend Mode ---
+
+    if (IsInputKeyPressed(KEY_M)) {
+        SetBlendMode(state, (PixelBlendMode)((state->blendMode + 1) % PIXEL_BLEND_COUNT));
+    }
+
     // --- Handle Color Swapping ---
 
-    if (IsKeyPressed(KEY_X)) {
+    if (IsInputKeyPressed(KEY_X)) {
         SwapColors(state);
     }
+}
+
+/**
+ * Update tool state based on user input
+ */
+void UpdateToolState(ToolState* state, Canvas* canvas, CanvasCamera* camera, int pixelSize) {
+    if (state == NULL || canvas == NULL || camera == NULL) return;
+
+    UpdateToolShortcuts(state);
 
     // --- Handle Drawing Input ---
 
     // Don't draw if the camera is panning
     // Camera pans with middle mouse or spacebar + left mouse
     bool isPanning = camera->isPanning;
-    bool spacebarDown = IsKeyDown(KEY_SPACE);
+    bool spacebarDown = IsInputKeyDown(KEY_SPACE);
 
     // Only allow drawing with left mouse if not panning
     bool canDraw = !isPanning && !spacebarDown;
 
     if (canDraw) {
         // Check if left mouse button is pressed or held
-        bool leftMousePressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
-        bool leftMouseDown = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+        bool leftMousePressed = IsInputMouseButtonPressed(MOUSE_BUTTON_LEFT);
+        bool leftMouseDown = IsInputMouseButtonDown(MOUSE_BUTTON_LEFT);
 
         if (leftMousePressed) {
             // Start drawing
-            state->isDrawing = true;
-            state->hasLastPixel = false; // Reset for new stroke
+            BeginToolStroke(state, canvas);
 
             // Get mouse position and convert to canvas coordinates
-            Vector2 mousePos = GetMousePosition();
+            Vector2 mousePos = GetInputMousePosition();
             Vector2 pixelPos = ScreenToPixel((int)mousePos.x, (int)mousePos.y,
                                             camera->position, camera->zoom, pixelSize);
 
             int pixelX = (int)floor(pixelPos.x);
             int pixelY = (int)floor(pixelPos.y);
 
-            // Draw the pixel
-            DrawPixelWithTool(state, canvas, pixelX, pixelY);
+            // Stamp the brush at the stroke start
+            StampWithTool(state, canvas, pixelX, pixelY);
 
             // Store last pixel position for drag drawing
             state->lastPixelX = pixelX;
@@ -226,7 +520,7 @@ void UpdateToolState(ToolState* state, Canvas* canvas, CanvasCamera* camera, int
 
         } else if (leftMouseDown && state->isDrawing) {
             // Continue drawing (drag)
-            Vector2 mousePos = GetMousePosition();
+            Vector2 mousePos = GetInputMousePosition();
             Vector2 pixelPos = ScreenToPixel((int)mousePos.x, (int)mousePos.y,
                                             camera->position, camera->zoom, pixelSize);
 
@@ -237,31 +531,29 @@ void UpdateToolState(ToolState* state, Canvas* canvas, CanvasCamera* camera, int
             if (state->hasLastPixel &&
                 (pixelX != state->lastPixelX || pixelY != state->lastPixelY)) {
                 // Draw a line from last pixel to current pixel for smooth drawing
-                DrawLineBetweenPixels(state, canvas,
-                                    state->lastPixelX, state->lastPixelY,
-                                    pixelX, pixelY);
+                DrawLineWithTool(state, canvas,
+                                 state->lastPixelX, state->lastPixelY,
+                                 pixelX, pixelY);
 
                 // Update last pixel position
                 state->lastPixelX = pixelX;
                 state->lastPixelY = pixelY;
             } else if (!state->hasLastPixel) {
                 // First pixel in drag (shouldn't happen, but handle it)
-                DrawPixelWithTool(state, canvas, pixelX, pixelY);
+                StampWithTool(state, canvas, pixelX, pixelY);
                 state->lastPixelX = pixelX;
                 state->lastPixelY = pixelY;
                 state->hasLastPixel = true;
             }
 
-        } else {
+        } else if (state->isDrawing) {
             // Mouse released, stop drawing
-            state->isDrawing = false;
-            state->hasLastPixel = false;
+            EndToolStroke(state);
         }
     } else {
         // Can't draw while panning, stop drawing state
         if (state->isDrawing) {
-            state->isDrawing = false;
-            state->hasLastPixel = false;
+            EndToolStroke(state);
         }
     }
 }
@@ -279,6 +571,8 @@ const char* GetToolName(ToolState* state) {
             return "Eraser";
         case TOOL_EYEDROPPER:
             return "Eyedropper";
+        case TOOL_FILL:
+            return (state->fillMode == FILL_GLOBAL) ? "Fill (Global)" : "Fill";
         default:
             return "Unknown";
     }
@@ -293,4 +587,5 @@ void SwapColors(ToolState* state) {
     Color temp = state->foregroundColor;
     state->foregroundColor = state->backgroundColor;
     state->backgroundColor = temp;
+    RequestRedraw(REDRAW_TOOL);
 }
@@ -0,0 +1,168 @@
+/**
+ * transform.c
+ *
+ * Implementation of Canvas Transforms
+ */
+
+#include "transform.h"
+#include <stdlib.h>
+
+/**
+ * Create the destination canvas of a transform, with the source's empty color
+ */
+static Canvas* CreateTransformTarget(Canvas* source, int width, int height) {
+    Canvas* canvas = CreateCanvas(width, height);
+    if (canvas != NULL) {
+        ClearCanvas(canvas, source->emptyColor);
+    }
+    return canvas;
+}
+
+/**
+ * Resize a canvas with nearest-neighbor sampling
+ */
+Canvas* ScaleCanvas(Canvas* source, int width, int height) {
+    if (source == NULL) return NULL;
+
+    Canvas* canvas = CreateTransformTarget(source, width, height);
+    Color* sourceRow = (Color*)malloc(sizeof(Color) * source->width);
+    Color* row = (Color*)malloc(sizeof(Color) * (size_t)width);
+    int* columns = (int*)malloc(sizeof(int) * (size_t)width);
+    bool ok = canvas != NULL && sourceRow != NULL && row != NULL && columns != NULL;
+
+    // Sample at pixel centers so scaling by whole factors repeats pixels evenly
+    for (int x = 0; x < width && ok; x++) {
+        columns[x] = (int)(((long long)x * 2 + 1) * source->width / (2LL * width));
+    }
+
+    int lastSourceY = -1;
+    for (int y = 0; y < height && ok; y++) {
+        int sourceY = (int)(((long long)y * 2 + 1) * source->height / (2LL * height));
+        if (sourceY != lastSourceY) {
+            ReadCanvasRow(source, sourceY, sourceRow);
+            for (int x = 0; x < width; x++) {
+                row[x] = sourceRow[columns[x]];
+            }
+            lastSourceY = sourceY;
+        }
+        ok = WriteCanvasRow(canvas, y, row);
+    }
+
+    free(sourceRow);
+    free(row);
+    free(columns);
+    if (!ok) {
+        DestroyCanvas(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+/**
+ * Mirror a canvas
+ */
+Canvas* FlipCanvas(Canvas* source, bool horizontal, bool vertical) {
+    if (source == NULL) return NULL;
+
+    Canvas* canvas = CreateTransformTarget(source, source->width, source->height);
+    Color* row = (Color*)malloc(sizeof(Color) * source->width);
+    bool ok = canvas != NULL && row != NULL;
+
+    for (int y = 0; y < source->height && ok; y++) {
+        ReadCanvasRow(source, vertical ? source->height - 1 - y : y, row);
+        if (horizontal) {
+            for (int left = 0, right = source->width - 1; left < right; left++, right--) {
+                Color swap = row[left];
+                row[left] = row[right];
+                row[right] = swap;
+            }
+        }
+        ok = WriteCanvasRow(canvas, y, row);
+    }
+
+    free(row);
+    if (!ok) {
+        DestroyCanvas(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+/**
+ * Copy a rectangle of a canvas into a new canvas
+ */
+Canvas* CropCanvas(Canvas* source, CanvasRect rect) {
+    if (source == NULL || rect.x < 0 || rect.y < 0 || rect.width <= 0 || rect.height <= 0 ||
+        rect.x + rect.width > source->width || rect.y + rect.height > source->height) {
+        return NULL;
+    }
+
+    Canvas* canvas = CreateTransformTarget(source, rect.width, rect.height);
+    Color* row = (Color*)malloc(sizeof(Color) * source->width);
+    bool ok = canvas != NULL && row != NULL;
+
+    for (int y = 0; y < rect.height && ok; y++) {
+        ReadCanvasRow(source, rect.y + y, row);
+        ok = WriteCanvasRow(canvas, y, row + rect.x);
+    }
+
+    free(row);
+    if (!ok) {
+        DestroyCanvas(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+/**
+ * Find the smallest rectangle holding every pixel that is not fully transparent
+ */
+bool GetCanvasContentBounds(Canvas* canvas, CanvasRect* bounds) {
+    if (canvas == NULL || bounds == NULL) return false;
+
+    int minX = canvas->width;
+    int minY = canvas->height;
+    int maxX = -1;
+    int maxY = -1;
+
+    for (int tileY = 0; tileY < canvas->tilesY; tileY++) {
+        for (int tileX = 0; tileX < canvas->tilesX; tileX++) {
+            int x0 = tileX << CANVAS_TILE_SHIFT;
+            int y0 = tileY << CANVAS_TILE_SHIFT;
+            int width = (canvas->width - x0 < CANVAS_TILE_SIZE) ? canvas->width - x0 : CANVAS_TILE_SIZE;
+            int height = (canvas->height - y0 < CANVAS_TILE_SIZE) ? canvas->height - y0 : CANVAS_TILE_SIZE;
+
+            const Color* pixels = GetCanvasTilePixels(canvas, tileY * canvas->tilesX + tileX);
+            if (pixels == NULL) {
+                if (canvas->emptyColor.a == 0) continue;
+
+                // An empty tile in an opaque empty color is content throughout
+                if (x0 < minX) minX = x0;
+                if (y0 < minY) minY = y0;
+                if (x0 + width - 1 > maxX) maxX = x0 + width - 1;
+                if (y0 + height - 1 > maxY) maxY = y0 + height - 1;
+                continue;
+            }
+
+            for (int y = 0; y < height; y++) {
+                const Color* line = pixels + (y << CANVAS_TILE_SHIFT);
+                int first = 0;
+                while (first < width && line[first].a == 0) first++;
+                if (first == width) continue;
+
+                int last = width - 1;
+                while (line[last].a == 0) last--;
+
+                if (x0 + first < minX) minX = x0 + first;
+                if (x0 + last > maxX) maxX = x0 + last;
+                if (y0 + y < minY) minY = y0 + y;
+                if (y0 + y > maxY) maxY = y0 + y;
+            }
+        }
+    }
+
+    if (maxX < 0) return false;
+
+    *bounds = (CanvasRect){minX, minY, maxX - minX + 1, maxY - minY + 1};
+    return true;
+}
@@ -1,5 +1,8 @@
 #include "ui.h"
+#include "redraw.h"
+#include "input.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 #define SLIDER_HEIGHT 20
 #define SLIDER_SPACING 10
@@ -14,6 +17,9 @@ ColorPicker InitColorPicker(float x, float y, float width, float height) {
     picker.isOpen = false;
     picker.bounds = (Rectangle){x, y, width, height};
     picker.activeSlider = 0;
+    picker.hasTextures = false;
+    picker.gradientsValid = false;
+    picker.stats = (ColorPickerStats){0};
 
     // Initialize slider positions
     float sliderY = y + 30;
@@ -37,10 +43,10 @@ bool UpdateColorPicker(ColorPicker* picker, Color* outputColor) {
     if (!picker->isOpen) return false;
 
     bool colorChanged = false;
-    Vector2 mousePos = GetMousePosition();
-    bool mousePressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
-    bool mouseDown = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
-    bool mouseReleased = IsMouseButtonReleased(MOUSE_LEFT_BUTTON);
+    Vector2 mousePos = GetInputMousePosition();
+    bool mousePressed = IsInputMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    bool mouseDown = IsInputMouseButtonDown(MOUSE_BUTTON_LEFT);
+    bool mouseReleased = IsInputMouseButtonReleased(MOUSE_BUTTON_LEFT);
 
     // Handle slider dragging
     if (mousePressed) {
@@ -56,8 +62,9 @@ bool UpdateColorPicker(ColorPicker* picker, Color* outputColor) {
         }
     }
 
-    if (mouseReleased) {
+    if (mouseReleased && picker->activeSlider != 0) {
         picker->activeSlider = 0;
+        RequestRedraw(REDRAW_UI);
     }
 
     // Update slider values while dragging
@@ -98,119 +105,212 @@ bool UpdateColorPicker(ColorPicker* picker, Color* outputColor) {
     // Update output color if changed
     if (colorChanged) {
         *outputColor = HSVToColor(picker->currentHSV, picker->alpha);
+        RequestRedraw(REDRAW_UI);
     }
 
     return colorChanged;
 }
 
+// Create a one-row texture for a gradient strip
+static Texture2D LoadStripTexture(int width) {
+    Image image = GenImageColor(width, 1, BLANK);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+    return texture;
+}
+
+// Create the picker's textures on first draw (needs a GL context)
+static bool LoadColorPickerTextures(ColorPicker* picker) {
+    int width = (int)picker->hueSlider.width;
+    if (width <= 0) return false;
+
+    // Allocated before any texture so a failure leaves nothing to unload
+    Color* pixels = (Color*)malloc(sizeof(Color) * width);
+    if (pixels == NULL) return false;
+
+    picker->hueTexture = LoadStripTexture(width);
+    picker->saturationTexture = LoadStripTexture(width);
+    picker->valueTexture = LoadStripTexture(width);
+    picker->alphaTexture = LoadStripTexture(width);
+
+    Image checker = GenImageChecked(16, 16, 8, 8, LIGHTGRAY, DARKGRAY);
+    picker->checkerTexture = LoadTextureFromImage(checker);
+    UnloadImage(checker);
+    SetTextureWrap(picker->checkerTexture, TEXTURE_WRAP_REPEAT);
+
+    picker->hasTextures = true;
+    picker->gradientsValid = false;
+
+    // The hue strip never changes, fill it once
+    for (int i = 0; i < width; i++) {
+        ColorHSV hsv = {((float)i / width) * 360.0f, 1.0f, 1.0f};
+        pixels[i] = HSVToColor(hsv, 255);
+    }
+    UpdateTexture(picker->hueTexture, pixels);
+    picker->stats.colorConversions += width;
+    picker->stats.gradientUpdates++;
+    free(pixels);
+
+    return true;
+}
+
+// Rebuild the gradients that depend on the current HSV, only if it changed
+static void UpdateColorPickerGradients(ColorPicker* picker) {
+    ColorHSV hsv = picker->currentHSV;
+    ColorHSV old = picker->gradientHSV;
+    bool valid = picker->gradientsValid;
+
+    // Saturation depends on hue/value, value on hue/saturation, alpha on all three
+    bool saturationStale = !valid || hsv.h != old.h || hsv.v != old.v;
+    bool valueStale = !valid || hsv.h != old.h || hsv.s != old.s;
+    bool alphaStale = saturationStale || valueStale;
+    if (!alphaStale) return;
+
+    int width = picker->saturationTexture.width;
+    Color* pixels = (Color*)malloc(sizeof(Color) * width);
+    if (pixels == NULL) return;
+
+    if (saturationStale) {
+        for (int i = 0; i < width; i++) {
+            pixels[i] = HSVToColor((ColorHSV){hsv.h, (float)i / width, hsv.v}, 255);
+        }
+        UpdateTexture(picker->saturationTexture, pixels);
+        picker->stats.colorConversions += width;
+        picker->stats.gradientUpdates++;
+    }
+
+    if (valueStale) {
+        for (int i = 0; i < width; i++) {
+            pixels[i] = HSVToColor((ColorHSV){hsv.h, hsv.s, (float)i / width}, 255);
+        }
+        UpdateTexture(picker->valueTexture, pixels);
+        picker->stats.colorConversions += width;
+        picker->stats.gradientUpdates++;
+    }
+
+    // Alpha strip: the current color faded over a 4px checkerboard, blended
+    // here so the strip is a single opaque texture
+    Color color = HSVToColor(hsv, 255);
+    picker->stats.colorConversions++;
+    for (int i = 0; i < width; i++) {
+        Color check = ((i / 4) % 2 == 0) ? LIGHTGRAY : DARKGRAY;
+        int a = (i * 255) / width;
+        pixels[i] = (Color){
+            (unsigned char)((color.r * a + check.r * (255 - a)) / 255),
+            (unsigned char)((color.g * a + check.g * (255 - a)) / 255),
+            (unsigned char)((color.b * a + check.b * (255 - a)) / 255),
+            255
+        };
+    }
+    UpdateTexture(picker->alphaTexture, pixels);
+    picker->stats.gradientUpdates++;
+
+    free(pixels);
+    picker->gradientHSV = hsv;
+    picker->gradientsValid = true;
+}
+
+// Draw a cached gradient strip stretched over a slider
+static void DrawGradientStrip(Texture2D texture, Rectangle slider) {
+    Rectangle source = {0.0f, 0.0f, (float)texture.width, 1.0f};
+    DrawTexturePro(texture, source, slider, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+}
+
 void DrawColorPicker(ColorPicker* picker, Color currentColor) {
+    picker->stats = (ColorPickerStats){0};
     if (!picker->isOpen) return;
 
+    if (!picker->hasTextures && !LoadColorPickerTextures(picker)) return;
+    UpdateColorPickerGradients(picker);
+
+    int drawCalls = 0;
+
     // Draw background panel
     DrawRectangleRec(picker->bounds, (Color){50, 50, 50, 240});
     DrawRectangleLinesEx(picker->bounds, 2, LIGHTGRAY);
 
     // Draw title
     DrawText("Color Picker", picker->bounds.x + 10, picker->bounds.y + 5, 20, WHITE);
+    drawCalls += 3;
 
     float labelX = picker->bounds.x + 10;
     float valueX = picker->bounds.x + picker->bounds.width - 50;
 
     // Draw Hue slider
     DrawText("H:", labelX, picker->hueSlider.y + 3, 16, WHITE);
-
-    // Draw hue gradient background
-    for (int i = 0; i < picker->hueSlider.width; i++) {
-        float hue = (i / picker->hueSlider.width) * 360.0f;
-        ColorHSV hsv = {hue, 1.0f, 1.0f};
-        Color hueColor = HSVToColor(hsv, 255);
-        DrawRectangle(picker->hueSlider.x + i, picker->hueSlider.y, 1, picker->hueSlider.height, hueColor);
-    }
-
+    DrawGradientStrip(picker->hueTexture, picker->hueSlider);
     DrawRectangleLinesEx(picker->hueSlider, 1, WHITE);
 
     // Draw hue handle
     float hueHandleX = picker->hueSlider.x + (picker->currentHSV.h / 360.0f) * picker->hueSlider.width;
     DrawRectangle(hueHandleX - 2, picker->hueSlider.y, 4, picker->hueSlider.height, BLACK);
     DrawText(TextFormat("%.0f", picker->currentHSV.h), valueX, picker->hueSlider.y + 3, 16, WHITE);
+    drawCalls += 5;
 
     // Draw Saturation slider
     DrawText("S:", labelX, picker->saturationSlider.y + 3, 16, WHITE);
-
-    // Draw saturation gradient
-    for (int i = 0; i < picker->saturationSlider.width; i++) {
-        float sat = i / picker->saturationSlider.width;
-        ColorHSV hsv = {picker->currentHSV.h, sat, picker->currentHSV.v};
-        Color satColor = HSVToColor(hsv, 255);
-        DrawRectangle(picker->saturationSlider.x + i, picker->saturationSlider.y, 1, picker->saturationSlider.height, satColor);
-    }
-
+    DrawGradientStrip(picker->saturationTexture, picker->saturationSlider);
     DrawRectangleLinesEx(picker->saturationSlider, 1, WHITE);
 
     // Draw saturation handle
     float satHandleX = picker->saturationSlider.x + picker->currentHSV.s * picker->saturationSlider.width;
     DrawRectangle(satHandleX - 2, picker->saturationSlider.y, 4, picker->saturationSlider.height, BLACK);
     DrawText(TextFormat("%.2f", picker->currentHSV.s), valueX, picker->saturationSlider.y + 3, 16, WHITE);
+    drawCalls += 5;
 
     // Draw Value slider
     DrawText("V:", labelX, picker->valueSlider.y + 3, 16, WHITE);
-
-    // Draw value gradient
-    for (int i = 0; i < picker->valueSlider.width; i++) {
-        float val = i / picker->valueSlider.width;
-        ColorHSV hsv = {picker->currentHSV.h, picker->currentHSV.s, val};
-        Color valColor = HSVToColor(hsv, 255);
-        DrawRectangle(picker->valueSlider.x + i, picker->valueSlider.y, 1, picker->valueSlider.height, valColor);
-    }
-
+    DrawGradientStrip(picker->valueTexture, picker->valueSlider);
     DrawRectangleLinesEx(picker->valueSlider, 1, WHITE);
 
     // Draw value handle
     float valHandleX = picker->valueSlider.x + picker->currentHSV.v * picker->valueSlider.width;
     DrawRectangle(valHandleX - 2, picker->valueSlider.y, 4, picker->valueSlider.height, BLACK);
     DrawText(TextFormat("%.2f", picker->currentHSV.v), valueX, picker->valueSlider.y + 3, 16, WHITE);
+    drawCalls += 5;
 
-    // Draw Alpha slider
+    // Draw Alpha slider (checkerboard is baked into the strip)
     DrawText("A:", labelX, picker->alphaSlider.y + 3, 16, WHITE);
-
-    // Draw alpha gradient with checkerboard background
-    for (int i = 0; i < picker->alphaSlider.width; i++) {
-        // Checkerboard pattern
-        int checkSize = 4;
-        int checkX = i / checkSize;
-        int checkY = 0;
-        Color checkColor = ((checkX + checkY) % 2 == 0) ? LIGHTGRAY : DARKGRAY;
-        DrawRectangle(picker->alphaSlider.x + i, picker->alphaSlider.y, 1, picker->alphaSlider.height, checkColor);
-
-        // Alpha color overlay
-        float alpha = i / picker->alphaSlider.width;
-        Color alphaColor = HSVToColor(picker->currentHSV, (unsigned char)(alpha * 255));
-        DrawRectangle(picker->alphaSlider.x + i, picker->alphaSlider.y, 1, picker->alphaSlider.height, alphaColor);
-    }
-
+    DrawGradientStrip(picker->alphaTexture, picker->alphaSlider);
     DrawRectangleLinesEx(picker->alphaSlider, 1, WHITE);
 
     // Draw alpha handle
     float alphaHandleX = picker->alphaSlider.x + (picker->alpha / 255.0f) * picker->alphaSlider.width;
     DrawRectangle(alphaHandleX - 2, picker->alphaSlider.y, 4, picker->alphaSlider.height, BLACK);
     DrawText(TextFormat("%d", picker->alpha), valueX, picker->alphaSlider.y + 3, 16, WHITE);
+    drawCalls += 5;
 
     // Draw color preview
     float previewY = picker->alphaSlider.y + SLIDER_HEIGHT + SLIDER_SPACING + 10;
     float previewSize = 60;
     float previewX = picker->bounds.x + (picker->bounds.width - previewSize) / 2;
+    Rectangle preview = {previewX, previewY, previewSize, previewSize};
 
-    // Checkerboard background for preview
-    int checkSize = 8;
-    for (int y = 0; y < previewSize; y += checkSize) {
-        for (int x = 0; x < previewSize; x += checkSize) {
-            Color checkColor = (((x / checkSize) + (y / checkSize)) % 2 == 0) ? LIGHTGRAY : DARKGRAY;
-            DrawRectangle(previewX + x, previewY + y, checkSize, checkSize, checkColor);
-        }
-    }
+    // Checkerboard background for preview (one repeated quad)
+    DrawTexturePro(picker->checkerTexture, (Rectangle){0.0f, 0.0f, previewSize, previewSize},
+                   preview, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
 
-    DrawRectangle(previewX, previewY, previewSize, previewSize, currentColor);
-    DrawRectangleLinesEx((Rectangle){previewX, previewY, previewSize, previewSize}, 2, WHITE);
+    DrawRectangleRec(preview, currentColor);
+    DrawRectangleLinesEx(preview, 2, WHITE);
+    drawCalls += 3;
+
+    picker->stats.drawCalls = drawCalls;
+}
+
+void UnloadColorPicker(ColorPicker* picker) {
+    if (!picker->hasTextures) return;
+
+    UnloadTexture(picker->hueTexture);
+    UnloadTexture(picker->saturationTexture);
+    UnloadTexture(picker->valueTexture);
+    UnloadTexture(picker->alphaTexture);
+    UnloadTexture(picker->checkerTexture);
+    picker->hasTextures = false;
+}
+
+ColorPickerStats GetColorPickerStats(ColorPicker* picker) {
+    return picker->stats;
 }
 
 void DrawColorSwatches(float x, float y, float size, Color foreground, Color background) {
@@ -248,16 +348,41 @@ void DrawColorSwatches(float x, float y, float size, Color foreground, Color bac
     DrawRectangleLines(fgX, fgY, fgSize, fgSize, BLACK);
 }
 
+void DrawLayerPanel(LayerStack* stack, float x, float y) {
+    if (stack == NULL) return;
+
+    DrawText(TextFormat("Layers (%d) | N = New | Del = Delete | PgUp/PgDn = Select (+Shift = Move) | V = Hide | O = Opacity | L = Blend",
+             stack->count), x, y, 14, GRAY);
+
+    const int rowHeight = 18;
+    float rowY = y + rowHeight;
+    for (int i = stack->count - 1; i >= 0; i--) {
+        Layer* layer = &stack->layers[i];
+        bool isActive = (i == stack->activeIndex);
+        Color textColor = isActive ? WHITE : (layer->visible ? LIGHTGRAY : GRAY);
+
+        if (isActive) {
+            DrawRectangle(x - 4, rowY - 2, 320, rowHeight, (Color){255, 255, 255, 40});
+        }
+        DrawText(TextFormat("%s %-20s %3d%%  %s", layer->visible ? "[o]" : "[ ]", layer->name,
+                 (layer->opacity * 100 + 127) / 255, GetPixelBlendModeName(layer->blendMode)),
+                 x, rowY, 14, textColor);
+        rowY += rowHeight;
+    }
+}
+
 bool IsMouseOverColorPicker(ColorPicker* picker) {
     if (!picker->isOpen) return false;
-    return CheckCollisionPointRec(GetMousePosition(), picker->bounds);
+    return CheckCollisionPointRec(GetInputMousePosition(), picker->bounds);
 }
 
 void ToggleColorPicker(ColorPicker* picker) {
     picker->isOpen = !picker->isOpen;
+    RequestRedraw(REDRAW_UI);
 }
 
 void SetColorPickerColor(ColorPicker* picker, Color color) {
     picker->currentHSV = ColorToHSV(color);
     picker->alpha = color.a;
+    RequestRedraw(REDRAW_UI);
 }